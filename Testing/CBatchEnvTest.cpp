@@ -0,0 +1,99 @@
+/**
+ * \file CBatchEnvTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "BatchEnv.h"
+#include "Solver.h"
+#include "Game.h"
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CBatchEnvTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCBatchEnvReset)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CBatchEnv env(&game, 3, 30);
+			Assert::AreEqual(3, env.GetCount());
+			Assert::AreEqual(4, env.GetLevelCount());
+
+			vector<float> observations(3 * CBatchEnv::ObservationSize);
+			env.Reset(1, observations.data());
+
+			// Every instance starts the same, with the whole time limit
+			// left and the cargo at the bottom
+			for (int i = 0; i < 3; i++)
+			{
+				const float* observation = &observations[i * CBatchEnv::ObservationSize];
+				Assert::AreEqual(observations[0], observation[0]);
+				Assert::AreEqual(1.0f, observation[3]);
+				Assert::AreEqual(0.0f, observation[4 + CBatchEnv::ClickCargo]);
+			}
+		}
+
+		TEST_METHOD(TestCBatchEnvPlaysSolution)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSolver solver(&game);
+			CSolver::Solution solution = solver.Solve(1, 60);
+			Assert::IsTrue(solution.mSolved);
+
+			// Instance 0 plays the solution, instance 1 waits where it starts
+			CBatchEnv env(&game, 2, 60);
+			vector<float> observations(2 * CBatchEnv::ObservationSize);
+			vector<float> rewards(2);
+			vector<unsigned char> done(2);
+			env.Reset(1, observations.data());
+
+			auto& inputs = solution.mScript.GetInputs();
+			size_t next = 0;
+			int step = CLaneModel::GetReadyStep();
+			for (; step < 1200; step++)
+			{
+				int actions[2] = { CBatchEnv::Wait, CBatchEnv::Wait };
+				if (next < inputs.size() && (int)lround(inputs[next].mTime / CLaneModel::StepTime) == step)
+				{
+					auto& input = inputs[next++];
+					actions[0] = input.mAction == CReplay::Cargo ? CBatchEnv::ClickCargo + input.mCargo :
+						CBatchEnv::Forward + input.mAction;
+				}
+
+				env.Step(actions, observations.data(), rewards.data(), done.data());
+				Assert::IsFalse(done[1] != 0);
+				if (done[0])
+				{
+					break;
+				}
+			}
+
+			// It wins on the last input, and has started over
+			Assert::AreEqual(inputs.size(), next);
+			Assert::AreEqual(1.0f, rewards[0]);
+			Assert::AreEqual(1.0f, observations[3]);
+			Assert::AreEqual(1LL, env.GetWins());
+		}
+
+	};
+}
@@ -0,0 +1,80 @@
+/**
+ * \file CCargoPuzzleTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "CargoPuzzle.h"
+#include "Simulation.h"
+#include "Game.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CCargoPuzzleTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCCargoPuzzleLevel)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+
+			// Grain, goose and fox, the goose eats the grain and the fox eats the goose
+			auto puzzle = game.GetCargoPuzzle();
+			Assert::IsTrue(puzzle != nullptr);
+			Assert::AreEqual(3, puzzle->GetCount());
+			Assert::IsTrue(puzzle->GetId(1) == L"goose");
+			Assert::IsTrue(puzzle->Eats(1, 0));
+			Assert::IsTrue(puzzle->Eats(2, 1));
+			Assert::IsFalse(puzzle->Eats(2, 0));
+
+			Assert::IsFalse(puzzle->IsEaten(0, 7, CCargoPuzzle::Bottom));
+			Assert::IsTrue(puzzle->IsEaten(0, 6, CCargoPuzzle::Away));
+			Assert::IsFalse(puzzle->IsEaten(0, 5, CCargoPuzzle::Away));
+			Assert::AreEqual(1, puzzle->GetEaten(6));
+			Assert::AreEqual(2, puzzle->GetEater(6));
+
+			// The goose goes over first and comes back once
+			Assert::IsTrue(puzzle->IsSolvable());
+			auto& trips = puzzle->GetTrips();
+			Assert::AreEqual(7, (int)trips.size());
+			Assert::AreEqual(1, trips.front().mCargo);
+			Assert::IsTrue(trips.back().mTo == CCargoPuzzle::Top);
+		}
+
+		TEST_METHOD(TestCCargoPuzzleEaten)
+		{
+			// Take the grain and leave the fox with the goose
+			CReplay replay;
+			replay.Clear(1);
+			replay.Add(3.2, CReplay::Cargo, 0);
+			replay.Add(3.4, CReplay::Forward);
+
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSimulation simulation(&game, CSimulation::FixedTick);
+			CSimulation::Outcome outcome = simulation.Run(replay, 5);
+
+			Assert::AreEqual(3, outcome.mLossCondition);
+			Assert::IsTrue(game.GetEatenCargo()->GetName() == L"Goose");
+			Assert::IsTrue(game.GetEatingCargo()->GetName() == L"Fox");
+		}
+
+	};
+}
@@ -0,0 +1,89 @@
+/**
+ * \file CCollisionMaskTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "CollisionMask.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CCollisionMaskTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCCollisionMaskTest)
+		{
+			CCollisionMask mask(200, 4);
+			mask.Set(150, 2, true);
+
+			Assert::IsTrue(mask.Test(150, 2));
+			Assert::IsFalse(mask.Test(149, 2));
+			Assert::IsFalse(mask.Test(-1, 2));
+			Assert::IsFalse(mask.Test(150, 4));
+		}
+
+		TEST_METHOD(TestCCollisionMaskOverlaps)
+		{
+			// A single solid pixel past the first 128 bit block
+			CCollisionMask wide(200, 4);
+			wide.Set(150, 2, true);
+
+			CCollisionMask dot(3, 3);
+			dot.Set(1, 1, true);
+
+			// Dot's solid pixel lands right on ours
+			Assert::IsTrue(wide.Overlaps(dot, 149, 1));
+			Assert::IsTrue(dot.Overlaps(wide, -149, -1));
+
+			// Rectangles overlap, solid pixels don't
+			Assert::IsFalse(wide.Overlaps(dot, 148, 1));
+			Assert::IsFalse(wide.Overlaps(dot, 149, 0));
+
+			// No overlap at all
+			Assert::IsFalse(wide.Overlaps(dot, 300, 1));
+			Assert::IsFalse(wide.Overlaps(dot, 149, 10));
+		}
+
+		TEST_METHOD(TestCCollisionMaskSweptOverlaps)
+		{
+			// Two solid pixels with a gap a dot fits through
+			CCollisionMask gate(200, 4);
+			gate.Set(20, 2, true);
+			gate.Set(180, 2, true);
+
+			CCollisionMask dot(3, 3);
+			dot.Set(1, 1, true);
+
+			int first, last;
+			Assert::IsTrue(gate.GetExtent(2, first, last));
+			Assert::AreEqual(20, first);
+			Assert::AreEqual(180, last);
+			Assert::IsFalse(gate.GetExtent(0, first, last));
+
+			// Moving between the pixels, then far enough to reach one
+			Assert::IsFalse(gate.SweptOverlaps(dot, 20, 178, 1));
+			Assert::IsTrue(gate.SweptOverlaps(dot, 20, 179, 1));
+			Assert::IsTrue(gate.SweptOverlaps(dot, -1000, 1000, 1));
+
+			// In another row the whole way
+			Assert::IsFalse(gate.SweptOverlaps(dot, -1000, 1000, 0));
+		}
+
+	};
+}
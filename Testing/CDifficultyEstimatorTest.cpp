@@ -0,0 +1,78 @@
+/**
+ * \file CDifficultyEstimatorTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "DifficultyEstimator.h"
+#include "Game.h"
+#include <numeric>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CDifficultyEstimatorTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCDifficultyEstimatorPerfect)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+			CDifficultyEstimator estimator(&game, 180);
+
+			// An agent with no lateness and no mistakes always gets across
+			CDifficultyEstimator::Agent agent;
+			agent.mReaction = 0;
+			agent.mErrorRate = 0;
+			auto estimate = estimator.Run(agent, 100, 1);
+			Assert::AreEqual(100, estimate.mPlays);
+			Assert::AreEqual(100, estimate.mWins);
+			Assert::AreEqual(1.0, estimate.GetSuccessRate());
+			Assert::AreEqual((size_t)100, estimate.mTimes.size());
+			Assert::IsTrue(estimate.mTimes.front() <= estimate.mTimes.back());
+		}
+
+		TEST_METHOD(TestCDifficultyEstimatorSeed)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+			CDifficultyEstimator estimator(&game, 180);
+
+			CDifficultyEstimator::Agent agent;
+			agent.mReaction = 0.3;
+			agent.mErrorRate = 0.03;
+			auto first = estimator.Run(agent, 300, 7);
+			auto second = estimator.Run(agent, 300, 7);
+
+			// Every play ends one way or another
+			int lost = accumulate(first.mLosses.begin(), first.mLosses.end(), 0);
+			Assert::AreEqual(first.mPlays, first.mWins + first.mTimedOut + lost);
+			Assert::AreEqual(lost, accumulate(first.mDeaths.begin(), first.mDeaths.end(), 0));
+
+			// The same seed makes the same estimate
+			Assert::AreEqual(first.mWins, second.mWins);
+			Assert::AreEqual(first.mTimedOut, second.mTimedOut);
+			Assert::IsTrue(first.mLosses == second.mLosses);
+			Assert::IsTrue(first.mDeaths == second.mDeaths);
+			Assert::IsTrue(first.mTimes == second.mTimes);
+		}
+
+	};
+}
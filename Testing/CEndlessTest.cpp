@@ -0,0 +1,112 @@
+/**
+ * \file CEndlessTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "Endless.h"
+#include "Game.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CEndlessTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCEndlessSeed)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.SetEndless(true, 3);
+			CEndless* endless = game.GetEndless();
+			Assert::IsNotNull(endless);
+			Assert::AreEqual(1, endless->GetHeroRow());
+			Assert::IsTrue(endless->GetTerrain(0) == CRuleTable::Land);
+
+			// The same seed makes the same rows
+			CEndless other(&game, 3);
+			bool lanes = false;
+			for (int row = 0; row < CEndless::Slots; row++)
+			{
+				Assert::IsTrue(endless->GetTerrain(row) == other.GetTerrain(row));
+				Assert::AreEqual(endless->GetVehicleCount(row), other.GetVehicleCount(row));
+				Assert::AreEqual(endless->GetSpeed(row), other.GetSpeed(row));
+				lanes = lanes || endless->GetTerrain(row) != CRuleTable::Land;
+			}
+			Assert::IsTrue(lanes);
+
+			// Loading a level leaves endless mode
+			game.Load(1);
+			Assert::IsNull(game.GetEndless());
+		}
+
+		TEST_METHOD(TestCEndlessStreaming)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.SetEndless(true, 5);
+			CEndless* endless = game.GetEndless();
+			endless->SetInvulnerable(true);
+
+			for (int step = 0; step < 2000; step++)
+			{
+				endless->Move(CReplay::Forward);
+				game.Update(0.25);
+				Assert::IsTrue(endless->GetHeroRow() > endless->GetCamera());
+				Assert::IsTrue(endless->GetHeroRow() < endless->GetCamera() + CRuleTable::Rows);
+			}
+			Assert::AreEqual(2001, endless->GetHeroRow());
+
+			// Only the slots are kept and the vehicles all come from the pool
+			auto stats = endless->GetStats();
+			Assert::AreEqual((long long)CEndless::Slots, stats.mGenerated - stats.mRetired);
+			Assert::AreEqual(CEndless::Slots * CEndless::MaxPerLane, stats.mPool);
+			Assert::IsTrue(stats.mLive <= stats.mPool);
+			Assert::IsTrue(stats.mSpawned > stats.mPool);
+			Assert::AreEqual(0, endless->GetVehicleCount(100));
+
+			// Starting over makes the first rows again
+			endless->Reset(5);
+			Assert::AreEqual(1, endless->GetHeroRow());
+			Assert::AreEqual((long long)CEndless::Slots, endless->GetStats().mGenerated);
+		}
+
+		TEST_METHOD(TestCEndlessRestart)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.SetEndless(true, 7);
+			CEndless* endless = game.GetEndless();
+
+			// Walk forward until something gets the hero, then wait out the loss
+			for (int step = 0; step < 2000 && endless->GetSeed() == 7; step++)
+			{
+				game.moveHero(VK_UP);
+				game.Update(0.25);
+				game.UpdateControlPanel(0.25);
+			}
+
+			// The same endless mode starts over with the next seed
+			Assert::IsTrue(game.GetEndless() == endless);
+			Assert::IsTrue(endless->GetSeed() == 8);
+			Assert::AreEqual(1, endless->GetHeroRow());
+			Assert::AreEqual(0.0, game.GetCameraY());
+		}
+
+	};
+}
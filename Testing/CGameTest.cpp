@@ -199,5 +199,57 @@ namespace Testing
 
 		}
 
+		TEST_METHOD(TestCGameClickCargo)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+			for (int i = 0; i < 100 && game.GetReady(); i++)
+			{
+				game.Update(0.1);
+				game.UpdateControlPanel(0.1);
+			}
+			Assert::IsFalse(game.GetReady());
+
+			// Cargo that isn't in the level is ignored
+			shared_ptr<Bitmap> bitmap = shared_ptr<Bitmap>(Bitmap::FromFile(gameTestFilename.c_str()));
+			CCargo stray(&game, bitmap, bitmap);
+			size_t inputs = game.GetReplay().GetInputs().size();
+			game.ClickCargo(&stray);
+			Assert::AreEqual(inputs, game.GetReplay().GetInputs().size());
+			Assert::IsFalse(stray.GetCarryStatus());
+
+			// Cargo that is gets recorded by where it is in the level
+			game.ClickCargo(game.GetCargo(1));
+			Assert::AreEqual(inputs + 1, game.GetReplay().GetInputs().size());
+			Assert::AreEqual(1, game.GetReplay().GetInputs().back().mCargo);
+		}
+
+		TEST_METHOD(TestCGameSpritesAfterLoad)
+		{
+			Bitmap target(512, 512, PixelFormat32bppARGB);
+			Graphics graphics(&target);
+
+			// Draw two levels in a row in software
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.SetFrameBufferEnabled(true);
+			game.SetSoftwareRasterEnabled(true);
+			game.Load(0);
+			game.OnDraw(&graphics, 512, 512);
+			Assert::IsTrue(game.GetSpriteBytes() > 0);
+			game.Load(1);
+			game.OnDraw(&graphics, 512, 512);
+
+			// Only the second level's sprites are kept, as if it was drawn first
+			CGame fresh;
+			fresh.LoadLevels(L".\\levels\\", 4);
+			fresh.SetFrameBufferEnabled(true);
+			fresh.SetSoftwareRasterEnabled(true);
+			fresh.Load(1);
+			fresh.OnDraw(&graphics, 512, 512);
+			Assert::AreEqual(fresh.GetSpriteBytes(), game.GetSpriteBytes());
+		}
+
 	};
 }
\ No newline at end of file
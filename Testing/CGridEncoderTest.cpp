@@ -0,0 +1,102 @@
+/**
+ * \file CGridEncoderTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "GridEncoder.h"
+#include "Game.h"
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CGridEncoderTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		/** Add up one plane of a grid
+		 * \param grid Grid
+		 * \param channel Plane to add up
+		 * \returns Sum of the plane's tiles */
+		static float Sum(const vector<float>& grid, int channel)
+		{
+			float sum = 0;
+			for (int i = 0; i < CGridEncoder::Rows * CGridEncoder::Columns; i++)
+			{
+				sum += grid[channel * CGridEncoder::Rows * CGridEncoder::Columns + i];
+			}
+			return sum;
+		}
+
+		TEST_METHOD(TestCGridEncoderSize)
+		{
+			CGridEncoder plain(false);
+			CGridEncoder offsets(true);
+			Assert::AreEqual((int)CGridEncoder::Offset, plain.GetChannels());
+			Assert::AreEqual(plain.GetChannels() + 1, offsets.GetChannels());
+			Assert::AreEqual(offsets.GetChannels() * 16 * 16, offsets.GetSize());
+		}
+
+		TEST_METHOD(TestCGridEncoderLevel)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+
+			CGridEncoder encoder(true);
+			vector<float> grid(encoder.GetSize(), -1.0f);
+			encoder.Encode(&game, grid.data());
+
+			// The hero starts on row 14, column 7
+			const int plane = CGridEncoder::Rows * CGridEncoder::Columns;
+			Assert::AreEqual(1.0f, Sum(grid, CGridEncoder::Hero));
+			Assert::AreEqual(1.0f, grid[CGridEncoder::Hero * plane + 14 * CGridEncoder::Columns + 7]);
+
+			// Level 1 has three cargo items, all on the bottom row
+			for (int i = 0; i < 3; i++)
+			{
+				Assert::AreEqual(1.0f, Sum(grid, CGridEncoder::Cargo + i));
+				float bottom = 0;
+				for (int column = 0; column < CGridEncoder::Columns; column++)
+				{
+					bottom += grid[(CGridEncoder::Cargo + i) * plane + 15 * CGridEncoder::Columns + column];
+				}
+				Assert::AreEqual(1.0f, bottom);
+			}
+			Assert::AreEqual(0.0f, Sum(grid, CGridEncoder::Cargo + 3));
+
+			// Terrain follows the rule table, and cars are only on roads
+			auto rules = game.GetRuleTable();
+			for (int row = 0; row < CGridEncoder::Rows; row++)
+			{
+				bool road = rules->GetTerrain(row) == CRuleTable::Road;
+				Assert::AreEqual(road ? 1.0f : 0.0f, grid[CGridEncoder::Road * plane + row * CGridEncoder::Columns]);
+				for (int column = 0; column < CGridEncoder::Columns && !road; column++)
+				{
+					Assert::AreEqual(0.0f, grid[CGridEncoder::Car * plane + row * CGridEncoder::Columns + column]);
+				}
+			}
+
+			// Encoding again gives the same grid
+			vector<float> again(encoder.GetSize());
+			encoder.Encode(&game, again.data());
+			Assert::IsTrue(grid == again);
+		}
+
+	};
+}
@@ -84,5 +84,30 @@ namespace Testing
 			Assert::IsNotNull(decorClone.get());
 		}
 
+		TEST_METHOD(TestCItemCollidesWithSwept)
+		{
+			shared_ptr<Bitmap> bitmap = shared_ptr<Bitmap>(Bitmap::FromFile(filename.c_str()));
+			CGame game;
+			CItemMock mover(&game, bitmap);
+			CItemMock still(&game, bitmap);
+			still.SetLocation(200, 100);
+
+			// Jumped clean over the other item in one step
+			mover.SetLocation(400, 100);
+			Assert::IsFalse(mover.CollidesWith(still));
+			Assert::IsTrue(mover.CollidesWithSwept(still, 0));
+			Assert::IsFalse(mover.CollidesWithSwept(still, 500));
+
+			// Passing by in another row
+			mover.SetLocation(400, 164);
+			Assert::IsFalse(mover.CollidesWithSwept(still, 0));
+
+			// Stopping just short of it
+			mover.SetLocation(136, 100);
+			Assert::IsFalse(mover.CollidesWithSwept(still, 0));
+			mover.SetLocation(137, 100);
+			Assert::IsTrue(mover.CollidesWithSwept(still, 0));
+		}
+
 	};
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+/**
+ * \file CLevelTunerTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "LevelTuner.h"
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CLevelTunerTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCLevelTunerSave)
+		{
+			CLevelTuner tuner;
+			Assert::IsFalse(tuner.Load(L".\\levels\\nosuchlevel.xml"));
+			Assert::IsTrue(tuner.Load(L".\\levels\\level1.xml"));
+
+			// Five rivers and five roads
+			auto lanes = tuner.GetLanes();
+			Assert::AreEqual((size_t)10, lanes.size());
+			Assert::AreEqual(2, lanes[0].mRow);
+			Assert::AreEqual(1.5, lanes[0].mSpeed);
+			Assert::AreEqual(20, lanes[0].mWidth);
+			Assert::AreEqual((size_t)2, lanes[0].mX.size());
+			Assert::AreEqual(12, lanes[0].mX[1]);
+
+			lanes[0].mSpeed = -2.7;
+			lanes[0].mWidth = 24;
+			lanes[0].mX[1] = 15;
+			tuner.Save(L"tuner-test.xml", lanes);
+
+			CLevelTuner saved;
+			Assert::IsTrue(saved.Load(L"tuner-test.xml"));
+			Assert::AreEqual(-2.7, saved.GetLanes()[0].mSpeed);
+			Assert::AreEqual(24, saved.GetLanes()[0].mWidth);
+			Assert::AreEqual(15, saved.GetLanes()[0].mX[1]);
+			Assert::AreEqual(lanes[1].mSpeed, saved.GetLanes()[1].mSpeed);
+		}
+
+		TEST_METHOD(TestCLevelTunerSolveTime)
+		{
+			CLevelTuner tuner;
+			Assert::IsTrue(tuner.Load(L".\\levels\\level1.xml"));
+
+			// Level 1 can be won in 30.4 seconds as it is
+			CLevelTuner::Target target;
+			target.mKind = CLevelTuner::Target::SolveTime;
+			target.mValue = 34;
+			auto result = tuner.Tune(target, L"tuner-test.xml", 3, 1);
+			Assert::AreEqual(30.4, result.mStart, 0.001);
+			Assert::IsTrue(fabs(result.mValue - 34) < fabs(result.mStart - 34));
+			Assert::IsTrue(result.mMeasured > 1);
+
+			// The file written has the lanes found in it
+			CLevelTuner tuned;
+			Assert::IsTrue(tuned.Load(L"tuner-test.xml"));
+			for (size_t i = 0; i < result.mLanes.size(); i++)
+			{
+				Assert::AreEqual(result.mLanes[i].mSpeed, tuned.GetLanes()[i].mSpeed);
+				Assert::AreEqual(result.mLanes[i].mWidth, tuned.GetLanes()[i].mWidth);
+				Assert::IsTrue(result.mLanes[i].mX == tuned.GetLanes()[i].mX);
+			}
+		}
+
+	};
+}
@@ -0,0 +1,142 @@
+/**
+ * \file COccupancyTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "Occupancy.h"
+#include "Simulation.h"
+#include "Game.h"
+#include "Vehicle.h"
+#include <cmath>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(COccupancyTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCOccupancyColumns)
+		{
+			Assert::AreEqual((int)0x0001, (int)COccupancy::GetColumns(0, 64));
+			Assert::AreEqual((int)0x0006, (int)COccupancy::GetColumns(65, 190));
+			Assert::AreEqual((int)0x0003, (int)COccupancy::GetColumns(-100, 100));
+			Assert::AreEqual((int)0xc000, (int)COccupancy::GetColumns(900, 1500));
+			Assert::AreEqual((int)0x0000, (int)COccupancy::GetColumns(-200, -10));
+		}
+
+		TEST_METHOD(TestCOccupancyMixedLane)
+		{
+			shared_ptr<Gdiplus::Bitmap> bitmap = shared_ptr<Gdiplus::Bitmap>(Gdiplus::Bitmap::FromFile(L"images/road1.png"));
+			CGame game;
+
+			// Row 1 goes around in one time, row 3 has a vehicle that goes faster
+			vector<shared_ptr<CItem>> items;
+			items.push_back(make_shared<CVehicle>(&game, bitmap, 128, 96, 0, 16));
+			items.push_back(make_shared<CVehicle>(&game, bitmap, 128, 96, 512, 16));
+			items.push_back(make_shared<CVehicle>(&game, bitmap, 128, 224, 0, 16));
+			items.push_back(make_shared<CVehicle>(&game, bitmap, 192, 224, 512, 16));
+			COccupancy occupancy(items);
+
+			Assert::AreEqual(2, occupancy.GetLaneCount());
+			Assert::IsTrue(occupancy.GetTouched(1, 0) != occupancy.GetTouched(1, 3));
+
+			// The mixed lane is touched everywhere the vehicles go, all the time
+			Assert::AreEqual((int)0xffff, (int)occupancy.GetTouched(3, 0));
+			Assert::AreEqual((int)0xffff, (int)occupancy.GetTouched(3, 3.7));
+			Assert::AreEqual(0, (int)occupancy.GetCovered(3, 3.7));
+			Assert::IsTrue(occupancy.IsTouched(3, 0, 64, 1, 1.1));
+		}
+
+		TEST_METHOD(TestCOccupancyWrappingBoat)
+		{
+			shared_ptr<Gdiplus::Bitmap> bitmap = shared_ptr<Gdiplus::Bitmap>(Gdiplus::Bitmap::FromFile(L"images/road1.png"));
+			CGame game;
+
+			// Going left, this one goes out of the lane at x=-32 partway
+			// through the bucket at 0.25 seconds and comes back in at x=992
+			vector<shared_ptr<CItem>> items;
+			items.push_back(make_shared<CVehicle>(&game, bitmap, -128, 96, 1, 16));
+			COccupancy occupancy(items);
+
+			Assert::IsTrue(occupancy.IsRiver(1));
+
+			// It stays over the center of the last tile once it is back in
+			Assert::AreEqual((int)0x8000, (int)occupancy.GetCovered(1, 0.26));
+			Assert::AreEqual((int)0x8000, (int)occupancy.GetCovered(1, 0.3));
+			Assert::AreEqual(0, (int)occupancy.GetCovered(1, 0.2));
+		}
+
+		TEST_METHOD(TestCOccupancyHugeLevel)
+		{
+			shared_ptr<Gdiplus::Bitmap> bitmap = shared_ptr<Gdiplus::Bitmap>(Gdiplus::Bitmap::FromFile(L"images/road1.png"));
+			CGame game;
+
+			// Enough lanes that short buckets would go over the most there can be
+			const int lanes = 4000;
+			vector<shared_ptr<CItem>> items;
+			shared_ptr<CVehicle> last;
+			for (int row = 0; row < lanes; row++)
+			{
+				last = make_shared<CVehicle>(&game, bitmap, 128, row * 64 + 32, 512, 16);
+				items.push_back(last);
+			}
+			COccupancy occupancy(items);
+
+			Assert::AreEqual(lanes, occupancy.GetLaneCount());
+			Assert::IsTrue(occupancy.GetBucketCount() <= COccupancy::MaxBuckets);
+
+			// The longer buckets still have the vehicle where it is
+			for (double time = 0; time < 8; time += 0.37)
+			{
+				int column = (int)floor(last->GetPositionAt(time) / 64);
+				if (column >= 0 && column < COccupancy::Columns)
+				{
+					Assert::IsTrue(occupancy.IsOccupied(lanes - 1, column, time));
+				}
+			}
+		}
+
+		TEST_METHOD(TestCOccupancyCheck)
+		{
+			// Walk up through every level with the tables checked against
+			// the vehicles and the car tests on every tick
+			for (int level = 0; level < 4; level++)
+			{
+				CReplay replay;
+				replay.Clear(level);
+				for (int i = 0; i < 12; i++)
+				{
+					replay.Add(3.2 + i * 0.45, CReplay::Forward);
+				}
+
+				CGame game;
+				game.LoadLevels(L".\\levels\\", 4);
+				game.SetOccupancyCheck(true);
+				CSimulation simulation(&game, CSimulation::FixedTick);
+				simulation.Run(replay, 40);
+
+				Assert::IsTrue(game.GetOccupancy() != nullptr);
+				Assert::IsTrue(game.GetOccupancy()->GetLaneCount() > 0);
+				Assert::IsTrue(game.GetOccupancyChecks() > 0);
+				Assert::AreEqual(0, game.GetOccupancyMisses());
+			}
+		}
+
+	};
+}
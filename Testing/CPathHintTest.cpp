@@ -0,0 +1,64 @@
+/**
+ * \file CPathHintTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "PathHint.h"
+#include "Game.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CPathHintTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCPathHintPlans)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+
+			// Put the hero on the top bank, the cargo is still at the bottom
+			game.GetHero()->SetLocation(480, 96);
+
+			CPathHint hint(&game);
+			hint.SetBudget(10);
+			hint.Update();
+
+			Assert::IsTrue(hint.HasPath());
+			Assert::AreEqual((int)CLaneModel::BottomRow, hint.GetTargetRow());
+
+			auto path = hint.GetPath();
+			Assert::AreEqual((int)CLaneModel::TopRow, path.front().mRow);
+			Assert::AreEqual((int)CLaneModel::BottomRow, path.back().mRow);
+
+			// Nothing can be done before the get ready countdown is over
+			auto script = hint.GetScript();
+			Assert::IsFalse(script.GetInputs().empty());
+			Assert::IsTrue(script.GetInputs().front().mTime >= CControlPanel::ReadyTime);
+
+			// The hero hasn't gone anywhere, so the plan is kept
+			hint.Update();
+			Assert::IsTrue(hint.HasPath());
+			Assert::AreEqual(1, hint.GetRestarts());
+			Assert::AreEqual(1, hint.GetFollowed());
+		}
+
+	};
+}
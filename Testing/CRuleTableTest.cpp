@@ -0,0 +1,84 @@
+/**
+ * \file CRuleTableTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "RuleTable.h"
+#include "Simulation.h"
+#include "Game.h"
+#include <algorithm>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CRuleTableTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCRuleTableRows)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+
+			// Level 1 has river on rows 2 to 6 and road on rows 9 to 13
+			auto rules = game.GetRuleTable();
+			Assert::IsTrue(rules != nullptr);
+			Assert::IsTrue(rules->GetTerrain(1) == CRuleTable::Land);
+			Assert::IsTrue(rules->GetTerrain(4) == CRuleTable::River);
+			Assert::IsTrue(rules->GetTerrain(8) == CRuleTable::Land);
+			Assert::IsTrue(rules->GetTerrain(11) == CRuleTable::Road);
+
+			auto has = [&rules](int row, CRuleTable::Hazard hazard) {
+				auto& hazards = rules->GetHazards(row);
+				return find(hazards.begin(), hazards.end(), hazard) != hazards.end();
+			};
+
+			Assert::IsTrue(has(4, CRuleTable::Water));
+			Assert::IsFalse(has(4, CRuleTable::Cars));
+			Assert::IsTrue(has(11, CRuleTable::Cars));
+			Assert::IsFalse(has(11, CRuleTable::Water));
+			Assert::IsFalse(has(14, CRuleTable::Cars));
+
+			// Every row checks for drifting off first and cargo eaten last
+			Assert::IsTrue(rules->GetHazards(14).front() == CRuleTable::OffScreen);
+			Assert::IsTrue(rules->GetHazards(14).back() == CRuleTable::Eaten);
+			Assert::IsTrue(CRuleTable::GetLoss(CRuleTable::Water) == CRuleTable::FellInRiver);
+		}
+
+		TEST_METHOD(TestCRuleTableRiver)
+		{
+			// Put the hero in the river with nothing under it
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+			game.GetHero()->SetLocation(480, 4 * 64 + 32);
+			Assert::IsFalse(game.GetGameLost());
+
+			game.Update(0.01);
+			Assert::IsTrue(game.GetGameLost());
+			Assert::IsTrue(game.GameLossCondition() == CRuleTable::FellInRiver);
+
+			// Nothing after that changes how the level was lost
+			game.GetHero()->SetLocation(-100, game.GetHero()->GetY());
+			game.Update(0.01);
+			Assert::IsTrue(game.GameLossCondition() == CRuleTable::FellInRiver);
+		}
+
+	};
+}
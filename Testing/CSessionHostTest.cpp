@@ -0,0 +1,96 @@
+/**
+ * \file CSessionHostTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "SessionHost.h"
+#include "Game.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CSessionHostTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCSessionHostOpenClose)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSessionHost host(&game, 2, 30);
+
+			int first = host.Open(1);
+			int second = host.Open(2);
+			Assert::IsTrue(first >= 0 && second >= 0 && first != second);
+			Assert::AreEqual(2, host.GetSessionCount());
+
+			// The host is full until a session closes
+			Assert::AreEqual(-1, host.Open(3));
+			host.Close(first);
+			Assert::AreEqual(1, host.GetSessionCount());
+			Assert::AreEqual(first, host.Open(3));
+		}
+
+		TEST_METHOD(TestCSessionHostBadNumbers)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSessionHost host(&game, 2, 30);
+
+			// Levels and sessions that don't exist are turned away
+			Assert::AreEqual(-1, host.Open(-1));
+			Assert::AreEqual(-1, host.Open(host.GetLevelCount()));
+			Assert::AreEqual(0, host.GetSessionCount());
+			Assert::IsFalse(host.PostInput(-1, CLevelTemplate::Left));
+			Assert::IsFalse(host.PostInput(2, CLevelTemplate::Left));
+			Assert::IsFalse(host.Close(2));
+
+			// A session can only be closed once
+			int session = host.Open(0);
+			Assert::IsTrue(host.Close(session));
+			Assert::IsFalse(host.Close(session));
+			Assert::AreEqual(0, host.GetSessionCount());
+		}
+
+		TEST_METHOD(TestCSessionHostUpdates)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSessionHost host(&game, 4, 30);
+			int waiting = host.Open(1);
+			int moving = host.Open(1);
+
+			// Waiting at the start changes nothing
+			host.Tick();
+			Assert::IsTrue(host.GetUpdates().empty());
+
+			// A step sideways is an update for that session only
+			Assert::IsTrue(host.PostInput(moving, CLevelTemplate::Left));
+			host.Tick();
+			Assert::AreEqual((size_t)1, host.GetUpdates().size());
+			Assert::AreEqual(moving, host.GetUpdates()[0].mSession);
+			Assert::IsTrue(host.GetUpdates()[0].mResult == CLevelTemplate::Playing);
+
+			auto start = host.GetTemplate(1)->GetStart();
+			Assert::AreEqual((int)CSessionHost::HeroChanged, host.GetUpdates()[0].mChanges);
+			Assert::AreEqual(start.mHero.mX - 64, host.GetUpdates()[0].mHero.mX, 0.001);
+			Assert::AreNotEqual(waiting, moving);
+		}
+
+	};
+}
@@ -0,0 +1,79 @@
+/**
+ * \file CSimulationTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "Simulation.h"
+#include "Game.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CSimulationTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCSimulationModesAgree)
+		{
+			// Walk straight up into the traffic of level 1 at a few paces
+			for (double pace = 0.2; pace < 1.0; pace += 0.15)
+			{
+				CReplay replay;
+				replay.Clear(1);
+				for (int i = 0; i < 12; i++)
+				{
+					replay.Add(3.2 + i * pace, CReplay::Forward);
+				}
+
+				CGame fixedGame;
+				fixedGame.LoadLevels(L".\\levels\\", 4);
+				CSimulation fixedTick(&fixedGame, CSimulation::FixedTick);
+				CSimulation::Outcome fixed = fixedTick.Run(replay, 30);
+
+				CGame eventGame;
+				eventGame.LoadLevels(L".\\levels\\", 4);
+				CSimulation eventDriven(&eventGame, CSimulation::EventDriven);
+				CSimulation::Outcome events = eventDriven.Run(replay, 30);
+
+				Assert::AreEqual(fixed.mWon, events.mWon);
+				Assert::AreEqual(fixed.mLossCondition, events.mLossCondition);
+				Assert::AreEqual(fixed.mTime, events.mTime, 0.05);
+				Assert::IsTrue(events.mUpdates < fixed.mUpdates);
+			}
+		}
+
+		TEST_METHOD(TestCSimulationWaiting)
+		{
+			// Nothing happens to a hero waiting on the sidewalk,
+			// so the events are only the get ready countdown
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSimulation simulation(&game, CSimulation::EventDriven);
+
+			CReplay replay;
+			replay.Clear(1);
+			CSimulation::Outcome outcome = simulation.Run(replay, 600);
+
+			Assert::IsFalse(outcome.mWon);
+			Assert::AreEqual(-1, outcome.mLossCondition);
+			Assert::AreEqual(600.0, outcome.mTime, 0.0001);
+			Assert::IsTrue(outcome.mUpdates < 5);
+		}
+
+	};
+}
@@ -0,0 +1,71 @@
+/**
+ * \file CSolverTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "Solver.h"
+#include "Simulation.h"
+#include "Game.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CSolverTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCSolverWins)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSolver solver(&game);
+
+			CSolver::Solution solution = solver.Solve(1, 60);
+			Assert::IsTrue(solution.mSolved);
+			Assert::IsTrue(solution.mTime > CControlPanel::ReadyTime);
+
+			// The last input puts the last cargo down at the top
+			auto& inputs = solution.mScript.GetInputs();
+			Assert::IsFalse(inputs.empty());
+			Assert::IsTrue(inputs.back().mAction == CReplay::Cargo);
+			Assert::AreEqual(solution.mTime, inputs.back().mTime, 0.0001);
+
+			// Playing the inputs wins the level either way the game is stepped
+			CSimulation fixedTick(&game, CSimulation::FixedTick);
+			CSimulation::Outcome fixed = fixedTick.Run(solution.mScript, solution.mTime + 1);
+			Assert::IsTrue(fixed.mWon);
+
+			CSimulation eventDriven(&game, CSimulation::EventDriven);
+			CSimulation::Outcome events = eventDriven.Run(solution.mScript, solution.mTime + 1);
+			Assert::IsTrue(events.mWon);
+		}
+
+		TEST_METHOD(TestCSolverNoCargo)
+		{
+			// Level 0 has no cargo to carry, so it can't be won
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			CSolver solver(&game);
+
+			CSolver::Solution solution = solver.Solve(0, 10);
+			Assert::IsFalse(solution.mSolved);
+			Assert::IsTrue(solution.mScript.GetInputs().empty());
+		}
+
+	};
+}
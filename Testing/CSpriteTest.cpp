@@ -0,0 +1,111 @@
+/**
+ * \file CSpriteTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "Sprite.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CSpriteTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+		
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCSpriteSpans)
+		{
+			CSprite sprite(8, 2);
+
+			// Row 0: clear, two opaque, one partly transparent, clear, one opaque, clear
+			UINT32* row = sprite.GetRow(0);
+			row[1] = 0xff102030;
+			row[2] = 0xff102030;
+			row[3] = 0x80081018;
+			row[5] = 0xffffffff;
+
+			// Row 1 is completely clear
+			sprite.BuildSpans();
+
+			auto span = sprite.GetSpansBegin(0);
+			Assert::AreEqual(3, (int)(sprite.GetSpansEnd(0) - span));
+
+			Assert::AreEqual(1, span[0].mStart);
+			Assert::AreEqual(3, span[0].mEnd);
+			Assert::IsTrue(span[0].mOpaque);
+
+			Assert::AreEqual(3, span[1].mStart);
+			Assert::AreEqual(4, span[1].mEnd);
+			Assert::IsFalse(span[1].mOpaque);
+
+			Assert::AreEqual(5, span[2].mStart);
+			Assert::AreEqual(6, span[2].mEnd);
+			Assert::IsTrue(span[2].mOpaque);
+
+			Assert::IsTrue(sprite.GetSpansBegin(1) == sprite.GetSpansEnd(1));
+		}
+
+		TEST_METHOD(TestCSpritePalettize)
+		{
+			CSprite sprite(4, 1);
+			UINT32* row = sprite.GetRow(0);
+			row[0] = 0xff102030;
+			row[1] = 0x80081018;
+			row[2] = 0xff102030;
+			sprite.BuildSpans();
+
+			Assert::IsTrue(sprite.Palettize());
+			Assert::IsTrue(sprite.IsPalettized());
+
+			// Three colors including clear, looked up exactly
+			const unsigned char* indices = sprite.GetIndexRow(0);
+			const UINT32* palette = sprite.GetPalette();
+			Assert::AreEqual(0xff102030u, palette[indices[0]]);
+			Assert::AreEqual(0x80081018u, palette[indices[1]]);
+			Assert::AreEqual(0xff102030u, palette[indices[2]]);
+			Assert::AreEqual(0u, palette[indices[3]]);
+			Assert::AreEqual(indices[0], indices[2]);
+
+			// Too many colors to palettize
+			CSprite big(300, 1);
+			for (int x = 0; x < 300; x++)
+			{
+				big.GetRow(0)[x] = 0xff000000 | x;
+			}
+			big.BuildSpans();
+			Assert::IsFalse(big.Palettize());
+			Assert::IsFalse(big.IsPalettized());
+		}
+
+		TEST_METHOD(TestCSpriteBlend)
+		{
+			// Opaque pixels replace, clear pixels leave the destination alone
+			UINT32 dst = 0xff204060;
+			CSprite::BlendPixel(dst, 0x00000000);
+			Assert::AreEqual(0xff204060u, dst);
+
+			CSprite::BlendPixel(dst, 0xff112233);
+			Assert::AreEqual(0xff112233u, dst);
+
+			// Half transparent white over black
+			dst = 0xff000000;
+			CSprite::BlendPixel(dst, CSprite::Premultiply(0x80ffffff));
+			Assert::AreEqual(0xff808080u, dst);
+		}
+
+	};
+}
@@ -0,0 +1,77 @@
+/**
+ * \file CSpscQueueTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "SpscQueue.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CSpscQueueTest)
+	{
+	public:
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCSpscQueueEmptyFull)
+		{
+			CSpscQueue<int, 4> queue;
+			int item = -1;
+
+			// Nothing to pop from a new queue
+			Assert::IsFalse(queue.Pop(item));
+			Assert::AreEqual(-1, item);
+
+			// One less than the capacity fits
+			Assert::IsTrue(queue.Push(1));
+			Assert::IsTrue(queue.Push(2));
+			Assert::IsTrue(queue.Push(3));
+			Assert::IsFalse(queue.Push(4));
+
+			// Popping makes room, in the order pushed
+			Assert::IsTrue(queue.Pop(item));
+			Assert::AreEqual(1, item);
+			Assert::IsTrue(queue.Push(4));
+			Assert::IsFalse(queue.Push(5));
+
+			for (int expected = 2; expected <= 4; expected++)
+			{
+				Assert::IsTrue(queue.Pop(item));
+				Assert::AreEqual(expected, item);
+			}
+			Assert::IsFalse(queue.Pop(item));
+		}
+
+		TEST_METHOD(TestCSpscQueueWrap)
+		{
+			// Go around the ring many times with the queue part full
+			CSpscQueue<int, 5> queue;
+			int pushed = 0;
+			int popped = 0;
+			for (int round = 0; round < 50; round++)
+			{
+				for (int i = 0; i < round % 4 + 1; i++)
+				{
+					Assert::IsTrue(queue.Push(pushed++));
+				}
+
+				int item;
+				while (queue.Pop(item))
+				{
+					Assert::AreEqual(popped++, item);
+				}
+			}
+
+			Assert::AreEqual(pushed, popped);
+		}
+
+	};
+}
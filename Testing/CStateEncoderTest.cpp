@@ -0,0 +1,96 @@
+/**
+ * \file CStateEncoderTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "StateEncoder.h"
+#include "StateDecoder.h"
+#include "Game.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CStateEncoderTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCStateEncoderIdle)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+			CLevelTemplate level(&game, 30);
+
+			CStateEncoder encoder;
+			encoder.WriteKeyframe(1, level.GetStart());
+			size_t keyframe = encoder.GetBytes().size();
+			Assert::IsTrue(keyframe > 0);
+
+			// Waiting at the start changes nothing the lanes don't say
+			auto state = level.GetStart();
+			level.Advance(state, CLevelTemplate::Wait);
+			encoder.WriteTick(state, CLevelTemplate::Playing);
+			Assert::AreEqual(keyframe, encoder.GetBytes().size());
+
+			// A step sideways is a header and a flags byte
+			level.Advance(state, CLevelTemplate::Left);
+			encoder.WriteTick(state, CLevelTemplate::Playing);
+			Assert::AreEqual(keyframe + 2, encoder.GetBytes().size());
+		}
+
+		TEST_METHOD(TestCStateEncoderDecode)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			game.Load(1);
+			CLevelTemplate level(&game, 30);
+			vector<const CLevelTemplate*> levels = { nullptr, &level };
+
+			CStateEncoder encoder;
+			CStateDecoder decoder(levels);
+			Assert::IsFalse(decoder.Tick());
+
+			auto state = level.GetStart();
+			encoder.WriteKeyframe(1, state);
+
+			int actions[] = { CLevelTemplate::Left, CLevelTemplate::Wait, CLevelTemplate::Right,
+				CLevelTemplate::Right, CLevelTemplate::Wait, CLevelTemplate::Forward };
+			for (int action : actions)
+			{
+				auto result = level.Advance(state, action);
+				if (result != CLevelTemplate::Playing)
+				{
+					state = level.GetStart();
+				}
+				encoder.WriteTick(state, result);
+
+				decoder.Read(encoder.GetBytes().data(), encoder.GetBytes().size());
+				encoder.Clear();
+				Assert::IsTrue(decoder.Tick());
+
+				Assert::AreEqual(1, decoder.GetLevel());
+				Assert::IsTrue(decoder.GetResult() == result);
+				Assert::AreEqual(state.mStep, decoder.GetState().mStep);
+				Assert::AreEqual(state.mHero.mRow, decoder.GetState().mHero.mRow);
+				Assert::AreEqual(state.mHero.mX, decoder.GetState().mHero.mX, 0.001);
+				Assert::AreEqual(state.mCargo, decoder.GetState().mCargo);
+			}
+		}
+
+	};
+}
@@ -0,0 +1,77 @@
+/**
+ * \file CStressLevelTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "StressLevel.h"
+#include "Game.h"
+#include "Level.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CStressLevelTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCStressLevelMake)
+		{
+			CGame game;
+			CStressLevel::Config config;
+			config.mLanes = 30;
+			config.mVehiclesPerLane = 5;
+			config.mDecorPerRow = 4;
+			config.mCargo = 4;
+
+			// The document compiles straight into a level
+			CLevel level(&game);
+			level.Load(CStressLevel::Make(config));
+			int rows = level.GetRows();
+			Assert::IsTrue(rows > 30 + 4);
+			Assert::AreEqual(4, (int)level.GetCargo().size());
+			Assert::AreEqual(rows * 4 + 30 * 5, (int)level.GetItems().size());
+
+			// Banks at the top and bottom, and every lane is a road or a river
+			auto rules = level.GetRuleTable();
+			Assert::AreEqual(rows, rules->GetRows());
+			Assert::IsTrue(rules->GetTerrain(0) == CRuleTable::Land);
+			Assert::IsTrue(rules->GetTerrain(rows - 1) == CRuleTable::Land);
+			int lanes = 0;
+			for (int row = 0; row < rows; row++)
+			{
+				lanes += rules->GetTerrain(row) != CRuleTable::Land ? 1 : 0;
+			}
+			Assert::AreEqual(30, lanes);
+
+			// The same seed makes the same level, and a small one still fills the screen
+			CLevel again(&game);
+			again.Load(CStressLevel::Make(config));
+			Assert::AreEqual(rows, again.GetRows());
+			for (int row = 0; row < rows; row++)
+			{
+				Assert::IsTrue(rules->GetTerrain(row) == again.GetRuleTable()->GetTerrain(row));
+			}
+
+			config.mLanes = 1;
+			CLevel small(&game);
+			small.Load(CStressLevel::Make(config));
+			Assert::AreEqual(16, small.GetRows());
+		}
+
+	};
+}
@@ -0,0 +1,101 @@
+/**
+ * \file CTallLevelTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "TallLevel.h"
+#include "Game.h"
+#include "Level.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CTallLevelTest)
+	{
+	public:
+
+		TEST_METHOD_INITIALIZE(methodName)
+		{
+			extern wchar_t g_dir[];
+			::SetCurrentDirectory(g_dir);
+		}
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCTallLevelMake)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			auto root = CTallLevel::Make(L".\\levels\\level3.xml", 100);
+			Assert::IsTrue(root != nullptr);
+			auto level = make_shared<CLevel>(&game);
+			level->Load(root);
+			Assert::AreEqual(100, level->GetRows());
+
+			// The rows of lanes repeat down to the bottom bank
+			auto rules = level->GetRuleTable();
+			Assert::AreEqual(100, rules->GetRows());
+			for (int row = 2; row < 14; row++)
+			{
+				Assert::IsTrue(rules->GetTerrain(row) == rules->GetTerrain(row + 12));
+				Assert::IsTrue(rules->GetTerrain(row) == rules->GetTerrain(row + 72));
+			}
+			Assert::IsTrue(rules->GetTerrain(98) == CRuleTable::Land);
+			Assert::IsTrue(rules->GetTerrain(99) == CRuleTable::Land);
+
+			// A level shorter than the screen isn't made
+			Assert::IsTrue(CTallLevel::Make(L".\\levels\\level3.xml", 10) == nullptr);
+		}
+
+		TEST_METHOD(TestCTallLevelCamera)
+		{
+			CGame game;
+			game.LoadLevels(L".\\levels\\", 4);
+			auto level = make_shared<CLevel>(&game);
+			level->Load(CTallLevel::Make(L".\\levels\\level3.xml", 100));
+			game.Add(level);
+
+			// A level that fits on the screen never moves the camera
+			game.Load(3);
+			game.Update(0.01);
+			Assert::AreEqual(0.0, game.GetCameraY());
+			Assert::AreEqual(16, game.GetLiveRows().second - game.GetLiveRows().first);
+			CRenderList screen;
+			game.BuildRenderList(&screen);
+
+			// The hero and cargo start on the bottom bank, with the camera on it
+			game.Load(4);
+			Assert::AreEqual(6400.0, game.GetLevelHeight());
+			Assert::AreEqual(6400.0 - 96, game.GetHero()->GetY());
+			Assert::AreEqual(6400.0 - game.GetHeight(), game.GetCameraY());
+			Assert::AreEqual(6400.0 - 32, game.GetCargo(0)->GetY());
+
+			// Clicks are on the screen, which is at the bottom of the level
+			double cargoX = game.GetCargo(0)->GetX();
+			Assert::IsTrue(game.HitTest(cargoX, game.GetHeight() - 32) == game.GetCargo(0));
+
+			// The camera follows the hero and only the rows near it move
+			game.SetRoadCheatState(true);
+			game.SetRiverCheatState(true);
+			game.GetHero()->SetLocation(480, 50 * 64 + 32);
+			game.Update(0.01);
+			Assert::AreEqual(50 * 64 + 32 - game.GetHeight() / 2.0, game.GetCameraY());
+			auto live = game.GetLiveRows();
+			Assert::IsTrue(live.first <= 50 && live.second > 50);
+			Assert::IsTrue(live.second - live.first <= 16 + 3);
+
+			// Only the rows on the screen are drawn, about as much as a level that fits
+			CRenderList tall;
+			game.BuildRenderList(&tall);
+			Assert::IsTrue(tall.GetSize() < screen.GetSize() * 2);
+		}
+
+	};
+}
@@ -0,0 +1,113 @@
+/**
+ * \file CThreadPoolTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <mutex>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CThreadPoolTest)
+	{
+	public:
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCThreadPoolDependencies)
+		{
+			for (int threads : { 1, 4 })
+			{
+				CThreadPool pool(threads);
+				mutex orderMutex;
+				vector<int> order;
+				auto record = [&](int task)
+				{
+					lock_guard<mutex> lock(orderMutex);
+					order.push_back(task);
+				};
+
+				// Diamond, the last task has to wait for both middle ones
+				auto first = pool.Spawn([&] { record(1); });
+				auto left = pool.Spawn([&] { record(2); }, { first });
+				auto right = pool.Spawn([&] { record(3); }, { first });
+				auto last = pool.Spawn([&] { record(4); }, { left, right });
+				pool.Wait(last);
+
+				Assert::AreEqual(4, (int)order.size());
+				Assert::AreEqual(1, order[0]);
+				Assert::AreEqual(4, order[3]);
+			}
+		}
+
+		TEST_METHOD(TestCThreadPoolParallelFor)
+		{
+			CThreadPool pool(4);
+
+			// Every index once, including from inside tasks
+			vector<int> counts(10000, 0);
+			vector<CThreadPool::Task> tasks;
+			for (int part = 0; part < 4; part++)
+			{
+				tasks.push_back(pool.Spawn([&, part]
+					{
+						pool.ParallelFor(part * 2500, (part + 1) * 2500, 7, [&](int begin, int end)
+							{
+								for (int i = begin; i < end; i++)
+								{
+									counts[i]++;
+								}
+							});
+					}));
+			}
+			pool.Wait(tasks);
+
+			for (int count : counts)
+			{
+				Assert::AreEqual(1, count);
+			}
+		}
+
+		TEST_METHOD(TestCThreadPoolSingleThreaded)
+		{
+			CThreadPool pool(4);
+			pool.SetSingleThreaded(true);
+			Assert::AreEqual(1, pool.GetThreadCount());
+
+			// The same tasks run in the same order every time, none of them on a worker
+			vector<int> orders[2];
+			for (auto& order : orders)
+			{
+				vector<CThreadPool::Task> tasks;
+				for (int i = 0; i < 100; i++)
+				{
+					vector<CThreadPool::Task> after;
+					if (i >= 3)
+					{
+						after.push_back(tasks[i - 3]);
+					}
+
+					tasks.push_back(pool.Spawn([&order, i] { order.push_back(i); }, after));
+				}
+				pool.Wait(tasks);
+			}
+
+			Assert::AreEqual(100, (int)orders[0].size());
+			Assert::IsTrue(orders[0] == orders[1]);
+			Assert::AreEqual(0LL, pool.GetStats().mStolen);
+			Assert::AreEqual(200LL, pool.GetStats().mRun);
+
+			pool.SetSingleThreaded(false);
+			Assert::AreEqual(4, pool.GetThreadCount());
+		}
+	};
+}
@@ -0,0 +1,68 @@
+/**
+ * \file CTripleBufferTest.cpp
+ *
+ * \author Michael Dittman
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+#include "TripleBuffer.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace std;
+
+namespace Testing
+{
+	TEST_CLASS(CTripleBufferTest)
+	{
+	public:
+
+		TEST_METHOD(TestNothing)
+		{
+			// This is an empty test just to ensure the system is working
+		}
+
+		TEST_METHOD(TestCTripleBufferAcquire)
+		{
+			CTripleBuffer<int> buffer;
+
+			// Nothing has been published yet
+			Assert::IsFalse(buffer.Acquire());
+
+			buffer.GetBack() = 1;
+			buffer.Publish();
+			Assert::IsTrue(buffer.Acquire());
+			Assert::AreEqual(1, buffer.GetFront());
+
+			// The same copy isn't acquired twice
+			Assert::IsFalse(buffer.Acquire());
+			Assert::AreEqual(1, buffer.GetFront());
+		}
+
+		TEST_METHOD(TestCTripleBufferLatest)
+		{
+			CTripleBuffer<int> buffer;
+
+			// Copies the reader never got to are written over by newer ones
+			for (int frame = 1; frame <= 10; frame++)
+			{
+				buffer.GetBack() = frame;
+				buffer.Publish();
+
+				// The writer never fills in the copy the reader has
+				Assert::IsTrue(&buffer.GetBack() != &buffer.GetFront());
+			}
+
+			Assert::IsTrue(buffer.Acquire());
+			Assert::AreEqual(10, buffer.GetFront());
+
+			// Publishing while the reader holds a copy leaves it alone
+			buffer.GetBack() = 11;
+			Assert::AreEqual(10, buffer.GetFront());
+			buffer.Publish();
+			Assert::AreEqual(10, buffer.GetFront());
+			Assert::IsTrue(buffer.Acquire());
+			Assert::AreEqual(11, buffer.GetFront());
+		}
+
+	};
+}
@@ -38,6 +38,34 @@ namespace Testing
 			// This is an empty test just to ensure the system is working
 		}
 
+		TEST_METHOD(TestCVehiclePositionAt)
+		{
+			shared_ptr<Bitmap> bitmap = shared_ptr<Bitmap>(Bitmap::FromFile(L"images/road1.png"));
+			CGame game;
+
+			// 64 pixels wide, going right at 2 tiles a second on a 16 tile lane.
+			// It wraps at 1024 + 64 - 256 = 832 back to 832 - 1280 = -448.
+			CVehicle right(&game, bitmap, 128, 96, 0, 16);
+			Assert::AreEqual(128.0, right.GetPositionAt(1), 0.0001);
+			Assert::AreEqual(819.2, right.GetPositionAt(6.4), 0.0001);
+			Assert::AreEqual(-448.0, right.GetPositionAt(6.5), 0.0001);
+			Assert::AreEqual(right.GetPositionAt(3), right.GetPositionAt(3 + 1280.0 / 128 * 50), 0.0001);
+
+			// Going left it wraps from -32 back to 1024 - 32
+			CVehicle left(&game, bitmap, -128, 96, 0, 16);
+			Assert::AreEqual(-12.8, left.GetPositionAt(0.1), 0.0001);
+			Assert::AreEqual(992.0, left.GetPositionAt(0.25), 0.0001);
+			Assert::AreEqual(0.0, left.GetPositionAt(8), 0.0001);
+
+			// Stepping gets to the same place as seeking
+			for (int i = 0; i < 1000; i++)
+			{
+				right.Update(0.05);
+			}
+			Assert::AreEqual(right.GetPositionAt(50), right.GetX(), 0.0001);
+			Assert::AreEqual(1, right.GetRow());
+		}
+
 		
 
 	};
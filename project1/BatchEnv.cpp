@@ -0,0 +1,216 @@
+/**
+ * \file BatchEnv.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "BatchEnv.h"
+#include "Game.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+
+using namespace std;
+
+/// Number of instances stepped together on one thread
+const int Grain = 256;
+
+/// Instances the benchmark plays
+const int BenchmarkInstances = 4096;
+
+/// Steps the benchmark plays each level for
+const int BenchmarkSteps = 1000;
+
+/// Level time in seconds benchmark episodes run out of time at
+const double BenchmarkLimit = 60;
+
+
+/**
+ * Constructor. Makes a template of each of the game's levels.
+ *
+ * Every level is loaded into the game to make its template, so this
+ * is done on the thread that owns the game. The game is left with the
+ * last level loaded. The instances start out on the first level.
+ *
+ * \param game Game with its levels added
+ * \param count Number of instances
+ * \param limit Level time in seconds an episode runs out of time at
+ */
+CBatchEnv::CBatchEnv(CGame* game, int count, double limit) : mPool(CThreadPool::GetShared())
+{
+    for (int level = 0; level < game->GetLevelCount(); level++)
+    {
+        game->Load(level);
+        mTemplates.push_back(make_unique<CLevelTemplate>(game, limit));
+    }
+
+    mInstances.resize(count);
+    mEnded.resize((count + Grain - 1) / Grain);
+    mWon.resize(mEnded.size());
+
+    for (auto& instance : mInstances)
+    {
+        instance.mLevel = mTemplates.empty() ? nullptr : mTemplates[0].get();
+    }
+}
+
+
+/**
+ * Start every instance on a level
+ * \param level Level to play
+ * \param observations Where to write what each instance sees, ObservationSize floats an instance
+ */
+void CBatchEnv::Reset(int level, float* observations)
+{
+    const CLevelTemplate* played = mTemplates[level].get();
+    mPool->ParallelFor(0, GetCount(), Grain, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                mInstances[i].mLevel = played;
+                mInstances[i].mState = played->GetStart();
+                Observe(mInstances[i], observations + (size_t)i * ObservationSize);
+            }
+        });
+
+    mWins = 0;
+    mEpisodes = 0;
+}
+
+
+/**
+ * Step every instance once.
+ *
+ * An instance gets a reward of 1 for winning and -1 for losing.
+ * Instances that are done have already started over.
+ *
+ * \param actions Action for each instance
+ * \param observations Where to write what each instance sees, ObservationSize floats an instance
+ * \param rewards Where to write the reward each instance got
+ * \param done Where to write 1 for each instance whose episode ended, 0 for the rest
+ */
+void CBatchEnv::Step(const int* actions, float* observations, float* rewards, unsigned char* done)
+{
+    mPool->ParallelFor(0, GetCount(), Grain, [&](int begin, int end)
+        {
+            int ended = 0;
+            int won = 0;
+            for (int i = begin; i < end; i++)
+            {
+                Instance& instance = mInstances[i];
+                CLevelTemplate::Result result = instance.mLevel->Advance(instance.mState, actions[i]);
+
+                rewards[i] = result == CLevelTemplate::Won ? 1.0f : result == CLevelTemplate::Lost ? -1.0f : 0.0f;
+                done[i] = result != CLevelTemplate::Playing;
+                if (result != CLevelTemplate::Playing)
+                {
+                    ended++;
+                    won += result == CLevelTemplate::Won ? 1 : 0;
+                    instance.mState = instance.mLevel->GetStart();
+                }
+
+                Observe(instance, observations + (size_t)i * ObservationSize);
+            }
+
+            mEnded[begin / Grain] = ended;
+            mWon[begin / Grain] = won;
+        });
+
+    for (size_t chunk = 0; chunk < mEnded.size(); chunk++)
+    {
+        mEpisodes += mEnded[chunk];
+        mWins += mWon[chunk];
+    }
+}
+
+
+/**
+ * Write what an instance sees
+ * \param instance Instance to look at
+ * \param observation Where to write ObservationSize floats
+ */
+void CBatchEnv::Observe(const Instance& instance, float* observation) const
+{
+    const CLevelTemplate& level = *instance.mLevel;
+    const CLevelTemplate::State& state = instance.mState;
+
+    observation[0] = (float)(state.mHero.mX / level.GetMaxX());
+    observation[1] = (float)state.mHero.mRow / (CLaneModel::Rows - 1);
+    observation[2] = state.mHero.mBoat >= 0 ? 1.0f : 0.0f;
+    observation[3] = (float)(level.GetLastStep() - state.mStep) / (level.GetLastStep() - level.GetFirstStep());
+
+    // Which moves the hero would get through the step after
+    for (int action = Wait; action < ClickCargo; action++)
+    {
+        observation[4 + action] = level.Survives(state, action) ? 1.0f : 0.0f;
+    }
+
+    const CCargoModel& cargo = level.GetCargo();
+    for (int i = 0; i < MaxCargo; i++)
+    {
+        float side = -1;
+        if (i < cargo.GetCount())
+        {
+            CCargoModel::Side at = CCargoModel::GetSide(state.mCargo, i);
+            side = at == CCargoModel::AtBottom ? 0.0f : at == CCargoModel::Carried ? 0.5f : 1.0f;
+        }
+
+        observation[4 + ClickCargo + i] = side;
+    }
+}
+
+
+/**
+ * Play every level with random actions and time how many steps a second are made
+ * \param levels Directory the levels are in, ending with a separator
+ * \returns Report of how each level went
+ */
+std::wstring CBatchEnv::Benchmark(const std::wstring& levels)
+{
+    CGame game;
+    game.LoadLevels(levels, 4);
+
+    auto start = chrono::steady_clock::now();
+    CBatchEnv env(&game, BenchmarkInstances, BenchmarkLimit);
+    chrono::duration<double, milli> built = chrono::steady_clock::now() - start;
+
+    int count = env.GetCount();
+    vector<float> observations((size_t)count * ObservationSize);
+    vector<float> rewards(count);
+    vector<unsigned char> done(count);
+    vector<int> actions(count);
+
+    wostringstream report;
+    report << L"Batch environment benchmark, " << count << L" instances, "
+        << env.mPool->GetThreadCount() << L" threads" << endl;
+    report << L"Templates made in " << fixed << setprecision(2) << built.count() << L" ms" << endl << endl;
+    report << L"  level  steps/s     episodes  wins" << endl;
+
+    // Random actions, the same every run
+    unsigned int seed = 12345;
+    for (int level = 0; level < env.GetLevelCount(); level++)
+    {
+        env.Reset(level, observations.data());
+
+        chrono::duration<double> stepping(0);
+        for (int step = 0; step < BenchmarkSteps; step++)
+        {
+            for (auto& action : actions)
+            {
+                seed = seed * 1664525 + 1013904223;
+                action = (int)(seed >> 16) % ActionCount;
+            }
+
+            auto begin = chrono::steady_clock::now();
+            env.Step(actions.data(), observations.data(), rewards.data(), done.data());
+            stepping += chrono::steady_clock::now() - begin;
+        }
+
+        double rate = stepping.count() > 0 ? (double)count * BenchmarkSteps / stepping.count() : 0;
+        report << setw(7) << level << setw(10) << setprecision(2) << rate / 1000000 << L"M"
+            << setw(12) << env.GetEpisodes() << setw(6) << env.GetWins() << endl;
+    }
+
+    return report.str();
+}
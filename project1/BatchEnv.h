@@ -0,0 +1,127 @@
+/**
+ * \file BatchEnv.h
+ *
+ * \author Michael Dittman
+ *
+ * Many copies of the game played at once by automated players.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "ThreadPool.h"
+#include "LevelTemplate.h"
+
+class CGame;
+
+
+/**
+ * Many copies of the game played at once by automated players.
+ *
+ * Every instance is stepped together: Step takes one action for each
+ * instance and writes what each one sees, the reward it got and if
+ * its episode ended straight into buffers the caller owns. Instances
+ * are split up across the shared thread pool.
+ *
+ * Instances don't play a CGame. Each level is made into a
+ * CLevelTemplate once and every instance on that level reads the
+ * same template. An instance is then just where the hero and cargo
+ * are and the step it is at.
+ *
+ * When an instance wins, loses or runs out of time it starts its
+ * level again, and what it sees after that step is the start of the
+ * new episode.
+ */
+class CBatchEnv
+{
+public:
+    /// Actions Step takes, ClickCargo + i clicks on cargo item i
+    enum Action
+    {
+        Wait = CLevelTemplate::Wait,
+        Forward = CLevelTemplate::Forward,
+        Backward = CLevelTemplate::Backward,
+        Left = CLevelTemplate::Left,
+        Right = CLevelTemplate::Right,
+        ClickCargo = CLevelTemplate::ClickCargo
+    };
+
+    /// Most cargo items an observation has room for
+    const static int MaxCargo = 4;
+
+    /// Number of actions, including a click on each cargo slot
+    const static int ActionCount = ClickCargo + MaxCargo;
+
+    /**
+     * Number of floats each instance writes to the observations.
+     *
+     * Hero X and row scaled to 0-1, 1 if riding a boat, the part of
+     * the time limit left, 1 for each move from Wait to Right that the
+     * hero would get through the step after, then where each cargo
+     * slot is: 0 at the bottom, 0.5 carried, 1 at the top, -1 unused.
+     */
+    const static int ObservationSize = 4 + ClickCargo + MaxCargo;
+
+    /// Default constructor (disabled)
+    CBatchEnv() = delete;
+
+    /// Copy constructor (disabled)
+    CBatchEnv(const CBatchEnv&) = delete;
+
+    CBatchEnv(CGame* game, int count, double limit);
+
+    /** Get the number of instances
+     * \returns Number of instances */
+    int GetCount() const { return (int)mInstances.size(); }
+
+    /** Get the number of levels there are templates for
+     * \returns Number of levels */
+    int GetLevelCount() const { return (int)mTemplates.size(); }
+
+    void Reset(int level, float* observations);
+
+    void Step(const int* actions, float* observations, float* rewards, unsigned char* done);
+
+    /** Get the number of episodes won since the last reset
+     * \returns Number of wins */
+    long long GetWins() const { return mWins; }
+
+    /** Get the number of episodes ended since the last reset
+     * \returns Number of episodes */
+    long long GetEpisodes() const { return mEpisodes; }
+
+    static std::wstring Benchmark(const std::wstring& levels);
+
+private:
+    /// One copy of the game
+    struct Instance
+    {
+        const CLevelTemplate* mLevel = nullptr; ///< Level being played
+        CLevelTemplate::State mState;           ///< Where the instance is in it
+    };
+
+    void Observe(const Instance& instance, float* observation) const;
+
+    /// Threads the instances are stepped on
+    CThreadPool* mPool;
+
+    /// Templates, by level
+    std::vector<std::unique_ptr<CLevelTemplate>> mTemplates;
+
+    /// The instances
+    std::vector<Instance> mInstances;
+
+    /// Episodes ended by each chunk of instances in the last step
+    std::vector<int> mEnded;
+
+    /// Episodes won by each chunk of instances in the last step
+    std::vector<int> mWon;
+
+    /// Episodes won since the last reset
+    long long mWins = 0;
+
+    /// Episodes ended since the last reset
+    long long mEpisodes = 0;
+};
@@ -78,9 +78,9 @@ void CCar::Update(double elapsed)
 
 /**
 * Draw this item
-* \param graphics Graphics device to draw on
+* \param list Render list to record the drawing into
 */
-void CCar::Draw(Gdiplus::Graphics* graphics)
+void CCar::Draw(CRenderList* list)
 {
 
     // Get the image item
@@ -99,7 +99,7 @@ void CCar::Draw(Gdiplus::Graphics* graphics)
        
         double wid = mSwappedImage->GetWidth();
         double hit = mSwappedImage->GetHeight();
-        graphics->DrawImage(mSwappedImage.get(),
+        list->DrawImage(mSwappedImage.get(),
             float(GetX() - wid / 2), float(GetY() - hit / 2),
             (float)wid, (float)hit); 
         
@@ -113,11 +113,9 @@ void CCar::Draw(Gdiplus::Graphics* graphics)
         if (GetX() - GetWidth() / 2 < 0)
         {
 
-            // Create a solid black brush
-            SolidBrush black(Color(0, 0, 0));
 
             // Fill a rectangle starting off the screen and going to the edge of the boundary
-            graphics->FillRectangle(&black, float(-600), float(GetY() - hit / 2),
+            list->FillRectangle(Color(0, 0, 0), float(-600), float(GetY() - hit / 2),
                 (float)600, (float)800);
 
         }
@@ -125,28 +123,24 @@ void CCar::Draw(Gdiplus::Graphics* graphics)
         else if (GetWidth() / 2 + GetX() > Width)
         {
 
-            // Create a solid black brush
-            SolidBrush black(Color(0, 0, 0));
 
             // Fill a recntangle starting at the width of the boundary to off screen
-            graphics->FillRectangle(&black, float(Width), float(GetY() - hit / 2),
+            list->FillRectangle(Color(0, 0, 0), float(Width), float(GetY() - hit / 2),
                 (float)800, (float)800);
         }
     }
     else 
     {
 
-        CItem::Draw(graphics);
+        CItem::Draw(list);
 
         // If the vehcile is starting to pass the left boundary
         if (GetX() - GetWidth() / 2 < 0)
         {
 
-            // Create a solid black brush
-            SolidBrush black(Color(0, 0, 0));
 
             // Fill a rectangle starting off the screen and going to the edge of the boundary
-            graphics->FillRectangle(&black, float(-600), float(GetY() - hit / 2),
+            list->FillRectangle(Color(0, 0, 0), float(-600), float(GetY() - hit / 2),
                 (float)600, (float)800);
 
         }
@@ -154,11 +148,9 @@ void CCar::Draw(Gdiplus::Graphics* graphics)
         else if (GetWidth() / 2 + GetX() > Width)
         {
 
-            // Create a solid black brush
-            SolidBrush black(Color(0, 0, 0));
 
             // Fill a recntangle starting at the width of the boundary to off screen
-            graphics->FillRectangle(&black, float(Width), float(GetY() - hit / 2),
+            list->FillRectangle(Color(0, 0, 0), float(Width), float(GetY() - hit / 2),
                 (float)800, (float)800);
         }
     }
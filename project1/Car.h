@@ -29,7 +29,7 @@ public:
 
     virtual void Update(double elapsed) override;
 
-    virtual void Draw(Gdiplus::Graphics* graphics) override;
+    virtual void Draw(CRenderList* list) override;
 
     /** 
     * Clones a car by invoking the copy constructor, returns an item pointer
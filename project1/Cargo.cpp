@@ -43,15 +43,16 @@ CCargo::CCargo(const CCargo& cargo) : CItem(cargo)
 	mCarriedItemImage = cargo.mCarriedItemImage;
 	mName = cargo.mName;
 	mId = cargo.mId;
+	mEats = cargo.mEats;
 	mImageNormal = cargo.mImageNormal;
 	mCarriedImage = cargo.mCarriedImage;
 	mHomeX = cargo.mHomeX;
 }
 
 /** Draws a cargo object
- * \param graphics Pointer to where to draw cargo
+ * \param list Render list to record the drawing into
  */
-void CCargo::Draw(Gdiplus::Graphics* graphics)
+void CCargo::Draw(CRenderList* list)
 {
 	CGame* game = GetGame();
 	
@@ -62,7 +63,7 @@ void CCargo::Draw(Gdiplus::Graphics* graphics)
 		double wid = mCarriedItemImage->GetWidth();
 		double hit = mCarriedItemImage->GetHeight();
 
-		graphics->DrawImage(mCarriedItemImage.get(),
+		list->DrawImage(mCarriedItemImage.get(),
 			float(game->GetHero()->GetX() - wid / 2), float(game->GetHero()->GetY() - hit / 2),
 			(float)mCarriedItemImage->GetWidth(), (float)mCarriedItemImage->GetHeight());
 	}
@@ -71,7 +72,7 @@ void CCargo::Draw(Gdiplus::Graphics* graphics)
 		double wid = mImageNormal->GetWidth();
 		double hit = mImageNormal->GetHeight();
 
-		graphics->DrawImage(mImageNormal.get(),
+		list->DrawImage(mImageNormal.get(),
 			float(GetX() - wid / 2), float(GetY() - hit / 2),
 			(float)GetWidth(), (float)GetHeight());
 	}
@@ -91,7 +92,8 @@ void CCargo::XmlLoad(const std::shared_ptr<xmlnode::CXmlNode>& node)
 	mHomeX = GetX();
 
 	// load cargo specific xml info
-	mId = node->GetAttributeValue(L"cargo id", L"");
+	mId = node->GetAttributeValue(L"id", L"");
+	mEats = node->GetAttributeValue(L"eats", L"");
 	mName = node->GetAttributeValue(L"name", L"");
 
 	mImage = node->GetAttributeValue(L"image", L"");
@@ -128,7 +130,10 @@ void CCargo::Release()
 {
 	double heroY = GetGame()->GetHero()->GetY();
 
-	if (heroY <= TileToPixels * 2 || heroY >= TileToPixels * 14)
+	// The bottom bank is at the bottom of the level, however tall it is
+	double bottom = GetGame()->GetLevelHeight();
+
+	if (heroY <= TileToPixels * 2 || heroY >= bottom - TileToPixels * 2)
 	{
 		mCarriedByHero = false;
 
@@ -136,9 +141,9 @@ void CCargo::Release()
 			{
 				SetLocation(mHomeX, TileToPixels * 0.5);
 			}
-			if (heroY >= TileToPixels * 14)
+			if (heroY >= bottom - TileToPixels * 2)
 			{
-				SetLocation(mHomeX, TileToPixels * 15.5);
+				SetLocation(mHomeX, bottom - TileToPixels * 0.5);
 			}
 			GetGame()->GetHero()->SetCarrying(false);
 	}
@@ -36,7 +36,7 @@ public:
 	 * \return True if Cargo is being carried */
 	bool GetCarryStatus() { return mCarriedByHero; }
 
-	virtual void Draw(Gdiplus::Graphics* graphics);
+	virtual void Draw(CRenderList* list);
 
 	virtual void XmlLoad(const std::shared_ptr<xmlnode::CXmlNode>& node);
 
@@ -62,6 +62,16 @@ public:
 	*/
 	std::wstring GetName() { return mName; }
 
+	/** Gets the id the level gives the cargo
+	* \return id of cargo
+	*/
+	const std::wstring& GetId() const { return mId; }
+
+	/** Gets the ids of the cargo this cargo eats
+	* \return ids separated by spaces, empty if it eats nothing
+	*/
+	const std::wstring& GetEats() const { return mEats; }
+
 private:
 
 	/// Flag for if the cargo is currently being held by the hero
@@ -82,6 +92,9 @@ private:
 	/// Cargo ID to identify object internally
 	std::wstring mId;
 
+	/// Ids of the cargo this cargo eats when left alone with it
+	std::wstring mEats;
+
 	/// Image filename when object is in place
 	std::wstring mImage;
 
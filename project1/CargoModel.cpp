@@ -0,0 +1,130 @@
+/**
+ * \file CargoModel.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "CargoModel.h"
+#include "Game.h"
+#include "LaneModel.h"
+#include <cmath>
+
+using namespace std;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Where CCargo::Release puts cargo down at the top
+const double TopCargoY = TileToPixels * 0.5;
+
+/// Where CCargo::Release puts cargo down at the bottom
+const double BottomCargoY = TileToPixels * 15.5;
+
+
+/**
+ * Constructor. Finds the cargo of the level the game has loaded.
+ *
+ * Whether cargo is eaten only depends on which bank each cargo item
+ * is on and which bank the hero is watching, so it is looked up in
+ * the level's puzzle for every combination.
+ *
+ * \param game Game with the level loaded
+ */
+CCargoModel::CCargoModel(CGame* game)
+{
+    for (CCargo* cargo = game->GetCargo(0); cargo != nullptr; cargo = game->GetCargo(mCount))
+    {
+        int side = cargo->GetY() < game->GetHeight() / 2 ? AtTop : AtBottom;
+        mStart += side * Pow3(mCount);
+        mCount++;
+    }
+
+    mRows = CLaneModel::Rows;
+    int states = GetStates();
+    mEaten.assign(states * mRows, false);
+
+    auto puzzle = game->GetCargoPuzzle();
+    for (int cargo = 0; cargo < states && puzzle != nullptr; cargo++)
+    {
+        int top = 0;
+        int bottom = 0;
+        for (int i = 0; i < mCount; i++)
+        {
+            top |= GetSide(cargo, i) == AtTop ? 1 << i : 0;
+            bottom |= GetSide(cargo, i) == AtBottom ? 1 << i : 0;
+        }
+
+        for (int row = 0; row < mRows; row++)
+        {
+            CCargoPuzzle::Bank bank = row <= CLaneModel::TopRow ? CCargoPuzzle::Top :
+                row >= CLaneModel::BottomRow ? CCargoPuzzle::Bottom : CCargoPuzzle::Away;
+            mEaten[cargo * mRows + row] = puzzle->IsEaten(top, bottom, bank);
+        }
+    }
+}
+
+
+/**
+ * Click on a cargo item, the way CCargo::PickUp and CCargo::Release do
+ * \param cargo Cargo state to click in, changed to the state after it
+ * \param row Row of tiles the hero is on
+ * \param index Cargo clicked on
+ * \returns False if the click does nothing
+ */
+bool CCargoModel::Click(int& cargo, int row, int index) const
+{
+    int digit = Pow3(index);
+    int side = GetSide(cargo, index);
+
+    // Where cargo put down here goes, if it can be put down here
+    int down = row == CLaneModel::TopRow ? AtTop : row == CLaneModel::BottomRow ? AtBottom : -1;
+
+    if (side == Carried)
+    {
+        if (down < 0)
+        {
+            return false;
+        }
+
+        cargo += (down - Carried) * digit;
+        return true;
+    }
+
+    // Cargo can only be picked up from the row next to it
+    double heroY = row * TileToPixels + TileToPixels / 2;
+    double cargoY = side == AtTop ? TopCargoY : BottomCargoY;
+    if (fabs(heroY - cargoY) > TileToPixels)
+    {
+        return false;
+    }
+
+    // Whatever the hero was carrying is put down first
+    for (int other = 0; other < mCount; other++)
+    {
+        if (GetSide(cargo, other) == Carried)
+        {
+            cargo += (down - Carried) * Pow3(other);
+        }
+    }
+
+    cargo += (Carried - side) * digit;
+    return true;
+}
+
+
+/**
+ * Get a power of 3, the value of a cargo digit
+ * \param power Power to raise 3 to
+ * \returns 3 to the power
+ */
+int CCargoModel::Pow3(int power)
+{
+    int value = 1;
+    for (int i = 0; i < power; i++)
+    {
+        value *= 3;
+    }
+
+    return value;
+}
@@ -0,0 +1,87 @@
+/**
+ * \file CargoModel.h
+ *
+ * \author Michael Dittman
+ *
+ * Where the cargo of a level can be and what happens when it is clicked on.
+ */
+
+#pragma once
+
+#include <vector>
+
+class CGame;
+
+
+/**
+ * Where the cargo of a level can be and what happens when it is clicked on.
+ *
+ * Each cargo item is at the bottom, at the top or carried, so where
+ * all of them are fits in one number with a base 3 digit an item.
+ * Whether any cargo gets eaten only depends on that number and the
+ * row the hero is on, so it is worked out for every combination when
+ * the model is made.
+ *
+ * The model is made from the game on the thread that owns it. After
+ * that it only reads its tables, so any number of threads can use it.
+ */
+class CCargoModel
+{
+public:
+    /// Where a cargo item can be, as a base 3 digit of a cargo state
+    enum Side { AtBottom = 0, AtTop = 1, Carried = 2 };
+
+    /// Default constructor (disabled)
+    CCargoModel() = delete;
+
+    /// Copy constructor (disabled)
+    CCargoModel(const CCargoModel&) = delete;
+
+    CCargoModel(CGame* game);
+
+    /** Get the number of cargo items
+     * \returns Number of items */
+    int GetCount() const { return mCount; }
+
+    /** Get where the cargo is when the level is loaded
+     * \returns Cargo state */
+    int GetStart() const { return mStart; }
+
+    /** Get the number of distinct cargo states
+     * \returns One past the largest cargo state */
+    int GetStates() const { return Pow3(mCount); }
+
+    /** Get where one cargo item is
+     * \param cargo Cargo state
+     * \param index Cargo item
+     * \returns Side the item is on */
+    static Side GetSide(int cargo, int index) { return (Side)(cargo / Pow3(index) % 3); }
+
+    bool Click(int& cargo, int row, int index) const;
+
+    /** Test if any cargo gets eaten
+     * \param cargo Cargo state
+     * \param row Row of tiles the hero is on
+     * \returns True if some cargo is left with what eats it */
+    bool IsEaten(int cargo, int row) const { return mEaten[cargo * mRows + row]; }
+
+    /** Test if all of the cargo has been put down at the top
+     * \param cargo Cargo state
+     * \returns True if the level is won */
+    bool IsWon(int cargo) const { return mCount > 0 && cargo == (GetStates() - 1) / 2; }
+
+    static int Pow3(int power);
+
+private:
+    /// Number of cargo items
+    int mCount = 0;
+
+    /// Cargo state when the level is loaded
+    int mStart = 0;
+
+    /// Number of rows the eaten table covers
+    int mRows = 0;
+
+    /// Whether cargo gets eaten, by cargo state and then hero row
+    std::vector<bool> mEaten;
+};
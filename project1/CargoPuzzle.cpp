@@ -0,0 +1,151 @@
+/**
+ * \file CargoPuzzle.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "CargoPuzzle.h"
+#include "Cargo.h"
+#include "IsCargoVisitor.h"
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+
+/**
+ * Constructor. Works out what eats what for the cargo among some items.
+ * \param cargo Cargo items of a level, in the order the level has them
+ */
+CCargoPuzzle::CCargoPuzzle(const std::vector<std::shared_ptr<CItem>>& cargo)
+{
+    vector<wstring> eats;
+    for (auto item : cargo)
+    {
+        CIsCargoVisitor visitor;
+        item->Accept(&visitor);
+        if (visitor.GetIsCargo() && (int)mIds.size() < MaxCargo)
+        {
+            mIds.push_back(visitor.GetCargo()->GetId());
+            eats.push_back(visitor.GetCargo()->GetEats());
+        }
+    }
+
+    // The eats attribute is a list of ids
+    mEats.assign(mIds.size(), 0);
+    for (int i = 0; i < (int)mIds.size(); i++)
+    {
+        wistringstream stream(eats[i]);
+        wstring id;
+        while (stream >> id)
+        {
+            auto found = find(mIds.begin(), mIds.end(), id);
+            if (found != mIds.end() && found - mIds.begin() != i)
+            {
+                mEats[i] |= 1 << (found - mIds.begin());
+            }
+        }
+    }
+
+    int sets = 1 << mIds.size();
+    mEaten.assign(sets, -1);
+    mEater.assign(sets, -1);
+    for (int bank = 0; bank < sets; bank++)
+    {
+        for (int eaten = 0; eaten < (int)mIds.size() && mEaten[bank] < 0; eaten++)
+        {
+            for (int eater = 0; eater < (int)mIds.size(); eater++)
+            {
+                if ((bank >> eaten & 1) && (bank >> eater & 1) && Eats(eater, eaten))
+                {
+                    mEaten[bank] = eaten;
+                    mEater[bank] = eater;
+                    break;
+                }
+            }
+        }
+    }
+
+    Solve();
+}
+
+
+/**
+ * Find the fewest trips that get the cargo across.
+ *
+ * An arrangement is the cargo on the top bank and the bank the hero is
+ * at. A trip takes the hero to the other bank with at most one cargo
+ * item, and both banks are left alone while the hero is crossing.
+ * Every arrangement is reached at most once, going out a trip at a time
+ * from the start, so the first time every cargo item is on the top
+ * bank is after the fewest trips.
+ */
+void CCargoPuzzle::Solve()
+{
+    int count = (int)mIds.size();
+    int all = (1 << count) - 1;
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Arrangement a trip came from and the trip, by arrangement
+    const int Unreached = -2;
+    vector<int> from(2 << count, Unreached);
+    vector<Trip> trip(2 << count);
+
+    auto encode = [count](int top, int hero) { return hero << count | top; };
+    int start = encode(0, Bottom);
+    int goal = encode(all, Top);
+    from[start] = -1;
+
+    vector<int> queue = { start };
+    for (size_t next = 0; next < queue.size() && from[goal] == Unreached; next++)
+    {
+        int top = queue[next] & all;
+        int hero = queue[next] >> count;
+        int here = hero == Top ? top : all & ~top;
+
+        for (int cargo = -1; cargo < count; cargo++)
+        {
+            int carried = cargo < 0 ? 0 : 1 << cargo;
+            if (cargo >= 0 && !(here & carried))
+            {
+                continue;
+            }
+
+            // Nobody is watching either bank on the way over
+            int leftTop = top & ~(hero == Top ? carried : 0);
+            int leftBottom = (all & ~top) & ~(hero == Bottom ? carried : 0);
+            if (mEaten[leftTop] >= 0 || mEaten[leftBottom] >= 0)
+            {
+                continue;
+            }
+
+            int to = hero == Top ? Bottom : Top;
+            int arrangement = encode(to == Top ? top | carried : top & ~carried, to);
+            if (from[arrangement] == Unreached)
+            {
+                from[arrangement] = queue[next];
+                trip[arrangement].mCargo = cargo;
+                trip[arrangement].mTo = (Bank)to;
+                queue.push_back(arrangement);
+            }
+        }
+    }
+
+    mSolvable = from[goal] != Unreached;
+    if (!mSolvable)
+    {
+        return;
+    }
+
+    for (int arrangement = goal; arrangement != start; arrangement = from[arrangement])
+    {
+        mTrips.push_back(trip[arrangement]);
+    }
+
+    reverse(mTrips.begin(), mTrips.end());
+}
+
@@ -0,0 +1,122 @@
+/**
+ * \file CargoPuzzle.h
+ *
+ * \author Michael Dittman
+ *
+ * Which cargo eats which, and the fewest trips that get it all across.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+
+class CItem;
+
+
+/**
+ * Which cargo eats which, and the fewest trips that get it all across.
+ *
+ * Each cargo item in a level can name the cargo it eats with an "eats"
+ * attribute. Cargo left on a bank without the hero eats what it eats if
+ * that is on the same bank. Cargo is numbered in the order the level
+ * has it, the same as CGame::GetCargo, and a set of cargo is a mask
+ * with a bit for each.
+ *
+ * What gets eaten is worked out once for every set of cargo when the
+ * level is loaded, so testing a bank is a single lookup. The fewest
+ * trips across the river are found the same way, by going through
+ * every arrangement of the cargo on the banks once.
+ */
+class CCargoPuzzle
+{
+public:
+    /// Most cargo items a level can have
+    const static int MaxCargo = 8;
+
+    /// Where the hero is, as far as the cargo is concerned
+    enum Bank { Bottom = 0, Top = 1, Away = 2 };
+
+    /// One trip across the river
+    struct Trip
+    {
+        int mCargo = -1;        ///< Cargo carried across, -1 for none
+        Bank mTo = Top;         ///< Bank the trip goes to
+    };
+
+    /// Default constructor (disabled)
+    CCargoPuzzle() = delete;
+
+    /// Copy constructor (disabled)
+    CCargoPuzzle(const CCargoPuzzle&) = delete;
+
+    CCargoPuzzle(const std::vector<std::shared_ptr<CItem>>& cargo);
+
+    /** Get the number of cargo items
+     * \returns Number of cargo items */
+    int GetCount() const { return (int)mIds.size(); }
+
+    /** Get the id of a cargo item
+     * \param cargo Cargo to get
+     * \returns Id from the level */
+    const std::wstring& GetId(int cargo) const { return mIds[cargo]; }
+
+    /** Does one cargo item eat another?
+     * \param eater Cargo that might eat
+     * \param eaten Cargo that might be eaten
+     * \returns True if eater eats eaten when left with it */
+    bool Eats(int eater, int eaten) const { return (mEats[eater] >> eaten & 1) != 0; }
+
+    /** Get the cargo that gets eaten on a bank the hero isn't at
+     * \param bank Mask of the cargo on the bank
+     * \returns Cargo that is eaten, -1 if the bank is safe */
+    int GetEaten(int bank) const { return mEaten[bank]; }
+
+    /** Get the cargo that does the eating on a bank the hero isn't at
+     * \param bank Mask of the cargo on the bank
+     * \returns Cargo that eats, -1 if the bank is safe */
+    int GetEater(int bank) const { return mEater[bank]; }
+
+    /** Does something get eaten?
+     * \param top Mask of the cargo on the top bank
+     * \param bottom Mask of the cargo on the bottom bank
+     * \param hero Bank the hero is at
+     * \returns True if cargo on a bank without the hero gets eaten */
+    bool IsEaten(int top, int bottom, Bank hero) const
+    {
+        return (hero != Top && mEaten[top] >= 0) || (hero != Bottom && mEaten[bottom] >= 0);
+    }
+
+    /** Can the cargo all be carried across?
+     * \returns True if some trips get every cargo item to the top bank */
+    bool IsSolvable() const { return mSolvable; }
+
+    /** Get the fewest trips that get every cargo item from the bottom
+     * bank to the top, starting and ending with the hero at the bottom
+     * and top
+     * \returns Trips in order, empty if there is no cargo or no way across */
+    const std::vector<Trip>& GetTrips() const { return mTrips; }
+
+private:
+    void Solve();
+
+    /// Id of each cargo item
+    std::vector<std::wstring> mIds;
+
+    /// Mask of the cargo each cargo item eats
+    std::vector<int> mEats;
+
+    /// Cargo eaten on an unattended bank, by mask of the cargo on it
+    std::vector<signed char> mEaten;
+
+    /// Cargo that eats on an unattended bank, by mask of the cargo on it
+    std::vector<signed char> mEater;
+
+    /// True if the cargo can all be carried across
+    bool mSolvable = false;
+
+    /// Fewest trips that carry the cargo across
+    std::vector<Trip> mTrips;
+};
+
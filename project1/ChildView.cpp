@@ -8,6 +8,19 @@
 #include "ChildView.h"
 #include "DoubleBufferDC.h"
 #include "Level.h"
+#include "RenderBenchmark.h"
+#include "Simulation.h"
+#include "Solver.h"
+#include "JobBenchmark.h"
+#include "BatchEnv.h"
+#include "SessionHost.h"
+#include "StateEncoder.h"
+#include "DifficultyEstimator.h"
+#include "LevelTuner.h"
+#include "Endless.h"
+#include "TallLevel.h"
+#include "StressLevel.h"
+#include <chrono>
 
 
 using namespace std;
@@ -23,13 +36,14 @@ using namespace Gdiplus;
 /// Frame duration in milliseconds
 const int FrameDuration = 30;
 
-/// Maximum amount of time to allow for elapsed
-const double MaxElapsed = 0.050;
+/// Maximum amount of time to allow for elapsed. Car collisions are
+/// swept, so this only keeps a long stall from being one huge step.
+const double MaxElapsed = 0.250;
 
 /**
  * Constructor
  */
-CChildView::CChildView()
+CChildView::CChildView() : mSimThread(&mGame)
 {
 	srand((unsigned int)time(nullptr));
 }
@@ -51,6 +65,33 @@ BEGIN_MESSAGE_MAP(CChildView, CWnd)
 	ON_WM_TIMER()
 	ON_COMMAND(ID_CHEATMENU_ROADCHEAT, &CChildView::OnCheatmenuRoadcheat)
 	ON_COMMAND(ID_CHEATMENU_RIVERCHEAT, &CChildView::OnCheatmenuRivercheat)
+	ON_COMMAND(ID_VIEW_FRAMEBUFFER, &CChildView::OnViewFramebuffer)
+	ON_COMMAND(ID_VIEW_BILINEARFILTER, &CChildView::OnViewBilinearfilter)
+	ON_COMMAND(ID_VIEW_SOFTWARERASTERIZER, &CChildView::OnViewSoftwarerasterizer)
+	ON_COMMAND(ID_VIEW_PALETTIZEDSPRITES, &CChildView::OnViewPalettizedsprites)
+	ON_COMMAND(ID_TOOLS_RENDERBENCHMARK, &CChildView::OnToolsRenderbenchmark)
+	ON_COMMAND(ID_TOOLS_SAVEREPLAY, &CChildView::OnToolsSavereplay)
+	ON_COMMAND(ID_TOOLS_CHECKREPLAYS, &CChildView::OnToolsCheckreplays)
+	ON_COMMAND(ID_TOOLS_CHECKOCCUPANCY, &CChildView::OnToolsCheckoccupancy)
+	ON_COMMAND(ID_TOOLS_OCCUPANCYREPORT, &CChildView::OnToolsOccupancyreport)
+	ON_COMMAND(ID_TOOLS_SOLVELEVELS, &CChildView::OnToolsSolvelevels)
+	ON_COMMAND(ID_VIEW_PATHHINT, &CChildView::OnViewPathhint)
+	ON_COMMAND(ID_TOOLS_PATHHINTREPORT, &CChildView::OnToolsPathhintreport)
+	ON_COMMAND(ID_TOOLS_JOBBENCHMARK, &CChildView::OnToolsJobbenchmark)
+	ON_COMMAND(ID_VIEW_SINGLETHREADEDJOBS, &CChildView::OnViewSinglethreadedjobs)
+	ON_COMMAND(ID_VIEW_SIMULATIONTHREAD, &CChildView::OnViewSimulationthread)
+	ON_COMMAND(ID_TOOLS_THREADTIMINGREPORT, &CChildView::OnToolsThreadtimingreport)
+	ON_COMMAND(ID_TOOLS_BATCHENVBENCHMARK, &CChildView::OnToolsBatchenvbenchmark)
+	ON_COMMAND(ID_TOOLS_SESSIONHOSTBENCHMARK, &CChildView::OnToolsSessionhostbenchmark)
+	ON_COMMAND(ID_TOOLS_STATESTREAMBENCHMARK, &CChildView::OnToolsStatestreambenchmark)
+	ON_COMMAND(ID_TOOLS_DIFFICULTYESTIMATE, &CChildView::OnToolsDifficultyestimate)
+	ON_COMMAND(ID_TOOLS_TUNELEVELS, &CChildView::OnToolsTunelevels)
+	ON_COMMAND(ID_LEVELMENU_ENDLESSMODE, &CChildView::OnLevelmenuEndlessmode)
+	ON_UPDATE_COMMAND_UI(ID_LEVELMENU_ENDLESSMODE, &CChildView::OnUpdateLevelmenuEndlessmode)
+	ON_COMMAND(ID_TOOLS_ENDLESSSOAKBENCHMARK, &CChildView::OnToolsEndlesssoakbenchmark)
+	ON_COMMAND(ID_LEVELMENU_TALLLEVEL, &CChildView::OnLevelmenuTalllevel)
+	ON_COMMAND(ID_TOOLS_TALLLEVELBENCHMARK, &CChildView::OnToolsTalllevelbenchmark)
+	ON_COMMAND(ID_TOOLS_STRESSLEVELBENCHMARK, &CChildView::OnToolsStresslevelbenchmark)
 END_MESSAGE_MAP()
 
 
@@ -86,6 +127,16 @@ void CChildView::OnPaint()
 
 	CRect rect;
 	GetClientRect(&rect);
+
+	// The simulation thread updates the game, just draw its newest frame
+	if (mSimThread.IsRunning())
+	{
+		auto start = chrono::steady_clock::now();
+		const CRenderList* frame = mSimThread.Acquire();
+		mGame.Present(&graphics, rect.Width(), rect.Height(), frame != nullptr ? *frame : CRenderList());
+		mSimThread.PaintDone(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+		return;
+	}
 	
 	mGame.OnDraw(&graphics, rect.Width(), rect.Height());
 
@@ -104,15 +155,8 @@ void CChildView::OnPaint()
 		mLastTime = time.QuadPart;
 		mTimeFreq = double(freq.QuadPart);
 
-		wstring pathName = L".\\levels\\level";
 		// Loads levels 0-3 and adds them to levels vector
-		for (int i = 0; i < 4; i++)
-		{
-			wstring filename = pathName + to_wstring(i) + L".xml";
-			shared_ptr<CLevel> levelPtr = make_shared<CLevel>(&mGame);
-			levelPtr->Load(filename);
-			mGame.Add(levelPtr);
-		}
+		mGame.LoadLevels(L".\\levels\\", 4);
 		// Load level 0 from level vector
 		mGame.Load(1);
 		Invalidate();
@@ -127,12 +171,11 @@ void CChildView::OnPaint()
 	double elapsed = double(diff) / mTimeFreq;
 	mLastTime = time.QuadPart;
 
-	// Prevent tunnelling
+	// Break up long stalls
 	while (elapsed > MaxElapsed)
 	{
 		mGame.Update(MaxElapsed);
 		mGame.UpdateControlPanel(MaxElapsed);
-		//mGame.CollisionTest()
 
 		elapsed -= MaxElapsed;
 	}
@@ -143,6 +186,9 @@ void CChildView::OnPaint()
 		mGame.Update(elapsed);
 		mGame.UpdateControlPanel(elapsed);
 	}
+
+	// Plan the hint once a frame, however many updates there were
+	mGame.UpdatePathHint();
 }
 
 
@@ -167,21 +213,15 @@ BOOL CChildView::OnEraseBkgnd(CDC* pDC)
 void CChildView::OnLButtonDown(UINT nFlags, CPoint point)
 {
 	std::pair<double, double> coords = mGame.ScaleCoords(point.x, point.y);
+	if (mSimThread.IsRunning())
+	{
+		mSimThread.PostClick(coords.first, coords.second);
+		return;
+	}
 
 	mClickedCargo = mGame.HitTest(coords.first, coords.second);
 
-	if ((mClickedCargo != nullptr) && !mGame.GetReady())
-	{
-		if (mClickedCargo->GetCarryStatus())
-		{
-				mClickedCargo->Release();
-		}
-		else
-		{
-				mClickedCargo->PickUp();
-		}
-
-	}
+	mGame.ClickCargo(mClickedCargo);
 }
 
 
@@ -194,6 +234,12 @@ void CChildView::OnLButtonDown(UINT nFlags, CPoint point)
 void CChildView::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 {
 	// Move the hero
+	if (mSimThread.IsRunning())
+	{
+		mSimThread.PostKey(nChar);
+		return;
+	}
+
 	mGame.moveHero(nChar);
 
 }
@@ -203,7 +249,9 @@ void CChildView::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
  */
 void CChildView::OnLevelmenuLevel0()
 {
+	auto lock = LockGame();
 	mGame.Load(0);
+	mEndless = false;
 	Invalidate();
 }
 
@@ -213,7 +261,9 @@ void CChildView::OnLevelmenuLevel0()
 void CChildView::OnLevelmenuLevel1()
 {
 	// TODO: Add your command handler code here
+	auto lock = LockGame();
 	mGame.Load(1);
+	mEndless = false;
 	Invalidate();
 }
 
@@ -223,7 +273,9 @@ void CChildView::OnLevelmenuLevel1()
 void CChildView::OnLevelmenuLevel2()
 {
 	// TODO: Add your command handler code here
+	auto lock = LockGame();
 	mGame.Load(2);
+	mEndless = false;
 	Invalidate();
 }
 
@@ -233,7 +285,9 @@ void CChildView::OnLevelmenuLevel2()
 void CChildView::OnLevelmenuLevel3()
 {
 	// TODO: Add your command handler code here
+	auto lock = LockGame();
 	mGame.Load(3);
+	mEndless = false;
 	Invalidate();
 }
 
@@ -255,6 +309,7 @@ void CChildView::OnCheatmenuRoadcheat()
 {
 	CWnd* pParent = GetParent();
 	CMenu* pMenu = pParent->GetMenu();
+	auto lock = LockGame();
 
 	// IF the cheat is on
 	if (mGame.GetRoadCheatState())
@@ -280,6 +335,7 @@ void CChildView::OnCheatmenuRivercheat()
 
 	CWnd* pParent = GetParent();
 	CMenu* pMenu = pParent->GetMenu();
+	auto lock = LockGame();
 
 	// if the cheat is on
 	if (mGame.GetRiverCheatState())
@@ -295,3 +351,588 @@ void CChildView::OnCheatmenuRivercheat()
 		pMenu->CheckMenuItem(ID_CHEATMENU_RIVERCHEAT, MF_CHECKED);
 	}
 }
+
+
+/**
+ * Virtual framebuffer menu handler.
+ *
+ * Switches between drawing straight into the window with a
+ * transform and drawing at native size then scaling once.
+ */
+void CChildView::OnViewFramebuffer()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	bool enabled = !mGame.GetFrameBufferEnabled();
+	mGame.SetFrameBufferEnabled(enabled);
+	pMenu->CheckMenuItem(ID_VIEW_FRAMEBUFFER, enabled ? MF_CHECKED : MF_UNCHECKED);
+	Invalidate();
+}
+
+
+/**
+ * Bilinear filter menu handler.
+ *
+ * Chooses the filter the virtual framebuffer is scaled with.
+ */
+void CChildView::OnViewBilinearfilter()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	bool bilinear = mGame.GetFrameBufferFilter() != CFrameScaler::Bilinear;
+	mGame.SetFrameBufferFilter(bilinear ? CFrameScaler::Bilinear : CFrameScaler::Nearest);
+	pMenu->CheckMenuItem(ID_VIEW_BILINEARFILTER, bilinear ? MF_CHECKED : MF_UNCHECKED);
+	Invalidate();
+}
+
+
+/**
+ * Software rasterizer menu handler.
+ *
+ * Switches the virtual framebuffer between drawing with GDI+
+ * and rasterizing in bands on several threads.
+ */
+void CChildView::OnViewSoftwarerasterizer()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	bool enabled = !mGame.GetSoftwareRasterEnabled();
+	mGame.SetSoftwareRasterEnabled(enabled);
+	pMenu->CheckMenuItem(ID_VIEW_SOFTWARERASTERIZER, enabled ? MF_CHECKED : MF_UNCHECKED);
+	Invalidate();
+}
+
+
+/**
+ * Palettized sprites menu handler.
+ *
+ * Switches the software rasterizer between 32-bit sprites and
+ * 8-bit sprites that are expanded through a palette as they are drawn.
+ */
+void CChildView::OnViewPalettizedsprites()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	bool enabled = !mGame.GetPalettizedSprites();
+	mGame.SetPalettizedSprites(enabled);
+	pMenu->CheckMenuItem(ID_VIEW_PALETTIZEDSPRITES, enabled ? MF_CHECKED : MF_UNCHECKED);
+	Invalidate();
+}
+
+
+/**
+ * Render benchmark menu handler.
+ *
+ * Times the software rasterizer on every level, saves the
+ * report to render-benchmark.txt and shows it.
+ */
+void CChildView::OnToolsRenderbenchmark()
+{
+	{
+		CWaitCursor wait;
+		CRenderBenchmark benchmark(&mGame);
+		{
+			auto lock = LockGame();
+			benchmark.Run();
+		}
+		benchmark.Save(L"render-benchmark.txt");
+		AfxMessageBox(benchmark.GetReport().c_str());
+	}
+
+	// Don't count the time the benchmark took as game time
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	mLastTime = time.QuadPart;
+	Invalidate();
+}
+
+
+/**
+ * Save replay menu handler.
+ *
+ * Saves the inputs made on the current level so far.
+ */
+void CChildView::OnToolsSavereplay()
+{
+	CReplay replay;
+	{
+		auto lock = LockGame();
+		replay = mGame.GetReplay();
+	}
+
+	CFileDialog dlg(FALSE, L".xml", L"replay.xml", OFN_OVERWRITEPROMPT, L"Replay Files (*.xml)|*.xml|All Files (*.*)|*.*||");
+	if (dlg.DoModal() == IDOK)
+	{
+		replay.Save((LPCTSTR)dlg.GetPathName());
+	}
+
+	// Don't count the time the dialog was up as game time
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	mLastTime = time.QuadPart;
+}
+
+
+/**
+ * Check replays menu handler.
+ *
+ * Plays every replay in the replays directory a tick at a time
+ * and jumping between events, and shows whether they agree.
+ */
+void CChildView::OnToolsCheckreplays()
+{
+	{
+		// The games it plays share bitmaps with this one
+		CWaitCursor wait;
+		wstring report;
+		{
+			auto lock = LockGame();
+			report = CSimulation::CheckReplays(L".\\levels\\", L".\\replays\\");
+		}
+		AfxMessageBox(report.c_str());
+	}
+
+	// Don't count the time the check took as game time
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	mLastTime = time.QuadPart;
+	Invalidate();
+}
+
+
+/**
+ * Check occupancy tables menu handler.
+ *
+ * Switches on checking the lane occupancy tables against the
+ * vehicles and the car collision tests on every update.
+ */
+void CChildView::OnToolsCheckoccupancy()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	auto lock = LockGame();
+	bool enabled = !mGame.GetOccupancyCheck();
+	mGame.SetOccupancyCheck(enabled);
+	pMenu->CheckMenuItem(ID_TOOLS_CHECKOCCUPANCY, enabled ? MF_CHECKED : MF_UNCHECKED);
+}
+
+
+/**
+ * Occupancy report menu handler.
+ *
+ * Shows the size of each level's occupancy tables and
+ * how the checks of them have gone.
+ */
+void CChildView::OnToolsOccupancyreport()
+{
+	wstring report;
+	{
+		auto lock = LockGame();
+		report = mGame.GetOccupancyReport();
+	}
+	AfxMessageBox(report.c_str());
+
+	// Don't count the time the report was up as game time
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	mLastTime = time.QuadPart;
+}
+
+
+/**
+ * Solve levels menu handler.
+ *
+ * Finds the quickest win of every level, saves each one to the
+ * temporary directory and shows how long they take. The game's
+ * own replays are left alone.
+ */
+void CChildView::OnToolsSolvelevels()
+{
+	{
+		CWaitCursor wait;
+		wchar_t temp[MAX_PATH];
+		GetTempPath(MAX_PATH, temp);
+		wstring report;
+		{
+			auto lock = LockGame();
+			report = CSolver::SolveLevels(L".\\levels\\", temp);
+		}
+		AfxMessageBox(report.c_str());
+	}
+
+	// Don't count the time the solver took as game time
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	mLastTime = time.QuadPart;
+	Invalidate();
+}
+
+
+/**
+ * Safe path hint menu handler.
+ *
+ * Switches on planning a safe way across the lanes from wherever
+ * the hero is and drawing it over the level.
+ */
+void CChildView::OnViewPathhint()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	auto lock = LockGame();
+	bool enabled = !mGame.GetPathHintEnabled();
+	mGame.SetPathHintEnabled(enabled);
+	pMenu->CheckMenuItem(ID_VIEW_PATHHINT, mGame.GetPathHintEnabled() ? MF_CHECKED : MF_UNCHECKED);
+	Invalidate();
+}
+
+
+/**
+ * Path hint report menu handler.
+ *
+ * Shows how long the safe path hint has been taking to plan.
+ */
+void CChildView::OnToolsPathhintreport()
+{
+	wstring report = L"The safe path hint is off.";
+	{
+		auto lock = LockGame();
+		auto hint = mGame.GetPathHint();
+		if (hint != nullptr)
+		{
+			report = hint->GetReport();
+		}
+	}
+	AfxMessageBox(report.c_str());
+
+	// Don't count the time the report was up as game time
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	mLastTime = time.QuadPart;
+}
+
+
+/**
+ * Job benchmark menu handler.
+ *
+ * Times the thread pool's tasks, saves the report to
+ * job-benchmark.txt and shows it.
+ */
+void CChildView::OnToolsJobbenchmark()
+{
+	{
+		CWaitCursor wait;
+		CJobBenchmark benchmark;
+		benchmark.Run();
+		benchmark.Save(L"job-benchmark.txt");
+		AfxMessageBox(benchmark.GetReport().c_str());
+	}
+
+	// Don't count the time the benchmark took as game time
+	LARGE_INTEGER time;
+	QueryPerformanceCounter(&time);
+	mLastTime = time.QuadPart;
+	Invalidate();
+}
+
+
+/**
+ * Single threaded jobs menu handler.
+ *
+ * Leaves the shared thread pool's workers idle, so loading, the
+ * solver and rendering run their tasks in the same order every time.
+ */
+void CChildView::OnViewSinglethreadedjobs()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	auto pool = CThreadPool::GetShared();
+	bool single = !pool->GetSingleThreaded();
+	pool->SetSingleThreaded(single);
+	pMenu->CheckMenuItem(ID_VIEW_SINGLETHREADEDJOBS, single ? MF_CHECKED : MF_UNCHECKED);
+	Invalidate();
+}
+
+
+/**
+ * Simulation thread menu handler.
+ *
+ * Switches between updating the game in OnPaint and updating it on
+ * a thread of its own that hands finished frames to OnPaint.
+ */
+void CChildView::OnViewSimulationthread()
+{
+	CWnd* pParent = GetParent();
+	CMenu* pMenu = pParent->GetMenu();
+
+	if (mSimThread.IsRunning())
+	{
+		mSimThread.Stop();
+
+		// Pick the time up from here
+		LARGE_INTEGER time;
+		QueryPerformanceCounter(&time);
+		mLastTime = time.QuadPart;
+	}
+	else
+	{
+		mSimThread.Start();
+	}
+
+	pMenu->CheckMenuItem(ID_VIEW_SIMULATIONTHREAD, mSimThread.IsRunning() ? MF_CHECKED : MF_UNCHECKED);
+	Invalidate();
+}
+
+
+/**
+ * Thread timing report menu handler.
+ *
+ * Shows how steady the simulation thread's ticks are and how
+ * long its frames take to be painted.
+ */
+void CChildView::OnToolsThreadtimingreport()
+{
+	AfxMessageBox(mSimThread.IsRunning() ? mSimThread.GetReport().c_str() : L"The simulation thread is off.");
+}
+
+
+/**
+ * Pause the simulation thread, if it is running, so a handler can use the game
+ * \returns Lock that holds the game until it goes out of scope
+ */
+std::unique_lock<std::mutex> CChildView::LockGame()
+{
+	return mSimThread.IsRunning() ? mSimThread.Lock() : std::unique_lock<std::mutex>();
+}
+
+
+/**
+ * Batch environment benchmark menu handler.
+ *
+ * Plays many copies of every level at once with random actions
+ * and reports how many steps a second they make.
+ */
+void CChildView::OnToolsBatchenvbenchmark()
+{
+	CWaitCursor wait;
+	wstring report;
+	{
+		// The game it makes templates from shares bitmaps with this one
+		auto lock = LockGame();
+		report = CBatchEnv::Benchmark(L".\\levels\\");
+	}
+	AfxMessageBox(report.c_str());
+}
+
+
+/**
+ * Session host benchmark menu handler.
+ *
+ * Hosts thousands of sessions making random inputs and
+ * reports how long each tick takes.
+ */
+void CChildView::OnToolsSessionhostbenchmark()
+{
+	CWaitCursor wait;
+	wstring report;
+	{
+		// The game it makes templates from shares bitmaps with this one
+		auto lock = LockGame();
+		report = CSessionHost::Benchmark(L".\\levels\\");
+	}
+	AfxMessageBox(report.c_str());
+}
+
+
+/**
+ * State stream benchmark menu handler.
+ *
+ * Streams the recorded replays as a keyframe and diffs and
+ * reports how many bytes that takes.
+ */
+void CChildView::OnToolsStatestreambenchmark()
+{
+	CWaitCursor wait;
+	wstring report;
+	{
+		// The game it makes templates from shares bitmaps with this one
+		auto lock = LockGame();
+		report = CStateEncoder::Benchmark(L".\\levels\\", L".\\replays\\");
+	}
+	AfxMessageBox(report.c_str());
+}
+
+
+/**
+ * Level difficulty estimate menu handler.
+ *
+ * Plays every level many times with imperfect agents and
+ * reports how often they win and where they lose.
+ */
+void CChildView::OnToolsDifficultyestimate()
+{
+	CWaitCursor wait;
+	wstring report;
+	{
+		// The game it makes templates from shares bitmaps with this one
+		auto lock = LockGame();
+		report = CDifficultyEstimator::EstimateLevels(L".\\levels\\");
+	}
+	AfxMessageBox(report.c_str());
+}
+
+
+/**
+ * Tune levels menu handler.
+ *
+ * Searches for lanes that make each level as hard as a
+ * target and writes the tuned levels to the temporary directory.
+ */
+void CChildView::OnToolsTunelevels()
+{
+	CWaitCursor wait;
+	wchar_t temp[MAX_PATH];
+	GetTempPath(MAX_PATH, temp);
+	wstring report;
+	{
+		// The games it loads candidates into share bitmaps with this one
+		auto lock = LockGame();
+		report = CLevelTuner::TuneLevels(L".\\levels\\", temp);
+	}
+	AfxMessageBox(report.c_str());
+}
+
+
+/**
+ * Endless mode menu handler.
+ *
+ * Starts endless lanes made from a new seed with the last
+ * level's vehicles, or goes back to that level.
+ */
+void CChildView::OnLevelmenuEndlessmode()
+{
+	mEndless = !mEndless;
+	{
+		auto lock = LockGame();
+		mGame.SetEndless(mEndless, (unsigned)rand());
+	}
+	Invalidate();
+}
+
+
+/**
+ * Check the endless mode menu item when endless mode is on.
+ * The flag is kept here so the menu never waits on the game;
+ * the level menu handlers clear it, since loading a level
+ * turns endless mode off
+ * \param pCmdUI Menu item to update
+ */
+void CChildView::OnUpdateLevelmenuEndlessmode(CCmdUI* pCmdUI)
+{
+	pCmdUI->SetCheck(mEndless);
+}
+
+
+/**
+ * Endless soak benchmark menu handler.
+ *
+ * Runs endless mode headless for hours of game time and reports
+ * if the memory and time a tick takes stay flat.
+ */
+void CChildView::OnToolsEndlesssoakbenchmark()
+{
+	CWaitCursor wait;
+	wstring report;
+	{
+		// The game it plays shares bitmaps with this one
+		auto lock = LockGame();
+		report = CEndless::Soak(L".\\levels\\", 4);
+	}
+	AfxMessageBox(report.c_str());
+}
+
+
+/**
+ * Tall level menu handler.
+ *
+ * Makes a level many screens tall out of level 3 the first time,
+ * adds it after the other levels and loads it. The level is only
+ * made in memory.
+ */
+void CChildView::OnLevelmenuTalllevel()
+{
+	CWaitCursor wait;
+	bool made = true;
+	{
+		auto lock = LockGame();
+		if (mGame.GetLevelCount() == 4)
+		{
+			auto root = CTallLevel::Make(L".\\levels\\level3.xml", CTallLevel::BenchmarkRows);
+			if (root != nullptr)
+			{
+				auto level = make_shared<CLevel>(&mGame);
+				level->Load(root);
+				mGame.Add(level);
+			}
+			made = root != nullptr;
+		}
+
+		if (made)
+		{
+			mGame.Load(4);
+			mEndless = false;
+		}
+	}
+
+	if (!made)
+	{
+		AfxMessageBox(L"Could not make the tall level");
+		return;
+	}
+
+	Invalidate();
+}
+
+
+/**
+ * Tall level benchmark menu handler.
+ *
+ * Compares the time a frame takes on level 3 and on a level
+ * made from it that is many screens tall.
+ */
+void CChildView::OnToolsTalllevelbenchmark()
+{
+	CWaitCursor wait;
+	wstring report;
+	{
+		// The game it plays shares bitmaps with this one
+		auto lock = LockGame();
+		report = CTallLevel::Benchmark(L".\\levels\\");
+	}
+	AfxMessageBox(report.c_str());
+}
+
+
+/**
+ * Stress level benchmark menu handler.
+ *
+ * Measures how loading, updating, collision testing and drawing
+ * grow on generated levels from a hundred items to a million.
+ */
+void CChildView::OnToolsStresslevelbenchmark()
+{
+	CWaitCursor wait;
+	wstring report;
+	{
+		// The game it plays shares bitmaps with this one
+		auto lock = LockGame();
+		report = CStressLevel::Benchmark();
+	}
+	AfxMessageBox(report.c_str());
+}
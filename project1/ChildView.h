@@ -7,6 +7,7 @@
 
 #include "Game.h"
 #include "Item.h"
+#include "SimThread.h"
 
 
 #include <memory>
@@ -43,9 +44,19 @@ private:
 	/// True until the first time we draw
 	bool mFirstDraw = true;
 
+	/// True while endless mode is on, so the menu can show it
+	/// without waiting on the game
+	bool mEndless = false;
+
 	long long mLastTime = 0;	///< Last time we read the timer
 	double mTimeFreq = 0;		///< Rate the timer updates
 
+	/// Runs the game on a thread of its own when switched on.
+	/// Declared after the game so it stops before the game goes.
+	CSimThread mSimThread;
+
+	std::unique_lock<std::mutex> LockGame();
+
 // Generated message map functions
 protected:
 	afx_msg void OnPaint();
@@ -63,5 +74,32 @@ public:
 	afx_msg void OnTimer(UINT_PTR nIDEvent);
 	afx_msg void OnCheatmenuRoadcheat();
 	afx_msg void OnCheatmenuRivercheat();
+	afx_msg void OnViewFramebuffer();
+	afx_msg void OnViewBilinearfilter();
+	afx_msg void OnViewSoftwarerasterizer();
+	afx_msg void OnViewPalettizedsprites();
+	afx_msg void OnToolsRenderbenchmark();
+	afx_msg void OnToolsSavereplay();
+	afx_msg void OnToolsCheckreplays();
+	afx_msg void OnToolsCheckoccupancy();
+	afx_msg void OnToolsOccupancyreport();
+	afx_msg void OnToolsSolvelevels();
+	afx_msg void OnViewPathhint();
+	afx_msg void OnToolsPathhintreport();
+	afx_msg void OnToolsJobbenchmark();
+	afx_msg void OnViewSinglethreadedjobs();
+	afx_msg void OnViewSimulationthread();
+	afx_msg void OnToolsThreadtimingreport();
+	afx_msg void OnToolsBatchenvbenchmark();
+	afx_msg void OnToolsSessionhostbenchmark();
+	afx_msg void OnToolsStatestreambenchmark();
+	afx_msg void OnToolsDifficultyestimate();
+	afx_msg void OnToolsTunelevels();
+	afx_msg void OnLevelmenuEndlessmode();
+	afx_msg void OnUpdateLevelmenuEndlessmode(CCmdUI* pCmdUI);
+	afx_msg void OnToolsEndlesssoakbenchmark();
+	afx_msg void OnLevelmenuTalllevel();
+	afx_msg void OnToolsTalllevelbenchmark();
+	afx_msg void OnToolsStresslevelbenchmark();
 };
 
@@ -0,0 +1,301 @@
+/**
+ * \file CollisionMask.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "CollisionMask.h"
+#include <emmintrin.h>
+#include <intrin.h>
+#include <climits>
+
+using namespace Gdiplus;
+using namespace std;
+
+/// Alpha at which a pixel counts as solid
+const UINT32 SolidAlpha = 128;
+
+std::map<Gdiplus::Bitmap*, std::weak_ptr<CCollisionMask>> CCollisionMask::mMasks;
+
+
+/**
+ * Constructor, makes an empty mask
+ * \param width Width in pixels
+ * \param height Height in pixels
+ */
+CCollisionMask::CCollisionMask(int width, int height) : mWidth(width), mHeight(height)
+{
+    mWords = ((width + 127) / 128) * 2;
+    mBits.assign((size_t)mWords * height, 0);
+}
+
+
+/**
+ * Get the mask of a bitmap, making it from the alpha channel the first time
+ * \param bitmap Bitmap to get the mask of
+ * \returns Mask, or null if the bitmap's pixels could not be read
+ */
+std::shared_ptr<CCollisionMask> CCollisionMask::Get(Gdiplus::Bitmap* bitmap)
+{
+    if (bitmap == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto mask = mMasks[bitmap].lock();
+    if (mask != nullptr)
+    {
+        return mask;
+    }
+
+    int width = (int)bitmap->GetWidth();
+    int height = (int)bitmap->GetHeight();
+
+    Rect rect(0, 0, width, height);
+    BitmapData data;
+    if (width == 0 || height == 0 ||
+        bitmap->LockBits(&rect, ImageLockModeRead, PixelFormat32bppARGB, &data) != Ok)
+    {
+        return nullptr;
+    }
+
+    mask = make_shared<CCollisionMask>(width, height);
+    for (int y = 0; y < height; y++)
+    {
+        const UINT32* row = (const UINT32*)((unsigned char*)data.Scan0 + (size_t)y * data.Stride);
+        for (int x = 0; x < width; x++)
+        {
+            mask->Set(x, y, (row[x] >> 24) >= SolidAlpha);
+        }
+    }
+
+    bitmap->UnlockBits(&data);
+
+    mMasks[bitmap] = mask;
+    return mask;
+}
+
+
+/**
+ * Set if a pixel is solid
+ * \param x X of the pixel
+ * \param y Y of the pixel
+ * \param solid True if the pixel is solid
+ */
+void CCollisionMask::Set(int x, int y, bool solid)
+{
+    uint64_t& word = mBits[(size_t)y * mWords + x / 64];
+    uint64_t bit = (uint64_t)1 << (x % 64);
+    word = solid ? (word | bit) : (word & ~bit);
+}
+
+
+/**
+ * Test if a pixel is solid
+ * \param x X of the pixel
+ * \param y Y of the pixel
+ * \returns True if the pixel is inside the mask and solid
+ */
+bool CCollisionMask::Test(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= mWidth || y >= mHeight)
+    {
+        return false;
+    }
+
+    return (GetRow(y)[x / 64] >> (x % 64)) & 1;
+}
+
+
+/**
+ * Get 64 bits of a row starting at any pixel.
+ *
+ * Pixels outside the row are clear.
+ *
+ * \param row Row to get the bits of
+ * \param x Pixel the bits start at, may be negative
+ * \returns Bits for pixels x to x + 63
+ */
+uint64_t CCollisionMask::Extract(const uint64_t* row, int x) const
+{
+    if (x <= -64 || x >= mWords * 64)
+    {
+        return 0;
+    }
+
+    // Floor division, so negative x lands in the word before the row
+    int word = x >= 0 ? x / 64 : -((-x + 63) / 64);
+    int shift = x - word * 64;
+
+    uint64_t low = word >= 0 ? row[word] : 0;
+    if (shift == 0)
+    {
+        return low;
+    }
+
+    uint64_t high = word + 1 < mWords ? row[word + 1] : 0;
+    return (low >> shift) | (high << (64 - shift));
+}
+
+
+/**
+ * Test if any solid pixels of two masks overlap.
+ *
+ * Each row of the other mask is shifted to line up with ours and
+ * ANDed with it 128 bits at a time.
+ *
+ * \param other The other mask
+ * \param dx X of the other mask's left edge relative to ours
+ * \param dy Y of the other mask's top edge relative to ours
+ * \returns True if a solid pixel of each mask is in the same place
+ */
+bool CCollisionMask::Overlaps(const CCollisionMask& other, int dx, int dy) const
+{
+    int top = max(0, dy);
+    int bottom = min(mHeight, dy + other.mHeight);
+    int left = max(0, dx);
+    int right = min(mWidth, dx + other.mWidth);
+    if (top >= bottom || left >= right)
+    {
+        return false;
+    }
+
+    // Only the blocks of our row the other mask covers
+    int firstBlock = left / 128;
+    int lastBlock = (right - 1) / 128;
+
+    for (int y = top; y < bottom; y++)
+    {
+        const uint64_t* ours = GetRow(y);
+        const uint64_t* theirs = other.GetRow(y - dy);
+
+        for (int block = firstBlock; block <= lastBlock; block++)
+        {
+            int x = block * 128;
+            __m128i a = _mm_loadu_si128((const __m128i*)(ours + block * 2));
+            __m128i b = _mm_set_epi64x((long long)other.Extract(theirs, x + 64 - dx),
+                (long long)other.Extract(theirs, x - dx));
+            __m128i both = _mm_and_si128(a, b);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(both, _mm_setzero_si128())) != 0xffff)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * Get the first and last solid pixels of a row
+ * \param y Row to look at
+ * \param first Set to the X of the first solid pixel
+ * \param last Set to the X of the last solid pixel
+ * \returns False if the row has no solid pixels
+ */
+bool CCollisionMask::GetExtent(int y, int& first, int& last) const
+{
+    const uint64_t* row = GetRow(y);
+    int low = 0;
+    while (low < mWords && row[low] == 0)
+    {
+        low++;
+    }
+
+    if (low == mWords)
+    {
+        return false;
+    }
+
+    int high = mWords - 1;
+    while (row[high] == 0)
+    {
+        high--;
+    }
+
+    unsigned long bit;
+    _BitScanForward64(&bit, row[low]);
+    first = low * 64 + (int)bit;
+    _BitScanReverse64(&bit, row[high]);
+    last = high * 64 + (int)bit;
+    return true;
+}
+
+
+/**
+ * Test if the other mask touches this one anywhere along a horizontal move.
+ *
+ * The other mask is at every whole pixel offset from firstDx to
+ * lastDx in turn. The offsets where the solid part of a row of
+ * each mask could meet follow from where the rows start and end,
+ * so those are worked out first. If there are any, the other mask
+ * is smeared across them, a row at a time by doubling shifts, and
+ * tested against this one once. Neither step depends on how far
+ * apart firstDx and lastDx are, only on the size of the masks.
+ *
+ * \param other The other mask
+ * \param firstDx Smallest X of the other mask's left edge relative to ours
+ * \param lastDx Largest X of the other mask's left edge relative to ours
+ * \param dy Y of the other mask's top edge relative to ours
+ * \returns True if a solid pixel of each mask is in the same place at any offset
+ */
+bool CCollisionMask::SweptOverlaps(const CCollisionMask& other, int firstDx, int lastDx, int dy) const
+{
+    int top = max(0, dy);
+    int bottom = min(mHeight, dy + other.mHeight);
+
+    // The offsets at which the solid spans of some pair of rows meet
+    int lo = INT_MAX;
+    int hi = INT_MIN;
+    for (int y = top; y < bottom; y++)
+    {
+        int ourFirst, ourLast, theirFirst, theirLast;
+        if (GetExtent(y, ourFirst, ourLast) && other.GetExtent(y - dy, theirFirst, theirLast))
+        {
+            int from = max(ourFirst - theirLast, firstDx);
+            int to = min(ourLast - theirFirst, lastDx);
+            if (from <= to)
+            {
+                lo = min(lo, from);
+                hi = max(hi, to);
+            }
+        }
+    }
+
+    if (lo > hi)
+    {
+        return false;
+    }
+
+    // The other mask at every offset from lo to hi at once
+    int spread = hi - lo;
+    CCollisionMask swept(other.mWidth + spread, other.mHeight);
+    int words = other.mWords;
+    for (int y = 0; y < other.mHeight; y++)
+    {
+        uint64_t* row = swept.GetRow(y);
+        copy(other.GetRow(y), other.GetRow(y) + words, row);
+
+        // Each pass doubles how far the row is smeared
+        for (int covered = 1; covered <= spread; )
+        {
+            int step = min(covered, spread + 1 - covered);
+            int wordStep = step / 64;
+            int bitStep = step % 64;
+            for (int word = swept.mWords - 1; word >= wordStep; word--)
+            {
+                uint64_t moved = row[word - wordStep] << bitStep;
+                if (bitStep != 0 && word - wordStep > 0)
+                {
+                    moved |= row[word - wordStep - 1] >> (64 - bitStep);
+                }
+                row[word] |= moved;
+            }
+            covered += step;
+        }
+    }
+
+    return Overlaps(swept, lo, dy);
+}
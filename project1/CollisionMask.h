@@ -0,0 +1,85 @@
+/**
+ * \file CollisionMask.h
+ *
+ * \author Michael Dittman
+ *
+ * Which pixels of an image are solid, packed one bit per pixel.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+
+/**
+ * Which pixels of an image are solid, packed one bit per pixel.
+ *
+ * A pixel is solid when it is at least half opaque. Each row is
+ * stored as 64-bit words, bit 0 of the first word being the left
+ * pixel, and padded to a whole number of 128-bit blocks so two
+ * masks can be ANDed a block at a time with SSE2.
+ */
+class CCollisionMask
+{
+public:
+    /// Default constructor (disabled)
+    CCollisionMask() = delete;
+
+    /// Copy constructor (disabled)
+    CCollisionMask(const CCollisionMask&) = delete;
+
+    CCollisionMask(int width, int height);
+
+    static std::shared_ptr<CCollisionMask> Get(Gdiplus::Bitmap* bitmap);
+
+    /** Get the width
+     * \returns Width in pixels */
+    int GetWidth() const { return mWidth; }
+
+    /** Get the height
+     * \returns Height in pixels */
+    int GetHeight() const { return mHeight; }
+
+    void Set(int x, int y, bool solid);
+
+    bool Test(int x, int y) const;
+
+    bool Overlaps(const CCollisionMask& other, int dx, int dy) const;
+
+    bool SweptOverlaps(const CCollisionMask& other, int firstDx, int lastDx, int dy) const;
+
+    bool GetExtent(int y, int& first, int& last) const;
+
+private:
+    /** Get the words of a row
+     * \param y Row to get
+     * \returns First word of the row */
+    const uint64_t* GetRow(int y) const { return mBits.data() + (size_t)y * mWords; }
+
+    /** Get the words of a row to change
+     * \param y Row to get
+     * \returns First word of the row */
+    uint64_t* GetRow(int y) { return mBits.data() + (size_t)y * mWords; }
+
+    uint64_t Extract(const uint64_t* row, int x) const;
+
+    /// Width in pixels
+    int mWidth;
+
+    /// Height in pixels
+    int mHeight;
+
+    /// 64-bit words per row, always even
+    int mWords;
+
+    /// The bits, row after row
+    std::vector<uint64_t> mBits;
+
+    /// Masks already made, by bitmap. Weak so the items using
+    /// a mask decide when it is freed.
+    static std::map<Gdiplus::Bitmap*, std::weak_ptr<CCollisionMask>> mMasks;
+};
+
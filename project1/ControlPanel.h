@@ -9,6 +9,7 @@
 #pragma once
 
 #include "Game.h"
+#include "TextCache.h"
 
 class CGame;
 
@@ -17,6 +18,9 @@ class CControlPanel
 {
 public: 
 
+	/// Seconds of get ready before the timer starts
+	const static int ReadyTime = 3;
+
 	/// Default constructor (disabled)
 	CControlPanel() = delete;
 
@@ -26,7 +30,7 @@ public:
 	CControlPanel(CGame* game);
 
 	//Function that will draw our timer, and other control panel graphics
-	virtual void Draw(Gdiplus::Graphics* graphics);
+	virtual void Draw(CRenderList* list);
 
 	//Function to constantly update timer
 	void Update(double elapsed);
@@ -46,12 +50,20 @@ public:
 
 	void Clear();
 
+	void Restart();
+
 	/**
 	* Return the time on the timer
 	* \return mTimerTime The time on the timer
 	*/
 	double GetTimerTime() { return mTimerTime; }
 
+	/**
+	* Return the time since the level was loaded, including the get ready time
+	* \return Time in seconds
+	*/
+	double GetTime() const { return mTime; }
+
 	/**
 	* Set the time on the timer
 	* \param time Time to set timer time to
@@ -110,6 +122,9 @@ private:
 	/// The vehicle that hit sparty
 	std::wstring mSpartyCar = L"Vehicle";
 
+	/// Fonts and laid out strings the panel draws with
+	CTextCache mText;
+
 
 
 
@@ -46,9 +46,9 @@ CDecor::CDecor(const CDecor& decor) : CItem(decor)
 /**
  * Draws a decor object onto the screen
  *
- * \param graphics Graphics device to draw on
+ * \param list Render list to record the drawing into
  */
-void CDecor::Draw(Gdiplus::Graphics* graphics)
+void CDecor::Draw(CRenderList* list)
 {
 	Gdiplus::Bitmap* itemImage = this->GetImage();
 	double wid = itemImage->GetWidth();
@@ -62,7 +62,7 @@ void CDecor::Draw(Gdiplus::Graphics* graphics)
 			// POSSIBLY TEMPORARY
 			// Multiplies coordinates by 64 until we have a concrete virtual pixel solution
 			// EDIT: Ethan - moved conversion of mX and mY to pixels into CItem XmlLoad()
-			graphics->DrawImage(itemImage,
+			list->DrawImage(itemImage,
 				float(GetX() + x * TileToPixels), float(GetY() + y * TileToPixels),
 				(float)itemImage->GetWidth() + 1, (float)itemImage->GetHeight() + 1);
 		}
@@ -91,29 +91,37 @@ void CDecor::XmlLoad(const std::shared_ptr<xmlnode::CXmlNode>& node)
 
 /**
  * Hittest for decor tile
- * \param x 
- * \param y 
- * \returns 
+ * \param x X location in virtual pixels
+ * \param y Y location in virtual pixels
+ * \returns True if the point is on one of the repeated tiles
  */
 bool CDecor::HitTest(double x, double y)
 {
 
-    //double wid = GetImage()->GetWidth();
+    double wid = GetImage()->GetWidth() * (double)GetRepeatX();
     double hit = GetImage()->GetHeight() * (double)GetRepeatY();
 
-    // Make x and y relative to the top-left corner of the bitmap image.
-    // Subtracting the center makes x, y relative to the center of
-    // the image. Adding half the size makes x, y relative to the top
-    // corner of the image.
-    //double testX = x - GetX() + wid / 2;
+    // Decor is positioned by its top-left corner
+    double testX = x - GetX();
     double testY = y - GetY();
 
     // Test to see if x, y are in the image
-    if (testY < 0 || testY >= hit)
+    if (testX < 0 || testY < 0 || testX >= wid || testY >= hit)
     {
         // We are outside the image
         return false;
     }
     else return true;
 
+}
+
+
+/**
+ * Get the part of the level the decor is drawn over, top to bottom.
+ * Decor is positioned by its top-left corner and repeats down.
+ * \returns Top and bottom Y in virtual pixels
+ */
+std::pair<double, double> CDecor::GetVerticalExtent() const
+{
+    return std::make_pair(GetY(), GetY() + GetImage()->GetHeight() * (double)mRepeatY);
 }
\ No newline at end of file
@@ -29,17 +29,19 @@ public:
 
 	/** Gets repeat in x direction
 	* \returns how many times to repeat in x direction */
-	int GetRepeatX() { return mRepeatX; }
+	int GetRepeatX() const { return mRepeatX; }
 
 	/** Gets repeat in y direction
 	 * \returns how many times to repeat in y direction */
-	int GetRepeatY() { return mRepeatY; }
+	int GetRepeatY() const { return mRepeatY; }
 
 	virtual void XmlLoad(const std::shared_ptr<xmlnode::CXmlNode>& node);
 
 	bool HitTest(double x, double y);
 
-	virtual void Draw(Gdiplus::Graphics* graphics);
+	virtual std::pair<double, double> GetVerticalExtent() const override;
+
+	virtual void Draw(CRenderList* list);
 
 	/** Accept a visitor
 	 * \param visitor The visitor we accept */
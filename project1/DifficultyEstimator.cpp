@@ -0,0 +1,523 @@
+/**
+ * \file DifficultyEstimator.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "DifficultyEstimator.h"
+#include "ThreadPool.h"
+#include "Game.h"
+#include <cmath>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+/// Width of a tile in virtual pixels
+const double TileToPixels = 64;
+
+/// Plays made in a batch with one stream of random numbers
+const int PlaysPerBatch = 256;
+
+/// Number of CRuleTable::Loss values a play can be lost with
+const int LossCount = CRuleTable::OutOfBounds + 1;
+
+/// Plays EstimateLevels makes of each level with each agent
+const int PlaysPerLevel = 100000;
+
+/// Level time in seconds EstimateLevels plays run out of time at
+const double EstimateLimit = 180;
+
+/// Steps an agent looks ahead for a way to stay alive
+const int LookAhead = 40;
+
+/// Heat map shades, from no losses on a tile to the most
+const wchar_t Shades[] = L" .:-=+*#%@";
+
+
+/**
+ * Constructor. Makes a template of the level the game has loaded.
+ * \param game Game with the level loaded
+ * \param limit Level time in seconds plays run out of time at
+ */
+CDifficultyEstimator::CDifficultyEstimator(CGame* game, double limit) : mPool(CThreadPool::GetShared())
+{
+    mLevel = make_unique<CLevelTemplate>(game, limit);
+
+    auto puzzle = game->GetCargoPuzzle();
+    if (puzzle != nullptr)
+    {
+        mTrips = puzzle->GetTrips();
+    }
+}
+
+
+/**
+ * Play the level many times with an agent
+ * \param agent How the agent plays
+ * \param plays Number of plays
+ * \param seed Seed of the random numbers, the same seed makes the same estimate
+ * \returns What the plays came to
+ */
+CDifficultyEstimator::Estimate CDifficultyEstimator::Run(const Agent& agent, int plays, unsigned seed) const
+{
+    Steps steps;
+    steps.mReaction = max(0, (int)lround(agent.mReaction / CLaneModel::StepTime));
+    steps.mCadence = max(1, (int)lround(agent.mCadence / CLaneModel::StepTime));
+    steps.mErrorRate = agent.mErrorRate;
+
+    Estimate empty;
+    empty.mLosses.assign(LossCount, 0);
+    empty.mColumns = (int)(mLevel->GetMaxX() / TileToPixels) + 1;
+    empty.mDeaths.assign(CLaneModel::Rows * empty.mColumns, 0);
+
+    int batches = (plays + PlaysPerBatch - 1) / PlaysPerBatch;
+    vector<Estimate> found(batches, empty);
+    mPool->ParallelFor(0, batches, 1, [&](int begin, int end)
+        {
+            for (int batch = begin; batch < end; batch++)
+            {
+                seed_seq sequence{ seed, (unsigned)batch };
+                mt19937 random(sequence);
+                Known known;
+
+                int count = min(PlaysPerBatch, plays - batch * PlaysPerBatch);
+                for (int i = 0; i < count; i++)
+                {
+                    Play(steps, random, known, found[batch]);
+                }
+            }
+        });
+
+    Estimate estimate = empty;
+    for (auto& batch : found)
+    {
+        estimate.mPlays += batch.mPlays;
+        estimate.mWins += batch.mWins;
+        estimate.mTimedOut += batch.mTimedOut;
+        for (int loss = 0; loss < LossCount; loss++)
+        {
+            estimate.mLosses[loss] += batch.mLosses[loss];
+        }
+        for (size_t cell = 0; cell < estimate.mDeaths.size(); cell++)
+        {
+            estimate.mDeaths[cell] += batch.mDeaths[cell];
+        }
+        estimate.mTimes.insert(estimate.mTimes.end(), batch.mTimes.begin(), batch.mTimes.end());
+    }
+
+    sort(estimate.mTimes.begin(), estimate.mTimes.end());
+    return estimate;
+}
+
+
+/**
+ * Play the level once
+ * \param agent How the agent plays, in steps
+ * \param random Random numbers of the batch the play is in
+ * \param known What CanLast found in this batch of plays
+ * \param estimate Estimate to add the play to
+ */
+void CDifficultyEstimator::Play(const Steps& agent, std::mt19937& random, Known& known, Estimate& estimate) const
+{
+    estimate.mPlays++;
+
+    unsigned errors = (unsigned)(agent.mErrorRate * 4294967295.0);
+    CLevelTemplate::State state = mLevel->GetStart();
+    int trip = 0;
+    int next = state.mStep;
+    int meant = CLevelTemplate::Wait;
+    int lands = -1;
+    for (;;)
+    {
+        if (lands < 0 && state.mStep >= next)
+        {
+            meant = Choose(state, agent, trip, (random() & 1) != 0, known);
+            if (meant != CLevelTemplate::Wait)
+            {
+                lands = state.mStep + random() % (agent.mReaction + 1);
+                if (random() < errors)
+                {
+                    meant = CLevelTemplate::Forward + random() % 4;
+                }
+            }
+        }
+
+        int action = CLevelTemplate::Wait;
+        if (lands >= 0 && state.mStep >= lands)
+        {
+            action = meant;
+            lands = -1;
+            next = state.mStep + agent.mCadence;
+        }
+
+        CLevelTemplate::State before = state;
+        switch (mLevel->Advance(state, action))
+        {
+        case CLevelTemplate::Playing:
+            continue;
+
+        case CLevelTemplate::Won:
+            estimate.mWins++;
+            estimate.mTimes.push_back((before.mStep + 1) * CLaneModel::StepTime);
+            return;
+
+        case CLevelTemplate::Lost:
+        {
+            CLaneModel::Position hero;
+            CRuleTable::Loss loss = mLevel->GetLoss(before, action, hero);
+            estimate.mLosses[max((int)loss, 0)]++;
+
+            int column = min(max((int)(hero.mX / TileToPixels), 0), estimate.mColumns - 1);
+            estimate.mDeaths[hero.mRow * estimate.mColumns + column]++;
+            return;
+        }
+
+        case CLevelTemplate::TimedOut:
+            estimate.mTimedOut++;
+            return;
+        }
+    }
+}
+
+
+/**
+ * Decide what an agent does next
+ * \param state Where the agent is
+ * \param agent How the agent plays, in steps
+ * \param trip Trip the agent is making, moved on past trips that are made
+ * \param leftFirst True to try stepping left before right to get out of the way
+ * \param known What CanLast found in this batch of plays
+ * \returns CLevelTemplate action
+ */
+int CDifficultyEstimator::Choose(const CLevelTemplate::State& state, const Steps& agent, int& trip, bool leftFirst,
+    Known& known) const
+{
+    int row = state.mHero.mRow;
+    for (; trip < (int)mTrips.size(); trip++)
+    {
+        const CCargoPuzzle::Trip& made = mTrips[trip];
+        int bank = made.mTo == CCargoPuzzle::Top ? CLaneModel::TopRow : CLaneModel::BottomRow;
+        CCargoModel::Side side = made.mTo == CCargoPuzzle::Top ? CCargoModel::AtTop : CCargoModel::AtBottom;
+        if (row != bank || (made.mCargo >= 0 && CCargoModel::GetSide(state.mCargo, made.mCargo) != side))
+        {
+            break;
+        }
+    }
+
+    // With nothing left to carry, head for the top
+    int target = CLaneModel::TopRow;
+    if (trip < (int)mTrips.size())
+    {
+        const CCargoPuzzle::Trip& making = mTrips[trip];
+        int to = making.mTo == CCargoPuzzle::Top ? CLaneModel::TopRow : CLaneModel::BottomRow;
+        int from = making.mTo == CCargoPuzzle::Top ? CLaneModel::BottomRow : CLaneModel::TopRow;
+        target = to;
+        if (making.mCargo >= 0)
+        {
+            if (CCargoModel::GetSide(state.mCargo, making.mCargo) != CCargoModel::Carried)
+            {
+                if (row == from)
+                {
+                    return CLevelTemplate::ClickCargo + making.mCargo;
+                }
+                target = from;
+            }
+            else if (row == to)
+            {
+                return CLevelTemplate::ClickCargo + making.mCargo;
+            }
+        }
+    }
+
+    if (row == target)
+    {
+        return CLevelTemplate::Wait;
+    }
+
+    // Toward the target, then staying put, then out of the way
+    int toward = target < row ? CLevelTemplate::Forward : CLevelTemplate::Backward;
+    int away = target < row ? CLevelTemplate::Backward : CLevelTemplate::Forward;
+    int actions[] = { toward, CLevelTemplate::Wait, leftFirst ? CLevelTemplate::Left : CLevelTemplate::Right,
+        leftFirst ? CLevelTemplate::Right : CLevelTemplate::Left, away };
+    for (int action : actions)
+    {
+        if (IsSafe(state, action, agent, known))
+        {
+            return action;
+        }
+    }
+
+    // Nothing lasts, so put off losing as long as possible
+    for (int action : actions)
+    {
+        CLevelTemplate::State next = state;
+        if (Land(next, action, 0, agent.mCadence) != CLevelTemplate::Lost)
+        {
+            return action;
+        }
+    }
+
+    return CLevelTemplate::Wait;
+}
+
+
+/**
+ * Test if an agent thinks an action is safe
+ * \param state Where the agent is
+ * \param action Action to try
+ * \param agent How the agent plays, in steps
+ * \param known What CanLast found in this batch of plays
+ * \returns True if the action does something and, whenever in the agent's
+ * reaction time it lands, the agent can see a way to stay alive after it
+ */
+bool CDifficultyEstimator::IsSafe(const CLevelTemplate::State& state, int action, const Steps& agent,
+    Known& known) const
+{
+    // Waiting is the same whenever it lands
+    int latest = action == CLevelTemplate::Wait ? 0 : agent.mReaction;
+    for (int delay = 0; delay <= latest; delay++)
+    {
+        CLevelTemplate::State next = state;
+        CLevelTemplate::Result result = Land(next, action, delay, agent.mCadence);
+        if (result == CLevelTemplate::Lost)
+        {
+            return false;
+        }
+
+        if (result == CLevelTemplate::Playing && !CanLast(next, LookAhead - delay - agent.mCadence, agent, known))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Search for moves that keep the hero alive for a while. Each move
+ * has to be safe landing on time or a whole reaction time late, and
+ * the search goes on from the late one.
+ * \param state State to start from
+ * \param steps Steps to stay alive for
+ * \param agent How the agent plays, in steps
+ * \param known What CanLast found in this batch of plays, added to
+ * \returns True if there is a way to get through the steps, or to land with no lanes on it
+ */
+bool CDifficultyEstimator::CanLast(const CLevelTemplate::State& state, int steps, const Steps& agent,
+    Known& known) const
+{
+    const CLaneModel& lanes = mLevel->GetLanes();
+    if (lanes.IsSafe(state.mHero))
+    {
+        return true;
+    }
+
+    if (steps <= 0)
+    {
+        return true;
+    }
+
+    // Plays in a batch keep coming back to the same states
+    KnownKey key;
+    key.mHero = lanes.GetKey(state.mHero, state.mStep);
+    key.mCargo = state.mCargo;
+    key.mStep = state.mStep;
+    key.mSteps = steps;
+    auto found = known.find(key);
+    if (found != known.end())
+    {
+        return found->second;
+    }
+
+    const int actions[] = { CLevelTemplate::Wait, CLevelTemplate::Forward, CLevelTemplate::Backward,
+        CLevelTemplate::Left, CLevelTemplate::Right };
+    for (int action : actions)
+    {
+        int delay = action == CLevelTemplate::Wait ? 0 : agent.mReaction;
+        if (delay > 0)
+        {
+            CLevelTemplate::State early = state;
+            if (Land(early, action, 0, agent.mCadence) == CLevelTemplate::Lost)
+            {
+                continue;
+            }
+        }
+
+        CLevelTemplate::State next = state;
+        CLevelTemplate::Result result = Land(next, action, delay, agent.mCadence);
+        if (result == CLevelTemplate::Won || result == CLevelTemplate::TimedOut ||
+            (result == CLevelTemplate::Playing && CanLast(next, steps - (next.mStep - state.mStep), agent, known)))
+        {
+            known[key] = true;
+            return true;
+        }
+    }
+
+    known[key] = false;
+    return false;
+}
+
+
+/**
+ * Hash a key of what CanLast found by mixing its parts together
+ * \param key Key to hash
+ * \returns Hash of the key
+ */
+size_t CDifficultyEstimator::KnownKeyHash::operator()(const KnownKey& key) const
+{
+    const unsigned long long parts[] = { key.mHero, (unsigned long long)key.mCargo,
+        (unsigned long long)key.mStep, (unsigned long long)key.mSteps };
+
+    unsigned long long hash = 0;
+    for (auto part : parts)
+    {
+        hash ^= part + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+
+    return (size_t)hash;
+}
+
+
+/**
+ * Make an action late and wait out the cadence after it
+ * \param state State to make the action in, changed to the state after
+ * \param action Action to make
+ * \param delay Steps to wait before the action
+ * \param cadence Steps until the next input can be made after a move
+ * \returns How the steps went, Lost as well if the action does nothing when it lands
+ */
+CLevelTemplate::Result CDifficultyEstimator::Land(CLevelTemplate::State& state, int action, int delay, int cadence) const
+{
+    CLevelTemplate::Result result = CLevelTemplate::Playing;
+    for (int step = 0; step < delay && result == CLevelTemplate::Playing; step++)
+    {
+        result = mLevel->Advance(state, CLevelTemplate::Wait);
+    }
+
+    if (result != CLevelTemplate::Playing)
+    {
+        return result;
+    }
+
+    CLaneModel::Position hero = state.mHero;
+    int cargo = state.mCargo;
+    if (action != CLevelTemplate::Wait && !mLevel->Apply(state, action, hero, cargo))
+    {
+        return CLevelTemplate::Lost;
+    }
+
+    result = mLevel->Advance(state, action);
+    for (int step = 1; action != CLevelTemplate::Wait && step < cadence && result == CLevelTemplate::Playing; step++)
+    {
+        result = mLevel->Advance(state, CLevelTemplate::Wait);
+    }
+
+    return result;
+}
+
+
+/**
+ * Describe an estimate
+ * \param estimate Estimate of this level
+ * \returns Success rate, win times, losses and a heat map of where they happen
+ */
+std::wstring CDifficultyEstimator::Report(const Estimate& estimate) const
+{
+    wostringstream report;
+    report << fixed << setprecision(1);
+    report << estimate.mPlays << L" plays, " << 100 * estimate.GetSuccessRate() << L"% won" << endl;
+
+    auto& times = estimate.mTimes;
+    if (!times.empty())
+    {
+        double total = 0;
+        for (double time : times)
+        {
+            total += time;
+        }
+        report << setprecision(2) << L"Won in " << total / times.size() << L" s mean, " << times[times.size() / 10]
+            << L" s 10th percentile, " << times[times.size() / 2] << L" s median, " << times[times.size() * 9 / 10]
+            << L" s 90th percentile" << endl;
+    }
+
+    report << setprecision(1);
+    for (int loss = CRuleTable::HitByCar; loss < LossCount; loss++)
+    {
+        report << CRuleTable::GetLossName((CRuleTable::Loss)loss) << L" "
+            << 100.0 * estimate.mLosses[loss] / max(estimate.mPlays, 1) << L"%, ";
+    }
+    report << L"out of time " << 100.0 * estimate.mTimedOut / max(estimate.mPlays, 1) << L"%" << endl;
+
+    // One shade a tile, the row the hero starts on at the bottom
+    int most = 1;
+    for (int deaths : estimate.mDeaths)
+    {
+        most = max(most, deaths);
+    }
+
+    const int shades = (int)wcslen(Shades);
+    for (int row = CLaneModel::TopRow; row <= CLaneModel::BottomRow; row++)
+    {
+        report << L"  |";
+        for (int column = 0; column < estimate.mColumns; column++)
+        {
+            int deaths = estimate.mDeaths[row * estimate.mColumns + column];
+            report << Shades[deaths == 0 ? 0 : 1 + (long long)deaths * (shades - 2) / most];
+        }
+        report << L"|" << endl;
+    }
+
+    return report.str();
+}
+
+
+/**
+ * Estimate how hard every level is for a few kinds of players
+ * \param levels Directory the levels are in, ending with a separator
+ * \returns Report of each level
+ */
+std::wstring CDifficultyEstimator::EstimateLevels(const std::wstring& levels)
+{
+    CGame game;
+    game.LoadLevels(levels, 4);
+
+    struct Kind
+    {
+        const wchar_t* mName;
+        Agent mAgent;
+    };
+
+    Kind kinds[] = {
+        { L"Sharp", { 0.15, 0.005, 0.1 } },
+        { L"Casual", { 0.3, 0.03, 0.25 } },
+    };
+
+    wostringstream report;
+    report << L"Level difficulty, " << PlaysPerLevel << L" plays a level for each player, "
+        << CThreadPool::GetShared()->GetThreadCount() << L" threads" << endl;
+
+    for (int level = 0; level < game.GetLevelCount(); level++)
+    {
+        game.Load(level);
+        CDifficultyEstimator estimator(&game, EstimateLimit);
+
+        for (auto& kind : kinds)
+        {
+            auto start = chrono::steady_clock::now();
+            Estimate estimate = estimator.Run(kind.mAgent, PlaysPerLevel, 1);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            report << endl << L"Level " << level << L", " << kind.mName << L" player: reaction " << fixed << setprecision(2)
+                << kind.mAgent.mReaction << L" s, cadence " << kind.mAgent.mCadence << L" s, errors "
+                << setprecision(1) << 100 * kind.mAgent.mErrorRate << L"%, " << setprecision(2) << seconds << L" s to run" << endl;
+            report << estimator.Report(estimate);
+        }
+    }
+
+    return report.str();
+}
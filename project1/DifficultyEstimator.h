@@ -0,0 +1,134 @@
+/**
+ * \file DifficultyEstimator.h
+ *
+ * \author Michael Dittman
+ *
+ * Estimates how hard a level is by playing it many times with imperfect agents.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <random>
+#include <unordered_map>
+#include "LevelTemplate.h"
+#include "CargoPuzzle.h"
+
+class CGame;
+class CThreadPool;
+
+
+/**
+ * Estimates how hard a level is by playing it many times with imperfect agents.
+ *
+ * An agent plays the way a person might. It carries the cargo across
+ * in the trips the level's CCargoPuzzle finds, heads for the bank each
+ * trip goes to and only moves when it can see a way to stay alive for
+ * two seconds after it. Its inputs land up to a reaction time later
+ * than it meant them to, which it allows for, it can't make inputs
+ * faster than its cadence, and now and then it makes a random move
+ * instead of the one it meant.
+ *
+ * Plays are made on a CLevelTemplate, spread over the shared thread
+ * pool. Each batch of plays has its own random numbers, made from the
+ * seed and the batch, so an estimate is the same however many threads
+ * make it.
+ */
+class CDifficultyEstimator
+{
+public:
+    /// How an agent plays
+    struct Agent
+    {
+        double mReaction = 0.25;    ///< Most seconds an input lands later than the agent meant
+        double mErrorRate = 0.02;   ///< Chance an input is a random move instead
+        double mCadence = 0.2;      ///< Shortest time in seconds between inputs
+    };
+
+    /// What many plays of a level came to
+    struct Estimate
+    {
+        int mPlays = 0;                 ///< Number of plays
+        int mWins = 0;                  ///< Plays that won
+        int mTimedOut = 0;              ///< Plays that ran out of time
+        std::vector<int> mLosses;       ///< Plays lost, by CRuleTable::Loss
+        std::vector<double> mTimes;     ///< Level time in seconds of each win, shortest first
+        int mColumns = 0;               ///< Number of columns of tiles in the heat map
+        std::vector<int> mDeaths;       ///< Plays lost on each tile, by row and then column
+
+        /** Get the fraction of plays that won
+         * \returns Success rate, 0 to 1 */
+        double GetSuccessRate() const { return mPlays > 0 ? (double)mWins / mPlays : 0; }
+    };
+
+    /// Default constructor (disabled)
+    CDifficultyEstimator() = delete;
+
+    /// Copy constructor (disabled)
+    CDifficultyEstimator(const CDifficultyEstimator&) = delete;
+
+    CDifficultyEstimator(CGame* game, double limit);
+
+    Estimate Run(const Agent& agent, int plays, unsigned seed) const;
+
+    std::wstring Report(const Estimate& estimate) const;
+
+    static std::wstring EstimateLevels(const std::wstring& levels);
+
+private:
+    /// An agent with its times in steps
+    struct Steps
+    {
+        int mReaction = 0;          ///< Most steps an input lands late by
+        int mCadence = 1;           ///< Fewest steps between inputs
+        double mErrorRate = 0;      ///< Chance an input is a random move instead
+    };
+
+    /// A state and steps to last that CanLast was asked about
+    struct KnownKey
+    {
+        unsigned long long mHero = 0;   ///< Lane model key of where the hero is
+        int mCargo = 0;                 ///< Where the cargo is
+        int mStep = 0;                  ///< Step the state is at
+        int mSteps = 0;                 ///< Steps to last
+
+        /** Test if two keys are the same
+         * \param other Key to compare to
+         * \returns True if every part is the same */
+        bool operator==(const KnownKey& other) const
+        {
+            return mHero == other.mHero && mCargo == other.mCargo && mStep == other.mStep && mSteps == other.mSteps;
+        }
+    };
+
+    /// Hashes a KnownKey
+    struct KnownKeyHash
+    {
+        size_t operator()(const KnownKey& key) const;
+    };
+
+    /// What CanLast found, by state and steps to last, kept for a batch of plays
+    typedef std::unordered_map<KnownKey, bool, KnownKeyHash> Known;
+
+    void Play(const Steps& agent, std::mt19937& random, Known& known, Estimate& estimate) const;
+
+    int Choose(const CLevelTemplate::State& state, const Steps& agent, int& trip, bool leftFirst,
+        Known& known) const;
+
+    bool IsSafe(const CLevelTemplate::State& state, int action, const Steps& agent, Known& known) const;
+
+    bool CanLast(const CLevelTemplate::State& state, int steps, const Steps& agent, Known& known) const;
+
+    CLevelTemplate::Result Land(CLevelTemplate::State& state, int action, int delay, int cadence) const;
+
+    /// Level being played
+    std::unique_ptr<CLevelTemplate> mLevel;
+
+    /// Trips that carry the cargo across
+    std::vector<CCargoPuzzle::Trip> mTrips;
+
+    /// Threads plays are made on
+    CThreadPool* mPool;
+};
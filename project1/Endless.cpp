@@ -0,0 +1,686 @@
+/**
+ * \file Endless.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "Endless.h"
+#include "Game.h"
+#include "Decor.h"
+#include "Car.h"
+#include "Boat.h"
+#include "LaneVisitor.h"
+#include "IsSketchyVisitor.h"
+#include "SimThread.h"
+#include <psapi.h>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+using namespace std;
+using namespace Gdiplus;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Width of the lanes on the screen in virtual pixels
+const double ScreenWidth = 1024;
+
+/// Rows at the start that are land, the bank the hero starts on
+const int StartBank = 3;
+
+/// Row the hero starts on, the one above the bottom of the screen as in a level
+const int StartRow = 1;
+
+/// X the hero starts at, where a level starts it
+const double StartX = 480;
+
+/// Virtual pixels a vehicle goes past either side of the screen before it comes back around
+const double Margin = 256;
+
+/// Fewest tiles a lane wraps around after
+const int MinLaneWidth = 24;
+
+/// Most tiles a lane wraps around after
+const int MaxLaneWidth = 32;
+
+/// Rows over which the roads get up to twice as fast
+const double RampRows = 300;
+
+/// Most a river's speed goes up by, as a multiple, so boats can still be caught
+const double RiverRamp = 1.5;
+
+/// Virtual pixels a car can overlap the hero's box by before it hits, since neither image fills its box
+const double CarOverlap = 16;
+
+/// X in virtual pixels decor is tested at to see which rows it covers
+const double TerrainTestX = TileToPixels * 8;
+
+/// Seed soaks make their rows from
+const unsigned SoakSeed = 12345;
+
+/// Ticks between the soak autopilot's steps forward
+const int SoakStepTicks = 25;
+
+/// Game time in seconds each line of a soak report covers
+const double SoakWindow = 1800;
+
+
+/**
+ * Visitor that collects every decor item, in item order
+ */
+class CEndlessDecorVisitor : public CItemVisitor
+{
+public:
+    /** Visit a decor item
+     * \param decor Decor visited */
+    virtual void VisitDecor(CDecor* decor) override { mDecor.push_back(decor); }
+
+    /// The decor visited
+    vector<CDecor*> mDecor;
+};
+
+
+/**
+ * Constructor. Takes the vehicles, tiles and hero of the game's current level.
+ * \param game Game with the level loaded
+ * \param seed Seed to make the rows from
+ */
+CEndless::CEndless(CGame* game, unsigned seed) : mGame(game)
+{
+    CLaneVisitor lanes;
+    game->Accept(&lanes);
+
+    // One style for each image, cars and boats that won't sink
+    auto add = [](vector<Style>& styles, CVehicle* vehicle)
+    {
+        for (auto& style : styles)
+        {
+            if (style.mImage == vehicle->GetImage())
+            {
+                return;
+            }
+        }
+
+        Style style;
+        style.mImage = vehicle->GetImage();
+        style.mWidth = vehicle->GetWidth();
+        style.mId = vehicle->GetId();
+        styles.push_back(style);
+    };
+
+    for (auto car : lanes.GetCars())
+    {
+        add(mCars, car);
+    }
+
+    for (auto boat : lanes.GetBoats())
+    {
+        CIsSketchyVisitor visitor;
+        boat->Accept(&visitor);
+        if (!visitor.GetIsSketchy())
+        {
+            add(mBoats, boat);
+        }
+    }
+
+    // Boats a tile wide are pieces of longer logs, which don't look right alone
+    auto pieces = [](const Style& style) { return style.mWidth < TileToPixels * 2; };
+    if (!all_of(mBoats.begin(), mBoats.end(), pieces))
+    {
+        mBoats.erase(remove_if(mBoats.begin(), mBoats.end(), pieces), mBoats.end());
+    }
+
+    // The last decor drawn over the middle of a row is what that kind of row looks like
+    CEndlessDecorVisitor decor;
+    game->Accept(&decor);
+    auto rules = game->GetRuleTable();
+    mTiles.assign(CRuleTable::River + 1, nullptr);
+    for (int row = 0; row < CRuleTable::Rows; row++)
+    {
+        auto terrain = rules != nullptr ? rules->GetTerrain(row) : CRuleTable::Land;
+        for (auto item : decor.mDecor)
+        {
+            if (item->HitTest(TerrainTestX, row * TileToPixels + TileToPixels / 2) && mTiles[terrain] == nullptr)
+            {
+                mTiles[terrain] = item->GetImage();
+            }
+        }
+    }
+
+    if (game->GetHero() != nullptr)
+    {
+        mHeroHalf = game->GetHero()->GetWidth() / 2;
+    }
+
+    // Every vehicle there will ever be
+    mPool.resize(Slots * MaxPerLane);
+    Reset(seed);
+}
+
+
+/**
+ * Start over from the first row, making the rows from a seed. The
+ * game's camera has to go back to the first screen with it.
+ * \param seed Seed to make the rows from
+ */
+void CEndless::Reset(unsigned seed)
+{
+    // Everything goes back on the free list
+    for (int i = 0; i < (int)mPool.size(); i++)
+    {
+        mPool[i].mNext = i + 1 < (int)mPool.size() ? i + 1 : -1;
+    }
+    mFree = mPool.empty() ? -1 : 0;
+    mLanes.assign(Slots, Lane());
+
+    mStats = Stats();
+    mStats.mPool = (int)mPool.size();
+
+    mSeed = seed;
+    mRandom.seed(seed);
+    mRunTerrain = CRuleTable::Land;
+    mRunLeft = 0;
+    mNextRow = 0;
+    mFirstRow = 0;
+    mTime = 0;
+    mHeroRow = StartRow;
+    mHeroX = StartX;
+    mBoat = -1;
+    mHitBy.clear();
+
+    while (mNextRow < mFirstRow + Slots)
+    {
+        Generate(mNextRow++);
+    }
+}
+
+
+/**
+ * Move everything along, keeping the rows the game's camera shows
+ * \param elapsed Time in seconds since the last update
+ * \returns How the hero lost, NoLoss if it hasn't
+ */
+CRuleTable::Loss CEndless::Update(double elapsed)
+{
+    mTime += elapsed;
+    Scroll();
+
+    // A hero on a boat goes where the boat goes
+    if (mBoat >= 0)
+    {
+        mHeroX = GetX(mPool[mBoat], GetLane(mHeroRow));
+    }
+
+    return GetLoss();
+}
+
+
+/**
+ * Move the hero a tile
+ * \param action Forward, Backward, Left or Right
+ * \returns True if the hero moved
+ */
+bool CEndless::Move(CReplay::Action action)
+{
+    switch (action)
+    {
+    case CReplay::Forward:
+        // Not past the row below the top of the screen
+        if (mHeroRow + 1 - GetCamera() > CRuleTable::Rows - 2)
+        {
+            return false;
+        }
+        mHeroRow++;
+        break;
+
+    case CReplay::Backward:
+        // Not onto the bottom row of the screen
+        if (mHeroRow - 1 - GetCamera() < 1)
+        {
+            return false;
+        }
+        mHeroRow--;
+        break;
+
+    case CReplay::Left:
+    case CReplay::Right:
+        // The hero can't move sideways on a boat
+        if (mBoat >= 0)
+        {
+            return false;
+        }
+        mHeroX += action == CReplay::Left ? -TileToPixels : TileToPixels;
+        break;
+
+    default:
+        return false;
+    }
+
+    // Step onto a boat if there is one here
+    mBoat = FindBoat(GetLane(mHeroRow), mHeroX);
+    if (mBoat >= 0)
+    {
+        mHeroX = GetX(mPool[mBoat], GetLane(mHeroRow));
+    }
+
+    return true;
+}
+
+
+/**
+ * Record the drawing of the rows on the screen, their vehicles and the hero.
+ * Everything is where it is in the level, for the game's camera to move.
+ * \param list Render list to record into
+ */
+void CEndless::Draw(CRenderList* list)
+{
+    // Only the rows the screen shows, the one part scrolled off included
+    int last = min(mFirstRow + CRuleTable::Rows, mNextRow - 1);
+    auto top = [](int row) { return (float)((CRuleTable::Rows - 1 - row) * TileToPixels); };
+
+    for (int row = mFirstRow; row <= last; row++)
+    {
+        const Lane& lane = GetLane(row);
+        Bitmap* tile = mTiles[lane.mTerrain];
+        if (tile == nullptr)
+        {
+            const Color colors[] = { Color(34, 139, 34), Color(64, 64, 64), Color(30, 90, 200) };
+            list->FillRectangle(colors[lane.mTerrain], 0, top(row), (float)ScreenWidth, (float)TileToPixels + 1);
+            continue;
+        }
+
+        for (double x = 0; x < ScreenWidth; x += TileToPixels)
+        {
+            list->DrawImage(tile, (float)x, top(row), (float)tile->GetWidth() + 1, (float)tile->GetHeight() + 1);
+        }
+    }
+
+    for (int row = mFirstRow; row <= last; row++)
+    {
+        const Lane& lane = GetLane(row);
+        const vector<Style>& styles = lane.mTerrain == CRuleTable::Road ? mCars : mBoats;
+        double y = top(row) + TileToPixels / 2;
+        for (int i = lane.mFirst; i >= 0; i = mPool[i].mNext)
+        {
+            const Style& style = styles[mPool[i].mStyle];
+            double x = GetX(mPool[i], lane);
+            if (x + style.mWidth / 2 < 0 || x - style.mWidth / 2 > ScreenWidth)
+            {
+                continue;
+            }
+
+            double wid = style.mImage->GetWidth();
+            double hit = style.mImage->GetHeight();
+            list->DrawImage(style.mImage, float(x - wid / 2), float(y - hit / 2), (float)wid, (float)hit);
+        }
+    }
+
+    // Hide what hangs off the sides and the top of the screen
+    Color black(0, 0, 0);
+    float screen = (float)mGame->GetCameraY();
+    list->FillRectangle(black, -600, screen, 600, (float)mGame->GetHeight());
+    list->FillRectangle(black, (float)ScreenWidth, screen, 800, (float)mGame->GetHeight());
+    list->FillRectangle(black, -600, screen - 800, 2424, 800);
+
+    auto hero = mGame->GetHero();
+    if (hero != nullptr)
+    {
+        hero->SetLocation(mHeroX, GetHeroY());
+        hero->Draw(list);
+    }
+}
+
+
+/**
+ * Get what a row is
+ * \param row Row, counting up from the bottom of the first screen
+ * \returns Terrain of the row, Land if it isn't being kept
+ */
+CRuleTable::Terrain CEndless::GetTerrain(int row) const
+{
+    return row >= 0 && GetLane(row).mRow == row ? GetLane(row).mTerrain : CRuleTable::Land;
+}
+
+
+/**
+ * Get how many vehicles a row has
+ * \param row Row, counting up from the bottom of the first screen
+ * \returns Number of vehicles, 0 if the row isn't being kept
+ */
+int CEndless::GetVehicleCount(int row) const
+{
+    return row >= 0 && GetLane(row).mRow == row ? GetLane(row).mCount : 0;
+}
+
+
+/**
+ * Get how fast a row's vehicles go
+ * \param row Row, counting up from the bottom of the first screen
+ * \returns Virtual pixels a second, to the right if positive, 0 if the row isn't being kept
+ */
+double CEndless::GetSpeed(int row) const
+{
+    return row >= 0 && GetLane(row).mRow == row ? GetLane(row).mSpeed : 0;
+}
+
+
+/**
+ * Make a row into its slot, which has to be empty.
+ *
+ * Rows come in runs of land, road or river. Past the bank the hero
+ * starts on, roads and rivers take turns, with land between some of
+ * them, and the roads get faster the farther the row is.
+ *
+ * \param row Row to make, the one after the last made
+ */
+void CEndless::Generate(int row)
+{
+    Lane& lane = GetLane(row);
+    lane.mRow = row;
+    lane.mBorn = mTime;
+    lane.mFirst = -1;
+    lane.mCount = 0;
+    lane.mSpeed = 0;
+    lane.mPeriod = 0;
+    mStats.mGenerated++;
+
+    bool roads = !mCars.empty();
+    bool rivers = !mBoats.empty();
+    if (row < StartBank || (!roads && !rivers))
+    {
+        lane.mTerrain = CRuleTable::Land;
+        return;
+    }
+
+    if (mRunLeft <= 0)
+    {
+        bool coin = mRandom() % 2 == 0;
+        if (mRunTerrain != CRuleTable::Land && coin)
+        {
+            mRunTerrain = CRuleTable::Land;
+        }
+        else if (mRunTerrain == CRuleTable::Road || (mRunTerrain == CRuleTable::Land && !coin))
+        {
+            mRunTerrain = rivers ? CRuleTable::River : CRuleTable::Road;
+        }
+        else
+        {
+            mRunTerrain = roads ? CRuleTable::Road : CRuleTable::River;
+        }
+
+        int longest = mRunTerrain == CRuleTable::Land ? 2 : mRunTerrain == CRuleTable::Road ? 4 : 3;
+        mRunLeft = uniform_int_distribution<int>(1, longest)(mRandom);
+    }
+
+    mRunLeft--;
+    lane.mTerrain = mRunTerrain;
+    if (lane.mTerrain == CRuleTable::Land)
+    {
+        return;
+    }
+
+    bool road = lane.mTerrain == CRuleTable::Road;
+    double ramp = 1 + min(row / RampRows, 1.0);
+    double tiles = road ? uniform_real_distribution<double>(1.5, 3.5)(mRandom) * ramp :
+        uniform_real_distribution<double>(1.0, 2.0)(mRandom) * min(ramp, RiverRamp);
+    lane.mSpeed = tiles * TileToPixels * (mRandom() % 2 == 0 ? 1 : -1);
+    lane.mPeriod = uniform_int_distribution<int>(MinLaneWidth, MaxLaneWidth)(mRandom) * TileToPixels;
+
+    // Spread out evenly, each a little way along from its place
+    const vector<Style>& styles = road ? mCars : mBoats;
+    int count = road ? uniform_int_distribution<int>(1, 3)(mRandom) : uniform_int_distribution<int>(2, MaxPerLane)(mRandom);
+    double spacing = lane.mPeriod / count;
+    for (int i = 0; i < count && mFree >= 0; i++)
+    {
+        int index = mFree;
+        Vehicle& vehicle = mPool[index];
+        mFree = vehicle.mNext;
+
+        vehicle.mStyle = uniform_int_distribution<int>(0, (int)styles.size() - 1)(mRandom);
+        vehicle.mStart = i * spacing + uniform_real_distribution<double>(0, spacing / 4)(mRandom);
+        vehicle.mNext = lane.mFirst;
+        lane.mFirst = index;
+        lane.mCount++;
+
+        mStats.mSpawned++;
+        mStats.mLive++;
+    }
+}
+
+
+/**
+ * Empty a row's slot, putting its vehicles back on the free list
+ * \param lane Lane in the slot
+ */
+void CEndless::Retire(Lane& lane)
+{
+    while (lane.mFirst >= 0)
+    {
+        int index = lane.mFirst;
+        lane.mFirst = mPool[index].mNext;
+        mPool[index].mNext = mFree;
+        mFree = index;
+        mStats.mLive--;
+    }
+
+    lane.mRow = -1;
+    lane.mCount = 0;
+    mStats.mRetired++;
+}
+
+
+/**
+ * Get the row at the bottom of the screen, from where the game's camera is
+ * \returns Row, with the fraction of it scrolled off
+ */
+double CEndless::GetCamera() const
+{
+    return -mGame->GetCameraY() / TileToPixels;
+}
+
+
+/**
+ * Get where the hero is in the level
+ * \returns Y location of the center of the hero in virtual pixels,
+ * which goes negative once the hero is past the first screen
+ */
+double CEndless::GetHeroY() const
+{
+    return (CRuleTable::Rows - 1 - mHeroRow) * TileToPixels + TileToPixels / 2;
+}
+
+
+/**
+ * Retire the rows the camera has scrolled off the bottom and make the
+ * rows that come in ahead
+ */
+void CEndless::Scroll()
+{
+    int first = (int)floor(GetCamera());
+    while (mFirstRow < first)
+    {
+        Retire(GetLane(mFirstRow++));
+    }
+
+    while (mNextRow < mFirstRow + Slots)
+    {
+        Generate(mNextRow++);
+    }
+}
+
+
+/**
+ * Get where a vehicle is now
+ * \param vehicle Vehicle in the pool
+ * \param lane Lane the vehicle is in
+ * \returns X location of the center of the vehicle in virtual pixels
+ */
+double CEndless::GetX(const Vehicle& vehicle, const Lane& lane) const
+{
+    double offset = fmod(vehicle.mStart + Margin + lane.mSpeed * (mTime - lane.mBorn), lane.mPeriod);
+    return (offset < 0 ? offset + lane.mPeriod : offset) - Margin;
+}
+
+
+/**
+ * Find the boat at a place in a lane
+ * \param lane Lane to look in
+ * \param x X location in virtual pixels
+ * \returns Index of the boat in the pool, -1 if there isn't one there
+ */
+int CEndless::FindBoat(const Lane& lane, double x) const
+{
+    if (lane.mTerrain != CRuleTable::River)
+    {
+        return -1;
+    }
+
+    for (int i = lane.mFirst; i >= 0; i = mPool[i].mNext)
+    {
+        if (fabs(GetX(mPool[i], lane) - x) < mBoats[mPool[i].mStyle].mWidth / 2)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * Find out if the hero lost this update, in the order a level's rules test
+ * \returns How the hero lost, NoLoss if it hasn't
+ */
+CRuleTable::Loss CEndless::GetLoss()
+{
+    double maxX = mGame->GetHeroMaxX();
+    if (mInvulnerable)
+    {
+        // Keep the hero on the screen, off the boat that would have carried it away
+        if (mHeroX < 0 || mHeroX > maxX)
+        {
+            mHeroX = max(0.0, min(mHeroX, maxX));
+            mBoat = -1;
+        }
+        return CRuleTable::NoLoss;
+    }
+
+    if (mHeroX < 0 || mHeroX > maxX)
+    {
+        return CRuleTable::OutOfBounds;
+    }
+
+    const Lane& lane = GetLane(mHeroRow);
+    if (lane.mTerrain == CRuleTable::Road)
+    {
+        for (int i = lane.mFirst; i >= 0; i = mPool[i].mNext)
+        {
+            const Style& car = mCars[mPool[i].mStyle];
+            if (fabs(GetX(mPool[i], lane) - mHeroX) < car.mWidth / 2 + mHeroHalf - CarOverlap)
+            {
+                mHitBy = car.mId;
+                return CRuleTable::HitByCar;
+            }
+        }
+    }
+
+    if (lane.mTerrain == CRuleTable::River && mBoat < 0)
+    {
+        return CRuleTable::FellInRiver;
+    }
+
+    return CRuleTable::NoLoss;
+}
+
+
+/**
+ * Run endless mode for hours of game time and report whether what it
+ * keeps and how long a tick takes stay flat.
+ *
+ * An autopilot that can't lose steps forward a row at a time, and
+ * each tick the game updates and records a frame the way the
+ * simulation thread does. A line is reported for each half hour.
+ *
+ * \param levels Directory the levels are in, ending with a separator
+ * \param hours Hours of game time to run for
+ * \returns Report text
+ */
+std::wstring CEndless::Soak(const std::wstring& levels, double hours)
+{
+    CGame game;
+    game.LoadLevels(levels, 4);
+    game.SetEndless(true, SoakSeed);
+    CEndless* endless = game.GetEndless();
+    endless->SetInvulnerable(true);
+
+    wostringstream report;
+    report << L"Endless soak, " << hours << L" hours of game time, " << CSimThread::TickTime * 1000
+        << L" ms ticks" << endl << endl;
+    report << L"Hour\tRows\tLanes\tVehicles\tTick mean\tTick max\tCommands\tPrivate" << endl;
+    report << fixed;
+
+    CRenderList list;
+    long long ticks = (long long)(hours * 3600 / CSimThread::TickTime);
+    long long windowTicks = max((long long)(SoakWindow / CSimThread::TickTime), 1LL);
+    double windowTotal = 0;
+    double windowMax = 0;
+    int commands = 0;
+    double firstMean = 0;
+    double lastMean = 0;
+    SIZE_T firstPrivate = 0;
+    SIZE_T lastPrivate = 0;
+    for (long long tick = 1; tick <= ticks; tick++)
+    {
+        auto start = chrono::steady_clock::now();
+        if (tick % SoakStepTicks == 0)
+        {
+            game.moveHero(VK_UP);
+        }
+        game.Update(CSimThread::TickTime);
+        game.UpdateControlPanel(CSimThread::TickTime);
+        list.Clear();
+        game.BuildFrame(&list);
+        double time = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+        windowTotal += time;
+        windowMax = max(windowMax, time);
+        commands = max(commands, list.GetSize());
+        if (tick % windowTicks != 0 && tick != ticks)
+        {
+            continue;
+        }
+
+        PROCESS_MEMORY_COUNTERS_EX memory = {};
+        GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&memory, sizeof(memory));
+
+        long long count = (tick - 1) % windowTicks + 1;
+        const Stats& stats = endless->GetStats();
+        report << setprecision(1) << tick * CSimThread::TickTime / 3600 << L"\t" << endless->GetHeroRow() << L"\t"
+            << stats.mGenerated - stats.mRetired << L"/" << stats.mGenerated << L"\t"
+            << stats.mLive << L"/" << stats.mPool << L"\t" << setprecision(2) << windowTotal / count << L" us\t"
+            << windowMax << L" us\t" << commands << L"\t" << memory.PrivateUsage / 1024 << L" KB" << endl;
+
+        if (firstPrivate == 0)
+        {
+            firstMean = windowTotal / count;
+            firstPrivate = memory.PrivateUsage;
+        }
+        lastMean = windowTotal / count;
+        lastPrivate = memory.PrivateUsage;
+        windowTotal = 0;
+        windowMax = 0;
+        commands = 0;
+    }
+
+    const Stats& stats = endless->GetStats();
+    report << endl << stats.mSpawned << L" vehicles taken from a pool of " << stats.mPool << L", "
+        << stats.mRetired << L" lanes retired" << endl;
+    report << L"From the first half hour to the last, the mean tick went from " << setprecision(2) << firstMean
+        << L" us to " << lastMean << L" us and private memory changed by "
+        << ((long long)lastPrivate - (long long)firstPrivate) / 1024 << L" KB" << endl;
+    return report.str();
+}
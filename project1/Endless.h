@@ -0,0 +1,237 @@
+/**
+ * \file Endless.h
+ *
+ * \author Michael Dittman
+ *
+ * Endless mode, with lanes made ahead of the hero and let go of behind it.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <random>
+#include "RuleTable.h"
+#include "Replay.h"
+#include "RenderList.h"
+
+class CGame;
+
+
+/**
+ * Endless mode, with lanes made ahead of the hero and let go of behind it.
+ *
+ * Rows are counted from the bottom of the first screen, and each row is
+ * made from the seed the first time it comes near the top of the
+ * screen, so a seed always makes the same rows. The rows are drawn
+ * where they are in the level, going up from the first screen, and the
+ * game's camera follows the hero up them and never goes back. Rows that
+ * scroll off the bottom are retired, so only a screen of lanes and a few ahead of it are ever
+ * kept, in a ring of slots by row.
+ *
+ * Vehicles come from a pool made when endless mode starts, big enough
+ * for every slot to have as many vehicles as a lane can. A retired
+ * lane's vehicles go back on the pool's free list and new lanes take
+ * them from it, so nothing is allocated however far the hero goes and
+ * an update always has the same few lanes to look at.
+ *
+ * The cars, boats, tiles and hero are the ones the game's current
+ * level has. A vehicle's place follows from the time since its lane
+ * was made, which stays small however long endless mode runs.
+ */
+class CEndless
+{
+public:
+    /// What endless mode has done so far
+    struct Stats
+    {
+        long long mGenerated = 0;   ///< Lanes made
+        long long mRetired = 0;     ///< Lanes retired
+        long long mSpawned = 0;     ///< Vehicles taken from the pool
+        int mLive = 0;              ///< Vehicles in lanes now
+        int mPool = 0;              ///< Vehicles the pool has room for
+    };
+
+    /// Rows made ahead of the top of the screen
+    const static int Ahead = 4;
+
+    /// Rows kept at once, a screen and part of another as it scrolls, and the rows ahead
+    const static int Slots = CRuleTable::Rows + 1 + Ahead;
+
+    /// Most vehicles a lane can have
+    const static int MaxPerLane = 4;
+
+    /// Default constructor (disabled)
+    CEndless() = delete;
+
+    /// Copy constructor (disabled)
+    CEndless(const CEndless&) = delete;
+
+    CEndless(CGame* game, unsigned seed);
+
+    void Reset(unsigned seed);
+
+    CRuleTable::Loss Update(double elapsed);
+
+    bool Move(CReplay::Action action);
+
+    void Draw(CRenderList* list);
+
+    CRuleTable::Terrain GetTerrain(int row) const;
+
+    int GetVehicleCount(int row) const;
+
+    double GetSpeed(int row) const;
+
+    /// Get the seed the rows are made from
+    /// \returns Seed
+    unsigned GetSeed() const { return mSeed; }
+
+    /// Get the row the hero is on
+    /// \returns Row, counting up from the bottom of the first screen
+    int GetHeroRow() const { return mHeroRow; }
+
+    /// Get where the hero is across the screen
+    /// \returns X location of the center of the hero in virtual pixels
+    double GetHeroX() const { return mHeroX; }
+
+    /// Get if the hero is riding a boat
+    /// \returns True if on a boat
+    bool GetOnBoat() const { return mBoat >= 0; }
+
+    double GetCamera() const;
+
+    double GetHeroY() const;
+
+    /// Get the id of the car that hit the hero
+    /// \returns Car id, empty if no car has
+    const std::wstring& GetHitBy() const { return mHitBy; }
+
+    /// Set if nothing can lose endless mode
+    /// \param invulnerable True to keep the hero alive and on the screen
+    void SetInvulnerable(bool invulnerable) { mInvulnerable = invulnerable; }
+
+    /// Get if nothing can lose endless mode
+    /// \returns True if the hero can't lose
+    bool GetInvulnerable() const { return mInvulnerable; }
+
+    /// Get what endless mode has done so far
+    /// \returns Counts of lanes and vehicles
+    const Stats& GetStats() const { return mStats; }
+
+    static std::wstring Soak(const std::wstring& levels, double hours);
+
+private:
+    /// A vehicle image from the level
+    struct Style
+    {
+        Gdiplus::Bitmap* mImage = nullptr;  ///< Image, owned by the level's items
+        double mWidth = 0;                  ///< Width in virtual pixels
+        std::wstring mId;                   ///< Car id, for what the hero was hit by
+    };
+
+    /// A vehicle in the pool
+    struct Vehicle
+    {
+        int mStyle = 0;             ///< Index of its style, in the cars or the boats
+        double mStart = 0;          ///< Place in the lane when the lane was made, in virtual pixels
+        int mNext = -1;             ///< Next vehicle in the lane or the free list, -1 for none
+    };
+
+    /// A row in the ring of slots
+    struct Lane
+    {
+        int mRow = -1;              ///< Row the slot has, -1 for none
+        CRuleTable::Terrain mTerrain = CRuleTable::Land;    ///< What the row is
+        double mSpeed = 0;          ///< Virtual pixels a second the vehicles go, to the right if positive
+        double mPeriod = 0;         ///< Virtual pixels a vehicle goes before it comes back around
+        double mBorn = 0;           ///< Time the lane was made
+        int mFirst = -1;            ///< First vehicle, -1 for none
+        int mCount = 0;             ///< Number of vehicles
+    };
+
+    void Generate(int row);
+
+    void Retire(Lane& lane);
+
+    void Scroll();
+
+    double GetX(const Vehicle& vehicle, const Lane& lane) const;
+
+    int FindBoat(const Lane& lane, double x) const;
+
+    CRuleTable::Loss GetLoss();
+
+    /** Get the slot a row is kept in
+     * \param row Row
+     * \returns Lane in the row's slot, which may have another row in it */
+    Lane& GetLane(int row) { return mLanes[row % Slots]; }
+
+    /** Get the slot a row is kept in
+     * \param row Row
+     * \returns Lane in the row's slot, which may have another row in it */
+    const Lane& GetLane(int row) const { return mLanes[row % Slots]; }
+
+    /// The game, whose hero is drawn
+    CGame* mGame;
+
+    /// Cars of the level
+    std::vector<Style> mCars;
+
+    /// Boats of the level that don't sink
+    std::vector<Style> mBoats;
+
+    /// Tile of each kind of row, by CRuleTable::Terrain, null if the level has none
+    std::vector<Gdiplus::Bitmap*> mTiles;
+
+    /// Half the width of the hero in virtual pixels
+    double mHeroHalf = 0;
+
+    /// Rows being kept, by row modulo Slots
+    std::vector<Lane> mLanes;
+
+    /// Every vehicle there can be, made once
+    std::vector<Vehicle> mPool;
+
+    /// First vehicle on the free list, -1 for none
+    int mFree = -1;
+
+    /// Seed the rows are made from
+    unsigned mSeed = 0;
+
+    /// Random numbers the rows are made with, in row order
+    std::mt19937 mRandom;
+
+    /// What the rows being made are
+    CRuleTable::Terrain mRunTerrain = CRuleTable::Land;
+
+    /// Rows left in the run of rows being made
+    int mRunLeft = 0;
+
+    /// Next row to make
+    int mNextRow = 0;
+
+    /// Lowest row still kept
+    int mFirstRow = 0;
+
+    /// Seconds endless mode has been running
+    double mTime = 0;
+
+    /// Row the hero is on
+    int mHeroRow = 0;
+
+    /// X location of the center of the hero in virtual pixels
+    double mHeroX = 0;
+
+    /// Vehicle the hero is riding, -1 for none
+    int mBoat = -1;
+
+    /// Id of the car that hit the hero
+    std::wstring mHitBy;
+
+    /// Nothing loses, for soaking
+    bool mInvulnerable = false;
+
+    /// What endless mode has done so far
+    Stats mStats;
+};
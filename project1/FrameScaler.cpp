@@ -0,0 +1,274 @@
+/**
+ * \file FrameScaler.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "FrameScaler.h"
+#include <emmintrin.h>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/// Fixed point weights are 0-128 so (b - a) * w fits in a signed 16 bit lane
+const int WeightOne = 128;
+
+/// Shift that undoes a weight multiply
+const int WeightShift = 7;
+
+
+/**
+ * Constructor
+ * \param pool Thread pool the rows are split over
+ */
+CFrameScaler::CFrameScaler(CThreadPool* pool) : mPool(pool)
+{
+}
+
+
+/**
+ * Scale a frame of 32 bit pixels into another frame.
+ *
+ * The source is stretched to cover the whole destination, so the
+ * caller is responsible for offsetting dst to do any letterboxing.
+ *
+ * \param src First byte of the source frame
+ * \param srcWidth Source width in pixels
+ * \param srcHeight Source height in pixels
+ * \param srcStride Bytes between source rows
+ * \param dst First byte of the destination area
+ * \param dstWidth Destination width in pixels
+ * \param dstHeight Destination height in pixels
+ * \param dstStride Bytes between destination rows
+ */
+void CFrameScaler::Scale(const unsigned char* src, int srcWidth, int srcHeight, int srcStride,
+    unsigned char* dst, int dstWidth, int dstHeight, int dstStride)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+    {
+        return;
+    }
+
+    BuildTables(srcWidth, srcHeight, dstWidth, dstHeight);
+
+    // Bilinear needs a right and lower neighbor to blend with
+    bool bilinear = mFilter == Bilinear && srcWidth > 1 && srcHeight > 1;
+
+    // A handful of chunks per thread keeps them all busy
+    int grain = max(8, dstHeight / (mPool->GetThreadCount() * 4));
+
+    mPool->ParallelFor(0, dstHeight, grain, [&](int y0, int y1)
+        {
+            if (bilinear)
+            {
+                BilinearRows(y0, y1, src, srcWidth, srcStride, dst, dstWidth, dstStride);
+            }
+            else
+            {
+                NearestRows(y0, y1, src, srcStride, dst, dstWidth, dstStride);
+            }
+        });
+}
+
+
+/**
+ * Build the row and column lookup tables if the sizes changed
+ * \param srcWidth Source width in pixels
+ * \param srcHeight Source height in pixels
+ * \param dstWidth Destination width in pixels
+ * \param dstHeight Destination height in pixels
+ */
+void CFrameScaler::BuildTables(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+    if (mTableSize[0] == srcWidth && mTableSize[1] == srcHeight &&
+        mTableSize[2] == dstWidth && mTableSize[3] == dstHeight)
+    {
+        return;
+    }
+
+    mTableSize[0] = srcWidth;
+    mTableSize[1] = srcHeight;
+    mTableSize[2] = dstWidth;
+    mTableSize[3] = dstHeight;
+
+    // Maps a destination pixel center onto the source axis
+    auto build = [](int srcSize, int dstSize, vector<int>& nearest, vector<int>& index, vector<short>& weight)
+    {
+        nearest.resize(dstSize);
+        index.resize(dstSize);
+        weight.resize(dstSize);
+
+        for (int d = 0; d < dstSize; d++)
+        {
+            nearest[d] = min(srcSize - 1, (int)(((long long)(2 * d + 1) * srcSize) / (2LL * dstSize)));
+
+            double s = (d + 0.5) * srcSize / dstSize - 0.5;
+            if (s < 0)
+            {
+                s = 0;
+            }
+
+            int i = (int)floor(s);
+            int w = (int)((s - i) * WeightOne + 0.5);
+            if (w >= WeightOne)
+            {
+                i++;
+                w = 0;
+            }
+
+            // Keep i + 1 inside the source
+            if (i >= srcSize - 1)
+            {
+                i = max(0, srcSize - 2);
+                w = srcSize > 1 ? WeightOne : 0;
+            }
+
+            index[d] = i;
+            weight[d] = (short)w;
+        }
+    };
+
+    build(srcWidth, dstWidth, mXNearest, mXIndex, mXWeight);
+    build(srcHeight, dstHeight, mYNearest, mYIndex, mYWeight);
+}
+
+
+/**
+ * Nearest neighbor scale of a range of destination rows
+ * \param y0 First destination row
+ * \param y1 One past the last destination row
+ * \param src First byte of the source frame
+ * \param srcStride Bytes between source rows
+ * \param dst First byte of the destination area
+ * \param dstWidth Destination width in pixels
+ * \param dstStride Bytes between destination rows
+ */
+void CFrameScaler::NearestRows(int y0, int y1, const unsigned char* src, int srcStride,
+    unsigned char* dst, int dstWidth, int dstStride)
+{
+    const int* xIndex = mXNearest.data();
+
+    for (int y = y0; y < y1; y++)
+    {
+        unsigned char* out = dst + (size_t)y * dstStride;
+
+        // When magnifying, neighboring rows usually come from the same source row
+        if (y > y0 && mYNearest[y] == mYNearest[y - 1])
+        {
+            memcpy(out, out - dstStride, (size_t)dstWidth * 4);
+            continue;
+        }
+
+        const int* in = (const int*)(src + (size_t)mYNearest[y] * srcStride);
+        int* outPixels = (int*)out;
+
+        int x = 0;
+        for (; x + 4 <= dstWidth; x += 4)
+        {
+            __m128i pixels = _mm_set_epi32(in[xIndex[x + 3]], in[xIndex[x + 2]],
+                in[xIndex[x + 1]], in[xIndex[x]]);
+            _mm_storeu_si128((__m128i*)(outPixels + x), pixels);
+        }
+
+        for (; x < dstWidth; x++)
+        {
+            outPixels[x] = in[xIndex[x]];
+        }
+    }
+}
+
+
+/**
+ * Bilinear scale of a range of destination rows.
+ *
+ * Each destination row first blends its two source rows into a row of
+ * 16 bit channels, then blends neighboring columns of that row two
+ * destination pixels at a time.
+ *
+ * \param y0 First destination row
+ * \param y1 One past the last destination row
+ * \param src First byte of the source frame
+ * \param srcWidth Source width in pixels
+ * \param srcStride Bytes between source rows
+ * \param dst First byte of the destination area
+ * \param dstWidth Destination width in pixels
+ * \param dstStride Bytes between destination rows
+ */
+void CFrameScaler::BilinearRows(int y0, int y1, const unsigned char* src, int srcWidth, int srcStride,
+    unsigned char* dst, int dstWidth, int dstStride)
+{
+    // One blended source row per thread, reused from frame to frame
+    thread_local vector<short> blended;
+    blended.resize((size_t)srcWidth * 4 + 8);
+    short* row = blended.data();
+
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int y = y0; y < y1; y++)
+    {
+        const unsigned char* a = src + (size_t)mYIndex[y] * srcStride;
+        const unsigned char* b = a + srcStride;
+        short fy = mYWeight[y];
+
+        //
+        // Vertical pass, two source pixels at a time
+        //
+        __m128i wy = _mm_set1_epi16(fy);
+        int i = 0;
+        for (; i + 2 <= srcWidth; i += 2)
+        {
+            __m128i pa = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(a + i * 4)), zero);
+            __m128i pb = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(b + i * 4)), zero);
+            __m128i d = _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(pb, pa), wy), WeightShift);
+            _mm_storeu_si128((__m128i*)(row + i * 4), _mm_add_epi16(pa, d));
+        }
+
+        for (; i < srcWidth; i++)
+        {
+            for (int c = 0; c < 4; c++)
+            {
+                int ca = a[i * 4 + c];
+                int cb = b[i * 4 + c];
+                row[i * 4 + c] = (short)(ca + (((cb - ca) * fy) >> WeightShift));
+            }
+        }
+
+        //
+        // Horizontal pass, two destination pixels at a time
+        //
+        unsigned char* out = dst + (size_t)y * dstStride;
+        int x = 0;
+        for (; x + 2 <= dstWidth; x += 2)
+        {
+            int i0 = mXIndex[x] * 4;
+            int i1 = mXIndex[x + 1] * 4;
+            short w0 = mXWeight[x];
+            short w1 = mXWeight[x + 1];
+
+            __m128i left = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(row + i0)),
+                _mm_loadl_epi64((const __m128i*)(row + i1)));
+            __m128i right = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(row + i0 + 4)),
+                _mm_loadl_epi64((const __m128i*)(row + i1 + 4)));
+            __m128i wx = _mm_set_epi16(w1, w1, w1, w1, w0, w0, w0, w0);
+
+            __m128i d = _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(right, left), wx), WeightShift);
+            __m128i result = _mm_add_epi16(left, d);
+            _mm_storel_epi64((__m128i*)(out + x * 4), _mm_packus_epi16(result, result));
+        }
+
+        for (; x < dstWidth; x++)
+        {
+            int i0 = mXIndex[x] * 4;
+            int w = mXWeight[x];
+            for (int c = 0; c < 4; c++)
+            {
+                int l = row[i0 + c];
+                int r = row[i0 + 4 + c];
+                out[x * 4 + c] = (unsigned char)(l + (((r - l) * w) >> WeightShift));
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * \file FrameScaler.h
+ *
+ * \author Michael Dittman
+ *
+ * Scales a 32-bit frame into a larger or smaller frame.
+ */
+
+#pragma once
+
+#include <vector>
+#include "ThreadPool.h"
+
+
+/**
+ * Scales a 32-bit frame into a larger or smaller frame.
+ *
+ * Both filters use SSE2 and the rows of the destination are
+ * split across the threads of a thread pool.
+ */
+class CFrameScaler
+{
+public:
+    /// Filters the scaler can use
+    enum Filter { Nearest, Bilinear };
+
+    /// Default constructor (disabled)
+    CFrameScaler() = delete;
+
+    /// Copy constructor (disabled)
+    CFrameScaler(const CFrameScaler&) = delete;
+
+    CFrameScaler(CThreadPool* pool);
+
+    /** Set the filter to scale with
+     * \param filter New filter */
+    void SetFilter(Filter filter) { mFilter = filter; }
+
+    /** Get the filter we scale with
+     * \returns Current filter */
+    Filter GetFilter() const { return mFilter; }
+
+    void Scale(const unsigned char* src, int srcWidth, int srcHeight, int srcStride,
+        unsigned char* dst, int dstWidth, int dstHeight, int dstStride);
+
+private:
+    void BuildTables(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+
+    void NearestRows(int y0, int y1, const unsigned char* src, int srcStride,
+        unsigned char* dst, int dstWidth, int dstStride);
+
+    void BilinearRows(int y0, int y1, const unsigned char* src, int srcWidth, int srcStride,
+        unsigned char* dst, int dstWidth, int dstStride);
+
+    /// Thread pool the rows are split over
+    CThreadPool* mPool;
+
+    /// Filter to scale with
+    Filter mFilter = Bilinear;
+
+    /// Sizes the tables below were built for
+    int mTableSize[4] = { 0, 0, 0, 0 };
+
+    /// Source column for each destination column
+    std::vector<int> mXIndex;
+
+    /// Weight of the column right of mXIndex (0-128)
+    std::vector<short> mXWeight;
+
+    /// Source row for each destination row
+    std::vector<int> mYIndex;
+
+    /// Weight of the row below mYIndex (0-128)
+    std::vector<short> mYWeight;
+
+    /// Source column for each destination column when not filtering
+    std::vector<int> mXNearest;
+
+    /// Source row for each destination row when not filtering
+    std::vector<int> mYNearest;
+};
+
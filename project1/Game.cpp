@@ -15,6 +15,7 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <sstream>
 #include "Cargo.h"
 #include "Car.h"
 #include "IsCargoVisitor.h"
@@ -24,15 +25,17 @@
 #include "IsSketchyVisitor.h"
 #include "ControlPanel.h"
 #include "DecorTypeVisitor.h"
-#include "CargoEatenVisitor.h"
+#include "SketchyBoat.h"
+#include "LaneVisitor.h"
 
 using namespace Gdiplus;
 using namespace std;
 using namespace xmlnode;
 
 
-/// TODO: change this so that images are only loaded once
-map<wstring, wstring> imageMap; //< Map holding the image names associated with IDs
+/// Image filenames by type ID. Only the names are kept here;
+/// the bitmaps are loaded once and shared by LoadImage in Level.cpp.
+map<wstring, wstring> imageMap;
 
 /// Number of pixels wide and tall a tile is.
 const double TileToPixels = 64;
@@ -40,6 +43,18 @@ const double TileToPixels = 64;
 /// Max level of game
 const int MaxLevel = 3;
 
+/// Rows past the top and bottom of the screen whose vehicles keep moving
+const int LiveMargin = 1;
+
+/// Virtual pixels up from the bottom of a level the hero starts at
+const double HeroStartAbove = 96;
+
+/// Rows the camera keeps below the hero in endless mode
+const int EndlessFollowRows = 5;
+
+/// Rows a second the camera scrolls to catch up with the hero in endless mode
+const double EndlessScrollSpeed = 6;
+
 /**
  * Game constructor
  */
@@ -66,10 +81,43 @@ void CGame::SetTime(double time)
  */
 void CGame::OnDraw(Gdiplus::Graphics* graphics, int width, int height)
 {
-    // Fill the background with black
-    SolidBrush brush(Color::Black);
-    graphics->FillRectangle(&brush, 0, 0, width, height);
-    
+    // A level loaded since the last draw may have freed the bitmaps sprites were made from
+    if (mDrawnLoads != mLoads)
+    {
+        ClearSprites();
+        mDrawnLoads = mLoads;
+    }
+
+    mRenderList.Clear();
+    BuildFrame(&mRenderList);
+    Present(graphics, width, height, mRenderList);
+}
+
+
+/**
+ * Record everything in a frame, the level and the control panel
+ * \param list Render list to record into
+ */
+void CGame::BuildFrame(CRenderList* list)
+{
+    BuildRenderList(list);
+    DrawControlPanel(list);
+}
+
+
+/**
+ * Draw a recorded frame scaled to fit the window.
+ *
+ * Only reads the list and the presentation settings, so the frame
+ * can have been recorded on another thread.
+ *
+ * \param graphics The GDI+ graphics context to draw on
+ * \param width Width of the client window
+ * \param height Height of the client window
+ * \param list Frame to draw
+ */
+void CGame::Present(Gdiplus::Graphics* graphics, int width, int height, const CRenderList& list)
+{
     //
     // Automatic Scaling
     //
@@ -84,22 +132,374 @@ void CGame::OnDraw(Gdiplus::Graphics* graphics, int width, int height)
     // Ensure it is centered vertically
     mYOffset = (float)((height - Height * mScale) / 2);
 
+    if (mFrameBufferEnabled)
+    {
+        // Draw at native size, then scale the whole frame once
+        if (mFrameBuffer == nullptr)
+        {
+            mFrameBuffer = make_unique<CVirtualFrameBuffer>(Width, Height);
+            mFrameBuffer->SetFilter(mFrameBufferFilter);
+            mFrameBuffer->SetPalettizedSprites(mPalettizedSprites);
+        }
+
+        if (mSoftwareRasterEnabled)
+        {
+            // Rasterize everything in bands on the thread pool
+            mFrameBuffer->Rasterize(list);
+        }
+        else
+        {
+            DrawVirtual(mFrameBuffer->Begin(), list);
+        }
+
+        mFrameBuffer->Present(graphics, width, height);
+        return;
+    }
+
+    // Fill the background with black
+    SolidBrush brush(Color::Black);
+    graphics->FillRectangle(&brush, 0, 0, width, height);
+
     graphics->TranslateTransform(mXOffset, mYOffset);
     graphics->ScaleTransform(mScale, mScale);
 
-    
-    // From here on you are drawing virtual pixels
+    DrawVirtual(graphics, list);
+}
 
-    // Iterate through all of the items in mItems
-    // and draw them.
-    for (auto item : mItems)
+
+/**
+ * Record the drawing of every item into a render list
+ * \param list Render list to record into
+ */
+void CGame::BuildRenderList(CRenderList* list)
+{
+    // Endless mode draws its own lanes instead of the level's
+    if (mEndless != nullptr)
     {
-        // For every item, draw the item
-        item->Draw(graphics);
+        list->SetOrigin(0, (float)-mCameraY);
+        mEndless->Draw(list);
+        list->SetOrigin(0, 0);
+        return;
     }
 
-    DrawControlPanel(graphics);
-    
+    // A level loaded from a file on its own isn't sorted into rows
+    if (mRowItems.empty())
+    {
+        for (auto item : mItems)
+        {
+            item->Draw(list);
+        }
+        return;
+    }
+
+    // Items record where they are in the level and the camera moves
+    // it all up. Only the items over the rows on the screen are
+    // recorded, in the order they were added so they overlap the way
+    // they always have.
+    list->SetOrigin(0, (float)-mCameraY);
+
+    mFrame++;
+    mFrameItems = mFloatingItems;
+    auto visible = GetNearRows(0);
+    for (int row = visible.first; row < visible.second; row++)
+    {
+        for (int index : mRowItems[row])
+        {
+            if (mRecordedFrame[index] != mFrame)
+            {
+                mRecordedFrame[index] = mFrame;
+                mFrameItems.push_back(index);
+            }
+        }
+    }
+
+    sort(mFrameItems.begin(), mFrameItems.end());
+    for (int index : mFrameItems)
+    {
+        mItems[index]->Draw(list);
+    }
+
+    // The hint plans a screen of lanes
+    if (mPathHint != nullptr && mRows <= CRuleTable::Rows)
+    {
+        mPathHint->Draw(list);
+    }
+
+    list->SetOrigin(0, 0);
+}
+
+
+/**
+ * Get the height of the current level
+ * \returns Height in virtual pixels, a screen's worth or more
+ */
+double CGame::GetLevelHeight() const
+{
+    return mRows * TileToPixels;
+}
+
+
+/**
+ * Move the camera so the hero is in the middle of the screen,
+ * unless that would show past the top or bottom of the level.
+ *
+ * Endless mode has no top, so the camera keeps a few rows below the
+ * hero instead. It scrolls up after the hero at a limited speed and
+ * never goes back down.
+ *
+ * \param elapsed The time since the last update
+ */
+void CGame::UpdateCamera(double elapsed)
+{
+    if (mEndless != nullptr)
+    {
+        double target = mEndless->GetHeroY() + TileToPixels / 2 + EndlessFollowRows * TileToPixels - Height;
+        if (target < mCameraY)
+        {
+            mCameraY = max(target, mCameraY - EndlessScrollSpeed * TileToPixels * elapsed);
+        }
+        return;
+    }
+
+    double bottom = GetLevelHeight() - Height;
+    mCameraY = mHero == nullptr ? 0 : min(max(mHero->GetY() - Height / 2.0, 0.0), bottom);
+}
+
+
+/**
+ * Get the rows that are on the screen, and some past it
+ * \param margin Rows past the top and bottom of the screen to add
+ * \returns First row and one past the last, within the level
+ */
+std::pair<int, int> CGame::GetNearRows(int margin) const
+{
+    int first = (int)floor(mCameraY / TileToPixels) - margin;
+    int end = (int)ceil((mCameraY + Height) / TileToPixels) + margin;
+    return make_pair(max(first, 0), min(end, mRows));
+}
+
+
+/**
+ * Move the vehicles of the rows near the screen.
+ *
+ * Rows that were near the screen last tick move on by the time since
+ * then. A row that has just come near has its vehicles moved straight
+ * to the level time, which is where they would be if they had been
+ * moving all along. Rows far from the screen are left where they were.
+ *
+ * \param elapsed The time since the last update
+ */
+void CGame::UpdateLiveRows(double elapsed)
+{
+    auto live = GetNearRows(LiveMargin);
+    for (int row = live.first; row < live.second; row++)
+    {
+        bool wasLive = row >= mLiveFirst && row < mLiveEnd;
+        for (auto vehicle : mLanes[row].mVehicles)
+        {
+            vehicle->Update(wasLive ? elapsed : mLevelTime - vehicle->GetTime());
+        }
+    }
+
+    mLiveFirst = live.first;
+    mLiveEnd = live.second;
+}
+
+
+/**
+ * Turn the safe path hint on or off
+ * \param enabled True to plan a safe way across and draw it over the level
+ */
+void CGame::SetPathHintEnabled(bool enabled)
+{
+    if (!enabled)
+    {
+        mPathHint = nullptr;
+    }
+    else if (mPathHint == nullptr && mHero != nullptr)
+    {
+        mPathHint = make_unique<CPathHint>(this);
+    }
+}
+
+
+/**
+ * Plan the safe path hint for this frame, if it is on
+ */
+void CGame::UpdatePathHint()
+{
+    if (mPathHint != nullptr && mEndless == nullptr && mRows <= CRuleTable::Rows)
+    {
+        mPathHint->Update();
+    }
+}
+
+
+/**
+ * Turn endless mode on or off.
+ *
+ * Endless mode uses the vehicles, tiles and hero of the last level,
+ * which is loaded under it. Loading any level turns it off.
+ *
+ * \param enabled True to start endless mode, false to go back to the level
+ * \param seed Seed to make endless mode's rows from
+ */
+void CGame::SetEndless(bool enabled, unsigned seed)
+{
+    Load(enabled ? MaxLevel : GetLevelNumber());
+    if (enabled)
+    {
+        mEndless = make_unique<CEndless>(this, seed);
+        mCameraY = 0;
+    }
+}
+
+
+/**
+ * Handle updates for animation in endless mode
+ * \param elapsed The time since the last update
+ */
+void CGame::UpdateEndless(double elapsed)
+{
+    mLevelTime += elapsed;
+    mLastElapsed = elapsed;
+
+    // Once the hero has lost the lanes keep moving, but nothing else can lose
+    UpdateCamera(elapsed);
+    CRuleTable::Loss loss = mEndless->Update(elapsed);
+    if ((loss == CRuleTable::HitByCar && mRoadCheatEnabled) || (loss == CRuleTable::FellInRiver && mRiverCheatEnabled))
+    {
+        loss = CRuleTable::NoLoss;
+    }
+
+    if (!mGameOver && loss != CRuleTable::NoLoss)
+    {
+        mGameOver = true;
+        mGameLossCondition = loss;
+        if (loss == CRuleTable::HitByCar)
+        {
+            mControlPanel->SetSpartyCar(mEndless->GetHitBy());
+        }
+    }
+
+    if (mControlPanel->GetTimerTime() > 0)
+    {
+        mGetReady = false;
+    }
+
+    // Start over with the next rows once the loss has been shown
+    if (mGameOver)
+    {
+        mTimeToSwitchLevel -= elapsed;
+        if (mTimeToSwitchLevel <= 0.0)
+        {
+            RestartEndless();
+        }
+    }
+}
+
+
+/**
+ * Start endless mode over with the next seed.
+ *
+ * The level under it is kept, so endless mode is reset in place
+ * rather than made again, and only the state a new level would clear
+ * is put back.
+ */
+void CGame::RestartEndless()
+{
+    mGameLossCondition = CRuleTable::NoLoss;
+    mGameOver = false;
+    mGetReady = true;
+    mTimeToSwitchLevel = 3.0;
+    mLevelTime = 0;
+    mLastElapsed = 0;
+    mCameraY = 0;
+    mControlPanel->Restart();
+
+    mEndless->Reset(mEndless->GetSeed() + 1);
+}
+
+
+/**
+ * Draw a frame's render list in virtual pixels
+ * \param graphics The GDI+ graphics context to draw on
+ * \param list Frame to draw
+ */
+void CGame::DrawVirtual(Gdiplus::Graphics* graphics, const CRenderList& list)
+{
+    list.Render(graphics);
+}
+
+
+/**
+ * Turn the virtual framebuffer presentation mode on or off
+ * \param enabled True to draw into the framebuffer and scale it once per frame
+ */
+void CGame::SetFrameBufferEnabled(bool enabled)
+{
+    mFrameBufferEnabled = enabled;
+
+    // Don't hang on to the frames when we aren't using them
+    if (!enabled)
+    {
+        mFrameBuffer = nullptr;
+    }
+}
+
+
+/**
+ * Forget the sprites the software rasterizer made from the bitmaps
+ * drawn so far. Call when those bitmaps are freed, as a new bitmap
+ * can be given a freed one's address.
+ */
+void CGame::ClearSprites()
+{
+    if (mFrameBuffer != nullptr)
+    {
+        mFrameBuffer->ClearSprites();
+    }
+}
+
+
+/**
+ * Set the filter the virtual framebuffer is scaled with
+ * \param filter Filter to scale with
+ */
+void CGame::SetFrameBufferFilter(CFrameScaler::Filter filter)
+{
+    mFrameBufferFilter = filter;
+
+    if (mFrameBuffer != nullptr)
+    {
+        mFrameBuffer->SetFilter(filter);
+    }
+}
+
+
+/**
+ * Set if the software rasterizer stores sprites as 8-bit palette
+ * indices when they have 256 colors or fewer
+ * \param enabled True to palettize sprites
+ */
+void CGame::SetPalettizedSprites(bool enabled)
+{
+    mPalettizedSprites = enabled;
+
+    if (mFrameBuffer != nullptr)
+    {
+        mFrameBuffer->SetPalettizedSprites(enabled);
+    }
+}
+
+
+/**
+ * Get the number of the level being played
+ * \returns Level number
+ */
+int CGame::GetLevelNumber()
+{
+    return mControlPanel->GetLevelNumber();
 }
 
 
@@ -274,7 +674,7 @@ void CGame::Clear()
     mControlPanel->Clear();
 
     // Set condition
-    mGameLossCondition = -1;
+    mGameLossCondition = CRuleTable::NoLoss;
 
     // Reset the game loss state
     mGameOver = false;
@@ -284,6 +684,32 @@ void CGame::Clear()
 
     // Reset timer once game over to load a level
     mTimeToSwitchLevel = 3.0;
+
+    mLevelTime = 0;
+    mLastElapsed = 0;
+    mOccupancy = nullptr;
+
+    mRuleTable = nullptr;
+    mLanes.clear();
+
+    mCargoPuzzle = nullptr;
+    mTopCargo = 0;
+    mBottomCargo = 0;
+    mEatenCargo = -1;
+    mEatingCargo = -1;
+
+    mRows = CRuleTable::Rows;
+    mCameraY = 0;
+    mLiveFirst = 0;
+    mLiveEnd = 0;
+    mRowItems.clear();
+    mFloatingItems.clear();
+    mCargoItems.clear();
+    mRecordedFrame.clear();
+    mFrame = 0;
+
+    mEndless = nullptr;
+    mLoads++;
 }
 
 
@@ -294,65 +720,283 @@ void CGame::Clear()
  */
 void CGame::moveHero(UINT nChar)
 {
-    bool validKeyPress = false;
-    // This works but I don't like that it uses a number not the char
-
     // Call the appropriate move function based on what key was hit
+    switch (nChar)
+    {
+        // Move hero backward
+    case 'D':
+    case VK_DOWN:
+        Move(CReplay::Backward);
+        break;
+
+        // Move hero forward 
+    case 'E':
+    case VK_UP:
+        Move(CReplay::Forward);
+        break;
+
+        // Move the hero right
+    case 'F':
+    case VK_RIGHT:
+        Move(CReplay::Right);
+        break;
+
+        // Move the hero left
+    case 'S':
+    case VK_LEFT:
+        Move(CReplay::Left);
+        break;
+    }
+}
+
+
+/**
+ * Move the hero a tile, in endless mode or in the level
+ * \param action Forward, Backward, Left or Right
+ */
+void CGame::Move(CReplay::Action action)
+{
+    // Endless mode moves its own hero through its own lanes
+    if (mEndless != nullptr)
+    {
+        if (!mGameOver && mControlPanel->GetTimerTime() > 0)
+        {
+            mEndless->Move(action);
+        }
+        return;
+    }
 
-    if (!mGameOver && !mGameWon && (mControlPanel->GetTimerTime() > 0))
+    if (mGameOver || mGameWon || mControlPanel->GetTimerTime() <= 0)
     {
-        
-        switch (nChar)
+        return;
+    }
+
+    bool moved = false;
+    switch (action)
+    {
+    case CReplay::Backward:
+        mHero->moveBackward();
+        moved = true;
+        break;
+
+    case CReplay::Forward:
+        mHero->moveForward();
+        moved = true;
+        break;
+
+    case CReplay::Right:
+        // Hero can't move right when on boats
+        if (!mHero->GetOnBoat())
         {
+            mHero->moveRight();
+            moved = true;
+        }
+        break;
 
-            // Move hero backward
-        case 68:
-        case 40:
-            mHero->moveBackward();
-            validKeyPress = true;
-            break;
+    case CReplay::Left:
+        // Hero can't move left when on boats
+        if (!mHero->GetOnBoat())
+        {
+            mHero->moveLeft();
+            moved = true;
+        }
+        break;
 
-            // Move hero forward 
-        case 69:
-        case 38:
-            mHero->moveForward();
-            validKeyPress = true;
-            break;
+    default:
+        break;
+    }
 
-            // Move the hero right
-        case 70:
-        case 39:
-            // Hero can't move right when on boats
-            if (!mHero->GetOnBoat())
-            {
-                mHero->moveRight();
-                validKeyPress = true;
-            }
-            break;
+    // The action actually moved hero, check if he stepped on a boat
+    if (moved)
+    {
+        mReplay.Add(mLevelTime, action);
+        BoatTest();
+    }
+}
+
+/**
+ * Pick up or put down a cargo item the player clicked on
+ * \param cargo Cargo clicked on, or nullptr if the click missed
+ */
+void CGame::ClickCargo(CCargo* cargo)
+{
+    // Endless mode has no cargo to carry
+    if (cargo == nullptr || mGetReady || mEndless != nullptr)
+    {
+        return;
+    }
+
+    // Cargo is recorded by where it is in the level, and
+    // cargo that isn't in the level can't be clicked
+    int index = 0;
+    for (CCargo* found = GetCargo(0); found != cargo; found = GetCargo(++index))
+    {
+        if (found == nullptr)
+        {
+            return;
+        }
+    }
+    mReplay.Add(mLevelTime, CReplay::Cargo, index);
+
+    if (cargo->GetCarryStatus())
+    {
+        cargo->Release();
+    }
+    else
+    {
+        cargo->PickUp();
+    }
+
+    UpdateCargoBanks();
+}
+
+
+/**
+ * Work out which cargo is on each bank.
+ *
+ * Cargo only changes banks when it is clicked on, so this is done then
+ * instead of every update.
+ */
+void CGame::UpdateCargoBanks()
+{
+    mTopCargo = 0;
+    mBottomCargo = 0;
+    for (int i = 0; i < (int)mCargoItems.size() && i < CCargoPuzzle::MaxCargo; i++)
+    {
+        CCargo* cargo = mCargoItems[i];
+        if (cargo->GetCarryStatus())
+        {
+            continue;
+        }
+
+        if (cargo->GetY() < GetLevelHeight() / 2)
+        {
+            mTopCargo |= 1 << i;
+        }
+        else
+        {
+            mBottomCargo |= 1 << i;
+        }
+    }
+}
+
+
+/**
+ * Get a cargo item by where it is in the level
+ * \param index Index of the cargo, counting in the order the items were added
+ * \returns Cargo item or nullptr if there are not that many
+ */
+CCargo* CGame::GetCargo(int index)
+{
+    for (auto item : mItems)
+    {
+        CIsCargoVisitor visitor;
+        item->Accept(&visitor);
+        if (visitor.GetIsCargo() && index-- == 0)
+        {
+            return visitor.GetCargo();
+        }
+    }
+
+    return nullptr;
+}
+
+
+/**
+ * Do what a player input does
+ * \param input Input to perform, as recorded in a replay
+ */
+void CGame::Perform(const CReplay::Input& input)
+{
+    if (input.mAction == CReplay::Cargo)
+    {
+        ClickCargo(GetCargo(input.mCargo));
+    }
+    else
+    {
+        Move(input.mAction);
+    }
+}
+
+
+/**
+ * Load every level file in a directory into the level vector
+ * \param directory Directory the levels are in, ending with a separator
+ * \param count Number of levels, named level0.xml and up
+ */
+void CGame::LoadLevels(const std::wstring& directory, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        wstring filename = directory + L"level" + to_wstring(i) + L".xml";
+        shared_ptr<CLevel> level = make_shared<CLevel>(this);
+        level->Load(filename);
+        Add(level);
+    }
+}
+
+
+/**
+ * Check the occupancy tables against where the vehicles are now.
+ *
+ * Every tile a vehicle covers part of has to be touched in its lane's
+ * table at the current time, or the tables could let a car through.
+ */
+void CGame::CheckOccupancy()
+{
+    if (mOccupancy == nullptr)
+    {
+        return;
+    }
+
+    // Allow for rounding where a vehicle's edge is right on a tile edge
+    const double Slack = 1e-6;
+
+    // Vehicles far from the screen aren't kept where they are
+    for (int row = mLiveFirst; row < mLiveEnd; row++)
+    {
+        for (auto vehicle : mLanes[row].mVehicles)
+        {
+            double half = vehicle->GetWidth() / 2;
+            uint16_t columns = COccupancy::GetColumns(vehicle->GetX() - half + Slack, vehicle->GetX() + half - Slack);
 
-            // Move the hero left
-        case 83:
-        case 37:
-            // Hero can't move left when on boats
-            if (!mHero->GetOnBoat())
+            mOccupancyChecks++;
+            if ((mOccupancy->GetTouched(vehicle->GetRow(), mLevelTime) & columns) != columns)
             {
-                mHero->moveLeft();
-                validKeyPress = true;
+                mOccupancyMisses++;
             }
-            break;
-
         }
+    }
+}
 
-        // Key press actually moved hero, check if he stepped on a boat
-        if (validKeyPress)
+
+/**
+ * Make a report of the size of each level's occupancy tables and
+ * how the checks of them have gone.
+ * \returns Report text
+ */
+std::wstring CGame::GetOccupancyReport()
+{
+    wstringstream report;
+    report << L"Occupancy tables, " << COccupancy::BucketTime * 1000 << L" ms buckets" << endl << endl;
+
+    for (int i = 0; i < (int)mLevels.size(); i++)
+    {
+        auto occupancy = mLevels[i]->GetOccupancy();
+        if (occupancy == nullptr)
         {
-            BoatTest();
+            continue;
         }
 
+        report << L"Level " << i << L": " << occupancy->GetLaneCount() << L" lanes, "
+            << occupancy->GetBucketCount() << L" buckets, " << occupancy->GetBytes() << L" bytes" << endl;
     }
 
+    report << endl << L"Checks: " << mOccupancyChecks << L", misses: " << mOccupancyMisses;
+    return report.str();
 }
 
+
 /**
 * Handle an item node.
 * \param node Pointer to XML node we are handling
@@ -395,56 +1039,33 @@ void CGame::XmlItem(const std::shared_ptr<xmlnode::CXmlNode>& node)
  */
 void CGame::Update(double elapsed)
 {
-    // Check if we have collided with the edge of the playing area
-    if (mHero->GetX() > Width - 264.0 || mHero->GetX() < 0)
+    if (mEndless != nullptr)
     {
-        // lost because hero drifted off of game bounds
-        mGameOver = true;
-
-        // 4 for drifting off screen
-        mGameLossCondition = 4;
+        UpdateEndless(elapsed);
+        return;
     }
 
-    for (auto item : mItems)
-    {
-        CIsVehicleVisitor vehicleVisitor;
-        item->Accept(&vehicleVisitor);
-        if (vehicleVisitor.GetIsVehicle())
-        {
-            vehicleVisitor.GetVehicle()->Update(elapsed);
-        }
+    mLevelTime += elapsed;
+    mLastElapsed = elapsed;
 
-        CIsCargoVisitor cargoVisitor;
-        item->Accept(&cargoVisitor);
-        if (cargoVisitor.GetIsCargo())
-        {
-            cargoVisitor.GetCargo()->Update(elapsed, mHero);
-        }
+    // The camera follows the hero, and only the vehicles near it move
+    UpdateCamera(elapsed);
+    UpdateLiveRows(elapsed);
+
+    for (auto cargo : mCargoItems)
+    {
+        cargo->Update(elapsed, mHero);
     }
     // Update the hero in case he's on a boat
     mHero->Update(elapsed);
 
-    // Don't need to check for car/river collisions when on a boat
-    if (!mHero->GetOnBoat())
+    if (mOccupancyCheck)
     {
-        CollisionTest(mHero->GetX(), mHero->GetY());
+        CheckOccupancy();
     }
-    else
-    {
-        // visit and find whatever boat the hero is on
-        // if its a sketchy boat, set mOnSketchy to true
 
-    }
-
-    CCargoEatenVisitor eatenVisitor(mHero);
-    Accept(&eatenVisitor);
-    if (eatenVisitor.GetSmallEaten() || eatenVisitor.GetMediumEaten())
-    {
-        mGameOver = true;
-
-        // Temporary
-        mGameLossCondition = 3;
-    }
+    // Everything has moved, see if any of it loses the level
+    CheckRules();
 
     if (mControlPanel->GetTimerTime() > 0)
     {
@@ -474,6 +1095,65 @@ void CGame::Update(double elapsed)
     }
 }
 
+/**
+ * Move every vehicle straight to where it is at a time since the
+ * level started.
+ *
+ * A hero riding a boat goes along with it. Nothing else is updated
+ * and no collisions are tested, so this is for fast forwarding a
+ * level, not for playing it.
+ *
+ * \param time Time in seconds since the level started
+ */
+void CGame::Seek(double time)
+{
+    double elapsed = time - mLevelTime;
+    mLevelTime = time;
+
+    for (auto item : mItems)
+    {
+        CIsVehicleVisitor visitor;
+        item->Accept(&visitor);
+        if (visitor.GetIsVehicle())
+        {
+            visitor.GetVehicle()->SetTime(time);
+        }
+    }
+
+    if (mHero != nullptr && mHero->GetOnBoat())
+    {
+        mHero->Update(elapsed);
+    }
+}
+
+
+/**
+ * Get where the vehicles in a lane are at a time since the level
+ * started, without moving them.
+ *
+ * \param row Row of tiles the lane is on, counting from the top
+ * \param time Time in seconds since the level started
+ * \returns Left and right edges of every vehicle in the lane, left to right
+ */
+std::vector<std::pair<double, double>> CGame::GetLaneState(int row, double time)
+{
+    vector<pair<double, double>> lane;
+
+    for (auto item : mItems)
+    {
+        CIsVehicleVisitor visitor;
+        item->Accept(&visitor);
+        if (visitor.GetIsVehicle() && visitor.GetVehicle()->GetRow() == row)
+        {
+            lane.push_back(visitor.GetVehicle()->GetExtentAt(time));
+        }
+    }
+
+    sort(lane.begin(), lane.end());
+    return lane;
+}
+
+
 /**
  * Loads level from level vector
  * 
@@ -501,39 +1181,102 @@ void CGame::Load(const int level)
 
     }
 
-    // number of cargo
-    int cargoNumber = 0;
+    // Load the name of the hero into the control panel
+    mControlPanel->SetHeroName(mHero->GetHeroName());
 
-    // Cargo Visitor 
-    CIsCargoVisitor visitor;
+    // Set the location of the hero, on the bottom bank
+    mRows = mLevels[level]->GetRows();
+    mHero->SetLocation(480, GetLevelHeight() - HeroStartAbove);
+
+    // Set this control panel to the level
+    mControlPanel->SetLevel(mLevels[level], level);
+
+    // Make sure the mGameWon variable is set to false
+    mGameWon = false;
 
-    // Load the names of the cargo into the control panel
-    for (auto i = mItems.rbegin(); i != mItems.rend(); i++) // Iterate through the items and detemrine if they are cargo
+    // Start recording the inputs made on this level
+    mReplay.Clear(level);
+
+    mOccupancy = mLevels[level]->GetOccupancy();
+
+    mCargoPuzzle = mLevels[level]->GetCargoPuzzle();
+
+    // The rules only look at the vehicles on the hero's row
+    mRuleTable = mLevels[level]->GetRuleTable();
+    mLanes.assign(mRows, Lane());
+    CLaneVisitor lanes;
+    Accept(&lanes);
+    for (auto car : lanes.GetCars())
     {
-        // Accept the visitor
-        (*i)->Accept(&visitor);
+        if (car->GetRow() >= 0 && car->GetRow() < mRows)
+        {
+            mLanes[car->GetRow()].mCars.push_back(car);
+        }
+    }
 
-        // If the item is cargo
-        if (visitor.GetIsCargo() && cargoNumber < 3)
+    for (auto boat : lanes.GetBoats())
+    {
+        CIsSketchyVisitor visitor;
+        boat->Accept(&visitor);
+        if (visitor.GetIsSketchy() && boat->GetRow() >= 0 && boat->GetRow() < mRows)
         {
+            mLanes[boat->GetRow()].mSketchy.push_back(visitor.GetSketchy());
+        }
+    }
 
-            // Push back the cargo item name
-            mControlPanel->SetCargoItem(visitor.GetCargo()->GetName());
-            cargoNumber++;
+    // Items that stay on their rows are only drawn and moved when their
+    // rows are near the screen, so they are sorted into rows once here
+    mRowItems.assign(mRows, vector<int>());
+    for (int i = 0; i < (int)mItems.size(); i++)
+    {
+        CIsCargoVisitor cargo;
+        mItems[i]->Accept(&cargo);
+        if (cargo.GetIsCargo() || mItems[i] == mHero)
+        {
+            if (cargo.GetIsCargo())
+            {
+                mCargoItems.push_back(cargo.GetCargo());
+            }
+            mFloatingItems.push_back(i);
+            continue;
+        }
 
+        CIsVehicleVisitor vehicle;
+        mItems[i]->Accept(&vehicle);
+        if (vehicle.GetIsVehicle() && vehicle.GetVehicle()->GetRow() >= 0 && vehicle.GetVehicle()->GetRow() < mRows)
+        {
+            mLanes[vehicle.GetVehicle()->GetRow()].mVehicles.push_back(vehicle.GetVehicle());
+        }
+
+        auto extent = mItems[i]->GetVerticalExtent();
+        int first = max((int)floor(extent.first / TileToPixels), 0);
+        int end = min((int)ceil(extent.second / TileToPixels), mRows);
+        for (int row = first; row < end; row++)
+        {
+            mRowItems[row].push_back(i);
         }
     }
-    // Load the name of the hero into the control panel
-    mControlPanel->SetHeroName(mHero->GetHeroName());
+    mRecordedFrame.assign(mItems.size(), 0);
 
-    // Set the location of the hero
-    mHero->SetLocation(480, 928);
+    // Load the names of the cargo into the control panel, as many as the level has
+    for (auto cargo = mCargoItems.rbegin(); cargo != mCargoItems.rend(); cargo++)
+    {
+        mControlPanel->SetCargoItem((*cargo)->GetName());
+    }
 
-    // Set this control panel to the level
-    mControlPanel->SetLevel(mLevels[level], level);
+    // Cargo eaten is looked up by which cargo is on each bank
+    UpdateCargoBanks();
 
-    // Make sure the mGameWon variable is set to false
-    mGameWon = false;
+    UpdateCamera(0);
+    auto live = GetNearRows(LiveMargin);
+    mLiveFirst = live.first;
+    mLiveEnd = live.second;
+
+    // The hint's lanes are the old level's vehicles
+    if (mPathHint != nullptr)
+    {
+        mPathHint->Reset();
+    }
 
     return;
 }
@@ -564,13 +1307,14 @@ void CGame::Accept(CItemVisitor* visitor)
 
 /**  Test an x,y click location to see if it clicked
 * on some cargo item in the game.
-* \param x X location
-* \param y Y location
+* \param x X location on the screen in virtual pixels
+* \param y Y location on the screen in virtual pixels, which the camera moves down the level
 * \returns Pointer to cargo item we clicked on or nullptr if none.
 */
 CCargo* CGame::HitTest(double x, double y)
 {
     CIsCargoVisitor visitor;
+    y += mCameraY;
 
     for (auto i = mItems.rbegin(); i != mItems.rend(); i++)
     {
@@ -599,57 +1343,138 @@ void CGame::UpdateControlPanel(double elapsed)
 
 /**
  * Draw the control panel
- * \param graphics The GDI+ graphics context to draw on
+ * \param list Render list to record the drawing into
  */
-void CGame::DrawControlPanel(Gdiplus::Graphics* graphics)
+void CGame::DrawControlPanel(CRenderList* list)
 {
 
-    mControlPanel->Draw(graphics);
+    mControlPanel->Draw(list);
 
 }
 
 
 /**
- * Collision test for Hero
- * \param x The x coordinate for the hero
- * \param y The y coordinate for the hero
+ * Check the current level's rules against where the hero is.
+ *
+ * The hazards of the hero's row are checked in the order the rule
+ * table has them, and the first one that applies loses the level.
+ * Once the level is lost nothing else can change how it was lost.
  */
-void CGame::CollisionTest(double x, double y)
+void CGame::CheckRules()
 {
-    CDecorTypeVisitor decorVisitor;
-    CIsCarVisitor visitor;
-
-    for (auto i = mItems.rbegin(); i != mItems.rend(); i++)
+    if (mGameOver || mRuleTable == nullptr)
     {
-        (*i)->Accept(&visitor);
+        return;
+    }
 
-        if (visitor.GetIsCar() && visitor.GetCar()->HitTest(x, y) && !mRoadCheatEnabled)
+    int row = (int)floor(mHero->GetY() / TileToPixels);
+    for (auto hazard : mRuleTable->GetHazards(row))
+    {
+        if (IsHazardHit(hazard, row))
         {
-
-            // Lost because a vehicle hit hero
             mGameOver = true;
+            mGameLossCondition = CRuleTable::GetLoss(hazard);
+            return;
+        }
+    }
+}
 
-            // 1 for getting hit by car
-            mGameLossCondition = 1;
 
-            mControlPanel->SetSpartyCar(visitor.GetId());
+/**
+ * Test if a hazard applies to the hero this update
+ * \param hazard Hazard to test
+ * \param row Row of tiles the hero is on
+ * \returns True if the hazard loses the level
+ */
+bool CGame::IsHazardHit(CRuleTable::Hazard hazard, int row)
+{
+    switch (hazard)
+    {
+    case CRuleTable::OffScreen:
+        return mHero->GetX() > GetHeroMaxX() || mHero->GetX() < 0;
 
+    case CRuleTable::Sinking:
+        // Only the boat the hero is on counts how long it has been ridden
+        for (auto boat : mLanes[row].mSketchy)
+        {
+            if (boat->GetTimeRidden() > CSketchyBoat::RideTime)
+            {
+                return true;
+            }
         }
+        return false;
 
-        (*i)->Accept(&decorVisitor);
+    case CRuleTable::Cars:
+        return !mHero->GetOnBoat() && !mRoadCheatEnabled && CarTest(row);
 
-        // Check if we are colliding with a river
-        if (decorVisitor.GetId() == L"r001" && decorVisitor.Decor()->HitTest(x, y) && !mRiverCheatEnabled)
+    case CRuleTable::Water:
+        return !mHero->GetOnBoat() && !mRiverCheatEnabled;
+
+    case CRuleTable::Eaten:
+    {
+        if (mCargoPuzzle == nullptr)
         {
-            // Lost because hero fell in river 
-            mGameOver = true;
+            return false;
+        }
 
-            // 2 for falling in river
-            mGameLossCondition = 2;
+        // Cargo is watched from the bank or the row next to it
+        double y = mHero->GetY();
+        CCargoPuzzle::Bank bank = y <= TileToPixels * 1.5 ? CCargoPuzzle::Top :
+            y >= GetLevelHeight() - TileToPixels * 1.5 ? CCargoPuzzle::Bottom : CCargoPuzzle::Away;
+        if (!mCargoPuzzle->IsEaten(mTopCargo, mBottomCargo, bank))
+        {
+            return false;
+        }
+
+        int unwatched = bank != CCargoPuzzle::Top && mCargoPuzzle->GetEaten(mTopCargo) >= 0 ? mTopCargo : mBottomCargo;
+        mEatenCargo = mCargoPuzzle->GetEaten(unwatched);
+        mEatingCargo = mCargoPuzzle->GetEater(unwatched);
+        return true;
+    }
+    }
+
+    return false;
+}
+
+
+/**
+ * Test if a car in the hero's row ran into it this update
+ * \param row Row of tiles the hero is on
+ * \returns True if the hero was hit
+ */
+bool CGame::CarTest(int row)
+{
+    // The occupancy tables say if any car came near the hero's tiles
+    // during the update, the car tests can be skipped if none did
+    double x = mHero->GetX();
+    double half = mHero->GetWidth() / 2;
+    bool touched = mOccupancy == nullptr ||
+        mOccupancy->IsTouched(row, x - half, x + half, mLevelTime - mLastElapsed, mLevelTime);
+    if (!touched && !mOccupancyCheck)
+    {
+        return false;
+    }
+
+    for (auto car : mLanes[row].mCars)
+    {
+        if (car->SweptCollidesWith(*mHero))
+        {
+            // A hit the tables missed
+            if (mOccupancyCheck)
+            {
+                mOccupancyChecks++;
+                if (!touched)
+                {
+                    mOccupancyMisses++;
+                }
+            }
 
+            mControlPanel->SetSpartyCar(car->GetId());
+            return true;
         }
     }
 
+    return false;
 }
 
 /** Tests whether hero stepped onto a boat, then locks his position with boat
@@ -18,8 +18,17 @@
 #include "Cargo.h"
 #include "Level.h"
 #include "ControlPanel.h"
+#include "VirtualFrameBuffer.h"
+#include "RenderList.h"
+#include "Replay.h"
+#include "Occupancy.h"
+#include "PathHint.h"
+#include "Endless.h"
 
 class CControlPanel;
+class CCar;
+class CSketchyBoat;
+class CVehicle;
 
 /**
  * Class that describes a game of Sparty Crossing.
@@ -33,6 +42,10 @@ public:
 
 	void OnDraw(Gdiplus::Graphics* graphics, int width, int height);
 
+	void BuildFrame(CRenderList* list);
+
+	void Present(Gdiplus::Graphics* graphics, int width, int height, const CRenderList& list);
+
 	std::pair<double, double> ScaleCoords(int x, int y);
 
 	void Add(std::shared_ptr<CItem> item);
@@ -54,8 +67,42 @@ public:
 
 	void moveHero(UINT nChar);
 
+	void Move(CReplay::Action action);
+
+	void ClickCargo(CCargo* cargo);
+
+	CCargo* GetCargo(int index);
+
+	/// Get what the current level's cargo eats
+	/// \returns Cargo puzzle, or null if no level is loaded
+	std::shared_ptr<CCargoPuzzle> GetCargoPuzzle() const { return mCargoPuzzle; }
+
+	/// Get the cargo that was eaten, once the level is lost to it
+	/// \returns Cargo, or nullptr if nothing was eaten
+	CCargo* GetEatenCargo() { return mEatenCargo >= 0 ? GetCargo(mEatenCargo) : nullptr; }
+
+	/// Get the cargo that did the eating, once the level is lost to it
+	/// \returns Cargo, or nullptr if nothing was eaten
+	CCargo* GetEatingCargo() { return mEatingCargo >= 0 ? GetCargo(mEatingCargo) : nullptr; }
+
+	void Perform(const CReplay::Input& input);
+
+	/// Get the inputs made on the current level so far
+	/// \returns Replay of the current level
+	const CReplay& GetReplay() const { return mReplay; }
+
+	void LoadLevels(const std::wstring& directory, int count);
+
 	void Update(double elapsed);
 
+	void Seek(double time);
+
+	/// Get how long the current level has been running
+	/// \returns Time in seconds
+	double GetLevelTime() const { return mLevelTime; }
+
+	std::vector<std::pair<double, double>> GetLaneState(int row, double time);
+
 	void Accept(CItemVisitor* visitor);
 
 	CCargo* HitTest(double x, double y);
@@ -68,15 +115,58 @@ public:
 	/// \returns Game window height
 	int GetHeight() const { return Height; }
 
+	double GetLevelHeight() const;
+
+	/// Get the number of rows of tiles in the current level
+	/// \returns Rows, a screen's worth or more
+	int GetRows() const { return mRows; }
+
+	/// Get how far down the level the top of the screen is
+	/// \returns Y in the level in virtual pixels, 0 when the level fits on the screen
+	/// and negative once endless mode has scrolled up
+	double GetCameraY() const { return mCameraY; }
+
+	/// Get the rows whose vehicles were updated in the last tick
+	/// \returns First row and one past the last
+	std::pair<int, int> GetLiveRows() const { return std::make_pair(mLiveFirst, mLiveEnd); }
+
 	/// Get a pointer to the Hero
 	/// \returns pointer to Hero
 	std::shared_ptr<CHero> GetHero() const { return mHero; }
 
+	/// Get the largest X the hero can be at before it has drifted off the game area
+	/// \returns X location in virtual pixels
+	double GetHeroMaxX() const { return Width - 264.0; }
+
+	/// Get the control panel
+	/// \returns Pointer to the control panel
+	std::shared_ptr<CControlPanel> GetControlPanel() const { return mControlPanel; }
+
 	void UpdateControlPanel(double elapsed);
 
-	void DrawControlPanel(Gdiplus::Graphics* graphics);
+	void DrawControlPanel(CRenderList* list);
+
+	/// Get the occupancy tables of the current level's lanes
+	/// \returns Occupancy tables, or null if there are none
+	std::shared_ptr<COccupancy> GetOccupancy() const { return mOccupancy; }
+
+	/// Set if the occupancy tables are checked against the vehicles every update
+	/// \param check True to check the tables and always run the full car tests
+	void SetOccupancyCheck(bool check) { mOccupancyCheck = check; }
+
+	/// Get if the occupancy tables are checked against the vehicles every update
+	/// \returns True if checking
+	bool GetOccupancyCheck() const { return mOccupancyCheck; }
+
+	/// Get the number of times the occupancy tables have been checked
+	/// \returns Number of checks
+	int GetOccupancyChecks() const { return mOccupancyChecks; }
 
-	void CollisionTest(double x, double y);
+	/// Get the number of checks the occupancy tables got wrong
+	/// \returns Number of misses
+	int GetOccupancyMisses() const { return mOccupancyMisses; }
+
+	std::wstring GetOccupancyReport();
 
 	void BoatTest();
 
@@ -86,9 +176,6 @@ public:
 	/// \returns True if game has been lost, False otherwise.
 	bool GetGameLost() { return mGameOver; }
 
-	/// Sets game over condition to be true
-	void SetGameLost() { mGameOver = true; }
-
 	/// Get if the game has been won.
 	/// \returns True if game has been won, False otherwise.
 	bool GetGameWon() { return mGameWon; }
@@ -108,17 +195,84 @@ public:
 	void SetRiverCheatState(bool state);
 
 	/// Gets the condition of the game's loss
-	/// \returns int representing condition of game's loss.
-	int GameLossCondition() { return mGameLossCondition; }
+	/// \returns How the level was lost, NoLoss if it hasn't been
+	CRuleTable::Loss GameLossCondition() { return mGameLossCondition; }
 
-	/// Sets game over condition to input
-	/// \param loss Condition to set loss condition to
-	void SetLossCondtion(int loss) { mGameLossCondition = loss; }
+	/// Get what each row of the current level is and what on it loses
+	/// \returns Rule table, or null if no level is loaded
+	std::shared_ptr<CRuleTable> GetRuleTable() const { return mRuleTable; }
 
 	/// Gets the game's get ready state
 	/// \returns bool of get ready state
 	bool GetReady() { return mGetReady; }
 
+	/// Get the time left before a finished level is reloaded or the next one loaded
+	/// \returns Time in seconds
+	double GetTimeToSwitchLevel() const { return mTimeToSwitchLevel; }
+
+	void SetFrameBufferEnabled(bool enabled);
+
+	/// Get if the virtual framebuffer presentation mode is on
+	/// \returns True if drawing through the framebuffer
+	bool GetFrameBufferEnabled() { return mFrameBufferEnabled; }
+
+	void SetFrameBufferFilter(CFrameScaler::Filter filter);
+
+	/// Get the filter the virtual framebuffer is scaled with
+	/// \returns Current filter
+	CFrameScaler::Filter GetFrameBufferFilter() { return mFrameBufferFilter; }
+
+	/// Set if the virtual framebuffer is rasterized in software
+	/// \param enabled True to rasterize the frame in bands on the thread pool
+	void SetSoftwareRasterEnabled(bool enabled) { mSoftwareRasterEnabled = enabled; }
+
+	/// Get if the virtual framebuffer is rasterized in software
+	/// \returns True if the frame is rasterized in software
+	bool GetSoftwareRasterEnabled() { return mSoftwareRasterEnabled; }
+
+	void SetPalettizedSprites(bool enabled);
+
+	/// Get if the software rasterizer stores sprites as palette indices
+	/// \returns True if sprites are palettized
+	bool GetPalettizedSprites() { return mPalettizedSprites; }
+
+	void ClearSprites();
+
+	/// Get the memory the software rasterizer's sprites take
+	/// \returns Size in bytes, 0 if the virtual framebuffer isn't in use
+	size_t GetSpriteBytes() const { return mFrameBuffer != nullptr ? mFrameBuffer->GetSpriteBytes() : 0; }
+
+	void BuildRenderList(CRenderList* list);
+
+	void SetPathHintEnabled(bool enabled);
+
+	/// Get if the safe path hint is shown
+	/// \returns True if the hint is planned and drawn
+	bool GetPathHintEnabled() const { return mPathHint != nullptr; }
+
+	/// Get the safe path hint
+	/// \returns Hint, or null if it isn't shown
+	CPathHint* GetPathHint() const { return mPathHint.get(); }
+
+	void UpdatePathHint();
+
+	/// Get the number of levels that can be played
+	/// \returns Number of levels
+	int GetLevelCount() const { return (int)mLevels.size(); }
+
+	int GetLevelNumber();
+
+	/// Get the number of times the game has been cleared for a level to load.
+	/// Bitmaps drawn before it changed may have been freed.
+	/// \returns Number of times
+	int GetLoads() const { return mLoads; }
+
+	void SetEndless(bool enabled, unsigned seed);
+
+	/// Get endless mode
+	/// \returns Endless mode, or null if a level is being played
+	CEndless* GetEndless() const { return mEndless.get(); }
+
 private:
 	// game playing area constants:
 	// leftmost 1024 x 1024 is the game grid
@@ -147,6 +301,8 @@ private:
 
 	void XmlItem(const std::shared_ptr<xmlnode::CXmlNode>& node);
 
+	void DrawVirtual(Gdiplus::Graphics* graphics, const CRenderList& list);
+
 	/// Pointer for our hero
 	std::shared_ptr<CHero> mHero = nullptr;
 
@@ -166,7 +322,70 @@ private:
 	bool mRoadCheatEnabled = false;
 
 	/// Game loss condition
-	int mGameLossCondition = -1;
+	CRuleTable::Loss mGameLossCondition = CRuleTable::NoLoss;
+
+	/// What each row of the current level is and what on it loses
+	std::shared_ptr<CRuleTable> mRuleTable;
+
+	/// The vehicles on a row
+	struct Lane
+	{
+		std::vector<CVehicle*> mVehicles;        ///< Every vehicle, in item order
+		std::vector<CCar*> mCars;                ///< Cars, in item order
+		std::vector<CSketchyBoat*> mSketchy;     ///< Sketchy boats, in item order
+	};
+
+	/// Vehicles of the current level, by row
+	std::vector<Lane> mLanes;
+
+	/// Rows of tiles in the current level
+	int mRows = CRuleTable::Rows;
+
+	/// Y in the level at the top of the screen, in virtual pixels.
+	/// Negative once endless mode has gone up past its first screen
+	double mCameraY = 0;
+
+	void UpdateCamera(double elapsed);
+
+	std::pair<int, int> GetNearRows(int margin) const;
+
+	/// First row whose vehicles were updated in the last tick
+	int mLiveFirst = 0;
+
+	/// One past the last row whose vehicles were updated in the last tick
+	int mLiveEnd = 0;
+
+	void UpdateLiveRows(double elapsed);
+
+	/// Items of the current level that stay on their rows, by index, under each row they are drawn over
+	std::vector<std::vector<int>> mRowItems;
+
+	/// Items that go from row to row, the hero and cargo, by index
+	std::vector<int> mFloatingItems;
+
+	/// Cargo of the current level, in item order
+	std::vector<CCargo*> mCargoItems;
+
+	/// Frame each item was last recorded in, so an item over several rows is recorded once
+	std::vector<int> mRecordedFrame;
+
+	/// Frames recorded since the level was loaded
+	int mFrame = 0;
+
+	/// Items to record this frame, by index, kept to save allocating each frame
+	std::vector<int> mFrameItems;
+
+	/// Number of times the game has been cleared for a level to load
+	int mLoads = 0;
+
+	/// Value of mLoads when OnDraw last drew, so sprites of freed bitmaps are let go
+	int mDrawnLoads = 0;
+
+	void CheckRules();
+
+	bool IsHazardHit(CRuleTable::Hazard hazard, int row);
+
+	bool CarTest(int row);
 
 	/// Are we still in the get ready stage?
 	bool mGetReady = true;
@@ -174,5 +393,73 @@ private:
 	/// Seconds until a new level is loaded or reloaded
 	double mTimeToSwitchLevel = 3.0;
 
+	/// Seconds the current level has been running
+	double mLevelTime = 0;
+
+	/// Inputs made on the current level
+	CReplay mReplay;
+
+	/// Time in seconds the last update covered
+	double mLastElapsed = 0;
+
+	/// What the current level's cargo eats
+	std::shared_ptr<CCargoPuzzle> mCargoPuzzle;
+
+	/// Mask of the cargo on the top bank
+	int mTopCargo = 0;
+
+	/// Mask of the cargo on the bottom bank
+	int mBottomCargo = 0;
+
+	/// Cargo that was eaten, -1 for none
+	int mEatenCargo = -1;
+
+	/// Cargo that did the eating, -1 for none
+	int mEatingCargo = -1;
+
+	void UpdateCargoBanks();
+
+	/// Which tiles of each lane of the current level have a vehicle in them over time
+	std::shared_ptr<COccupancy> mOccupancy;
+
+	/// Check the occupancy tables against the vehicles every update
+	bool mOccupancyCheck = false;
+
+	/// Number of times the occupancy tables have been checked
+	int mOccupancyChecks = 0;
+
+	/// Number of checks the occupancy tables got wrong
+	int mOccupancyMisses = 0;
+
+	void CheckOccupancy();
+
+	/// Draw into an offscreen frame at native size and scale it once
+	bool mFrameBufferEnabled = false;
+
+	/// Filter used to scale the offscreen frame
+	CFrameScaler::Filter mFrameBufferFilter = CFrameScaler::Bilinear;
+
+	/// Offscreen frame, created the first time it is needed
+	std::unique_ptr<CVirtualFrameBuffer> mFrameBuffer;
+
+	/// Rasterize the framebuffer in software instead of with GDI+
+	bool mSoftwareRasterEnabled = false;
+
+	/// Store the software rasterizer's sprites as 8-bit palette indices
+	bool mPalettizedSprites = false;
+
+	/// Drawing commands recorded by the items this frame
+	CRenderList mRenderList;
+
+	/// Plans a safe way across the lanes, null when the hint is off
+	std::unique_ptr<CPathHint> mPathHint;
+
+	/// Endless mode, null when a level is being played
+	std::unique_ptr<CEndless> mEndless;
+
+	void UpdateEndless(double elapsed);
+
+	void RestartEndless();
+
 };
 
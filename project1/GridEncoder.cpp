@@ -0,0 +1,195 @@
+/**
+ * \file GridEncoder.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "GridEncoder.h"
+#include "Game.h"
+#include "LaneVisitor.h"
+#include "IsSketchyVisitor.h"
+#include "Car.h"
+#include "Boat.h"
+#include <cmath>
+#include <algorithm>
+#include <emmintrin.h>
+
+using namespace std;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Size of one plane of the grid
+const int PlaneSize = CGridEncoder::Rows * CGridEncoder::Columns;
+
+
+/**
+ * Constructor
+ * \param offsets True to also write where in its tile each vehicle is
+ */
+CGridEncoder::CGridEncoder(bool offsets) : mOffsets(offsets)
+{
+}
+
+
+/**
+ * Write the state of the game
+ * \param game Game to encode
+ * \param grid Where to write GetSize floats
+ */
+void CGridEncoder::Encode(CGame* game, float* grid)
+{
+    fill(grid, grid + GetSize(), 0.0f);
+
+    auto hero = game->GetHero();
+    if (hero == nullptr)
+    {
+        return;
+    }
+
+    // Each load makes a new hero, so a new hero means a new level
+    if (hero != mHero)
+    {
+        Find(game);
+    }
+
+    auto rules = game->GetRuleTable();
+    auto occupancy = game->GetOccupancy();
+    double time = game->GetLevelTime();
+    for (int row = 0; row < Rows; row++)
+    {
+        CRuleTable::Terrain terrain = rules != nullptr ? rules->GetTerrain(row) : CRuleTable::Land;
+        SetRow(grid + Road * PlaneSize, row, terrain == CRuleTable::Road ? 0xffff : 0);
+        SetRow(grid + River * PlaneSize, row, terrain == CRuleTable::River ? 0xffff : 0);
+
+        if (occupancy != nullptr && occupancy->IsRoad(row))
+        {
+            SetRow(grid + Car * PlaneSize, row, occupancy->GetTouched(row, time));
+        }
+        else if (occupancy != nullptr && occupancy->IsRiver(row))
+        {
+            SetRow(grid + Boat * PlaneSize, row, occupancy->GetCovered(row, time));
+        }
+    }
+
+    for (auto& vehicle : mVehicles)
+    {
+        double x = vehicle.mVehicle->GetX();
+        if (vehicle.mSketchy)
+        {
+            SetRow(grid + Sketchy * PlaneSize, vehicle.mRow, COccupancy::GetColumns(x - vehicle.mHalf, x + vehicle.mHalf));
+        }
+
+        int column = (int)floor(x / TileToPixels);
+        if (mOffsets && column >= 0 && column < Columns)
+        {
+            grid[Offset * PlaneSize + vehicle.mRow * Columns + column] = (float)(x / TileToPixels - column);
+        }
+    }
+
+    SetTile(grid + Hero * PlaneSize, hero->GetX(), hero->GetY(), 1.0f);
+
+    for (int i = 0; i < (int)mCargo.size(); i++)
+    {
+        CCargo* cargo = mCargo[i];
+        if (cargo->GetCarryStatus())
+        {
+            SetTile(grid + (Cargo + i) * PlaneSize, hero->GetX(), hero->GetY(), 0.5f);
+        }
+        else
+        {
+            SetTile(grid + (Cargo + i) * PlaneSize, cargo->GetX(), cargo->GetY(), 1.0f);
+        }
+    }
+}
+
+
+/**
+ * Find the vehicles and cargo of the level the game has loaded
+ * \param game Game to look in
+ */
+void CGridEncoder::Find(CGame* game)
+{
+    mHero = game->GetHero();
+    mVehicles.clear();
+    mCargo.clear();
+
+    CLaneVisitor lanes;
+    game->Accept(&lanes);
+
+    vector<CVehicle*> vehicles(lanes.GetCars().begin(), lanes.GetCars().end());
+    vehicles.insert(vehicles.end(), lanes.GetBoats().begin(), lanes.GetBoats().end());
+    for (auto found : vehicles)
+    {
+        Vehicle vehicle;
+        vehicle.mVehicle = found;
+        vehicle.mRow = found->GetRow();
+        vehicle.mHalf = found->GetWidth() / 2;
+
+        CIsSketchyVisitor visitor;
+        found->Accept(&visitor);
+        vehicle.mSketchy = visitor.GetIsSketchy();
+
+        if (vehicle.mRow >= 0 && vehicle.mRow < Rows)
+        {
+            mVehicles.push_back(vehicle);
+        }
+    }
+
+    for (CCargo* cargo = game->GetCargo(0); cargo != nullptr && (int)mCargo.size() < MaxCargo;
+        cargo = game->GetCargo((int)mCargo.size()))
+    {
+        mCargo.push_back(cargo);
+    }
+}
+
+
+/**
+ * Set the tiles of a row of a plane to 1
+ *
+ * Four tiles are done at once. Each bit is spread out to a whole
+ * float lane of all ones or all zeros, which picks between 1 and
+ * the tile that is already there.
+ *
+ * \param plane Plane to set
+ * \param row Row of tiles
+ * \param columns Bit for each column to set
+ */
+void CGridEncoder::SetRow(float* plane, int row, uint16_t columns)
+{
+    static_assert(Columns % 4 == 0, "rows are set four tiles at a time");
+    if (columns == 0)
+    {
+        return;
+    }
+
+    float* tiles = plane + row * Columns;
+    __m128i bits = _mm_set1_epi32(columns);
+    __m128 one = _mm_set1_ps(1.0f);
+    for (int column = 0; column < Columns; column += 4)
+    {
+        __m128i lanes = _mm_setr_epi32(1 << column, 2 << column, 4 << column, 8 << column);
+        __m128 set = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(bits, lanes), lanes));
+        __m128 old = _mm_loadu_ps(tiles + column);
+        _mm_storeu_ps(tiles + column, _mm_or_ps(_mm_and_ps(set, one), _mm_andnot_ps(set, old)));
+    }
+}
+
+
+/**
+ * Set the tile under a point of a plane
+ * \param plane Plane to set
+ * \param x X in virtual pixels
+ * \param y Y in virtual pixels
+ * \param value Value to set the tile to
+ */
+void CGridEncoder::SetTile(float* plane, double x, double y, float value)
+{
+    int column = (int)floor(x / TileToPixels);
+    int row = (int)floor(y / TileToPixels);
+    if (column >= 0 && column < Columns && row >= 0 && row < Rows)
+    {
+        plane[row * Columns + column] = value;
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * \file GridEncoder.h
+ *
+ * \author Michael Dittman
+ *
+ * Writes the state of a game as a grid of tiles, one plane a channel.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class CGame;
+class CHero;
+class CCargo;
+class CVehicle;
+
+
+/**
+ * Writes the state of a game as a grid of tiles, one plane a channel.
+ *
+ * The grid is the 16 x 16 tiles of the play area. Each channel is a
+ * plane of floats, rows then columns, and the planes follow each
+ * other, so the whole grid is GetSize floats with nothing drawn.
+ *
+ * Terrain comes from the level's rule table and where cars and boats
+ * are from its occupancy tables at the level time. Cars mark the tiles
+ * they touch, boats the tiles they can be stepped onto. The hero and
+ * cargo are read straight from the items. A cargo item is 1 on the
+ * tile it sits on, or 0.5 on the hero's tile while it is carried.
+ *
+ * With offsets on, one more plane has, on the tile under the center
+ * of each vehicle, how far across the tile the center is, 0 to 1.
+ *
+ * The vehicles and cargo of a level are found the first time it is
+ * encoded. After that encoding allocates nothing.
+ */
+class CGridEncoder
+{
+public:
+    /// Channels of the grid, Cargo + i for cargo item i
+    enum Channel { Road, River, Car, Boat, Sketchy, Hero, Cargo };
+
+    /// Number of rows of tiles
+    const static int Rows = 16;
+
+    /// Number of columns of tiles
+    const static int Columns = 16;
+
+    /// Most cargo items the grid has channels for
+    const static int MaxCargo = 4;
+
+    /// Channel of the vehicle offsets, when they are on
+    const static int Offset = Cargo + MaxCargo;
+
+    /// Default constructor (disabled)
+    CGridEncoder() = delete;
+
+    /// Copy constructor (disabled)
+    CGridEncoder(const CGridEncoder&) = delete;
+
+    CGridEncoder(bool offsets);
+
+    /** Get the number of channels
+     * \returns Number of planes in the grid */
+    int GetChannels() const { return Offset + (mOffsets ? 1 : 0); }
+
+    /** Get the number of floats in the grid
+     * \returns Channels times rows times columns */
+    int GetSize() const { return GetChannels() * Rows * Columns; }
+
+    void Encode(CGame* game, float* grid);
+
+private:
+    /// A vehicle of the level being encoded
+    struct Vehicle
+    {
+        CVehicle* mVehicle = nullptr;   ///< The vehicle
+        int mRow = 0;                   ///< Row of tiles its lane is on
+        double mHalf = 0;               ///< Half its width in virtual pixels
+        bool mSketchy = false;          ///< True for sketchy boats
+    };
+
+    void Find(CGame* game);
+
+    static void SetRow(float* plane, int row, uint16_t columns);
+
+    static void SetTile(float* plane, double x, double y, float value);
+
+    /// Also write the vehicle offsets
+    bool mOffsets;
+
+    /// Hero of the level the vehicles and cargo were found in
+    std::shared_ptr<CHero> mHero;
+
+    /// Vehicles of that level
+    std::vector<Vehicle> mVehicles;
+
+    /// Cargo of that level, in level order
+    std::vector<CCargo*> mCargo;
+};
@@ -15,8 +15,8 @@ using namespace Gdiplus;
 /// The upper border of the screen
 const int topBorder = 128;
 
-/// The lower border of the screen
-const int lowerBorder = 896;
+/// The lower border, up from the bottom of the level
+const int lowerBorder = 128;
 
 /// Number of pixels wide and tall a tile is.
 const double TileToPixels = 64;
@@ -107,8 +107,8 @@ void CHero::moveBackward()
     double currentY = this->GetY();
     double currentX = this->GetX();
 
-    // Move the hero forward, unless at bottom of the screen
-    if (currentY < lowerBorder)
+    // Move the hero backward, unless at bottom of the level
+    if (currentY < GetGame()->GetLevelHeight() - lowerBorder)
     {
         this->SetLocation(currentX, currentY + TileToPixels);
     }
@@ -159,29 +159,29 @@ void CHero::Update(double elapsed)
  * Responsible for drawing the hero on the screen. 
  * Overloaded from CItem. Handles what to do with hero 
  * if loss conditions occur.
- * \param graphics Graphics context to draw with
+ * \param list Render list to record the drawing into
  */
-void CHero::Draw(Gdiplus::Graphics* graphics)
+void CHero::Draw(CRenderList* list)
 {
     CGame* game = GetGame();
 
     // If hero got shmucked by a car
-    if (game->GameLossCondition() == 1)
+    if (game->GameLossCondition() == CRuleTable::HitByCar)
     {
         // draw the swapped image
         SetImage(mSwappedItemImage);
-        CItem::Draw(graphics);
+        CItem::Draw(list);
     }
     // If hero fell in the river
-    else if (game->GameLossCondition() == 2)
+    else if (game->GameLossCondition() == CRuleTable::FellInRiver)
     {
-        CItem::Draw(graphics);
+        CItem::Draw(list);
 
         // add the mask over the hero image
         double wid = mItemMask->GetWidth();
         double hit = mItemMask->GetHeight();
 
-        graphics->DrawImage(mItemMask.get(),
+        list->DrawImage(mItemMask.get(),
             float(GetX() - wid / 2), float(GetY() - hit / 2),
             (float)mItemMask->GetWidth(), (float)mItemMask->GetHeight());
 
@@ -189,11 +189,9 @@ void CHero::Draw(Gdiplus::Graphics* graphics)
         if (GetX() - GetWidth() / 2 < 0)
         {
 
-            // Create a solid black brush
-            SolidBrush black(Color(0, 0, 0));
 
             // Fill a rectangle starting off the screen and going to the edge of the boundary
-            graphics->FillRectangle(&black, float(-600), float(GetY() - hit / 2),
+            list->FillRectangle(Color(0, 0, 0), float(-600), float(GetY() - hit / 2),
                 (float)600, (float)800);
 
         }
@@ -201,23 +199,21 @@ void CHero::Draw(Gdiplus::Graphics* graphics)
         else if (GetWidth() / 2 + GetX() > Width)
         {
 
-            // Create a solid black brush
-            SolidBrush black(Color(0, 0, 0));
 
             // Fill a recntangle starting at the width of the boundary to off screen
-            graphics->FillRectangle(&black, float(Width), float(GetY() - hit / 2),
+            list->FillRectangle(Color(0, 0, 0), float(Width), float(GetY() - hit / 2),
                 (float)800, (float)800);
         }
 
     }
     // If hero drifted off screen
-    else if (game->GameLossCondition() == 4)
+    else if (game->GameLossCondition() == CRuleTable::OutOfBounds)
     {
         // Don't draw hero for remainder of this run
     }
     else
     {
         // draw the image normally
-        CItem::Draw(graphics);
+        CItem::Draw(list);
     }
 }
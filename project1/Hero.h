@@ -86,6 +86,11 @@ public:
     */
     void SetSpeed(double speed) { mSpeed = speed; }
 
+    /** Gets speed of hero
+    * \return Speed in virtual pixels per second, nonzero when riding a boat
+    */
+    double GetSpeed() const { return mSpeed; }
+
     void Update(double elapsed);
 
     /** Return hero name
@@ -93,7 +98,7 @@ public:
     */
     std::wstring GetHeroName() { return mName; }
 
-    virtual void Draw(Gdiplus::Graphics* graphics) override;
+    virtual void Draw(CRenderList* list) override;
 
 private:
     /// Name of hero
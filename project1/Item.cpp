@@ -8,6 +8,7 @@
 #include "Item.h"
 #include "Game.h"
 #include "XmlNode.h"
+#include <cmath>
 
 using namespace Gdiplus;
 using namespace std;
@@ -26,6 +27,7 @@ const double TileToPixels = 64;
 CItem::CItem(CGame* game, std::shared_ptr<Gdiplus::Bitmap> bitmap, int yPos, int xPos)
     : mGame(game), mItemImage(bitmap), mY(yPos), mX(xPos)
 {
+    mMask = CCollisionMask::Get(bitmap.get());
 }
 
 /**
@@ -35,6 +37,7 @@ CItem::CItem(CGame* game, std::shared_ptr<Gdiplus::Bitmap> bitmap, int yPos, int
  */
 CItem::CItem(CGame* game, std::shared_ptr<Gdiplus::Bitmap> bitmap) : mGame(game), mItemImage(bitmap)
 {
+    mMask = CCollisionMask::Get(bitmap.get());
 }
 
 /**
@@ -54,6 +57,7 @@ CItem::CItem(const CItem& item)
     mX = item.GetX();
     mY = item.GetY();
     mItemImage = item.mItemImage;
+    mMask = item.mMask;
     mGame = item.mGame;
 }
 
@@ -66,14 +70,14 @@ CItem::~CItem()
 
 /**
  * Draw the game item
- * \param graphics Graphics device to draw on
+ * \param list Render list to record the drawing into
  */
-void CItem::Draw(Gdiplus::Graphics* graphics)
+void CItem::Draw(CRenderList* list)
 {
     double wid = mItemImage->GetWidth();
     double hit = mItemImage->GetHeight();
 
-    graphics->DrawImage(mItemImage.get(),
+    list->DrawImage(mItemImage.get(),
         float(GetX() - wid / 2), float(GetY() - hit / 2),
         (float)mItemImage->GetWidth(), (float)mItemImage->GetHeight());
 
@@ -128,4 +132,124 @@ double CItem::Distance(std::shared_ptr<CItem> other)
 
     // Determine how far away we are
     return sqrt(dx * dx + dy * dy);
-}
\ No newline at end of file
+}
+
+
+/**
+ * Test if a point is on a solid pixel of this item.
+ *
+ * The image rectangle is checked first, the collision
+ * mask only when the point is inside it.
+ *
+ * \param x X location in virtual pixels
+ * \param y Y location in virtual pixels
+ * \returns True if the point hits the item
+ */
+bool CItem::HitTest(double x, double y)
+{
+    double wid = GetImage()->GetWidth();
+    double hit = GetImage()->GetHeight();
+
+    // Make x and y relative to the top-left corner of the bitmap image.
+    double testX = x - GetX() + wid / 2;
+    double testY = y - GetY() + hit / 2;
+
+    // Test to see if x, y are in the image
+    if (testX < 0 || testY < 0 || testX >= wid || testY >= hit)
+    {
+        // We are outside the image
+        return false;
+    }
+
+    // No mask means we could not read the image, go by the rectangle
+    return mMask == nullptr || mMask->Test((int)testX, (int)testY);
+}
+
+
+/**
+ * Get the part of the level the item is drawn over, top to bottom.
+ * Items are drawn centered on their location.
+ * \returns Top and bottom Y in virtual pixels
+ */
+std::pair<double, double> CItem::GetVerticalExtent() const
+{
+    return make_pair(mY - GetHeight() / 2, mY + GetHeight() / 2);
+}
+
+
+/**
+ * Test if the solid pixels of this item touch those of another.
+ *
+ * The image rectangles are checked first, the collision
+ * masks only when the rectangles overlap.
+ *
+ * \param other Item to test against
+ * \returns True if the items collide
+ */
+bool CItem::CollidesWith(const CItem& other) const
+{
+    double left = mX - GetWidth() / 2;
+    double top = mY - GetHeight() / 2;
+    double otherLeft = other.mX - other.GetWidth() / 2;
+    double otherTop = other.mY - other.GetHeight() / 2;
+
+    if (otherLeft >= left + GetWidth() || left >= otherLeft + other.GetWidth() ||
+        otherTop >= top + GetHeight() || top >= otherTop + other.GetHeight())
+    {
+        return false;
+    }
+
+    if (mMask == nullptr || other.mMask == nullptr)
+    {
+        return true;
+    }
+
+    return mMask->Overlaps(*other.mMask, (int)floor(otherLeft - left), (int)floor(otherTop - top));
+}
+
+
+/**
+ * Test if this item touched another while moving horizontally.
+ *
+ * This item moved in a straight line from startX to where it is
+ * now while the other item stayed put. The rectangle swept out by
+ * the move is checked first, then the masks along the part of the
+ * move where the rectangles overlap, which takes as long however
+ * far the item moved.
+ *
+ * \param other Item to test against
+ * \param startX X location this item moved from
+ * \returns True if the items collided at any point along the move
+ */
+bool CItem::CollidesWithSwept(const CItem& other, double startX) const
+{
+    double width = GetWidth();
+    double height = GetHeight();
+    double startLeft = startX - width / 2;
+    double endLeft = mX - width / 2;
+    double left = min(startLeft, endLeft);
+    double right = max(startLeft, endLeft) + width;
+    double top = mY - height / 2;
+    double otherLeft = other.mX - other.GetWidth() / 2;
+    double otherTop = other.mY - other.GetHeight() / 2;
+
+    if (otherLeft >= right || left >= otherLeft + other.GetWidth() ||
+        otherTop >= top + height || top >= otherTop + other.GetHeight())
+    {
+        return false;
+    }
+
+    if (mMask == nullptr || other.mMask == nullptr)
+    {
+        return true;
+    }
+
+    // Offsets of the other mask from ours along the move, limited
+    // to those where the two rectangles overlap
+    int dy = (int)floor(otherTop - top);
+    int first = max((int)floor(otherLeft - max(startLeft, endLeft)), 1 - mMask->GetWidth());
+    int last = min((int)floor(otherLeft - min(startLeft, endLeft)), mMask->GetWidth() - 1);
+    first = max(first, 1 - other.mMask->GetWidth());
+
+    return first <= last && mMask->SweptOverlaps(*other.mMask, first, last, dy);
+}
@@ -10,8 +10,11 @@
 
 #include <string>
 #include <memory>
+#include <utility>
 #include "XmlNode.h"
 #include "ItemVisitor.h"
+#include "RenderList.h"
+#include "CollisionMask.h"
 
 class CGame;
 
@@ -51,7 +54,7 @@ public:
 
 	/// Sets the image to draw of the hero
 	/// \param image The bitmap pointer image to set
-	void SetImage(std::shared_ptr<Gdiplus::Bitmap> image) { mItemImage = image;}
+	void SetImage(std::shared_ptr<Gdiplus::Bitmap> image) { mItemImage = image; mMask = CCollisionMask::Get(image.get()); }
 
 	/// Set the item location
 	/// \param x X location
@@ -62,7 +65,7 @@ public:
 	/// \returns Game pointer
 	CGame* GetGame() { return mGame; }
 
-	virtual void Draw(Gdiplus::Graphics* graphics);
+	virtual void Draw(CRenderList* list);
 
 	virtual std::shared_ptr<xmlnode::CXmlNode> XmlSave(const std::shared_ptr<xmlnode::CXmlNode>& node);
 
@@ -70,6 +73,14 @@ public:
 
 	double Distance(std::shared_ptr<CItem> other);
 
+	bool HitTest(double x, double y);
+
+	virtual std::pair<double, double> GetVerticalExtent() const;
+
+	bool CollidesWith(const CItem& other) const;
+
+	bool CollidesWithSwept(const CItem& other, double startX) const;
+
 	/** Accept a visitor
 	 * \param visitor The visitor we accept */
 	virtual void Accept(CItemVisitor* visitor) {};
@@ -94,5 +105,8 @@ private:
 
 	/// The image of this item
 	std::shared_ptr<Gdiplus::Bitmap> mItemImage;
+
+	/// Solid pixels of the image
+	std::shared_ptr<CCollisionMask> mMask;
 };
 
@@ -0,0 +1,218 @@
+/**
+ * \file JobBenchmark.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "JobBenchmark.h"
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+/// Empty tasks spawned for each timing
+const int SpawnedTasks = 100000;
+
+/// Tasks in the chain
+const int ChainTasks = 20000;
+
+/// Levels of the tree below its root
+const int TreeDepth = 14;
+
+/// Indices in the ParallelFor
+const int RangeSize = 1 << 22;
+
+/// Indices handed out at a time in the ParallelFor
+const int RangeGrain = 4096;
+
+
+/**
+ * Constructor
+ */
+CJobBenchmark::CJobBenchmark()
+{
+}
+
+
+/**
+ * Run the benchmark with every thread count
+ */
+void CJobBenchmark::Run()
+{
+    mReport.str(L"");
+    mReport << L"Job benchmark, " << thread::hardware_concurrency() << L" hardware threads" << endl << endl;
+    mReport << L"  threads  spawn us  chain us  tree ms  stolen  for ms  speedup" << endl;
+
+    int hardware = (int)thread::hardware_concurrency();
+    for (int threads = 1; threads < hardware; threads *= 2)
+    {
+        Measure(threads);
+    }
+    Measure(hardware > 1 ? hardware : 1);
+
+    //
+    // With the workers idle the chain has to run in the order
+    // it was spawned, every time
+    //
+    CThreadPool pool;
+    pool.SetSingleThreaded(true);
+
+    vector<int> orders[2];
+    for (auto& order : orders)
+    {
+        vector<CThreadPool::Task> tasks;
+        for (int i = 0; i < 1000; i++)
+        {
+            vector<CThreadPool::Task> after;
+            if (i >= 3)
+            {
+                after.push_back(tasks[i - 3]);
+            }
+
+            tasks.push_back(pool.Spawn([&order, i] { order.push_back(i); }, after));
+        }
+
+        pool.Wait(tasks);
+    }
+
+    mReport << endl << L"Single threaded runs in the same order: " << (orders[0] == orders[1] ? L"yes" : L"NO") << endl;
+}
+
+
+/**
+ * Time every test with one number of threads and add a line to the report
+ * \param threads Threads including the caller
+ */
+void CJobBenchmark::Measure(int threads)
+{
+    CThreadPool pool(threads);
+
+    double spawn = TimeSpawns(pool);
+    double chain = TimeChain(pool);
+
+    pool.ResetStats();
+    double tree = TimeTree(pool);
+    CThreadPool::Stats stats = pool.GetStats();
+
+    double single = 0;
+    {
+        CThreadPool one(1);
+        single = TimeParallelFor(one);
+    }
+    double range = TimeParallelFor(pool);
+
+    mReport << setw(9) << threads << fixed << setprecision(3) << setw(10) << spawn << setw(10) << chain
+        << setprecision(2) << setw(9) << tree << setw(7) << setprecision(0)
+        << (stats.mRun > 0 ? 100.0 * stats.mStolen / stats.mRun : 0) << L"%"
+        << setprecision(2) << setw(8) << range << setw(8) << (range > 0 ? single / range : 0) << L"x" << endl;
+}
+
+
+/**
+ * Time spawning empty tasks and waiting for them all
+ * \param pool Pool to time
+ * \returns Microseconds per task
+ */
+double CJobBenchmark::TimeSpawns(CThreadPool& pool)
+{
+    vector<CThreadPool::Task> tasks;
+    tasks.reserve(SpawnedTasks);
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < SpawnedTasks; i++)
+    {
+        tasks.push_back(pool.Spawn([] {}));
+    }
+    pool.Wait(tasks);
+    chrono::duration<double, micro> duration = chrono::steady_clock::now() - start;
+    return duration.count() / SpawnedTasks;
+}
+
+
+/**
+ * Time a chain of tasks that each run after the one before
+ * \param pool Pool to time
+ * \returns Microseconds per task
+ */
+double CJobBenchmark::TimeChain(CThreadPool& pool)
+{
+    auto start = chrono::steady_clock::now();
+    CThreadPool::Task last = pool.Spawn([] {});
+    for (int i = 1; i < ChainTasks; i++)
+    {
+        last = pool.Spawn([] {}, { last });
+    }
+    pool.Wait(last);
+    chrono::duration<double, micro> duration = chrono::steady_clock::now() - start;
+    return duration.count() / ChainTasks;
+}
+
+
+/**
+ * Time a binary tree of tasks where each spawns its children and
+ * waits for them, so idle threads have to steal to help
+ * \param pool Pool to time
+ * \returns Milliseconds for the tree
+ */
+double CJobBenchmark::TimeTree(CThreadPool& pool)
+{
+    function<void(int)> node = [&](int depth)
+    {
+        if (depth == 0)
+        {
+            return;
+        }
+
+        auto left = pool.Spawn([&node, depth] { node(depth - 1); });
+        auto right = pool.Spawn([&node, depth] { node(depth - 1); });
+        pool.Wait({ left, right });
+    };
+
+    auto start = chrono::steady_clock::now();
+    pool.Wait(pool.Spawn([&node] { node(TreeDepth); }));
+    chrono::duration<double, milli> duration = chrono::steady_clock::now() - start;
+    return duration.count();
+}
+
+
+/**
+ * Time a ParallelFor that adds up a big range
+ * \param pool Pool to time
+ * \returns Milliseconds for the range
+ */
+double CJobBenchmark::TimeParallelFor(CThreadPool& pool)
+{
+    vector<unsigned> values(RangeSize);
+    for (int i = 0; i < RangeSize; i++)
+    {
+        values[i] = i * 2654435761u;
+    }
+
+    vector<unsigned long long> sums(RangeSize / RangeGrain + 1);
+    auto start = chrono::steady_clock::now();
+    pool.ParallelFor(0, RangeSize, RangeGrain, [&](int begin, int end)
+        {
+            unsigned long long sum = 0;
+            for (int i = begin; i < end; i++)
+            {
+                sum += values[i] % 1009;
+            }
+            sums[begin / RangeGrain] = sum;
+        });
+    chrono::duration<double, milli> duration = chrono::steady_clock::now() - start;
+    return duration.count();
+}
+
+
+/**
+ * Save the report to a text file
+ * \param filename File to save to
+ */
+void CJobBenchmark::Save(const std::wstring& filename)
+{
+    wofstream file(filename);
+    file << mReport.str();
+}
@@ -0,0 +1,56 @@
+/**
+ * \file JobBenchmark.h
+ *
+ * \author Michael Dittman
+ *
+ * Times the thread pool's tasks against the number of threads.
+ */
+
+#pragma once
+
+#include <string>
+#include <sstream>
+#include "ThreadPool.h"
+
+
+/**
+ * Times the thread pool's tasks against the number of threads.
+ *
+ * For 1, 2, 4 and so on up to the hardware thread count this times
+ * spawning empty tasks, a chain of tasks that each wait on the last,
+ * a tree of tasks that spawn tasks, and a ParallelFor over a big
+ * range. The tree reports how many of its tasks were stolen. Last,
+ * the chain is run twice with the workers idle to check that it runs
+ * in the same order every time.
+ */
+class CJobBenchmark
+{
+public:
+    /// Copy constructor (disabled)
+    CJobBenchmark(const CJobBenchmark&) = delete;
+
+    CJobBenchmark();
+
+    void Run();
+
+    void Save(const std::wstring& filename);
+
+    /** Get the report of the last run
+     * \returns Report text */
+    std::wstring GetReport() const { return mReport.str(); }
+
+private:
+    void Measure(int threads);
+
+    static double TimeSpawns(CThreadPool& pool);
+
+    static double TimeChain(CThreadPool& pool);
+
+    static double TimeTree(CThreadPool& pool);
+
+    static double TimeParallelFor(CThreadPool& pool);
+
+    /// Report of the results
+    std::wostringstream mReport;
+};
+
@@ -0,0 +1,462 @@
+/**
+ * \file LaneModel.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "LaneModel.h"
+#include "Game.h"
+#include "LaneVisitor.h"
+#include "IsSketchyVisitor.h"
+#include "Car.h"
+#include "Boat.h"
+#include "SketchyBoat.h"
+#include "Replay.h"
+#include "ControlPanel.h"
+#include "Occupancy.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Length in seconds of a step
+const double CLaneModel::StepTime = 0.050;
+
+/// Width in virtual pixels of hero locations taken to be the same
+const double PositionKey = 4;
+
+/// Fewest steps Discard lets go of at once
+const int DiscardSteps = 1200;
+
+
+/**
+ * Constructor. Finds the lanes of the level the game has loaded.
+ *
+ * The tables start out empty, Extend fills them in.
+ *
+ * \param game Game with the level loaded
+ */
+CLaneModel::CLaneModel(CGame* game)
+{
+    auto hero = game->GetHero();
+    mHeroHalf = hero->GetWidth() / 2;
+    mMaxX = game->GetHeroMaxX();
+    mOccupancy = game->GetOccupancy();
+
+    CLaneVisitor lanes;
+    game->Accept(&lanes);
+
+    mRoad.assign(Rows, false);
+    for (auto car : lanes.GetCars())
+    {
+        Vehicle vehicle;
+        vehicle.mVehicle = car;
+        vehicle.mRow = car->GetRow();
+        if (vehicle.mRow >= 0 && vehicle.mRow < Rows)
+        {
+            mRoad[vehicle.mRow] = true;
+        }
+
+        mCars.push_back(vehicle);
+    }
+
+    for (auto boat : lanes.GetBoats())
+    {
+        Vehicle vehicle;
+        vehicle.mVehicle = boat;
+        vehicle.mRow = boat->GetRow();
+
+        CIsSketchyVisitor visitor;
+        boat->Accept(&visitor);
+        vehicle.mSketchy = visitor.GetIsSketchy();
+
+        // Where along the middle of the boat the hero can step on,
+        // going by the same test as CGame::BoatTest
+        double width = boat->GetWidth();
+        double left = boat->GetX() - width / 2;
+        vehicle.mLandLeft = width / 2;
+        vehicle.mLandRight = -width / 2;
+        for (int i = 0; i < (int)width; i++)
+        {
+            if (boat->HitTest(left + i + 0.5, boat->GetY()))
+            {
+                vehicle.mLandLeft = min(vehicle.mLandLeft, i - width / 2);
+                vehicle.mLandRight = max(vehicle.mLandRight, i + 1 - width / 2);
+            }
+        }
+
+        mBoats.push_back(vehicle);
+    }
+
+    mRiver.assign(Rows, false);
+    auto rules = game->GetRuleTable();
+    for (int row = 0; row < Rows && rules != nullptr; row++)
+    {
+        mRiver[row] = rules->GetTerrain(row) == CRuleTable::River;
+    }
+}
+
+
+/**
+ * Follow the vehicles far enough to try moves up to a step.
+ *
+ * Asks the game's vehicles where they are, so only call this on the
+ * thread that owns the game.
+ *
+ * \param steps Moves can be tried in any step before this one
+ */
+void CLaneModel::Extend(int steps)
+{
+    for (int step = mFollowed; step <= steps; step++)
+    {
+        for (auto& car : mCars)
+        {
+            Follow(car, step);
+        }
+
+        for (auto& boat : mBoats)
+        {
+            Follow(boat, step);
+        }
+    }
+
+    mFollowed = max(mFollowed, steps + 1);
+}
+
+
+/**
+ * Let go of the tables of steps that are over.
+ *
+ * The step before is kept, as a move tests for cars that went past
+ * during it. Tables are only let go of a good number of steps at a time.
+ *
+ * \param step First step moves will be tried in from now on
+ */
+void CLaneModel::Discard(int step)
+{
+    int drop = min(step - 1, mFollowed) - mFirstStep;
+    if (drop < DiscardSteps)
+    {
+        return;
+    }
+
+    for (auto vehicles : { &mCars, &mBoats })
+    {
+        for (auto& vehicle : *vehicles)
+        {
+            vehicle.mPositions.erase(vehicle.mPositions.begin(), vehicle.mPositions.begin() + drop);
+            vehicle.mSweeps.erase(vehicle.mSweeps.begin(), vehicle.mSweeps.begin() + drop * 2);
+        }
+    }
+
+    mFirstStep += drop;
+}
+
+
+/**
+ * Add where a vehicle is during a step to its tables
+ * \param vehicle Vehicle to follow
+ * \param step Step to add, the one after the last step added
+ */
+void CLaneModel::Follow(Vehicle& vehicle, int step)
+{
+    vehicle.mPositions.push_back(vehicle.mVehicle->GetPositionAt(step * StepTime));
+
+    pair<double, double> sweep[2];
+    int parts = vehicle.mVehicle->GetSweep(step * StepTime, (step + 1) * StepTime, sweep);
+    vehicle.mSweeps.push_back(sweep[0]);
+    vehicle.mSweeps.push_back(parts > 1 ? sweep[1] : make_pair(HUGE_VAL, -HUGE_VAL));
+}
+
+
+/**
+ * Move the hero, the way CHero's moves and CGame::BoatTest do
+ * \param position Where the hero is, changed to where the move takes it
+ * \param action Forward, Backward, Left or Right
+ * \param step Step the move is made in
+ * \returns False if the move does nothing or goes off the play area
+ */
+bool CLaneModel::Move(Position& position, int action, int step) const
+{
+    switch (action)
+    {
+    case CReplay::Forward:
+        if (position.mRow <= TopRow)
+        {
+            return false;
+        }
+        position.mRow--;
+        break;
+
+    case CReplay::Backward:
+        if (position.mRow >= BottomRow)
+        {
+            return false;
+        }
+        position.mRow++;
+        break;
+
+    case CReplay::Left:
+    case CReplay::Right:
+        // Can't move sideways on a boat
+        if (position.mBoat >= 0)
+        {
+            return false;
+        }
+        position.mX += action == CReplay::Left ? -TileToPixels : TileToPixels;
+        if (position.mX < 0 || position.mX > mMaxX)
+        {
+            return false;
+        }
+        break;
+
+    default:
+        return false;
+    }
+
+    Board(position, step);
+    return true;
+}
+
+
+/**
+ * Put the hero on the first boat under it, the way CGame::BoatTest does
+ * \param position Where the hero just moved to
+ * \param step Step the move is made in
+ */
+void CLaneModel::Board(Position& position, int step) const
+{
+    int index = step - mFirstStep;
+    for (int i = 0; i < (int)mBoats.size(); i++)
+    {
+        const Vehicle& boat = mBoats[i];
+        double offset = position.mX - boat.mPositions[index];
+        double end = position.mX - boat.mPositions[index + (mLoose ? 1 : 0)];
+        if (boat.mRow == position.mRow && min(offset, end) >= boat.mLandLeft && max(offset, end) < boat.mLandRight)
+        {
+            position.mBoat = i;
+            position.mBoarded = step;
+            position.mX = boat.mPositions[index];
+            return;
+        }
+    }
+
+    position.mBoat = -1;
+}
+
+
+/**
+ * Find what a lane loses the level to during a step, if anything.
+ *
+ * Anything that may only just miss the hero is taken as a loss, so
+ * what passes still does when the game is played a frame at a time.
+ *
+ * \param position Where the hero is at the start of the step, after any move
+ * \param step Step to get through
+ * \param moved True if the hero just moved
+ * \returns How the level is lost, NoLoss if the hero gets through the step
+ */
+CRuleTable::Loss CLaneModel::GetLoss(const Position& position, int step, bool moved) const
+{
+    if (position.mBoat >= 0)
+    {
+        // The hero goes off the screen with the boat, or the boat
+        // wraps around without it
+        const Vehicle& boat = mBoats[position.mBoat];
+        int index = step - mFirstStep;
+        double x = boat.mPositions[index + 1];
+        if (x < 0 || x > mMaxX || boat.mSweeps[index * 2 + 1].first <= boat.mSweeps[index * 2 + 1].second)
+        {
+            return CRuleTable::OutOfBounds;
+        }
+
+        bool sinks = boat.mSketchy && (step + 1 - position.mBoarded) * StepTime > CSketchyBoat::RideTime - StepTime;
+        return sinks ? CRuleTable::FellInRiver : CRuleTable::NoLoss;
+    }
+
+    if (mRiver[position.mRow])
+    {
+        return CRuleTable::FellInRiver;
+    }
+
+    // A car that went past just before the hero stepped out
+    // counts too, the game sweeps it from the last frame
+    bool hit = IsHit(position, step) || (moved && step > mFirstStep && IsHit(position, step - 1));
+    return hit ? CRuleTable::HitByCar : CRuleTable::NoLoss;
+}
+
+
+/**
+ * Carry the hero along with the boat it is riding to the next step
+ * \param position Where the hero is, changed to where it is a step later
+ * \param step Step the hero is riding through
+ */
+void CLaneModel::Ride(Position& position, int step) const
+{
+    if (position.mBoat >= 0)
+    {
+        position.mX = mBoats[position.mBoat].mPositions[step + 1 - mFirstStep];
+    }
+}
+
+
+/**
+ * Test if a car covers any of the hero during a step
+ * \param position Where the hero is
+ * \param step Step to test
+ * \returns True if a car in the hero's row overlaps it
+ */
+bool CLaneModel::IsHit(const Position& position, int step) const
+{
+    if (!mRoad[position.mRow])
+    {
+        return false;
+    }
+
+    // The tables only know the columns of the play area, where they are
+    // a lookup instead of a look at every car
+    double left = position.mX - mHeroHalf;
+    double right = position.mX + mHeroHalf;
+    if (mOccupancy != nullptr && left >= 0 && right <= COccupancy::Columns * TileToPixels &&
+        !mOccupancy->IsTouched(position.mRow, left, right, step * StepTime, (step + 1) * StepTime))
+    {
+        return false;
+    }
+
+    int index = (step - mFirstStep) * 2;
+    for (auto& car : mCars)
+    {
+        if (car.mRow != position.mRow)
+        {
+            continue;
+        }
+
+        for (int i = index; i < index + 2; i++)
+        {
+            if (car.mSweeps[i].first < position.mX + mHeroHalf && car.mSweeps[i].second > position.mX - mHeroHalf)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * Test if the hero can wait where it is for as long as it likes
+ * \param position Where the hero is
+ * \returns True if the hero is on a row with no cars or river
+ */
+bool CLaneModel::IsSafe(const Position& position) const
+{
+    return position.mBoat < 0 && !mRiver[position.mRow] && !mRoad[position.mRow];
+}
+
+
+/**
+ * Get a key that is the same for hero positions taken to be the same.
+ *
+ * Positions off of boats go by row and X. Positions on a boat go by
+ * the boat, and for sketchy boats how long it has been ridden.
+ *
+ * \param position Where the hero is
+ * \param step Step the hero is there at
+ * \returns Key, less than GetKeyCount
+ */
+unsigned long long CLaneModel::GetKey(const Position& position, int step) const
+{
+    unsigned long long key = position.mRow;
+    key = key * (mBoats.size() + 1) + (position.mBoat + 1);
+    if (position.mBoat < 0)
+    {
+        key = key * 4096 + (unsigned long long)(max(position.mX, 0.0) / PositionKey);
+    }
+    else if (mBoats[position.mBoat].mSketchy)
+    {
+        key = key * 4096 + (step - position.mBoarded);
+    }
+    else
+    {
+        key = key * 4096;
+    }
+
+    return key;
+}
+
+
+/**
+ * Find the boat the hero is riding
+ * \param row Row of tiles the hero is on
+ * \param x Hero X in virtual pixels
+ * \param step Step to look at
+ * \returns Boat in that row nearest the hero at the step, -1 if there are none
+ */
+int CLaneModel::FindBoat(int row, double x, int step) const
+{
+    int found = -1;
+    double nearest = HUGE_VAL;
+    for (int i = 0; i < (int)mBoats.size(); i++)
+    {
+        double distance = fabs(mBoats[i].mPositions[step - mFirstStep] - x);
+        if (mBoats[i].mRow == row && distance < nearest)
+        {
+            found = i;
+            nearest = distance;
+        }
+    }
+
+    return found;
+}
+
+
+/**
+ * Find where the game's hero is, as if it were the start of a step
+ * \param hero The hero
+ * \param step Step to take the hero to be at
+ * \returns Where the hero is
+ */
+CLaneModel::Position CLaneModel::Locate(CHero* hero, int step) const
+{
+    Position position;
+    position.mX = hero->GetX();
+    position.mRow = (int)(hero->GetY() / TileToPixels);
+    if (!hero->GetOnBoat())
+    {
+        return position;
+    }
+
+    position.mBoat = FindBoat(position.mRow, hero->GetX(), step);
+    if (position.mBoat < 0)
+    {
+        return position;
+    }
+
+    position.mX = mBoats[position.mBoat].mPositions[step - mFirstStep];
+    position.mBoarded = step;
+
+    // A sketchy boat has been ridden for a while already
+    CIsSketchyVisitor visitor;
+    mBoats[position.mBoat].mVehicle->Accept(&visitor);
+    if (visitor.GetIsSketchy())
+    {
+        position.mBoarded -= (int)ceil(visitor.GetSketchy()->GetTimeRidden() / StepTime);
+    }
+
+    return position;
+}
+
+
+/**
+ * Get the first step an input does anything in
+ * \returns Step just after the get ready countdown is over
+ */
+int CLaneModel::GetReadyStep()
+{
+    return (int)ceil(CControlPanel::ReadyTime / StepTime) + 2;
+}
@@ -0,0 +1,173 @@
+/**
+ * \file LaneModel.h
+ *
+ * \author Michael Dittman
+ *
+ * Where the hero can go in a level, a step of time at a time.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include "RuleTable.h"
+
+class CGame;
+class CHero;
+class CVehicle;
+class COccupancy;
+
+
+/**
+ * Where the hero can go in a level, a step of time at a time.
+ *
+ * Vehicles follow the same path every time a level is played, so where
+ * each one is at the start of every step and the parts of its lane it
+ * sweeps during the step are worked out ahead of time. The hero's moves
+ * are then tried against those tables the way CGame moves the hero,
+ * locks it onto boats and tests it for collisions. Where the level's
+ * occupancy tables say no car comes near the hero during a step, the
+ * cars aren't looked at.
+ *
+ * The tables are made from the game on the thread that owns it, as the
+ * vehicles' images can't be used from more than one thread. After that
+ * the model only reads its tables, so any number of threads can try
+ * moves on it at once.
+ */
+class CLaneModel
+{
+public:
+    /// Length in seconds of a step, the hero can make one input a step
+    const static double StepTime;
+
+    /// Number of rows of tiles in the play area
+    const static int Rows = 16;
+
+    /// Highest row the hero can move to, the row of the top bank that cargo is taken across to
+    const static int TopRow = 1;
+
+    /// Lowest row the hero can move to, the row of the bottom bank where the cargo starts
+    const static int BottomRow = 14;
+
+    /// Where the hero is at the start of a step
+    struct Position
+    {
+        double mX = 0;              ///< Hero X in virtual pixels
+        int mRow = 0;               ///< Row of tiles the hero is on
+        int mBoat = -1;             ///< Boat the hero is riding, -1 for none
+        int mBoarded = 0;           ///< Step the hero got on the boat it is riding
+    };
+
+    /// Default constructor (disabled)
+    CLaneModel() = delete;
+
+    /// Copy constructor (disabled)
+    CLaneModel(const CLaneModel&) = delete;
+
+    CLaneModel(CGame* game);
+
+    void Extend(int steps);
+
+    void Discard(int step);
+
+    /** Set if moves may be made any time during a step instead of at its start
+     * \param loose True to only step onto boats that are under the hero the whole step */
+    void SetLoose(bool loose) { mLoose = loose; }
+
+    /** Get the first step the tables cover
+     * \returns Step number */
+    int GetFirstStep() const { return mFirstStep; }
+
+    /** Get the number of steps the tables cover from the start of the level
+     * \returns One past the last step moves can be tried in */
+    int GetSteps() const { return mFollowed - 1; }
+
+    bool Move(Position& position, int action, int step) const;
+
+    CRuleTable::Loss GetLoss(const Position& position, int step, bool moved) const;
+
+    /** Test if the hero gets through a step without losing to a lane
+     * \param position Where the hero is at the start of the step, after any move
+     * \param step Step to get through
+     * \param moved True if the hero just moved
+     * \returns True if no vehicle or river loses the level during the step */
+    bool Survives(const Position& position, int step, bool moved) const { return GetLoss(position, step, moved) == CRuleTable::NoLoss; }
+
+    void Ride(Position& position, int step) const;
+
+    bool IsSafe(const Position& position) const;
+
+    unsigned long long GetKey(const Position& position, int step) const;
+
+    int FindBoat(int row, double x, int step) const;
+
+    Position Locate(CHero* hero, int step) const;
+
+    static int GetReadyStep();
+
+    /** Is a boat a sketchy boat?
+     * \param boat Boat to test
+     * \returns True if the boat sinks when ridden too long */
+    bool IsSketchy(int boat) const { return mBoats[boat].mSketchy; }
+
+    /** Get the X of a boat at the start of a step
+     * \param boat Boat to get
+     * \param step Step to get it at
+     * \returns X in virtual pixels */
+    double GetBoatX(int boat, int step) const { return mBoats[boat].mPositions[step - mFirstStep]; }
+
+    /** Get the number of distinct keys GetKey makes, which has room for every boat
+     * \returns One past the largest key */
+    unsigned long long GetKeyCount() const { return (unsigned long long)Rows * (mBoats.size() + 1) * 4096; }
+
+private:
+    /// Where a vehicle is each step
+    struct Vehicle
+    {
+        CVehicle* mVehicle = nullptr;   ///< Vehicle in the game
+        int mRow = 0;                   ///< Row of tiles the vehicle's lane is on
+        bool mSketchy = false;          ///< True for sketchy boats
+        double mLandLeft = 0;           ///< Left edge of where the hero can land, from the boat's center
+        double mLandRight = 0;          ///< Right edge of where the hero can land, from the boat's center
+        std::vector<double> mPositions;                     ///< X at the start of each step
+        std::vector<std::pair<double, double>> mSweeps;     ///< Parts covered during each step, two a step
+    };
+
+    void Follow(Vehicle& vehicle, int step);
+
+    void Board(Position& position, int step) const;
+
+    bool IsHit(const Position& position, int step) const;
+
+    /// The cars, in the order the game tests them
+    std::vector<Vehicle> mCars;
+
+    /// The boats, in the order the game tests them
+    std::vector<Vehicle> mBoats;
+
+    /// Rows that are river, by row
+    std::vector<bool> mRiver;
+
+    /// Rows with cars on them, by row
+    std::vector<bool> mRoad;
+
+    /// Occupancy tables of the level, or null if it has none
+    std::shared_ptr<COccupancy> mOccupancy;
+
+    /// Half the hero's width in virtual pixels
+    double mHeroHalf = 0;
+
+    /// Largest X the hero can be at
+    double mMaxX = 0;
+
+    /// First step the tables cover
+    int mFirstStep = 0;
+
+    /// One past the last step the tables cover
+    int mFollowed = 0;
+
+    /// Moves may be made any time during a step
+    bool mLoose = false;
+};
+
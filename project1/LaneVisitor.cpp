@@ -0,0 +1,28 @@
+/**
+ * \file LaneVisitor.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "LaneVisitor.h"
+
+
+/**
+ * Visit a Car object
+ * \param car Car object we are visiting.
+ */
+void CLaneVisitor::VisitCar(CCar* car)
+{
+    mCars.push_back(car);
+}
+
+
+/**
+ * Visit a Boat object
+ * \param boat Boat object we are visiting.
+ */
+void CLaneVisitor::VisitBoat(CBoat* boat)
+{
+    mBoats.push_back(boat);
+}
@@ -0,0 +1,41 @@
+/**
+ * \file LaneVisitor.h
+ *
+ * \author Michael Dittman
+ *
+ * Visitor that collects the things in a level the hero has to cross.
+ */
+
+#pragma once
+#include "ItemVisitor.h"
+#include <vector>
+
+
+/**
+ * Visitor that collects the things in a level the hero has to cross.
+ *
+ * That is the cars and the boats, each in the order the game
+ * tests them in. Which rows are river is up to CRuleTable.
+ */
+class CLaneVisitor : public CItemVisitor
+{
+public:
+    virtual void VisitCar(CCar* car) override;
+
+    virtual void VisitBoat(CBoat* boat) override;
+
+    /** Returns the cars.
+    * \returns Cars in item order */
+    const std::vector<CCar*>& GetCars() const { return mCars; }
+
+    /** Returns the boats, sketchy ones included.
+    * \returns Boats in item order */
+    const std::vector<CBoat*>& GetBoats() const { return mBoats; }
+
+private:
+    /// The cars visited
+    std::vector<CCar*> mCars;
+
+    /// The boats visited
+    std::vector<CBoat*> mBoats;
+};
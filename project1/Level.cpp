@@ -15,10 +15,12 @@
 #include "Boat.h"
 #include "SketchyBoat.h"
 #include "Car.h"
+#include "ThreadPool.h"
 #include <memory>
 #include <map>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 using namespace std;
 using namespace Gdiplus;
@@ -36,24 +38,115 @@ CLevel::CLevel(CGame* game) : mGame(game)
 {
 }
 
+/// Images already loaded, by filename. Weak so the levels
+/// still decide when the bitmaps are freed.
+static map<wstring, weak_ptr<Bitmap>> LoadedImages;
+
 /**
  * Loads an image from a file
  * 
+ * An image used by several levels is only loaded once and
+ * the levels share the bitmap.
+ * 
  * \param filename file to load image from
  * \return bitmap of image from file
  */
 shared_ptr<Bitmap> LoadImage(wstring& filename)
 {
-    shared_ptr<Bitmap> image = shared_ptr<Bitmap>(Bitmap::FromFile(filename.c_str()));
+    shared_ptr<Bitmap> image = LoadedImages[filename].lock();
+    if (image != nullptr)
+    {
+        return image;
+    }
+
+    image = shared_ptr<Bitmap>(Bitmap::FromFile(filename.c_str()));
     if (image->GetLastStatus() != Ok)
     {
         wstring msg(L"Failed to open ");
         msg += filename;
         AfxMessageBox(msg.c_str());
     }
+    else
+    {
+        LoadedImages[filename] = image;
+    }
     return image;
 }
 
+/**
+ * Decode the images a level uses that are not loaded yet.
+ *
+ * Each image is decoded into its own bitmap on the shared thread
+ * pool, so no bitmap is touched by two threads. Images that fail
+ * are left for LoadImage to report.
+ *
+ * \param root Root node of the level
+ * \returns The bitmaps decoded, to keep them alive while the level takes them
+ */
+static vector<shared_ptr<Bitmap>> PreloadImages(const shared_ptr<CXmlNode>& root)
+{
+    const wchar_t* attributes[] = { L"image", L"image1", L"image2", L"hit-image", L"mask", L"carried-image" };
+
+    // Types, hero and cargo are the nodes that name images
+    vector<shared_ptr<CXmlNode>> nodes;
+    for (auto section : root->GetChildren())
+    {
+        if (section->GetType() != NODE_ELEMENT)
+        {
+            continue;
+        }
+
+        if (section->GetName() == L"types")
+        {
+            for (auto node : section->GetChildren())
+            {
+                if (node->GetType() == NODE_ELEMENT)
+                {
+                    nodes.push_back(node);
+                }
+            }
+        }
+        else if (section->GetName() == L"hero" || section->GetName() == L"cargo")
+        {
+            nodes.push_back(section);
+        }
+    }
+
+    vector<wstring> filenames;
+    for (auto node : nodes)
+    {
+        for (auto attribute : attributes)
+        {
+            wstring name = node->GetAttributeValue(attribute, L"");
+            wstring filename = L".\\images\\" + name;
+            if (!name.empty() && LoadedImages[filename].expired() &&
+                find(filenames.begin(), filenames.end(), filename) == filenames.end())
+            {
+                filenames.push_back(filename);
+            }
+        }
+    }
+
+    vector<shared_ptr<Bitmap>> images(filenames.size());
+    CThreadPool::GetShared()->ParallelFor(0, (int)filenames.size(), 1, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                images[i] = shared_ptr<Bitmap>(Bitmap::FromFile(filenames[i].c_str()));
+            }
+        });
+
+    for (size_t i = 0; i < filenames.size(); i++)
+    {
+        if (images[i] != nullptr && images[i]->GetLastStatus() == Ok)
+        {
+            LoadedImages[filenames[i]] = images[i];
+        }
+    }
+
+    return images;
+}
+
 /**
  * Function to load in the contents of each level
  *
@@ -71,7 +164,34 @@ void CLevel::Load(const std::wstring& filename)
     try
     {
         // Open the document to read
-        shared_ptr<CXmlNode> root = CXmlNode::OpenDocument(filename);
+        Load(CXmlNode::OpenDocument(filename));
+    }
+    catch (CXmlNode::Exception ex)
+    {
+        AfxMessageBox(ex.Message().c_str());
+    }
+
+}
+
+/**
+ * Load the contents of a level from its document.
+ *
+ * The document can be one read from a file or one made in
+ * memory, the way generated levels are made.
+ *
+ * \param root Root node of the level document
+ */
+void CLevel::Load(const std::shared_ptr<xmlnode::CXmlNode>& root)
+{
+
+    // We surround with a try/catch to handle errors
+    try
+    {
+        // Decoding the images is most of the work, do it all at once
+        auto images = PreloadImages(root);
+
+        // A level can be taller than the screen, but not shorter
+        mRows = max(root->GetAttributeIntValue(L"rows", CRuleTable::Rows), CRuleTable::Rows);
 
         //
         // Traverse the children of the root
@@ -92,6 +212,12 @@ void CLevel::Load(const std::wstring& filename)
                         wstring imageName = L".\\images\\" + node->GetAttributeValue(L"image", L"");
                         wstring id = node->GetAttributeValue(L"id", L"");
                         mImageMap[id].push_back(LoadImage(imageName));
+
+                        // Decor says if it is road or river
+                        if (node->GetName() == L"decor")
+                        {
+                            mTerrain[id] = CRuleTable::GetTerrainKind(node->GetAttributeValue(L"terrain", L""));
+                        }
                     }
 
                     // If the type was car
@@ -180,6 +306,11 @@ void CLevel::Load(const std::wstring& filename)
         mTempHeroCargoVec.erase(mTempHeroCargoVec.begin(), mTempHeroCargoVec.end());
         */
 
+        // Vehicles are all in place, work out where they will be
+        mOccupancy = make_shared<COccupancy>(mBelowHero);
+        mCargoPuzzle = make_shared<CCargoPuzzle>(mAboveHero);
+        mRuleTable = make_shared<CRuleTable>(mBelowHero, mTerrain, mRows);
+
     }
     catch (CXmlNode::Exception ex)
     {
@@ -265,6 +396,12 @@ void CLevel::XmlItem(const std::shared_ptr<xmlnode::CXmlNode>& node, const doubl
     {
         item->XmlLoad(node);
 
+        // Cargo starts on the bottom bank unless it says where
+        if (heroCargo && node->GetAttribute(L"y") == nullptr)
+        {
+            item->SetLocation(item->GetX(), (mRows - 0.5) * TileToPixels);
+        }
+
         if (!heroCargo)
         {
             Add(item);
@@ -13,6 +13,9 @@
 #include <string>
 #include "Item.h"
 #include "Hero.h"
+#include "Occupancy.h"
+#include "CargoPuzzle.h"
+#include "RuleTable.h"
 
 
  /**
@@ -26,6 +29,7 @@ public:
 	CLevel(CGame* game);
 
 	void Load(const std::wstring& filename);
+	void Load(const std::shared_ptr<xmlnode::CXmlNode>& root);
 	void XmlItem(const std::shared_ptr<xmlnode::CXmlNode>& node, const double speed = 0.0, const int width = 0, const int yPos = 0);
 	void Add(std::shared_ptr<CItem> item);
 	void AddCargo(std::shared_ptr<CItem> item);
@@ -45,9 +49,27 @@ public:
 	 * \return vector of cargo items for this level
 	 */
 	std::vector<std::shared_ptr<CItem>> GetCargo() { return mAboveHero; }
+	/** Getter for the occupancy tables of this level's lanes
+	 * \return occupancy tables, or null if the level failed to load
+	 */
+	std::shared_ptr<COccupancy> GetOccupancy() { return mOccupancy; }
+	/** Getter for what this level's cargo eats
+	 * \return cargo puzzle, or null if the level failed to load
+	 */
+	std::shared_ptr<CCargoPuzzle> GetCargoPuzzle() { return mCargoPuzzle; }
+	/** Getter for what each row of this level is and what on it loses
+	 * \return rule table, or null if the level failed to load
+	 */
+	std::shared_ptr<CRuleTable> GetRuleTable() { return mRuleTable; }
+	/** Getter for the number of rows of tiles in this level
+	 * \return rows, a screen's worth or more
+	 */
+	int GetRows() { return mRows; }
 private:
 	/// Map holding the bitmaps associated with IDs
 	std::map<std::wstring, std::vector<std::shared_ptr<Gdiplus::Bitmap>>> mImageMap; 
+	/// Map holding the terrain of each decor type, by ID
+	std::map<std::wstring, CRuleTable::Terrain> mTerrain;
 	/// Vector holding all items drawn above hero for this level (everything except hero and cargo)
 	std::vector<std::shared_ptr<CItem>> mBelowHero; 
 	/// Pointer to game
@@ -56,5 +78,13 @@ private:
 	std::shared_ptr<CHero> mHero; 
 	/// Vector holding things drawn above the hero (cargo)
 	std::vector<std::shared_ptr<CItem>> mAboveHero;
+	/// Which tiles of each lane have a vehicle in them over time
+	std::shared_ptr<COccupancy> mOccupancy;
+	/// What the cargo eats and how to get it across
+	std::shared_ptr<CCargoPuzzle> mCargoPuzzle;
+	/// What each row is and what on it loses the level
+	std::shared_ptr<CRuleTable> mRuleTable;
+	/// Rows of tiles in this level, from the level's rows attribute
+	int mRows = CRuleTable::Rows;
 };
 
@@ -0,0 +1,162 @@
+/**
+ * \file LevelTemplate.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "LevelTemplate.h"
+#include "Game.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+
+/**
+ * Constructor. Makes a template of the level the game has loaded.
+ *
+ * The level's vehicles are followed up to the time limit, so this
+ * is done on the thread that owns the game.
+ *
+ * \param game Game with the level loaded
+ * \param limit Level time in seconds players run out of time at
+ */
+CLevelTemplate::CLevelTemplate(CGame* game, double limit)
+{
+    mFirstStep = CLaneModel::GetReadyStep();
+    mLastStep = max(mFirstStep + 1, (int)ceil(limit / CLaneModel::StepTime));
+    mMaxX = game->GetHeroMaxX();
+
+    mLanes = make_unique<CLaneModel>(game);
+    mLanes->Extend(mLastStep);
+    mCargo = make_unique<CCargoModel>(game);
+    mStart = mLanes->Locate(game->GetHero().get(), mFirstStep);
+}
+
+
+/**
+ * Get where a player starts the level
+ * \returns State at the start
+ */
+CLevelTemplate::State CLevelTemplate::GetStart() const
+{
+    State state;
+    state.mHero = mStart;
+    state.mCargo = mCargo->GetStart();
+    state.mStep = mFirstStep;
+    return state;
+}
+
+
+/**
+ * Make an action and take a state to the next step, the way
+ * CSolver::Expand does.
+ *
+ * A state that won or lost is left where it was.
+ *
+ * \param state State to step
+ * \param action Action to make
+ * \returns How the step went
+ */
+CLevelTemplate::Result CLevelTemplate::Advance(State& state, int action) const
+{
+    // Actions that do nothing are the same as waiting
+    CLaneModel::Position hero = state.mHero;
+    int cargo = state.mCargo;
+    bool acted = Apply(state, action, hero, cargo);
+    if (!acted)
+    {
+        hero = state.mHero;
+        cargo = state.mCargo;
+    }
+
+    bool moved = acted && action < ClickCargo;
+    if (!mLanes->Survives(hero, state.mStep, moved) || mCargo->IsEaten(cargo, hero.mRow))
+    {
+        return Lost;
+    }
+
+    if (acted && action >= ClickCargo && mCargo->IsWon(cargo))
+    {
+        return Won;
+    }
+
+    mLanes->Ride(hero, state.mStep);
+    state.mHero = hero;
+    state.mCargo = cargo;
+    state.mStep++;
+    return state.mStep >= mLastStep ? TimedOut : Playing;
+}
+
+
+/**
+ * Try an action
+ * \param state State to make the action in
+ * \param action Action to make
+ * \param hero Where the hero is, changed to where the action takes it
+ * \param cargo Where the cargo is, changed to where the action leaves it
+ * \returns False if the action does nothing or drifts the hero off the screen
+ */
+bool CLevelTemplate::Apply(const State& state, int action, CLaneModel::Position& hero, int& cargo) const
+{
+    if (action >= ClickCargo)
+    {
+        int index = action - ClickCargo;
+        return index < mCargo->GetCount() && mCargo->Click(cargo, hero.mRow, index);
+    }
+
+    if (action > Wait)
+    {
+        return mLanes->Move(hero, CReplay::Forward + action - Forward, state.mStep);
+    }
+
+    return false;
+}
+
+
+/**
+ * Test if the hero would get through the step after a move
+ * \param state State to move in
+ * \param action Wait or a move
+ * \returns True if nothing would lose the level during the step
+ */
+bool CLevelTemplate::Survives(const State& state, int action) const
+{
+    CLaneModel::Position hero = state.mHero;
+    int cargo = state.mCargo;
+    bool acted = Apply(state, action, hero, cargo);
+    if (!acted)
+    {
+        hero = state.mHero;
+    }
+
+    return mLanes->Survives(hero, state.mStep, acted) && !mCargo->IsEaten(state.mCargo, hero.mRow);
+}
+
+
+/**
+ * Find how a step that Advance says is lost loses the level
+ * \param state State at the start of the step
+ * \param action Action made in the step
+ * \param hero Set to where the hero is when it loses
+ * \returns How the level is lost, NoLoss if the step doesn't lose it
+ */
+CRuleTable::Loss CLevelTemplate::GetLoss(const State& state, int action, CLaneModel::Position& hero) const
+{
+    hero = state.mHero;
+    int cargo = state.mCargo;
+    bool acted = Apply(state, action, hero, cargo);
+    if (!acted)
+    {
+        hero = state.mHero;
+        cargo = state.mCargo;
+    }
+
+    CRuleTable::Loss loss = mLanes->GetLoss(hero, state.mStep, acted && action < ClickCargo);
+    if (loss == CRuleTable::NoLoss && mCargo->IsEaten(cargo, hero.mRow))
+    {
+        loss = CRuleTable::CargoEaten;
+    }
+    return loss;
+}
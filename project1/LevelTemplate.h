@@ -0,0 +1,100 @@
+/**
+ * \file LevelTemplate.h
+ *
+ * \author Michael Dittman
+ *
+ * A level made ready to be played by any number of players at once.
+ */
+
+#pragma once
+
+#include <memory>
+#include "LaneModel.h"
+#include "CargoModel.h"
+
+class CGame;
+
+
+/**
+ * A level made ready to be played by any number of players at once.
+ *
+ * The template is a CLaneModel and a CCargoModel of the level, made
+ * once from the game. Where a player is in the level is a small State
+ * of its own, and Advance takes a state through one step the same way
+ * the solver tries inputs. The template itself is never changed after
+ * it is made, so any number of threads can advance states on it.
+ */
+class CLevelTemplate
+{
+public:
+    /// Actions a player can make in a step, ClickCargo + i clicks on cargo item i
+    enum Action { Wait, Forward, Backward, Left, Right, ClickCargo };
+
+    /// How a step went
+    enum Result { Playing, Won, Lost, TimedOut };
+
+    /// Where a player is in the level
+    struct State
+    {
+        CLaneModel::Position mHero; ///< Where the hero is
+        int mCargo = 0;             ///< Where the cargo is, a CCargoModel state
+        int mStep = 0;              ///< Step the player is at
+    };
+
+    /// Default constructor (disabled)
+    CLevelTemplate() = delete;
+
+    /// Copy constructor (disabled)
+    CLevelTemplate(const CLevelTemplate&) = delete;
+
+    CLevelTemplate(CGame* game, double limit);
+
+    State GetStart() const;
+
+    Result Advance(State& state, int action) const;
+
+    bool Apply(const State& state, int action, CLaneModel::Position& hero, int& cargo) const;
+
+    bool Survives(const State& state, int action) const;
+
+    CRuleTable::Loss GetLoss(const State& state, int action, CLaneModel::Position& hero) const;
+
+    /** Get where the hero can go
+     * \returns Lane model */
+    const CLaneModel& GetLanes() const { return *mLanes; }
+
+    /** Get where the cargo can be
+     * \returns Cargo model */
+    const CCargoModel& GetCargo() const { return *mCargo; }
+
+    /** Get the step players start at, once the get ready countdown is over
+     * \returns Step number */
+    int GetFirstStep() const { return mFirstStep; }
+
+    /** Get the step players run out of time at
+     * \returns Step number */
+    int GetLastStep() const { return mLastStep; }
+
+    /** Get the largest X the hero can be at
+     * \returns X in virtual pixels */
+    double GetMaxX() const { return mMaxX; }
+
+private:
+    /// Where the hero can go
+    std::unique_ptr<CLaneModel> mLanes;
+
+    /// Where the cargo can be
+    std::unique_ptr<CCargoModel> mCargo;
+
+    /// Where the hero starts
+    CLaneModel::Position mStart;
+
+    /// Step players start at
+    int mFirstStep = 0;
+
+    /// Step players run out of time at
+    int mLastStep = 0;
+
+    /// Largest X the hero can be at
+    double mMaxX = 0;
+};
@@ -0,0 +1,535 @@
+/**
+ * \file LevelTuner.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "LevelTuner.h"
+#include "ThreadPool.h"
+#include "Solver.h"
+#include "Game.h"
+#include "Level.h"
+#include <cmath>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+
+using namespace std;
+using namespace xmlnode;
+
+/// Candidates made each generation
+const int Candidates = 8;
+
+/// Changes tried for each candidate before a generation makes do with fewer
+const int MaxTries = 20;
+
+/// Plays of each candidate in a round of measuring success rates
+const int RoundPlays = 512;
+
+/// Most rounds a candidate's success rate is measured over
+const int Rounds = 8;
+
+/// Standard errors a success rate could be off by before a candidate is dropped
+const double Confidence = 3;
+
+/// Level time in seconds plays run out of time at
+const double TuneLimit = 180;
+
+/// Longest solve time in seconds looked for
+const double SolveLimit = 180;
+
+/// A success rate this close to the target is close enough
+const double RateTolerance = 0.01;
+
+/// A solve time this many seconds from the target is close enough
+const double TimeTolerance = 0.25;
+
+/// Fewest tiles a lane can wrap around after, the width of the screen
+const int MinWidth = 16;
+
+/// Most tiles a lane can wrap around after
+const int MaxWidth = 48;
+
+/// Slowest a lane can go in tenths of a tile a second
+const int MinSpeed = 5;
+
+/// Fastest a lane can go in tenths of a tile a second
+const int MaxSpeed = 150;
+
+/// Success rate TuneLevels aims for
+const double TunedRate = 0.6;
+
+/// Generations TuneLevels searches for
+const int TuneGenerations = 12;
+
+
+/**
+ * Load the lanes of a level
+ * \param filename Level file
+ * \returns False if the file can't be read
+ */
+bool CLevelTuner::Load(const std::wstring& filename)
+{
+    mRoot = nullptr;
+    mLaneNodes.clear();
+    mVehicleNodes.clear();
+    mLanes.clear();
+    mGaps.clear();
+
+    try
+    {
+        mRoot = CXmlNode::OpenDocument(filename);
+
+        for (auto section : mRoot->GetChildren())
+        {
+            if (section->GetType() == NODE_ELEMENT && (section->GetName() == L"road" || section->GetName() == L"river"))
+            {
+                Lane lane;
+                lane.mRow = section->GetAttributeIntValue(L"y", 0);
+                lane.mSpeed = section->GetAttributeDoubleValue(L"speed", 1.0);
+                lane.mWidth = section->GetAttributeIntValue(L"width", 1);
+
+                vector<shared_ptr<CXmlNode>> vehicles;
+                for (auto node : section->GetChildren())
+                {
+                    if (node->GetType() == NODE_ELEMENT)
+                    {
+                        lane.mX.push_back(node->GetAttributeIntValue(L"x", 0));
+                        vehicles.push_back(node);
+                    }
+                }
+
+                mLaneNodes.push_back(section);
+                mVehicleNodes.push_back(vehicles);
+                mLanes.push_back(lane);
+                mGaps.push_back(GetGap(lane));
+            }
+        }
+    }
+    catch (CXmlNode::Exception ex)
+    {
+        mRoot = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Search for lanes that make the level as hard as a target
+ * \param target What to aim for
+ * \param filename Level file to write, it has the closest lanes in it when the search is done
+ * \param generations Most generations of candidates to make
+ * \param seed Seed of the changes made to lanes, the same seed makes the same search
+ * \returns What the search came to
+ */
+CLevelTuner::Result CLevelTuner::Tune(const Target& target, const std::wstring& filename, int generations, unsigned seed)
+{
+    Result result;
+    result.mLanes = mLanes;
+    if (mRoot == nullptr)
+    {
+        return result;
+    }
+
+    // What each set of lanes measured, by key
+    unordered_map<wstring, Measure> measured;
+    auto measure = [&](vector<Candidate>& candidates, double best)
+    {
+        if (target.mKind == Target::SolveTime)
+        {
+            MeasureTimes(candidates, target, filename, best, result);
+        }
+        else
+        {
+            MeasureRates(candidates, target, filename, best, result);
+        }
+
+        for (auto& candidate : candidates)
+        {
+            measured[candidate.mKey] = candidate.mMeasure;
+        }
+        result.mMeasured += (int)candidates.size();
+    };
+
+    vector<Candidate> start(1);
+    start[0].mLanes = mLanes;
+    start[0].mKey = GetKey(mLanes);
+    measure(start, HUGE_VAL);
+    result.mStart = result.mValue = start[0].mMeasure.mValue;
+
+    double best = fabs(result.mValue - target.mValue);
+    double tolerance = target.mKind == Target::SolveTime ? TimeTolerance : RateTolerance;
+    mt19937 random(seed);
+    for (int generation = 0; generation < generations && best > tolerance; generation++)
+    {
+        vector<Candidate> candidates;
+        for (int tries = 0; (int)candidates.size() < Candidates && tries < Candidates * MaxTries; tries++)
+        {
+            Candidate candidate;
+            candidate.mLanes = result.mLanes;
+            if (!Mutate(candidate.mLanes, random))
+            {
+                continue;
+            }
+
+            candidate.mKey = GetKey(candidate.mLanes);
+            if (measured.find(candidate.mKey) != measured.end())
+            {
+                result.mCached++;
+                continue;
+            }
+
+            auto same = [&](const Candidate& other) { return other.mKey == candidate.mKey; };
+            if (find_if(candidates.begin(), candidates.end(), same) == candidates.end())
+            {
+                candidates.push_back(move(candidate));
+            }
+        }
+
+        if (candidates.empty())
+        {
+            break;
+        }
+
+        measure(candidates, best);
+        for (auto& candidate : candidates)
+        {
+            double distance = fabs(candidate.mMeasure.mValue - target.mValue);
+            if (!candidate.mMeasure.mDropped && distance < best)
+            {
+                best = distance;
+                result.mLanes = candidate.mLanes;
+                result.mValue = candidate.mMeasure.mValue;
+            }
+        }
+    }
+
+    Save(filename, result.mLanes);
+    return result;
+}
+
+
+/**
+ * Write a level file with different lanes
+ * \param filename File to write
+ * \param lanes Lanes to write, one for each lane of the level as loaded
+ */
+void CLevelTuner::Save(const std::wstring& filename, const std::vector<Lane>& lanes) const
+{
+    if (mRoot == nullptr)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < lanes.size() && i < mLaneNodes.size(); i++)
+    {
+        // Written the way the levels are, not with the digits a double has
+        wostringstream speed;
+        speed << lanes[i].mSpeed;
+        mLaneNodes[i]->SetAttribute(L"speed", speed.str());
+        mLaneNodes[i]->SetAttribute(L"width", lanes[i].mWidth);
+
+        for (size_t v = 0; v < lanes[i].mX.size() && v < mVehicleNodes[i].size(); v++)
+        {
+            mVehicleNodes[i][v]->SetAttribute(L"x", lanes[i].mX[v]);
+        }
+    }
+
+    try
+    {
+        mRoot->Save(filename);
+    }
+    catch (CXmlNode::Exception ex)
+    {
+        AfxMessageBox(ex.Message().c_str());
+    }
+}
+
+
+/**
+ * Measure the success rates of candidates, dropping those that can't
+ * get closer to the target than the best as soon as that is clear
+ * \param candidates Candidates to measure
+ * \param target What the search aims for
+ * \param filename Level file to load each candidate from
+ * \param best How far the best lanes so far are from the target
+ * \param result Search counts, added to
+ */
+void CLevelTuner::MeasureRates(std::vector<Candidate>& candidates, const Target& target, const std::wstring& filename,
+    double best, Result& result)
+{
+    // Templates are made from a game on this thread, the plays
+    // on them can be anywhere
+    CGame game;
+    for (auto& candidate : candidates)
+    {
+        Save(filename, candidate.mLanes);
+        auto level = make_shared<CLevel>(&game);
+        level->Load(filename);
+        game.Add(level);
+        game.Load(game.GetLevelCount() - 1);
+        candidate.mEstimator = make_unique<CDifficultyEstimator>(&game, TuneLimit);
+    }
+
+    vector<Candidate*> live;
+    for (auto& candidate : candidates)
+    {
+        live.push_back(&candidate);
+    }
+
+    for (int round = 0; round < Rounds && !live.empty(); round++)
+    {
+        // Every candidate gets the same plays, so chance favors none of them
+        CThreadPool::GetShared()->ParallelFor(0, (int)live.size(), 1, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                auto estimate = live[i]->mEstimator->Run(target.mAgent, RoundPlays, round);
+                live[i]->mPlays += estimate.mPlays;
+                live[i]->mWins += estimate.mWins;
+            }
+        });
+        result.mPlays += (long long)RoundPlays * live.size();
+
+        vector<Candidate*> next;
+        for (auto candidate : live)
+        {
+            double rate = (double)candidate->mWins / candidate->mPlays;
+            candidate->mMeasure.mValue = rate;
+
+            // A play either way as well, for rates near none or all
+            double spread = Confidence * sqrt(rate * (1 - rate) / candidate->mPlays) + 1.0 / candidate->mPlays;
+            if (fabs(rate - target.mValue) - spread > best)
+            {
+                candidate->mMeasure.mDropped = true;
+                result.mDropped++;
+            }
+            else
+            {
+                next.push_back(candidate);
+            }
+        }
+
+        live = next;
+    }
+
+    for (auto& candidate : candidates)
+    {
+        candidate.mEstimator = nullptr;
+    }
+}
+
+
+/**
+ * Measure the quickest solve times of candidates, giving up on each
+ * one past the time it would have to be won by to be closer to the
+ * target than the best
+ * \param candidates Candidates to measure
+ * \param target What the search aims for
+ * \param filename Level file to load each candidate from
+ * \param best How far the best lanes so far are from the target
+ * \param result Search counts, added to
+ */
+void CLevelTuner::MeasureTimes(std::vector<Candidate>& candidates, const Target& target, const std::wstring& filename,
+    double best, Result& result)
+{
+    CGame game;
+    CSolver solver(&game);
+    double limit = min(target.mValue + best, SolveLimit);
+    for (auto& candidate : candidates)
+    {
+        Save(filename, candidate.mLanes);
+        auto level = make_shared<CLevel>(&game);
+        level->Load(filename);
+        game.Add(level);
+
+        // The solver searches states of each step in parallel
+        auto solution = solver.Solve(game.GetLevelCount() - 1, limit + CLaneModel::StepTime);
+        candidate.mMeasure.mValue = solution.mSolved ? solution.mTime : limit;
+        candidate.mMeasure.mDropped = !solution.mSolved;
+        if (!solution.mSolved)
+        {
+            result.mDropped++;
+        }
+    }
+}
+
+
+/**
+ * Change one or two lanes a little
+ * \param lanes Lanes to change
+ * \param random Random numbers to pick the changes with
+ * \returns False if the lanes are no good after the changes
+ */
+bool CLevelTuner::Mutate(std::vector<Lane>& lanes, std::mt19937& random) const
+{
+    if (lanes.empty())
+    {
+        return false;
+    }
+
+    int changes = 1 + random() % 2;
+    for (int change = 0; change < changes; change++)
+    {
+        int index = random() % lanes.size();
+        Lane& lane = lanes[index];
+        switch (random() % 3)
+        {
+        case 0:
+        {
+            // Up to a fifth faster or slower, in tenths of a tile a second
+            int tenths = (int)lround(fabs(lane.mSpeed) * 10);
+            int most = max(tenths / 5, 1);
+            tenths += (int)(random() % (2 * most + 1)) - most;
+            tenths = min(max(tenths, MinSpeed), MaxSpeed);
+            lane.mSpeed = (lane.mSpeed < 0 ? -tenths : tenths) / 10.0;
+            break;
+        }
+
+        case 1:
+            lane.mWidth = min(max(lane.mWidth + (int)(random() % 5) - 2, MinWidth), MaxWidth);
+            break;
+
+        default:
+            if (!lane.mX.empty())
+            {
+                int& x = lane.mX[random() % lane.mX.size()];
+                x = (x + lane.mWidth + (int)(random() % 5) - 2) % lane.mWidth;
+            }
+            break;
+        }
+
+        // Vehicles have to start in the lane without running into each other
+        for (int x : lane.mX)
+        {
+            if (x < 0 || x >= lane.mWidth)
+            {
+                return false;
+            }
+        }
+
+        if (GetGap(lane) < mGaps[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Get the fewest tiles between the starts of two vehicles in a lane
+ * \param lane Lane to look at
+ * \returns Tiles, going around the end of the lane, or the width with fewer than two vehicles
+ */
+int CLevelTuner::GetGap(const Lane& lane)
+{
+    vector<int> x = lane.mX;
+    sort(x.begin(), x.end());
+
+    int gap = lane.mWidth;
+    for (size_t i = 1; i < x.size(); i++)
+    {
+        gap = min(gap, x[i] - x[i - 1]);
+    }
+
+    if (x.size() > 1)
+    {
+        gap = min(gap, x.front() + lane.mWidth - x.back());
+    }
+
+    return gap;
+}
+
+
+/**
+ * Get a key that is the same for the same lanes
+ * \param lanes Lanes
+ * \returns Key
+ */
+std::wstring CLevelTuner::GetKey(const std::vector<Lane>& lanes)
+{
+    wostringstream key;
+    for (auto& lane : lanes)
+    {
+        key << lround(lane.mSpeed * 10) << L"," << lane.mWidth;
+        for (int x : lane.mX)
+        {
+            key << L"," << x;
+        }
+        key << L";";
+    }
+
+    return key.str();
+}
+
+
+/**
+ * Tune every level for a reference player and write the tuned levels
+ * as levelN-tuned.xml
+ * \param levels Directory the levels are in, ending with a separator
+ * \param tuned Directory to write the tuned levels to, ending with a
+ * separator, not the levels directory
+ * \returns Report of each level
+ */
+std::wstring CLevelTuner::TuneLevels(const std::wstring& levels, const std::wstring& tuned)
+{
+    // The Sharp player of CDifficultyEstimator::EstimateLevels
+    Target target;
+    target.mValue = TunedRate;
+    target.mAgent = { 0.15, 0.005, 0.1 };
+
+    wostringstream report;
+    report << fixed << setprecision(1);
+    report << L"Level tuning for a " << 100 * TunedRate << L"% success rate, reaction " << setprecision(2)
+        << target.mAgent.mReaction << L" s, cadence " << target.mAgent.mCadence << L" s, errors " << setprecision(1)
+        << 100 * target.mAgent.mErrorRate << L"%, " << CThreadPool::GetShared()->GetThreadCount() << L" threads" << endl;
+    report << L"Tuned levels written to " << tuned << endl;
+
+    for (int level = 0; level < 4; level++)
+    {
+        wstring name = L"level" + to_wstring(level);
+        CLevelTuner tuner;
+        if (!tuner.Load(levels + name + L".xml") || tuner.GetLanes().empty())
+        {
+            report << endl << L"Level " << level << L": no lanes to tune" << endl;
+            continue;
+        }
+
+        auto start = chrono::steady_clock::now();
+        Result result = tuner.Tune(target, tuned + name + L"-tuned.xml", TuneGenerations, 1);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        report << endl << L"Level " << level << L": " << 100 * result.mStart << L"% won to " << 100 * result.mValue
+            << L"% won, " << result.mMeasured << L" lanes measured, " << result.mCached << L" cached, "
+            << result.mDropped << L" dropped early, " << result.mPlays << L" plays, " << setprecision(2)
+            << seconds << L" s" << setprecision(1) << endl;
+
+        auto& lanes = tuner.GetLanes();
+        for (size_t i = 0; i < lanes.size(); i++)
+        {
+            auto& from = lanes[i];
+            auto& to = result.mLanes[i];
+            if (GetKey({ from }) == GetKey({ to }))
+            {
+                continue;
+            }
+
+            report << L"  Row " << from.mRow << L": speed " << from.mSpeed << L" to " << to.mSpeed
+                << L", width " << from.mWidth << L" to " << to.mWidth << L", vehicles at";
+            for (size_t v = 0; v < to.mX.size(); v++)
+            {
+                report << L" " << from.mX[v] << L" to " << to.mX[v];
+            }
+            report << endl;
+        }
+    }
+
+    return report.str();
+}
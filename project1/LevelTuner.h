@@ -0,0 +1,139 @@
+/**
+ * \file LevelTuner.h
+ *
+ * \author Michael Dittman
+ *
+ * Searches for lane speeds, widths and vehicle places that make a level as hard as asked.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <random>
+#include "XmlNode.h"
+#include "DifficultyEstimator.h"
+
+
+/**
+ * Searches for lane speeds, widths and vehicle places that make a level as hard as asked.
+ *
+ * A level file is loaded, and each road and river in it is a Lane of
+ * the search. A Target is a success rate for a reference agent or a
+ * quickest solve time. Each generation makes a few candidates by
+ * changing one or two lanes of the best lanes found so far, and the
+ * closest to the target takes over if it is closer than the best.
+ *
+ * Success rates are measured by CDifficultyEstimator plays of all of a
+ * generation's candidates at once, a round of plays at a time. After
+ * each round a candidate whose rate can't be closer to the target than
+ * the best's, allowing for chance, is dropped. Solve times are found by
+ * CSolver, with a limit past which a candidate is farther from the
+ * target than the best. Every candidate is kept by its lanes, so a set
+ * of lanes the search comes back to is never measured again.
+ *
+ * Candidates are written to the level file being made and loaded the
+ * way the game loads levels, so the tuner runs on the thread that owns
+ * the images, like the game. When the search is done the file has the
+ * best lanes in it.
+ */
+class CLevelTuner
+{
+public:
+    /// What the tuner aims for
+    struct Target
+    {
+        /// What is measured
+        enum Kind { SuccessRate, SolveTime };
+
+        Kind mKind = SuccessRate;               ///< What is measured
+        double mValue = 0.5;                    ///< Success rate, 0 to 1, or quickest solve time in seconds
+        CDifficultyEstimator::Agent mAgent;     ///< Agent success rates are measured with
+    };
+
+    /// A road or river of the level
+    struct Lane
+    {
+        int mRow = 0;               ///< Row of tiles the lane is on, which isn't tuned
+        double mSpeed = 0;          ///< Tiles a second the vehicles go, to the right if positive
+        int mWidth = 0;             ///< Tiles the lane wraps around after
+        std::vector<int> mX;        ///< Tile each vehicle starts at
+    };
+
+    /// What a search came to
+    struct Result
+    {
+        std::vector<Lane> mLanes;   ///< Closest lanes found
+        double mValue = 0;          ///< What the closest lanes measured
+        double mStart = 0;          ///< What the level's own lanes measured
+        int mMeasured = 0;          ///< Sets of lanes measured
+        int mCached = 0;            ///< Candidates that had been measured before
+        int mDropped = 0;           ///< Candidates dropped before they were measured in full
+        long long mPlays = 0;       ///< Plays made, for success rates
+    };
+
+    /// Default constructor
+    CLevelTuner() = default;
+
+    /// Copy constructor (disabled)
+    CLevelTuner(const CLevelTuner&) = delete;
+
+    bool Load(const std::wstring& filename);
+
+    Result Tune(const Target& target, const std::wstring& filename, int generations, unsigned seed);
+
+    void Save(const std::wstring& filename, const std::vector<Lane>& lanes) const;
+
+    /** Get the lanes of the level as loaded
+     * \returns Lanes, in the order they are in the file */
+    const std::vector<Lane>& GetLanes() const { return mLanes; }
+
+    static std::wstring TuneLevels(const std::wstring& levels, const std::wstring& tuned);
+
+private:
+    /// What a set of lanes measured
+    struct Measure
+    {
+        double mValue = 0;          ///< Success rate or solve time
+        bool mDropped = false;      ///< True if mValue is only as far as it got before it was dropped
+    };
+
+    /// A set of lanes being measured
+    struct Candidate
+    {
+        std::vector<Lane> mLanes;   ///< Lanes to measure
+        std::wstring mKey;          ///< Key of the lanes in the cache
+        std::unique_ptr<CDifficultyEstimator> mEstimator;   ///< Estimator of the level with these lanes
+        int mPlays = 0;             ///< Plays made so far
+        int mWins = 0;              ///< Plays won so far
+        Measure mMeasure;           ///< What they measured
+    };
+
+    void MeasureRates(std::vector<Candidate>& candidates, const Target& target, const std::wstring& filename,
+        double best, Result& result);
+
+    void MeasureTimes(std::vector<Candidate>& candidates, const Target& target, const std::wstring& filename,
+        double best, Result& result);
+
+    bool Mutate(std::vector<Lane>& lanes, std::mt19937& random) const;
+
+    static int GetGap(const Lane& lane);
+
+    static std::wstring GetKey(const std::vector<Lane>& lanes);
+
+    /// The level file, written to with each candidate's lanes
+    std::shared_ptr<xmlnode::CXmlNode> mRoot;
+
+    /// Road and river nodes, by lane
+    std::vector<std::shared_ptr<xmlnode::CXmlNode>> mLaneNodes;
+
+    /// Vehicle nodes, by lane
+    std::vector<std::vector<std::shared_ptr<xmlnode::CXmlNode>>> mVehicleNodes;
+
+    /// Lanes of the level as loaded
+    std::vector<Lane> mLanes;
+
+    /// Fewest tiles between vehicles in each lane as loaded, which candidates keep to
+    std::vector<int> mGaps;
+};
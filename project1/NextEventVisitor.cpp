@@ -0,0 +1,45 @@
+/**
+ * \file NextEventVisitor.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "NextEventVisitor.h"
+#include "Car.h"
+#include "SketchyBoat.h"
+#include "Hero.h"
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+
+/**
+ * Visit a Car object
+ * \param car Car object we are visiting.
+ */
+void CNextEventVisitor::VisitCar(CCar* car)
+{
+    // Cars only hit the hero when it is walking in their lane
+    if (mHero->GetOnBoat() || fabs(car->GetY() - mHero->GetY()) >= TileToPixels / 2)
+    {
+        return;
+    }
+
+    double half = mHero->GetWidth() / 2;
+    double time = car->GetNextCrossing(car->GetTime(), mHero->GetX() - half, mHero->GetX() + half);
+    mTimeToEvent = fmin(mTimeToEvent, time - car->GetTime());
+}
+
+
+/**
+ * Visit a Sketchy Boat object
+ * \param boat Sketchy boat object we are visiting.
+ */
+void CNextEventVisitor::VisitSketchy(CSketchyBoat* boat)
+{
+    if (mHero->GetOnSketchy() && fabs(mHero->GetX() - boat->GetX()) < 0.5)
+    {
+        mTimeToEvent = fmin(mTimeToEvent, CSketchyBoat::RideTime - boat->GetTimeRidden());
+    }
+}
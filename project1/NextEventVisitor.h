@@ -0,0 +1,45 @@
+/**
+ * \file NextEventVisitor.h
+ *
+ * \author Michael Dittman
+ *
+ * Visitor that finds how long until a vehicle next changes what
+ * happens to the hero.
+ */
+
+#pragma once
+#include "ItemVisitor.h"
+#include <memory>
+#include <cmath>
+
+
+/**
+ * Visitor that finds how long until a vehicle next changes what
+ * happens to the hero.
+ *
+ * That is a car in the hero's lane starting or stopping covering
+ * the hero, or the sketchy boat the hero is riding breaking.
+ */
+class CNextEventVisitor : public CItemVisitor
+{
+public:
+    /** Constructor
+     * \param hero The game's hero.
+     */
+    CNextEventVisitor(std::shared_ptr<CHero> hero) { mHero = hero; }
+
+    virtual void VisitCar(CCar* car) override;
+
+    virtual void VisitSketchy(CSketchyBoat* boat) override;
+
+    /** Returns how long until the next event.
+    * \returns Time in seconds, HUGE_VAL if no vehicle will change anything. */
+    double GetTimeToEvent() { return mTimeToEvent; }
+
+private:
+    /// Time in seconds until the next event
+    double mTimeToEvent = HUGE_VAL;
+
+    /// The game's Hero.
+    std::shared_ptr<CHero> mHero;
+};
@@ -0,0 +1,354 @@
+/**
+ * \file Occupancy.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "Occupancy.h"
+#include "Vehicle.h"
+#include "IsVehicleVisitor.h"
+#include "IsCarVisitor.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Length of a time bucket in seconds
+const double COccupancy::BucketTime = 1.0 / 60;
+
+/// Seconds the periods of the vehicles in a lane can differ by and still be the same
+const double PeriodTolerance = 1e-6;
+
+
+/**
+ * Constructor. Makes the tables for the vehicles among some items.
+ * \param items Items of a level, vehicles at their starting locations
+ */
+COccupancy::COccupancy(const std::vector<std::shared_ptr<CItem>>& items)
+{
+    // The vehicles on each row
+    vector<vector<CVehicle*>> vehicles;
+    for (auto item : items)
+    {
+        CIsVehicleVisitor visitor;
+        item->Accept(&visitor);
+        if (!visitor.GetIsVehicle())
+        {
+            continue;
+        }
+
+        CVehicle* vehicle = visitor.GetVehicle();
+        int row = vehicle->GetRow();
+        if (row < 0)
+        {
+            continue;
+        }
+
+        if (row >= (int)mLanes.size())
+        {
+            mLanes.resize(row + 1);
+            vehicles.resize(row + 1);
+        }
+
+        if (vehicles[row].empty())
+        {
+            CIsCarVisitor carVisitor;
+            item->Accept(&carVisitor);
+            mLanes[row].mRoad = carVisitor.GetIsCar();
+            mLaneCount++;
+        }
+
+        vehicles[row].push_back(vehicle);
+    }
+
+    // Most buckets each lane can have for the tables to stay under MaxBuckets
+    int laneBuckets = max(MaxBuckets / max(mLaneCount, 1), 1);
+
+    for (int row = 0; row < (int)vehicles.size(); row++)
+    {
+        if (vehicles[row].empty())
+        {
+            continue;
+        }
+
+        // A lane only repeats if all of its vehicles go around in the same time
+        Lane& lane = mLanes[row];
+        lane.mPeriod = vehicles[row][0]->GetPeriod();
+        for (auto vehicle : vehicles[row])
+        {
+            if (fabs(vehicle->GetPeriod() - lane.mPeriod) > PeriodTolerance)
+            {
+                MakeMixed(lane, vehicles[row]);
+                break;
+            }
+        }
+
+        if (!lane.mTouched.empty())
+        {
+            continue;
+        }
+
+        // A lane that never repeats is the same all the time
+        int buckets = lane.mPeriod > 0 ? (int)ceil(lane.mPeriod / BucketTime) : 1;
+        lane.mBucketTime = BucketTime;
+        if (buckets > laneBuckets)
+        {
+            // Too many for a level this big, so fewer longer ones that split the period evenly
+            buckets = laneBuckets;
+            lane.mBucketTime = lane.mPeriod / buckets;
+        }
+
+        lane.mTouched.assign(buckets, 0);
+        lane.mCovered.assign(buckets, 0);
+        for (auto vehicle : vehicles[row])
+        {
+            Add(lane, vehicle);
+        }
+    }
+}
+
+
+/**
+ * Add the tiles a vehicle touches and covers in each bucket to the tables of its lane
+ * \param lane Lane the vehicle is in, with its buckets made
+ * \param vehicle Vehicle to add
+ */
+void COccupancy::Add(Lane& lane, CVehicle* vehicle)
+{
+    double half = vehicle->GetWidth() / 2;
+    pair<double, double> sweep[2];
+    for (int bucket = 0; bucket < (int)lane.mTouched.size(); bucket++)
+    {
+        double from = bucket * lane.mBucketTime;
+        double to = lane.mPeriod > 0 ? min(from + lane.mBucketTime, lane.mPeriod) : from;
+        int parts = vehicle->GetSweep(from, to, sweep);
+        for (int part = 0; part < parts; part++)
+        {
+            lane.mTouched[bucket] |= GetColumns(sweep[part].first, sweep[part].second);
+        }
+
+        // The tile centers it stayed over. If it wrapped around, the ones it
+        // stayed over up to going out and the ones from coming back in on.
+        double start = vehicle->GetPositionAt(from);
+        double end = vehicle->GetPositionAt(to);
+        if (parts == 1)
+        {
+            lane.mCovered[bucket] |= GetCentered(max(start, end) - half, min(start, end) + half);
+        }
+        else
+        {
+            auto wrap = vehicle->GetWrap();
+            lane.mCovered[bucket] |= GetCentered(max(start, wrap.first) - half, min(start, wrap.first) + half);
+            lane.mCovered[bucket] |= GetCentered(max(wrap.second, end) - half, min(wrap.second, end) + half);
+        }
+    }
+}
+
+
+/**
+ * Get the tile columns whose centers are inside part of a row
+ * \param left Left edge in virtual pixels
+ * \param right Right edge in virtual pixels
+ * \returns Bit for each column with its center in the part
+ */
+uint16_t COccupancy::GetCentered(double left, double right)
+{
+    int first = max((int)ceil((left - TileToPixels / 2) / TileToPixels), 0);
+    int last = min((int)floor((right - TileToPixels / 2) / TileToPixels), Columns - 1);
+    if (first > last)
+    {
+        return 0;
+    }
+
+    return (uint16_t)(((1 << (last + 1)) - 1) & ~((1 << first) - 1));
+}
+
+
+/**
+ * Make the tables of a lane whose vehicles don't all go around in
+ * the same time.
+ *
+ * Traffic like that takes too long to repeat to keep a bucket for,
+ * so the lane gets one bucket for all time. Every tile any of the
+ * vehicles ever passes over is touched, and no tile is covered,
+ * which never says a tile is clear when a vehicle could be there.
+ *
+ * \param lane Lane to make the tables of
+ * \param vehicles Vehicles in the lane
+ */
+void COccupancy::MakeMixed(Lane& lane, const std::vector<CVehicle*>& vehicles)
+{
+    lane.mPeriod = 0;
+    lane.mTouched.assign(1, 0);
+    lane.mCovered.assign(1, 0);
+    for (auto vehicle : vehicles)
+    {
+        // Half a period at a time, as a sweep can only be as long as a period
+        double period = vehicle->GetPeriod();
+        for (double from = 0; from < period; from += period / 2)
+        {
+            pair<double, double> sweep[2];
+            int parts = vehicle->GetSweep(from, from + period / 2, sweep);
+            for (int part = 0; part < parts; part++)
+            {
+                lane.mTouched[0] |= GetColumns(sweep[part].first, sweep[part].second);
+            }
+        }
+
+        if (period <= 0)
+        {
+            auto extent = vehicle->GetExtentAt(0);
+            lane.mTouched[0] |= GetColumns(extent.first, extent.second);
+        }
+    }
+}
+
+
+/**
+ * Get the tiles of a row vehicles touch around a time
+ * \param row Row of tiles
+ * \param time Level time in seconds
+ * \returns Bit for each column, set if a vehicle covers part of the tile
+ */
+uint16_t COccupancy::GetTouched(int row, double time) const
+{
+    if (!IsLane(row))
+    {
+        return 0;
+    }
+
+    const Lane& lane = mLanes[row];
+    return lane.mTouched[GetBucket(lane, time)];
+}
+
+
+/**
+ * Get the tiles of a row whose centers vehicles cover around a time
+ * \param row Row of tiles
+ * \param time Level time in seconds
+ * \returns Bit for each column, set if a vehicle covers the center of the tile
+ */
+uint16_t COccupancy::GetCovered(int row, double time) const
+{
+    if (!IsLane(row))
+    {
+        return 0;
+    }
+
+    const Lane& lane = mLanes[row];
+    return lane.mCovered[GetBucket(lane, time)];
+}
+
+
+/**
+ * Test if a vehicle may touch part of a row over a span of time
+ * \param row Row of tiles
+ * \param left Left edge of the part in virtual pixels
+ * \param right Right edge of the part in virtual pixels
+ * \param from Level time in seconds the span starts at
+ * \param to Level time in seconds the span ends at
+ * \returns True if a tile the part overlaps is touched in any bucket of the span
+ */
+bool COccupancy::IsTouched(int row, double left, double right, double from, double to) const
+{
+    if (!IsLane(row))
+    {
+        return false;
+    }
+
+    uint16_t columns = GetColumns(left, right);
+    const Lane& lane = mLanes[row];
+    int count = (int)lane.mTouched.size();
+
+    // Number of buckets the span runs into after the first
+    int buckets = count - 1;
+    if (lane.mPeriod > 0 && to - from < lane.mPeriod)
+    {
+        buckets = (GetBucket(lane, to) - GetBucket(lane, from) + count) % count;
+    }
+
+    int bucket = GetBucket(lane, from);
+    for (int i = 0; i <= buckets; i++)
+    {
+        if ((lane.mTouched[bucket] & columns) != 0)
+        {
+            return true;
+        }
+
+        bucket = (bucket + 1) % count;
+    }
+
+    return false;
+}
+
+
+/**
+ * Get the tile columns part of a row overlaps
+ * \param left Left edge in virtual pixels
+ * \param right Right edge in virtual pixels
+ * \returns Bit for each column the part overlaps
+ */
+uint16_t COccupancy::GetColumns(double left, double right)
+{
+    int first = max((int)floor(left / TileToPixels), 0);
+    int last = min((int)ceil(right / TileToPixels) - 1, Columns - 1);
+    if (first > last)
+    {
+        return 0;
+    }
+
+    return (uint16_t)(((1 << (last + 1)) - 1) & ~((1 << first) - 1));
+}
+
+
+/**
+ * Get the total number of time buckets in all of the lanes
+ * \returns Number of buckets
+ */
+int COccupancy::GetBucketCount() const
+{
+    int count = 0;
+    for (auto& lane : mLanes)
+    {
+        count += (int)lane.mTouched.size();
+    }
+
+    return count;
+}
+
+
+/**
+ * Get the memory the tables take
+ * \returns Size in bytes
+ */
+size_t COccupancy::GetBytes() const
+{
+    return mLanes.size() * sizeof(Lane) + GetBucketCount() * 2 * sizeof(uint16_t);
+}
+
+
+/**
+ * Get the bucket of a lane a time falls in
+ * \param lane Lane to look in
+ * \param time Level time in seconds
+ * \returns Index of the bucket
+ */
+int COccupancy::GetBucket(const Lane& lane, double time) const
+{
+    if (lane.mPeriod <= 0)
+    {
+        return 0;
+    }
+
+    double offset = fmod(time, lane.mPeriod);
+    if (offset < 0)
+    {
+        offset += lane.mPeriod;
+    }
+
+    return min((int)(offset / lane.mBucketTime), (int)lane.mTouched.size() - 1);
+}
@@ -0,0 +1,125 @@
+/**
+ * \file Occupancy.h
+ *
+ * \author Michael Dittman
+ *
+ * Tables of which tiles of each lane have a vehicle in them over time.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class CItem;
+class CVehicle;
+
+
+/**
+ * Tables of which tiles of each lane have a vehicle in them over time.
+ *
+ * Traffic in a lane repeats once every vehicle has gone around the
+ * lane, so one period of it is split into short time buckets and
+ * each bucket stores a bit per tile column. The tables are made once
+ * from a level's vehicles when the level is loaded, after which any
+ * row, column and time can be looked up directly. A level with so many
+ * lanes that the buckets would go over MaxBuckets gets longer buckets
+ * instead. Those only ever err the safe way, with more tiles touched
+ * and fewer covered.
+ *
+ * Two bits are kept for each tile. A tile is touched when some
+ * vehicle covers any part of it at any time during the bucket, which
+ * is what a car could hit. A tile is covered when some vehicle covers
+ * its center for the whole bucket, which is where a boat can be
+ * stepped on. A vehicle that wraps around during a bucket covers the
+ * centers it stayed over on each side of the lane.
+ *
+ * A lane whose vehicles go around in different times doesn't repeat
+ * often enough to tabulate, so it gets a single bucket in which every
+ * tile its vehicles ever pass over is touched and none are covered.
+ */
+class COccupancy
+{
+public:
+    /// Length of a time bucket in seconds
+    const static double BucketTime;
+
+    /// Most buckets all the lanes of a level have between them
+    const static int MaxBuckets = 1 << 20;
+
+    /// Number of tile columns in the play area
+    const static int Columns = 16;
+
+    /// Default constructor (disabled)
+    COccupancy() = delete;
+
+    /// Copy constructor (disabled)
+    COccupancy(const COccupancy&) = delete;
+
+    COccupancy(const std::vector<std::shared_ptr<CItem>>& items);
+
+    /** Is there a lane on a row?
+     * \param row Row of tiles
+     * \returns True if vehicles travel along the row */
+    bool IsLane(int row) const { return row >= 0 && row < (int)mLanes.size() && !mLanes[row].mTouched.empty(); }
+
+    /** Is a row a road?
+     * \param row Row of tiles
+     * \returns True if cars travel along the row */
+    bool IsRoad(int row) const { return IsLane(row) && mLanes[row].mRoad; }
+
+    /** Is a row a river?
+     * \param row Row of tiles
+     * \returns True if boats travel along the row */
+    bool IsRiver(int row) const { return IsLane(row) && !mLanes[row].mRoad; }
+
+    /** Is a tile touched by a vehicle?
+     * \param row Row of tiles
+     * \param column Column of tiles
+     * \param time Level time in seconds
+     * \returns True if a vehicle covers part of the tile around then */
+    bool IsOccupied(int row, int column, double time) const { return ((GetTouched(row, time) >> column) & 1) != 0; }
+
+    uint16_t GetTouched(int row, double time) const;
+
+    uint16_t GetCovered(int row, double time) const;
+
+    bool IsTouched(int row, double left, double right, double from, double to) const;
+
+    static uint16_t GetColumns(double left, double right);
+
+    /** Get the number of lanes
+     * \returns Number of rows with vehicles on them */
+    int GetLaneCount() const { return mLaneCount; }
+
+    int GetBucketCount() const;
+
+    size_t GetBytes() const;
+
+private:
+    /// The tables of one lane
+    struct Lane
+    {
+        bool mRoad = false;                 ///< True for cars, false for boats
+        double mPeriod = 0;                 ///< Seconds until the traffic repeats
+        double mBucketTime = 0;             ///< Length of each bucket in seconds
+        std::vector<uint16_t> mTouched;     ///< Tiles touched in each bucket
+        std::vector<uint16_t> mCovered;     ///< Tiles covered in each bucket
+    };
+
+    void Add(Lane& lane, CVehicle* vehicle);
+
+    static uint16_t GetCentered(double left, double right);
+
+    void MakeMixed(Lane& lane, const std::vector<CVehicle*>& vehicles);
+
+    int GetBucket(const Lane& lane, double time) const;
+
+    /// Tables for each row, empty for rows without vehicles
+    std::vector<Lane> mLanes;
+
+    /// Number of rows with vehicles on them
+    int mLaneCount = 0;
+};
+
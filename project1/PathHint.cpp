@@ -0,0 +1,700 @@
+/**
+ * \file PathHint.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "PathHint.h"
+#include "Game.h"
+#include "RenderList.h"
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+using namespace Gdiplus;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Default budget in seconds of planning a frame
+const double CPathHint::FrameBudget = 0.001;
+
+/// Most steps ahead of the hero the search looks
+const int Lookahead = 600;
+
+/// Most nodes the tree keeps before the search gives up
+const size_t MaxNodes = 200000;
+
+/// Farthest in virtual pixels the hero can be from a node and still be at it
+const double MatchDistance = 8;
+
+/// Number of nodes expanded between looks at the clock
+const int CheckEvery = 16;
+
+/// Size in virtual pixels of the marks the plan is drawn with
+const float MarkSize = 16;
+
+/// Color the plan is drawn in
+const Color MarkColor(160, 255, 220, 0);
+
+/// Most of the latest measurements of each kind kept for the report
+const size_t MaxSamples = 4096;
+
+
+/**
+ * Add a measurement, writing over the oldest once there are MaxSamples
+ * \param value Value to add
+ */
+void CPathHint::Samples::Add(double value)
+{
+    if (mValues.size() < MaxSamples)
+    {
+        mValues.push_back(value);
+    }
+    else
+    {
+        mValues[mNext] = value;
+        mNext = (mNext + 1) % MaxSamples;
+    }
+
+    mCount++;
+}
+
+
+/**
+ * Get a percentile of some values
+ * \param values Values to look at
+ * \param fraction Fraction of the values at or below the percentile
+ * \returns The value that fraction of the way through them in order, 0 if there are none
+ */
+static double Percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+
+    sort(values.begin(), values.end());
+    size_t index = (size_t)ceil(fraction * values.size());
+    return values[min(max(index, (size_t)1), values.size()) - 1];
+}
+
+
+/**
+ * Constructor
+ * \param game Game with the level to plan in loaded
+ */
+CPathHint::CPathHint(CGame* game) : mGame(game)
+{
+    Reset();
+}
+
+
+/**
+ * Start planning in the level the game has loaded.
+ *
+ * The measurements of how planning has gone are kept.
+ */
+void CPathHint::Reset()
+{
+    mModel = make_unique<CLaneModel>(mGame);
+
+    // The player doesn't press keys right at the start of a step
+    mModel->SetLoose(true);
+    mTarget = -1;
+    mRoot = -1;
+    mGoal = -1;
+    mNodes.clear();
+    mPath.clear();
+    mAt = 0;
+    mSources.clear();
+    mFrontier.clear();
+    mWaiting.clear();
+    mReached.clear();
+    mSettled.clear();
+    mReplanning = false;
+}
+
+
+/**
+ * Plan for a frame.
+ *
+ * Works out where the hero is and keeps, cuts back or starts over
+ * the tree, then searches until the frame's budget is used up.
+ */
+void CPathHint::Update()
+{
+    auto start = chrono::steady_clock::now();
+    if (mGame->GetGameLost() || mGame->GetGameWon())
+    {
+        mGoal = -1;
+        mPath.clear();
+        mRoot = -1;
+        return;
+    }
+
+    // Plan from the next step to start, the hero can't do anything
+    // before the get ready countdown is over
+    mNow = (int)ceil(mGame->GetLevelTime() / CLaneModel::StepTime - 0.001);
+    if (mGame->GetReady())
+    {
+        mNow = max(mNow, CLaneModel::GetReadyStep());
+    }
+
+    mModel->Extend(mNow + 1);
+    CLaneModel::Position hero = mModel->Locate(mGame->GetHero().get(), mNow);
+
+    int target = GetTarget();
+    int node = target == mTarget && mRoot >= 0 ? FindNode(hero, mNow) : -1;
+    int at = node >= 0 ? FindOnPath(node, mNow) : -1;
+    if (at >= 0)
+    {
+        mAt = at;
+        mFollowed++;
+    }
+    else if (node >= 0 && node == mRoot && !HasPath())
+    {
+        // Still planning from here
+    }
+    else if (node >= 0)
+    {
+        Reroot(node);
+    }
+    else
+    {
+        mTarget = target;
+        Restart(hero, mNow);
+    }
+
+    auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(mBudget));
+    Search(deadline);
+
+    // A cut back tree can run out of places to go that a full
+    // search would have found, so look again from scratch
+    if (mExhausted && mRerooted)
+    {
+        Restart(hero, mNow);
+        Search(deadline);
+    }
+
+    // Nothing from before now is needed any more
+    mModel->Discard(mNow);
+
+    double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    mFrameTimes.Add(time);
+    if (mReplanning)
+    {
+        mReplanTime += time;
+        mReplanFrames++;
+        if (mGoal >= 0 || mExhausted)
+        {
+            mReplanTimes.Add(mReplanTime);
+            mReplanFrameCounts.Add(mReplanFrames);
+            mReplanning = false;
+        }
+    }
+}
+
+
+/**
+ * Draw a mark where each move of the plan still to come goes to
+ * \param list Render list to record into
+ */
+void CPathHint::Draw(CRenderList* list)
+{
+    if (!HasPath())
+    {
+        return;
+    }
+
+    for (int i = mAt + 1; i < (int)mPath.size(); i++)
+    {
+        const Node& node = mNodes[mPath[i]];
+        if (node.mAction < 0)
+        {
+            continue;
+        }
+
+        // Marks on boats go along with the boat
+        double x = node.mPosition.mX;
+        if (node.mPosition.mBoat >= 0)
+        {
+            x = mModel->GetBoatX(node.mPosition.mBoat, mNow);
+        }
+
+        double y = node.mPosition.mRow * TileToPixels + TileToPixels / 2;
+        list->FillRectangle(MarkColor, float(x - MarkSize / 2), float(y - MarkSize / 2), MarkSize, MarkSize);
+    }
+}
+
+
+/**
+ * Get where the hero is along the plan
+ * \returns Where the hero is at each node from the root of the tree to the far bank, empty with no plan
+ */
+std::vector<CLaneModel::Position> CPathHint::GetPath() const
+{
+    vector<CLaneModel::Position> path;
+    for (int index : mPath)
+    {
+        path.push_back(mNodes[index].mPosition);
+    }
+
+    return path;
+}
+
+
+/**
+ * Get the moves of the plan still to come
+ * \returns Moves, stamped with the level time they are made at
+ */
+CReplay CPathHint::GetScript() const
+{
+    CReplay script;
+    script.Clear(mGame->GetLevelNumber());
+    for (int i = mAt + 1; i < (int)mPath.size(); i++)
+    {
+        const Node& node = mNodes[mPath[i]];
+        if (node.mAction >= 0)
+        {
+            script.Add(max(node.mStep - 1, mNow) * CLaneModel::StepTime, (CReplay::Action)node.mAction);
+        }
+    }
+
+    return script;
+}
+
+
+/**
+ * Get a report of how long planning takes
+ * \returns Report text
+ */
+std::wstring CPathHint::GetReport() const
+{
+    wostringstream report;
+    report << fixed << setprecision(3);
+    report << L"Path hint, " << mBudget * 1000 << L" ms a frame, " << CLaneModel::StepTime * 1000 << L" ms steps" << endl << endl;
+
+    report << L"Frames: " << mFrameTimes.mCount << L", the latest " << mFrameTimes.mValues.size() << L" measured" << endl;
+    report << L"  planning p50 " << Percentile(mFrameTimes.mValues, 0.5) * 1000
+        << L" ms, p90 " << Percentile(mFrameTimes.mValues, 0.9) * 1000
+        << L" ms, p99 " << Percentile(mFrameTimes.mValues, 0.99) * 1000
+        << L" ms, max " << Percentile(mFrameTimes.mValues, 1) * 1000 << L" ms" << endl;
+    report << L"  on the plan " << mFollowed << L", tree kept " << mReroots << L", started over " << mRestarts << endl << endl;
+
+    report << L"Replans finished: " << mReplanTimes.mCount << L", the latest " << mReplanTimes.mValues.size() << L" measured" << endl;
+    report << L"  latency p50 " << Percentile(mReplanTimes.mValues, 0.5) * 1000
+        << L" ms, p90 " << Percentile(mReplanTimes.mValues, 0.9) * 1000
+        << L" ms, p99 " << Percentile(mReplanTimes.mValues, 0.99) * 1000
+        << L" ms, max " << Percentile(mReplanTimes.mValues, 1) * 1000 << L" ms" << endl;
+    report << setprecision(0);
+    report << L"  frames p50 " << Percentile(mReplanFrameCounts.mValues, 0.5)
+        << L", p90 " << Percentile(mReplanFrameCounts.mValues, 0.9)
+        << L", p99 " << Percentile(mReplanFrameCounts.mValues, 0.99)
+        << L", max " << Percentile(mReplanFrameCounts.mValues, 1) << endl << endl;
+
+    report << L"Tree: " << mNodes.size() << L" nodes, " << (HasPath() ? L"plan found" : mExhausted ? L"no way across" : L"searching");
+
+    return report.str();
+}
+
+
+/**
+ * Work out which bank the plan goes to
+ * \returns Top row if the hero has cargo or there's none left at the bottom, otherwise the bottom row
+ */
+int CPathHint::GetTarget()
+{
+    if (mGame->GetHero()->GetCarrying())
+    {
+        return CLaneModel::TopRow;
+    }
+
+    for (int i = 0; mGame->GetCargo(i) != nullptr; i++)
+    {
+        if (mGame->GetCargo(i)->GetY() > mGame->GetHeight() / 2)
+        {
+            return CLaneModel::BottomRow;
+        }
+    }
+
+    return CLaneModel::TopRow;
+}
+
+
+/**
+ * Find the node in the tree the hero is at
+ * \param position Where the hero is
+ * \param step Step the hero is there at
+ * \returns Node, -1 if the tree never reached there at that step
+ */
+int CPathHint::FindNode(const CLaneModel::Position& position, int step) const
+{
+    if (mModel->IsSafe(position))
+    {
+        auto found = mSettled.find(mModel->GetKey(position, step));
+        if (found != mSettled.end() && mNodes[found->second].mStep <= step)
+        {
+            return found->second;
+        }
+
+        for (int index : mWaiting)
+        {
+            if (mNodes[index].mStep <= step && IsSame(mNodes[index].mPosition, position))
+            {
+                return index;
+            }
+        }
+
+        return -1;
+    }
+
+    // Nodes are added a step at a time, so the ones at a step are together
+    auto first = lower_bound(mNodes.begin(), mNodes.end(), step,
+        [](const Node& node, int value) { return node.mStep < value; });
+    for (auto node = first; node != mNodes.end() && node->mStep == step; node++)
+    {
+        if (!node->mPruned && IsSame(node->mPosition, position))
+        {
+            return (int)(node - mNodes.begin());
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * Test if the hero is close enough to where a node has it to be there.
+ *
+ * The game moves the hero a frame at a time, so a hero that gets off
+ * a boat between steps can be a few pixels from where the tree has it.
+ *
+ * \param node Where a node has the hero
+ * \param hero Where the hero is
+ * \returns True if the hero is at the node
+ */
+bool CPathHint::IsSame(const CLaneModel::Position& node, const CLaneModel::Position& hero) const
+{
+    if (node.mRow != hero.mRow || node.mBoat != hero.mBoat)
+    {
+        return false;
+    }
+
+    if (hero.mBoat >= 0)
+    {
+        return !mModel->IsSketchy(hero.mBoat) || abs(node.mBoarded - hero.mBoarded) <= 1;
+    }
+
+    return fabs(node.mX - hero.mX) <= MatchDistance;
+}
+
+
+/**
+ * Find where the hero is along the plan
+ * \param node Node the hero is at
+ * \param step Step the hero is there at
+ * \returns Index of the node in the plan, -1 if it isn't on it or its next move can't be made any more
+ */
+int CPathHint::FindOnPath(int node, int step) const
+{
+    auto found = find(mPath.begin(), mPath.end(), node);
+    if (found == mPath.end())
+    {
+        return -1;
+    }
+
+    int at = (int)(found - mPath.begin());
+    if (found + 1 == mPath.end())
+    {
+        return at;
+    }
+
+    // Moves along somewhere safe can be made any time, moves out into
+    // a lane have to be made when the plan has them
+    const Node& next = mNodes[*(found + 1)];
+    if (next.mStep > step || (mModel->IsSafe(mNodes[node].mPosition) && mModel->IsSafe(next.mPosition)))
+    {
+        return at;
+    }
+
+    return -1;
+}
+
+
+/**
+ * Throw the tree away and start a new one where the hero is
+ * \param position Where the hero is
+ * \param step Step the hero is there at
+ */
+void CPathHint::Restart(const CLaneModel::Position& position, int step)
+{
+    mRestarts++;
+    mNodes.clear();
+    mPath.clear();
+    mFrontier.clear();
+    mWaiting.clear();
+    mReached.clear();
+    mSettled.clear();
+    mExhausted = false;
+    mRerooted = false;
+    StartReplan();
+
+    Node root;
+    root.mPosition = position;
+    root.mStep = step;
+    mNodes.push_back(root);
+    mRoot = 0;
+    mGoal = -1;
+
+    if (mModel->IsSafe(position))
+    {
+        mSettled[mModel->GetKey(position, step)] = 0;
+        mWaiting.push_back(0);
+    }
+
+    mLayer = step;
+    mSources = { 0 };
+    mNextSource = 0;
+
+    if (position.mRow == mTarget)
+    {
+        mGoal = 0;
+        Finish();
+    }
+}
+
+
+/**
+ * Make a node the hero is at the root of the tree.
+ *
+ * Only what leads on from the node is kept. Moves out into a lane
+ * the tree made before now were never made, so what they lead to goes
+ * as well. Moves along somewhere safe can still be made any time.
+ *
+ * \param node Node the hero is at
+ */
+void CPathHint::Reroot(int node)
+{
+    mReroots++;
+    mRoot = node;
+    mGoal = -1;
+    mPath.clear();
+    mExhausted = false;
+    mRerooted = true;
+    StartReplan();
+
+    // A node's parent always comes before it
+    vector<bool> keep(mNodes.size(), false);
+    for (int i = 0; i < (int)mNodes.size(); i++)
+    {
+        int parent = mNodes[i].mParent;
+        keep[i] = i == node || (parent >= 0 && keep[parent] && (mNodes[i].mStep > mNow ||
+            (mModel->IsSafe(mNodes[parent].mPosition) && mModel->IsSafe(mNodes[i].mPosition))));
+        mNodes[i].mPruned = !keep[i];
+    }
+
+    auto pruned = [this](int index) { return mNodes[index].mPruned; };
+
+    int expanded = (int)count_if(mSources.begin(), mSources.begin() + mNextSource,
+        [this](int index) { return !mNodes[index].mPruned; });
+    mSources.erase(remove_if(mSources.begin(), mSources.end(), pruned), mSources.end());
+    mNextSource = expanded;
+
+    mFrontier.erase(remove_if(mFrontier.begin(), mFrontier.end(), pruned), mFrontier.end());
+    mWaiting.erase(remove_if(mWaiting.begin(), mWaiting.end(), pruned), mWaiting.end());
+
+    mReached.clear();
+    for (int index : mFrontier)
+    {
+        if (!mModel->IsSafe(mNodes[index].mPosition))
+        {
+            mReached.insert(mModel->GetKey(mNodes[index].mPosition, mNodes[index].mStep));
+        }
+    }
+
+    mSettled.clear();
+    for (int index : mWaiting)
+    {
+        mSettled[mModel->GetKey(mNodes[index].mPosition, mNodes[index].mStep)] = index;
+    }
+
+    // The search stops at the first step anything gets across, so
+    // anything kept that is across got there first
+    for (int i = 0; i < (int)mNodes.size(); i++)
+    {
+        if (keep[i] && mNodes[i].mPosition.mRow == mTarget)
+        {
+            mGoal = i;
+            Finish();
+            break;
+        }
+    }
+}
+
+
+/**
+ * Search until the plan is found or a time is reached
+ * \param deadline Time to stop searching at
+ */
+void CPathHint::Search(std::chrono::steady_clock::time_point deadline)
+{
+    int count = 0;
+    while (mGoal < 0 && !mExhausted)
+    {
+        if (mNextSource >= (int)mSources.size())
+        {
+            EndLayer();
+            if (mGoal >= 0)
+            {
+                break;
+            }
+
+            if (mSources.empty() || mNodes.size() >= MaxNodes)
+            {
+                mExhausted = true;
+                break;
+            }
+        }
+
+        // Far enough ahead for now, carry on as time goes by
+        if (mLayer >= mNow + Lookahead)
+        {
+            break;
+        }
+
+        mModel->Extend(mLayer + 1);
+        Expand(mSources[mNextSource++]);
+
+        if (++count % CheckEvery == 0 && chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+}
+
+
+/**
+ * Find the nodes each move from a node leads to a step later
+ * \param index Node to move from, at or before the layer's step
+ */
+void CPathHint::Expand(int index)
+{
+    const Node& node = mNodes[index];
+    bool safe = mModel->IsSafe(node.mPosition);
+
+    // Everything that doesn't lead into a lane was already tried
+    // from a safe node the step it got there
+    bool waited = safe && node.mStep < mLayer;
+
+    for (int action = -1; action <= CReplay::Right; action++)
+    {
+        // A safe node waits by staying in the waiting nodes
+        if ((safe && action < 0) ||
+            (waited && action != CReplay::Forward && action != CReplay::Backward))
+        {
+            continue;
+        }
+
+        Node next;
+        next.mPosition = mNodes[index].mPosition;
+        next.mParent = index;
+        next.mStep = mLayer + 1;
+        next.mAction = action;
+
+        if ((action >= 0 && !mModel->Move(next.mPosition, action, mLayer)) || (waited && mModel->IsSafe(next.mPosition)))
+        {
+            continue;
+        }
+
+        if (!mModel->Survives(next.mPosition, mLayer, action >= 0))
+        {
+            continue;
+        }
+
+        mModel->Ride(next.mPosition, mLayer);
+
+        unsigned long long key = mModel->GetKey(next.mPosition, next.mStep);
+        bool nextSafe = mModel->IsSafe(next.mPosition);
+        if (nextSafe ? mSettled.count(key) > 0 : !mReached.insert(key).second)
+        {
+            continue;
+        }
+
+        mNodes.push_back(next);
+        int added = (int)mNodes.size() - 1;
+        mFrontier.push_back(added);
+        if (nextSafe)
+        {
+            mSettled[key] = added;
+            mWaiting.push_back(added);
+        }
+    }
+}
+
+
+/**
+ * Move on to the next step once every node of a step has been expanded
+ */
+void CPathHint::EndLayer()
+{
+    mLayer++;
+    for (int index : mFrontier)
+    {
+        if (mNodes[index].mPosition.mRow == mTarget)
+        {
+            mGoal = index;
+            Finish();
+            break;
+        }
+    }
+
+    // The nodes that just got here, then the ones waiting somewhere safe
+    mSources = mFrontier;
+    for (int index : mWaiting)
+    {
+        if (mNodes[index].mStep < mLayer)
+        {
+            mSources.push_back(index);
+        }
+    }
+
+    mNextSource = 0;
+    mFrontier.clear();
+    mReached.clear();
+}
+
+
+/**
+ * Make the plan from the root to the goal
+ */
+void CPathHint::Finish()
+{
+    mPath.clear();
+    for (int index = mGoal; index >= 0; index = mNodes[index].mParent)
+    {
+        mPath.push_back(index);
+        if (index == mRoot)
+        {
+            break;
+        }
+    }
+
+    reverse(mPath.begin(), mPath.end());
+    mAt = 0;
+}
+
+
+/**
+ * Start measuring a new replan
+ */
+void CPathHint::StartReplan()
+{
+    mReplanning = true;
+    mReplanTime = 0;
+    mReplanFrames = 0;
+}
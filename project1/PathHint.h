@@ -0,0 +1,218 @@
+/**
+ * \file PathHint.h
+ *
+ * \author Michael Dittman
+ *
+ * Plans a safe way across the lanes from wherever the hero is, a little at a time.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include "LaneModel.h"
+#include "Replay.h"
+
+class CGame;
+class CRenderList;
+
+
+/**
+ * Plans a safe way across the lanes from wherever the hero is, a little at a time.
+ *
+ * The plan goes to the far bank, the top row when the hero is carrying
+ * cargo or there is none left at the bottom, otherwise the bottom row.
+ * It is found by going forward a step of time at a time through the
+ * hero's moves on a CLaneModel, the same way CSolver does, keeping
+ * every state reached in a tree.
+ *
+ * Each frame gets a small budget of time to plan in. A search that
+ * doesn't finish in one frame picks up where it left off in the next.
+ * The tree is kept as time goes on and the hero moves: while the hero
+ * follows the plan there is nothing to do, and when it goes somewhere
+ * else the tree already reached, the part of the tree that leads on
+ * from there becomes the new tree. Only when the hero is somewhere the
+ * tree never reached does the search start over.
+ */
+class CPathHint
+{
+public:
+    /// Default budget in seconds of planning a frame
+    const static double FrameBudget;
+
+    /// Default constructor (disabled)
+    CPathHint() = delete;
+
+    /// Copy constructor (disabled)
+    CPathHint(const CPathHint&) = delete;
+
+    CPathHint(CGame* game);
+
+    void Reset();
+
+    void Update();
+
+    void Draw(CRenderList* list);
+
+    /** Is there a plan to show?
+     * \returns True if a way to the far bank has been found */
+    bool HasPath() const { return mGoal >= 0; }
+
+    std::vector<CLaneModel::Position> GetPath() const;
+
+    CReplay GetScript() const;
+
+    /** Get the row the plan goes to
+     * \returns Row of tiles, -1 before the first update */
+    int GetTargetRow() const { return mTarget; }
+
+    /** Set the time each frame may plan for
+     * \param budget Time in seconds */
+    void SetBudget(double budget) { mBudget = budget; }
+
+    /** Get the number of times the search started over
+     * \returns Number of restarts */
+    int GetRestarts() const { return mRestarts; }
+
+    /** Get the number of times the tree was kept when the hero left the plan
+     * \returns Number of reroots */
+    int GetReroots() const { return mReroots; }
+
+    /** Get the number of frames the hero was following the plan
+     * \returns Number of frames */
+    int GetFollowed() const { return mFollowed; }
+
+    std::wstring GetReport() const;
+
+private:
+    /// One state in the tree
+    struct Node
+    {
+        CLaneModel::Position mPosition; ///< Where the hero is
+        int mParent = -1;               ///< Node the move was made in, -1 for the root
+        int mStep = 0;                  ///< Step the node is reached at
+        int mAction = -1;               ///< Move made to get here, -1 for none
+        bool mPruned = false;           ///< True once the node has been cut from the tree
+    };
+
+    /// The latest of a series of measurements, in a ring that stops growing once full
+    struct Samples
+    {
+        std::vector<double> mValues;    ///< The latest values, in no order
+        size_t mNext = 0;               ///< Value to write over next once the ring is full
+        long long mCount = 0;           ///< Number of values ever added
+
+        void Add(double value);
+    };
+
+    int GetTarget();
+
+    int FindNode(const CLaneModel::Position& position, int step) const;
+
+    bool IsSame(const CLaneModel::Position& node, const CLaneModel::Position& hero) const;
+
+    int FindOnPath(int node, int step) const;
+
+    void Restart(const CLaneModel::Position& position, int step);
+
+    void Reroot(int node);
+
+    void Search(std::chrono::steady_clock::time_point deadline);
+
+    void Expand(int index);
+
+    void EndLayer();
+
+    void Finish();
+
+    void StartReplan();
+
+    /// Game the hero is in
+    CGame* mGame;
+
+    /// Where the hero can go in the level
+    std::unique_ptr<CLaneModel> mModel;
+
+    /// Time in seconds each frame may plan for
+    double mBudget = FrameBudget;
+
+    /// Row the plan goes to
+    int mTarget = -1;
+
+    /// Step the hero is taken to be at this frame
+    int mNow = 0;
+
+    /// Every node in the tree
+    std::vector<Node> mNodes;
+
+    /// Node the hero is at
+    int mRoot = -1;
+
+    /// Node at the far bank, -1 if none has been found yet
+    int mGoal = -1;
+
+    /// Nodes from the root to the goal
+    std::vector<int> mPath;
+
+    /// Where in mPath the hero is
+    int mAt = 0;
+
+    /// Step the layer being expanded is made in
+    int mLayer = 0;
+
+    /// Nodes to expand this layer
+    std::vector<int> mSources;
+
+    /// Next of mSources to expand
+    int mNextSource = 0;
+
+    /// Nodes reached this layer
+    std::vector<int> mFrontier;
+
+    /// Keys of the lane nodes reached this layer
+    std::unordered_set<unsigned long long> mReached;
+
+    /// Nodes somewhere safe, kept the first time they are reached
+    std::vector<int> mWaiting;
+
+    /// Nodes somewhere safe, by key
+    std::unordered_map<unsigned long long, int> mSettled;
+
+    /// True when the search ran out of places to go without a plan
+    bool mExhausted = false;
+
+    /// True when the tree was cut back since the search last started over
+    bool mRerooted = false;
+
+    /// True while a replan is being measured
+    bool mReplanning = false;
+
+    /// Time in seconds spent on the current replan so far
+    double mReplanTime = 0;
+
+    /// Frames spent on the current replan so far
+    int mReplanFrames = 0;
+
+    /// Time in seconds the latest frames planned for
+    Samples mFrameTimes;
+
+    /// Time in seconds the latest replans took to finish
+    Samples mReplanTimes;
+
+    /// Frames the latest replans took to finish
+    Samples mReplanFrameCounts;
+
+    /// Number of times the search started over
+    int mRestarts = 0;
+
+    /// Number of times the tree was kept when the hero left the plan
+    int mReroots = 0;
+
+    /// Number of frames the hero was following the plan
+    int mFollowed = 0;
+};
+
@@ -38,20 +38,20 @@ CRectangle::CRectangle(const CRectangle& rectangle) : CDecor(rectangle)
 /**
  * Draws a rectangle object onto the screen
  *
- * \param graphics Graphics device to draw on
+ * \param list Render list to record the drawing into
  */
-void CRectangle::Draw(Gdiplus::Graphics* graphics)
+void CRectangle::Draw(CRenderList* list)
 {
 	double xCoordinate = GetX();
 	double yCoordinate = GetY();
-	SolidBrush brush(Color(mColor[0], mColor[1], mColor[2]));
+	Color color(mColor[0], mColor[1], mColor[2]);
 	// Repeats drawing rectangles in both directions
 	for (int x = 0; x < GetRepeatX(); x++)
 	{
 		for (int y = 0; y < GetRepeatY(); y++)
 		{
 			// Draws a filled rectangle
-			graphics->FillRectangle(&brush, 
+			list->FillRectangle(color, 
 				(int)xCoordinate + x * TileToPixels, (int)yCoordinate + y * TileToPixels, 
 				(int)(mWidth * (double)TileToPixels) + 1, (int)(mHeight * (double)TileToPixels) + 1);
 		}
@@ -85,4 +85,14 @@ void CRectangle::XmlLoad(const std::shared_ptr<xmlnode::CXmlNode>& node)
 		i++;
 	}
 	
+}
+
+
+/**
+ * Get the part of the level the rectangle is drawn over, top to bottom
+ * \returns Top and bottom Y in virtual pixels
+ */
+std::pair<double, double> CRectangle::GetVerticalExtent() const
+{
+	return make_pair(GetY(), GetY() + (GetRepeatY() - 1) * TileToPixels + mHeight * TileToPixels);
 }
\ No newline at end of file
@@ -27,7 +27,9 @@ public:
 
 	CRectangle(CGame* game);
 
-	virtual void Draw(Gdiplus::Graphics* graphics);
+	virtual void Draw(CRenderList* list);
+
+	virtual std::pair<double, double> GetVerticalExtent() const override;
 
 	/** Clones a rectangle by invoking the copy constructor, returns an item pointer
 	* \return pointer to a copied object
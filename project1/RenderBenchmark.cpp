@@ -0,0 +1,259 @@
+/**
+ * \file RenderBenchmark.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "RenderBenchmark.h"
+#include "Game.h"
+#include "GridEncoder.h"
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+using namespace Gdiplus;
+using namespace std;
+
+/// Number of lanes in the synthetic level
+const int SyntheticLanes = 100;
+
+/// Height of a lane in virtual pixels
+const int LaneHeight = 64;
+
+/// Top of the first lane in virtual pixels
+const int FirstLane = 128;
+
+/// Number of lanes in a real level
+const int LevelLanes = 12;
+
+/// Rows of virtual pixels above and below the lanes
+const int Border = 128;
+
+/// Frames rendered for each timing
+const int TimedFrames = 10;
+
+/// Grids encoded for each timing
+const int TimedGrids = 1000;
+
+/// Scale that makes the frame 2160 pixels tall per 1024 virtual pixels
+const float UhdScale = 2160.0f / 1024.0f;
+
+
+/**
+ * Constructor
+ * \param game Game whose levels we render
+ */
+CRenderBenchmark::CRenderBenchmark(CGame* game) : mGame(game)
+{
+}
+
+
+/**
+ * Run the benchmark over every level and the synthetic level.
+ *
+ * The level being played is loaded again when we are done.
+ */
+void CRenderBenchmark::Run()
+{
+    mReport.str(L"");
+    mReport << L"Render benchmark, " << thread::hardware_concurrency() << L" hardware threads" << endl;
+
+    int current = mGame->GetLevelNumber();
+    int levels = mGame->GetLevelCount();
+
+    CRenderList list;
+    for (int level = 0; level < levels; level++)
+    {
+        // The list points at the bitmaps of the loaded level,
+        // so it has to be measured before the next level is loaded
+        mGame->Load(level);
+        list.Clear();
+        mGame->BuildRenderList(&list);
+
+        wostringstream name;
+        name << L"Level " << level;
+        Measure(name.str(), list, mGame->GetHeight());
+
+        // What agents get instead of pixels
+        CGridEncoder encoder(true);
+        vector<float> grid(encoder.GetSize());
+        encoder.Encode(mGame, grid.data());
+
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < TimedGrids; i++)
+        {
+            encoder.Encode(mGame, grid.data());
+        }
+        chrono::duration<double, micro> encoding = chrono::steady_clock::now() - start;
+        mReport << L"  grid encoder takes " << fixed << setprecision(2) << encoding.count() / TimedGrids
+            << L" us/frame for " << grid.size() << L" floats" << endl;
+    }
+
+    //
+    // The synthetic level repeats the lanes of the last
+    // level until there are 100 of them
+    //
+    if (levels > 0)
+    {
+        CRenderList synthetic;
+        int lanePixels = LevelLanes * LaneHeight;
+        for (int copy = 0; copy * LevelLanes < SyntheticLanes; copy++)
+        {
+            float offset = (float)(copy * lanePixels);
+            for (auto& command : list.GetCommands())
+            {
+                if (command.mDest.Y + command.mDest.Height <= FirstLane ||
+                    command.mDest.Y >= FirstLane + lanePixels)
+                {
+                    continue;
+                }
+
+                RectF dest = command.mDest;
+                dest.Y += offset;
+                if (command.mType == CRenderList::Image)
+                {
+                    synthetic.DrawImage(command.mImage, dest, command.mSource);
+                }
+                else
+                {
+                    synthetic.FillRectangle(Color(command.mColor), dest.X, dest.Y, dest.Width, dest.Height);
+                }
+            }
+        }
+
+        wostringstream name;
+        name << L"Synthetic " << SyntheticLanes << L" lanes";
+        Measure(name.str(), synthetic, SyntheticLanes * LaneHeight + 2 * Border);
+
+        mGame->Load(current);
+    }
+}
+
+
+/**
+ * Time one scene with every thread count at native size and at 4K
+ * \param name Name of the scene for the report
+ * \param list Commands of the scene
+ * \param height Height of the scene in virtual pixels
+ */
+void CRenderBenchmark::Measure(const std::wstring& name, const CRenderList& list, int height)
+{
+    // Sprites are cached by bitmap, so every scene gets its own renderer
+    CSoftwareRenderer renderer;
+
+    vector<int> threadCounts;
+    int hardware = (int)thread::hardware_concurrency();
+    for (int threads = 1; threads < hardware; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardware > 1 ? hardware : 1);
+
+    const float scales[] = { 1.0f, UhdScale };
+    for (float scale : scales)
+    {
+        int width = (int)(mGame->GetWidth() * scale + 0.5f);
+        int rows = (int)(height * scale + 0.5f);
+        int stride = width * 4;
+        vector<unsigned char> reference((size_t)stride * rows);
+        vector<unsigned char> frame((size_t)stride * rows);
+
+        renderer.Render(list, reference.data(), width, rows, stride, scale, nullptr);
+
+        mReport << endl << name << L", " << width << L" x " << rows << L", "
+            << list.GetSize() << L" commands" << endl;
+        mReport << L"  threads  ms/frame  speedup  identical" << endl;
+
+        double single = 0;
+        for (int threads : threadCounts)
+        {
+            CThreadPool pool(threads);
+            double ms = TimeFrames(renderer, list, frame.data(), width, rows, stride, scale, &pool);
+            if (threads == 1)
+            {
+                single = ms;
+            }
+
+            bool identical = memcmp(reference.data(), frame.data(), frame.size()) == 0;
+            mReport << setw(9) << threads << setw(10) << fixed << setprecision(2) << ms
+                << setw(8) << (ms > 0 ? single / ms : 0) << L"x" << setw(11) << (identical ? L"yes" : L"NO")
+                << endl;
+        }
+
+        //
+        // Compare span blits with alpha blending every pixel
+        //
+        CSoftwareRenderer::Traffic traffic = renderer.MeasureTraffic();
+
+        renderer.SetSpansEnabled(false);
+        double plain = TimeFrames(renderer, list, frame.data(), width, rows, stride, scale, nullptr);
+        bool identical = memcmp(reference.data(), frame.data(), frame.size()) == 0;
+        renderer.SetSpansEnabled(true);
+
+        mReport << L"  image blits touch " << traffic.mSpanBytes / 1024 << L" KB per frame with spans, "
+            << traffic.mPlainBytes / 1024 << L" KB plain ("
+            << setprecision(0) << (traffic.mPlainBytes > 0 ? 100.0 * traffic.mSpanBytes / traffic.mPlainBytes : 0)
+            << L"%)" << endl;
+        mReport << L"  plain blits take " << setprecision(2) << plain << L" ms/frame on 1 thread, identical "
+            << (identical ? L"yes" : L"NO") << endl;
+
+        //
+        // Compare palettized sprites with 32-bit sprites
+        //
+        size_t directBytes = renderer.GetSpriteBytes();
+
+        renderer.SetPalettesEnabled(true);
+        double palettized = TimeFrames(renderer, list, frame.data(), width, rows, stride, scale, nullptr);
+        identical = memcmp(reference.data(), frame.data(), frame.size()) == 0;
+        size_t paletteBytes = renderer.GetSpriteBytes();
+        CSoftwareRenderer::Traffic paletteTraffic = renderer.MeasureTraffic();
+        renderer.SetPalettesEnabled(false);
+
+        mReport << L"  palettized sprites take " << paletteBytes / 1024 << L" KB, 32-bit " << directBytes / 1024
+            << L" KB; blits touch " << paletteTraffic.mSpanBytes / 1024 << L" KB per frame" << endl;
+        mReport << L"  palettized blits take " << palettized << L" ms/frame on 1 thread, identical "
+            << (identical ? L"yes" : L"NO") << endl;
+    }
+}
+
+
+/**
+ * Time how long a renderer takes to rasterize a list
+ * \param renderer Renderer to time
+ * \param list Commands to rasterize
+ * \param pixels First byte of the frame
+ * \param width Frame width in pixels
+ * \param height Frame height in pixels
+ * \param stride Bytes between frame rows
+ * \param scale Frame pixels per virtual pixel
+ * \param pool Threads to rasterize on, or null for the calling thread only
+ * \returns Milliseconds per frame
+ */
+double CRenderBenchmark::TimeFrames(CSoftwareRenderer& renderer, const CRenderList& list, unsigned char* pixels,
+    int width, int height, int stride, float scale, CThreadPool* pool)
+{
+    // One untimed frame so the workers are running
+    renderer.Render(list, pixels, width, height, stride, scale, pool);
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < TimedFrames; i++)
+    {
+        renderer.Render(list, pixels, width, height, stride, scale, pool);
+    }
+    chrono::duration<double, milli> duration = chrono::steady_clock::now() - start;
+    return duration.count() / TimedFrames;
+}
+
+
+/**
+ * Save the report to a text file
+ * \param filename File to save to
+ */
+void CRenderBenchmark::Save(const std::wstring& filename)
+{
+    wofstream file(filename);
+    file << mReport.str();
+}
@@ -0,0 +1,62 @@
+/**
+ * \file RenderBenchmark.h
+ *
+ * \author Michael Dittman
+ *
+ * Times the software renderer against the number of threads.
+ */
+
+#pragma once
+
+#include <string>
+#include <sstream>
+#include "RenderList.h"
+#include "SoftwareRenderer.h"
+#include "ThreadPool.h"
+
+class CGame;
+
+
+/**
+ * Times the software renderer against the number of threads.
+ *
+ * Every level is rasterized with 1, 2, 4 and so on up to the
+ * hardware thread count, at native size and at 4K. A synthetic
+ * level with 100 lanes is timed the same way. Each result is
+ * compared byte for byte with the single threaded frame. The
+ * memory the image blits touch is reported for span blits, for
+ * plain alpha blits and for palettized sprites. Each level is also
+ * timed through the grid encoder, for comparison.
+ */
+class CRenderBenchmark
+{
+public:
+    /// Default constructor (disabled)
+    CRenderBenchmark() = delete;
+
+    /// Copy constructor (disabled)
+    CRenderBenchmark(const CRenderBenchmark&) = delete;
+
+    CRenderBenchmark(CGame* game);
+
+    void Run();
+
+    void Save(const std::wstring& filename);
+
+    /** Get the report of the last run
+     * \returns Report text */
+    std::wstring GetReport() const { return mReport.str(); }
+
+private:
+    void Measure(const std::wstring& name, const CRenderList& list, int height);
+
+    static double TimeFrames(CSoftwareRenderer& renderer, const CRenderList& list, unsigned char* pixels,
+        int width, int height, int stride, float scale, CThreadPool* pool);
+
+    /// The game whose levels we render
+    CGame* mGame;
+
+    /// Report of the results
+    std::wostringstream mReport;
+};
+
@@ -0,0 +1,85 @@
+/**
+ * \file RenderList.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "RenderList.h"
+
+using namespace Gdiplus;
+
+
+/**
+ * Record drawing a whole image
+ * \param image Image to draw
+ * \param x Left edge in virtual pixels
+ * \param y Top edge in virtual pixels
+ * \param width Width to draw the image at
+ * \param height Height to draw the image at
+ */
+void CRenderList::DrawImage(Gdiplus::Bitmap* image, float x, float y, float width, float height)
+{
+    DrawImage(image, RectF(x, y, width, height),
+        Rect(0, 0, (INT)image->GetWidth(), (INT)image->GetHeight()));
+}
+
+
+/**
+ * Record drawing part of an image
+ * \param image Image to draw
+ * \param dest Destination rectangle in virtual pixels
+ * \param source Part of the image to draw
+ */
+void CRenderList::DrawImage(Gdiplus::Bitmap* image, const Gdiplus::RectF& dest, const Gdiplus::Rect& source)
+{
+    Command command;
+    command.mType = Image;
+    command.mImage = image;
+    command.mDest = RectF(dest.X + mOriginX, dest.Y + mOriginY, dest.Width, dest.Height);
+    command.mSource = source;
+    command.mColor = 0;
+    mCommands.push_back(command);
+}
+
+
+/**
+ * Record filling a rectangle with a solid color
+ * \param color Color to fill with
+ * \param x Left edge in virtual pixels
+ * \param y Top edge in virtual pixels
+ * \param width Width of the rectangle
+ * \param height Height of the rectangle
+ */
+void CRenderList::FillRectangle(const Gdiplus::Color& color, float x, float y, float width, float height)
+{
+    Command command;
+    command.mType = Fill;
+    command.mImage = nullptr;
+    command.mDest = RectF(x + mOriginX, y + mOriginY, width, height);
+    command.mColor = color.GetValue();
+    mCommands.push_back(command);
+}
+
+
+/**
+ * Play the commands back onto a GDI+ graphics
+ * \param graphics The graphics to draw on
+ */
+void CRenderList::Render(Gdiplus::Graphics* graphics) const
+{
+    for (auto& command : mCommands)
+    {
+        if (command.mType == Image)
+        {
+            graphics->DrawImage(command.mImage, command.mDest,
+                (REAL)command.mSource.X, (REAL)command.mSource.Y,
+                (REAL)command.mSource.Width, (REAL)command.mSource.Height, UnitPixel);
+        }
+        else
+        {
+            SolidBrush brush(Color(command.mColor));
+            graphics->FillRectangle(&brush, command.mDest);
+        }
+    }
+}
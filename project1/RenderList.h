@@ -0,0 +1,87 @@
+/**
+ * \file RenderList.h
+ *
+ * \author Michael Dittman
+ *
+ * List of drawing commands recorded by the items in a frame.
+ */
+
+#pragma once
+
+#include <vector>
+
+
+/**
+ * List of drawing commands recorded by the items in a frame.
+ *
+ * Items record what they want drawn instead of drawing straight
+ * to GDI+. The list can then be played back onto a Graphics or
+ * rasterized in software, in bands, on several threads.
+ *
+ * Commands hold raw bitmap pointers. The bitmaps belong to the
+ * levels and must outlive the list.
+ *
+ * An origin can be set that is added to everything recorded after it,
+ * so items of a level taller than the screen can record where they
+ * are in the level and land where the camera has them.
+ */
+class CRenderList
+{
+public:
+    /// Kinds of drawing command
+    enum CommandType { Image, Fill };
+
+    /// One recorded drawing command
+    struct Command
+    {
+        /// What kind of command this is
+        CommandType mType;
+
+        /// Image to draw for Image commands
+        Gdiplus::Bitmap* mImage;
+
+        /// Destination rectangle in virtual pixels
+        Gdiplus::RectF mDest;
+
+        /// Part of the image to draw for Image commands
+        Gdiplus::Rect mSource;
+
+        /// Color for Fill commands
+        Gdiplus::ARGB mColor;
+    };
+
+    /// Remove all of the commands and put the origin back
+    void Clear() { mCommands.clear(); mOriginX = 0; mOriginY = 0; }
+
+    /** Set where the origin of what is recorded next goes
+     * \param x Virtual pixels to add to X locations
+     * \param y Virtual pixels to add to Y locations */
+    void SetOrigin(float x, float y) { mOriginX = x; mOriginY = y; }
+
+    void DrawImage(Gdiplus::Bitmap* image, float x, float y, float width, float height);
+
+    void DrawImage(Gdiplus::Bitmap* image, const Gdiplus::RectF& dest, const Gdiplus::Rect& source);
+
+    void FillRectangle(const Gdiplus::Color& color, float x, float y, float width, float height);
+
+    void Render(Gdiplus::Graphics* graphics) const;
+
+    /** Get the recorded commands
+     * \returns Commands in drawing order */
+    const std::vector<Command>& GetCommands() const { return mCommands; }
+
+    /** Get the number of recorded commands
+     * \returns Number of commands */
+    int GetSize() const { return (int)mCommands.size(); }
+
+private:
+    /// Commands in the order they are to be drawn
+    std::vector<Command> mCommands;
+
+    /// Virtual pixels added to the X of what is recorded
+    float mOriginX = 0;
+
+    /// Virtual pixels added to the Y of what is recorded
+    float mOriginY = 0;
+};
+
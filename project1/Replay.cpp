@@ -0,0 +1,85 @@
+/**
+ * \file Replay.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "Replay.h"
+#include "XmlNode.h"
+
+using namespace std;
+using namespace xmlnode;
+
+/// Names of the actions in replay files, in the order of CReplay::Action
+static const wchar_t* ActionNames[] = { L"forward", L"backward", L"left", L"right", L"cargo" };
+
+
+/**
+ * Save the replay as XML
+ * \param filename File to save to
+ */
+void CReplay::Save(const std::wstring& filename) const
+{
+    auto root = CXmlNode::CreateDocument(L"replay");
+    root->SetAttribute(L"level", mLevel);
+
+    for (auto& input : mInputs)
+    {
+        auto node = root->AddChild(L"input");
+        node->SetAttribute(L"time", input.mTime);
+        node->SetAttribute(L"action", ActionNames[input.mAction]);
+        if (input.mAction == Cargo)
+        {
+            node->SetAttribute(L"cargo", input.mCargo);
+        }
+    }
+
+    try
+    {
+        root->Save(filename);
+    }
+    catch (CXmlNode::Exception ex)
+    {
+        AfxMessageBox(ex.Message().c_str());
+    }
+}
+
+
+/**
+ * Load a replay saved by Save
+ * \param filename File to load from
+ * \returns True if the replay was loaded
+ */
+bool CReplay::Load(const std::wstring& filename)
+{
+    try
+    {
+        shared_ptr<CXmlNode> root = CXmlNode::OpenDocument(filename);
+
+        Clear(root->GetAttributeIntValue(L"level", 0));
+        for (auto node : root->GetChildren())
+        {
+            if (node->GetType() != NODE_ELEMENT || node->GetName() != L"input")
+            {
+                continue;
+            }
+
+            wstring name = node->GetAttributeValue(L"action", L"");
+            for (int action = Forward; action <= Cargo; action++)
+            {
+                if (name == ActionNames[action])
+                {
+                    Add(node->GetAttributeDoubleValue(L"time", 0), (Action)action,
+                        node->GetAttributeIntValue(L"cargo", 0));
+                }
+            }
+        }
+    }
+    catch (CXmlNode::Exception ex)
+    {
+        return false;
+    }
+
+    return true;
+}
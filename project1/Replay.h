@@ -0,0 +1,69 @@
+/**
+ * \file Replay.h
+ *
+ * \author Michael Dittman
+ *
+ * The inputs a player made while playing one level.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+
+/**
+ * The inputs a player made while playing one level.
+ *
+ * Each input is stamped with the level time it was made at.
+ * Lane motion does not depend on the player, so playing the
+ * inputs back at the same times plays the level out the same way.
+ */
+class CReplay
+{
+public:
+    /// Things the player can do
+    enum Action { Forward, Backward, Left, Right, Cargo };
+
+    /// One input made by the player
+    struct Input
+    {
+        double mTime;       ///< Level time in seconds the input was made at
+        Action mAction;     ///< What the player did
+        int mCargo;         ///< Cargo clicked on for Cargo inputs, in level order
+    };
+
+    /**
+     * Start an empty replay
+     * \param level Level the inputs are made on
+     */
+    void Clear(int level) { mLevel = level; mInputs.clear(); }
+
+    /**
+     * Add an input to the end of the replay
+     * \param time Level time in seconds
+     * \param action What the player did
+     * \param cargo Cargo clicked on for Cargo inputs
+     */
+    void Add(double time, Action action, int cargo = 0) { mInputs.push_back({ time, action, cargo }); }
+
+    /** Get the level the inputs are made on
+     * \returns Level number */
+    int GetLevel() const { return mLevel; }
+
+    /** Get the inputs
+     * \returns Inputs in the order they were made */
+    const std::vector<Input>& GetInputs() const { return mInputs; }
+
+    void Save(const std::wstring& filename) const;
+
+    bool Load(const std::wstring& filename);
+
+private:
+    /// Level the inputs are made on
+    int mLevel = 0;
+
+    /// Inputs in the order they were made
+    std::vector<Input> mInputs;
+};
+
@@ -0,0 +1,186 @@
+/**
+ * \file RuleTable.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "RuleTable.h"
+#include "Decor.h"
+#include "Car.h"
+#include "SketchyBoat.h"
+#include "DecorTypeVisitor.h"
+#include "IsCarVisitor.h"
+#include "IsSketchyVisitor.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// X in virtual pixels decor is tested at to see which rows it covers
+const double TerrainTestX = TileToPixels * 8;
+
+
+/**
+ * Constructor. Works out the terrain and hazards of each row.
+ * \param items Items of a level
+ * \param terrain Terrain of each decor type, by id. Types not in it are land.
+ * \param rows Rows of tiles the level has
+ */
+CRuleTable::CRuleTable(const std::vector<std::shared_ptr<CItem>>& items, const std::map<std::wstring, Terrain>& terrain,
+    int rows)
+{
+    mTerrain.assign(rows, Land);
+    vector<bool> cars(rows, false);
+    vector<bool> sketchy(rows, false);
+
+    for (auto item : items)
+    {
+        // Later decor is drawn over earlier decor, so it wins
+        CDecorTypeVisitor decor;
+        item->Accept(&decor);
+        auto found = decor.Decor() != nullptr ? terrain.find(decor.GetId()) : terrain.end();
+        if (found != terrain.end())
+        {
+            // Only the rows the decor is drawn over can be under it
+            auto extent = decor.Decor()->GetVerticalExtent();
+            int first = max((int)floor(extent.first / TileToPixels), 0);
+            int end = min((int)ceil(extent.second / TileToPixels), rows);
+            for (int row = first; row < end; row++)
+            {
+                if (decor.Decor()->HitTest(TerrainTestX, row * TileToPixels + TileToPixels / 2))
+                {
+                    mTerrain[row] = found->second;
+                }
+            }
+        }
+
+        CIsCarVisitor car;
+        item->Accept(&car);
+        if (car.GetIsCar() && car.GetCar()->GetRow() >= 0 && car.GetCar()->GetRow() < rows)
+        {
+            cars[car.GetCar()->GetRow()] = true;
+        }
+
+        CIsSketchyVisitor boat;
+        item->Accept(&boat);
+        if (boat.GetIsSketchy() && boat.GetSketchy()->GetRow() >= 0 && boat.GetSketchy()->GetRow() < rows)
+        {
+            sketchy[boat.GetSketchy()->GetRow()] = true;
+        }
+    }
+
+    mOffRows = { OffScreen, Eaten };
+    mHazards.resize(rows);
+    for (int row = 0; row < rows; row++)
+    {
+        auto& hazards = mHazards[row];
+        hazards.push_back(OffScreen);
+        if (sketchy[row])
+        {
+            hazards.push_back(Sinking);
+        }
+
+        if (cars[row] || mTerrain[row] == Road)
+        {
+            hazards.push_back(Cars);
+        }
+
+        if (mTerrain[row] == River)
+        {
+            hazards.push_back(Water);
+        }
+
+        hazards.push_back(Eaten);
+    }
+}
+
+
+/**
+ * Get the terrain a decor type's terrain attribute names
+ * \param name Value of the attribute
+ * \returns Terrain, land for anything not known
+ */
+CRuleTable::Terrain CRuleTable::GetTerrainKind(const std::wstring& name)
+{
+    if (name == L"river")
+    {
+        return River;
+    }
+
+    if (name == L"road")
+    {
+        return Road;
+    }
+
+    return Land;
+}
+
+
+/**
+ * Get the hazards of a row
+ * \param row Row of tiles
+ * \returns Hazards in the order they are checked
+ */
+const std::vector<CRuleTable::Hazard>& CRuleTable::GetHazards(int row) const
+{
+    return row >= 0 && row < GetRows() ? mHazards[row] : mOffRows;
+}
+
+
+/**
+ * Get how a hazard loses the level
+ * \param hazard Hazard that applied
+ * \returns Loss condition
+ */
+CRuleTable::Loss CRuleTable::GetLoss(Hazard hazard)
+{
+    switch (hazard)
+    {
+    case OffScreen:
+        return OutOfBounds;
+
+    case Cars:
+        return HitByCar;
+
+    case Sinking:
+    case Water:
+        return FellInRiver;
+
+    case Eaten:
+        return CargoEaten;
+    }
+
+    return NoLoss;
+}
+
+
+/**
+ * Get a short name for a loss condition, for reports
+ * \param loss Loss condition
+ * \returns Name, empty for no loss
+ */
+const wchar_t* CRuleTable::GetLossName(Loss loss)
+{
+    switch (loss)
+    {
+    case HitByCar:
+        return L"car";
+
+    case FellInRiver:
+        return L"river";
+
+    case CargoEaten:
+        return L"eaten";
+
+    case OutOfBounds:
+        return L"drift";
+
+    default:
+        return L"";
+    }
+}
+
@@ -0,0 +1,87 @@
+/**
+ * \file RuleTable.h
+ *
+ * \author Michael Dittman
+ *
+ * What each row of a level is and what on it can lose the level.
+ */
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+
+class CItem;
+
+
+/**
+ * What each row of a level is and what on it can lose the level.
+ *
+ * Rows are land, road or river. Decor types in a level say which with
+ * a "terrain" attribute, so a level can add a new kind of river or road
+ * without any code knowing its id. The hazards each row has are worked
+ * out once when the level is loaded, in the order they are checked.
+ * CGame checks the hazards of the hero's row once an update, and the
+ * first one that applies decides how the level was lost.
+ */
+class CRuleTable
+{
+public:
+    /// Number of rows of tiles on a screen of the play area, and in a level unless it says
+    const static int Rows = 16;
+
+    /// What a row of tiles is
+    enum Terrain { Land, Road, River };
+
+    /// Something that can lose the level
+    enum Hazard
+    {
+        OffScreen,      ///< The hero is carried off the side of the play area
+        Sinking,        ///< A sketchy boat the hero is riding breaks
+        Cars,           ///< A car runs into the hero
+        Water,          ///< The hero is in the river and not on a boat
+        Eaten           ///< Cargo left without the hero is eaten
+    };
+
+    /// How a level was lost
+    enum Loss { NoLoss = -1, HitByCar = 1, FellInRiver = 2, CargoEaten = 3, OutOfBounds = 4 };
+
+    /// Default constructor (disabled)
+    CRuleTable() = delete;
+
+    /// Copy constructor (disabled)
+    CRuleTable(const CRuleTable&) = delete;
+
+    CRuleTable(const std::vector<std::shared_ptr<CItem>>& items, const std::map<std::wstring, Terrain>& terrain,
+        int rows = Rows);
+
+    static Terrain GetTerrainKind(const std::wstring& name);
+
+    /** Get what a row is
+     * \param row Row of tiles
+     * \returns Terrain of the row, land off the play area */
+    Terrain GetTerrain(int row) const { return row >= 0 && row < GetRows() ? mTerrain[row] : Land; }
+
+    /** Get the number of rows the level has
+     * \returns Rows of tiles, a screen's worth or more */
+    int GetRows() const { return (int)mTerrain.size(); }
+
+    const std::vector<Hazard>& GetHazards(int row) const;
+
+    static Loss GetLoss(Hazard hazard);
+
+    static const wchar_t* GetLossName(Loss loss);
+
+private:
+    /// Terrain of each row
+    std::vector<Terrain> mTerrain;
+
+    /// Hazards of each row, in the order they are checked
+    std::vector<std::vector<Hazard>> mHazards;
+
+    /// Hazards anywhere off of the rows
+    std::vector<Hazard> mOffRows;
+};
+
@@ -0,0 +1,272 @@
+/**
+ * \file SessionHost.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "SessionHost.h"
+#include "Game.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+/// Number of sessions stepped together on one thread
+const int Grain = 256;
+
+/// Sessions the benchmark hosts
+const int BenchmarkSessions = 10000;
+
+/// Ticks the benchmark runs
+const int BenchmarkTicks = 1000;
+
+/// Level time in seconds benchmark sessions run out of time at
+const double BenchmarkLimit = 60;
+
+
+/**
+ * Constructor. Makes a template of each of the game's levels.
+ *
+ * Every level is loaded into the game to make its template, so this
+ * is done on the thread that owns the game. The game is left with the
+ * last level loaded.
+ *
+ * \param game Game with its levels added
+ * \param capacity Most sessions that can be open at once
+ * \param limit Level time in seconds a session runs out of time at
+ */
+CSessionHost::CSessionHost(CGame* game, int capacity, double limit) :
+    mPool(CThreadPool::GetShared()), mSessions(new Session[capacity]), mCapacity(capacity)
+{
+    for (int level = 0; level < game->GetLevelCount(); level++)
+    {
+        game->Load(level);
+        mTemplates.push_back(make_unique<CLevelTemplate>(game, limit));
+    }
+
+    for (int slot = capacity - 1; slot >= 0; slot--)
+    {
+        mFree.push_back(slot);
+    }
+
+    mFound.resize((capacity + Grain - 1) / Grain);
+    for (auto& found : mFound)
+    {
+        found.reserve(Grain);
+    }
+    mUpdates.reserve(capacity);
+}
+
+
+/**
+ * Open a session
+ * \param level Level the session plays
+ * \returns Session number, -1 if there is no such level or the host is full
+ */
+int CSessionHost::Open(int level)
+{
+    if (level < 0 || level >= GetLevelCount() || mFree.empty())
+    {
+        return -1;
+    }
+
+    int session = mFree.back();
+    mFree.pop_back();
+
+    Session& opened = mSessions[session];
+    opened.mLevel = mTemplates[level].get();
+    opened.mState = opened.mLevel->GetStart();
+
+    // Anything left from the last session in this slot
+    unsigned char input;
+    while (opened.mInputs.Pop(input))
+    {
+    }
+
+    mOpen++;
+    return session;
+}
+
+
+/**
+ * Close a session
+ * \param session Session to close
+ * \returns False if there is no such session open
+ */
+bool CSessionHost::Close(int session)
+{
+    if (session < 0 || session >= mCapacity || mSessions[session].mLevel == nullptr)
+    {
+        return false;
+    }
+
+    mSessions[session].mLevel = nullptr;
+    mFree.push_back(session);
+    mOpen--;
+    return true;
+}
+
+
+/**
+ * Send an input to a session. Called from the front end thread.
+ * \param session Session to send to
+ * \param action CLevelTemplate action
+ * \returns False if there is no such session slot or the session
+ * has too many inputs waiting
+ */
+bool CSessionHost::PostInput(int session, int action)
+{
+    if (session < 0 || session >= mCapacity)
+    {
+        return false;
+    }
+
+    return mSessions[session].mInputs.Push((unsigned char)action);
+}
+
+
+/**
+ * Step every open session once
+ */
+void CSessionHost::Tick()
+{
+    mPool->ParallelFor(0, mCapacity, Grain, [this](int begin, int end)
+        {
+            vector<Update>& found = mFound[begin / Grain];
+            found.clear();
+
+            for (int i = begin; i < end; i++)
+            {
+                Session& session = mSessions[i];
+                if (session.mLevel == nullptr)
+                {
+                    continue;
+                }
+
+                unsigned char input = CLevelTemplate::Wait;
+                session.mInputs.Pop(input);
+
+                CLevelTemplate::State before = session.mState;
+                CLevelTemplate::Result result = session.mLevel->Advance(session.mState, input);
+                int changes = HeroChanged | CargoChanged;
+                if (result != CLevelTemplate::Playing)
+                {
+                    session.mState = session.mLevel->GetStart();
+                }
+                else
+                {
+                    changes = GetChanges(before, session.mState);
+                }
+
+                if (result != CLevelTemplate::Playing || changes != 0)
+                {
+                    Update update;
+                    update.mSession = i;
+                    update.mChanges = changes;
+                    if (changes & HeroChanged)
+                    {
+                        update.mHero = session.mState.mHero;
+                    }
+                    if (changes & CargoChanged)
+                    {
+                        update.mCargo = session.mState.mCargo;
+                    }
+                    update.mResult = result;
+                    found.push_back(update);
+                }
+            }
+        });
+
+    mUpdates.clear();
+    for (auto& found : mFound)
+    {
+        mUpdates.insert(mUpdates.end(), found.begin(), found.end());
+        found.clear();
+    }
+}
+
+
+/**
+ * Get the parts of a state a step changed in a way the lanes don't say
+ * \param before State at the start of the step
+ * \param after State at the end of it
+ * \returns Changes bits, HeroChanged if the hero moved on its own and
+ * CargoChanged if the cargo changed
+ */
+int CSessionHost::GetChanges(const CLevelTemplate::State& before, const CLevelTemplate::State& after)
+{
+    int changes = 0;
+
+    // A hero riding a boat moves with it, which can be worked out
+    if (before.mHero.mRow != after.mHero.mRow || before.mHero.mBoat != after.mHero.mBoat ||
+        (after.mHero.mBoat < 0 && before.mHero.mX != after.mHero.mX))
+    {
+        changes |= HeroChanged;
+    }
+
+    if (before.mCargo != after.mCargo)
+    {
+        changes |= CargoChanged;
+    }
+
+    return changes;
+}
+
+
+/**
+ * Host many sessions making random inputs and time the ticks
+ * \param levels Directory the levels are in, ending with a separator
+ * \returns Report of the tick times
+ */
+std::wstring CSessionHost::Benchmark(const std::wstring& levels)
+{
+    CGame game;
+    game.LoadLevels(levels, 4);
+
+    CSessionHost host(&game, BenchmarkSessions, BenchmarkLimit);
+    for (int i = 0; i < BenchmarkSessions && host.GetLevelCount() > 0; i++)
+    {
+        host.Open(i % host.GetLevelCount());
+    }
+
+    // Random inputs, about one a second a session, the same every run
+    unsigned int seed = 12345;
+    vector<double> ticks;
+    long long updates = 0;
+    for (int tick = 0; tick < BenchmarkTicks; tick++)
+    {
+        for (int i = 0; i < BenchmarkSessions; i++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            if ((seed >> 16) % 20 == 0)
+            {
+                host.PostInput(i, (seed >> 8) % (CLevelTemplate::ClickCargo + 3));
+            }
+        }
+
+        auto start = chrono::steady_clock::now();
+        host.Tick();
+        ticks.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+        updates += host.GetUpdates().size();
+    }
+
+    double total = 0;
+    for (double time : ticks)
+    {
+        total += time;
+    }
+    sort(ticks.begin(), ticks.end());
+
+    wostringstream report;
+    report << L"Session host benchmark, " << host.GetSessionCount() << L" sessions, "
+        << host.mPool->GetThreadCount() << L" threads" << endl << endl;
+    report << fixed << setprecision(3);
+    report << L"Tick takes " << total / ticks.size() << L" ms mean, " << ticks[ticks.size() / 2] << L" ms median, "
+        << ticks[ticks.size() * 99 / 100] << L" ms 99th percentile, " << ticks.back() << L" ms longest" << endl;
+    report << setprecision(1) << (double)updates / BenchmarkTicks << L" updates a tick" << endl;
+    report << sizeof(Session) << L" bytes a session beyond the shared templates" << endl;
+    return report.str();
+}
@@ -0,0 +1,130 @@
+/**
+ * \file SessionHost.h
+ *
+ * \author Michael Dittman
+ *
+ * Hosts many independent games at once without windows.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include "ThreadPool.h"
+#include "LevelTemplate.h"
+#include "SpscQueue.h"
+
+class CGame;
+
+
+/**
+ * Hosts many independent games at once without windows.
+ *
+ * Each session plays a level on its own, one step a tick. Every level
+ * is made into a CLevelTemplate once and sessions on the same level
+ * share it, so a session is only where its hero and cargo are, the
+ * step it is at and a short queue of inputs. Tick steps the sessions
+ * in batches on the shared thread pool.
+ *
+ * Inputs are posted to a session's queue from one other thread, the
+ * front end, and a session makes at most one a tick. Open, Close and
+ * Tick are called from the thread that owns the host.
+ *
+ * After each tick GetUpdates has the sessions whose state changed in
+ * a way that can't be worked out from the lanes: the hero moved,
+ * got on or off a boat, cargo was picked up or put down, or the level
+ * was won, lost or ran out of time. An update only has the parts of
+ * the state that changed. A session that ends starts its level again
+ * at step 0, and its update has the hero and cargo at the start.
+ */
+class CSessionHost
+{
+public:
+    /// Parts of a session's state an update has
+    enum Changes { HeroChanged = 1, CargoChanged = 2 };
+
+    /// The parts of a session's state a tick changed
+    struct Update
+    {
+        int mSession = 0;                               ///< Session that changed
+        int mChanges = 0;                               ///< Changes bits for the parts it has
+        CLaneModel::Position mHero;                     ///< Where the hero is, if HeroChanged
+        int mCargo = 0;                                 ///< Where the cargo is, if CargoChanged
+        CLevelTemplate::Result mResult = CLevelTemplate::Playing;   ///< How the tick went
+    };
+
+    /// Default constructor (disabled)
+    CSessionHost() = delete;
+
+    /// Copy constructor (disabled)
+    CSessionHost(const CSessionHost&) = delete;
+
+    CSessionHost(CGame* game, int capacity, double limit);
+
+    int Open(int level);
+
+    bool Close(int session);
+
+    bool PostInput(int session, int action);
+
+    void Tick();
+
+    /** Get the sessions that changed in the last tick
+     * \returns Updates, in session order */
+    const std::vector<Update>& GetUpdates() const { return mUpdates; }
+
+    /** Get the number of open sessions
+     * \returns Number of sessions */
+    int GetSessionCount() const { return mOpen; }
+
+    /** Get the number of levels sessions can play
+     * \returns Number of levels */
+    int GetLevelCount() const { return (int)mTemplates.size(); }
+
+    /** Get the template of a level
+     * \param level Level number
+     * \returns Template sessions on that level share */
+    const CLevelTemplate* GetTemplate(int level) const { return mTemplates[level].get(); }
+
+    static std::wstring Benchmark(const std::wstring& levels);
+
+private:
+    /// Inputs a session can have waiting
+    const static int InputSlots = 8;
+
+    /// One game
+    struct Session
+    {
+        const CLevelTemplate* mLevel = nullptr;             ///< Level being played, null if closed
+        CLevelTemplate::State mState;                       ///< Where the session is in it
+        CSpscQueue<unsigned char, InputSlots> mInputs;      ///< Inputs from the front end
+    };
+
+    static int GetChanges(const CLevelTemplate::State& before, const CLevelTemplate::State& after);
+
+    /// Threads the sessions are stepped on
+    CThreadPool* mPool;
+
+    /// Templates, by level
+    std::vector<std::unique_ptr<CLevelTemplate>> mTemplates;
+
+    /// Every session slot, open or not. Never reallocated, as the
+    /// front end posts to the queues while sessions are stepped
+    std::unique_ptr<Session[]> mSessions;
+
+    /// Number of session slots
+    int mCapacity = 0;
+
+    /// Slots that are closed, the one to open next at the back
+    std::vector<int> mFree;
+
+    /// Number of open sessions
+    int mOpen = 0;
+
+    /// Updates found by each batch of sessions in the last tick
+    std::vector<std::vector<Update>> mFound;
+
+    /// Updates of the last tick
+    std::vector<Update> mUpdates;
+};
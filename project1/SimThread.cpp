@@ -0,0 +1,394 @@
+/**
+ * \file SimThread.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "SimThread.h"
+#include "Game.h"
+#include <cmath>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <mmsystem.h>
+
+#pragma comment(lib, "winmm.lib")
+
+using namespace std;
+using namespace Gdiplus;
+
+/// Length in seconds of a tick
+constexpr double CSimThread::TickTime;
+
+/// Most ticks run back to back to catch up. Time past that is dropped,
+/// so a long pause doesn't become a burst of ticks.
+const int MaxCatchUp = 25;
+
+
+/**
+ * Constructor
+ * \param game Game to run
+ */
+CSimThread::CSimThread(CGame* game) : mGame(game)
+{
+}
+
+
+/**
+ * Destructor
+ */
+CSimThread::~CSimThread()
+{
+    Stop();
+}
+
+
+/**
+ * Start running the game on the thread
+ */
+void CSimThread::Start()
+{
+    if (IsRunning())
+    {
+        return;
+    }
+
+    ResetTimings();
+    mStop = false;
+
+    // Sleeps are only as fine as the system timer
+    timeBeginPeriod(1);
+    mThread = thread(&CSimThread::Loop, this);
+}
+
+
+/**
+ * Stop running the game, waiting for the thread to finish
+ */
+void CSimThread::Stop()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+
+    mStop = true;
+    mThread.join();
+    timeEndPeriod(1);
+
+    // Anything still queued was meant for the thread
+    Input input;
+    while (mInputs.Pop(input))
+    {
+    }
+    mBacklog.clear();
+}
+
+
+/**
+ * Send a key press to the game
+ * \param key Key pressed
+ */
+void CSimThread::PostKey(UINT key)
+{
+    Input input;
+    input.mKey = key;
+    Post(input);
+}
+
+
+/**
+ * Send a click to the game
+ * \param x X clicked in virtual pixels
+ * \param y Y clicked in virtual pixels
+ */
+void CSimThread::PostClick(double x, double y)
+{
+    Input input;
+    input.mClick = true;
+    input.mX = x;
+    input.mY = y;
+    Post(input);
+}
+
+
+/**
+ * Send an input to the thread, after any that are already waiting
+ * \param input Key press or click
+ */
+void CSimThread::Post(const Input& input)
+{
+    mBacklog.push_back(input);
+    SendBacklog();
+    if (!mBacklog.empty())
+    {
+        mHeldInputs++;
+    }
+}
+
+
+/**
+ * Move inputs waiting on the window's side into the queue while there's room
+ */
+void CSimThread::SendBacklog()
+{
+    while (!mBacklog.empty() && mInputs.Push(mBacklog.front()))
+    {
+        mBacklog.pop_front();
+    }
+}
+
+
+/**
+ * Get the newest frame to paint.
+ *
+ * Called by the window. Bitmaps in the frame are swapped for the
+ * window's copies of them, making any copies it doesn't have yet.
+ * Inputs waiting for room in the queue are sent on first.
+ *
+ * \returns Frame, null until the thread has published one
+ */
+const CRenderList* CSimThread::Acquire()
+{
+    // The thread has had a chance to take inputs since the last paint
+    SendBacklog();
+
+    if (!mFrames.Acquire())
+    {
+        return mHasFrame ? &mPresented : nullptr;
+    }
+
+    const Frame& frame = mFrames.GetFront();
+    chrono::duration<double, milli> latency = chrono::steady_clock::now() - frame.mPublished;
+    mLatencies.Add(latency.count());
+
+    // A copy made before a level was loaded may be of a bitmap that
+    // has since been freed, with a new one now at the same address
+    bool loaded = frame.mLoads != mCopiesLoads;
+    vector<Bitmap*> missing;
+    for (auto& command : frame.mList.GetCommands())
+    {
+        if (command.mType == CRenderList::Image && (loaded || mCopies.find(command.mImage) == mCopies.end()) &&
+            find(missing.begin(), missing.end(), command.mImage) == missing.end())
+        {
+            missing.push_back(command.mImage);
+        }
+    }
+
+    if (!missing.empty())
+    {
+        auto lock = Lock();
+
+        // The frame's bitmaps may be gone if a level loaded since, so keep
+        // painting the last frame until one from the new level comes
+        if (frame.mLoads != mGame->GetLoads())
+        {
+            return mHasFrame ? &mPresented : nullptr;
+        }
+
+        // The renderer's sprites of the freed copies go with them
+        if (loaded)
+        {
+            mCopies.clear();
+            mGame->ClearSprites();
+            mCopiesLoads = frame.mLoads;
+        }
+
+        for (auto bitmap : missing)
+        {
+            mCopies[bitmap] = unique_ptr<Bitmap>(bitmap->Clone(0, 0,
+                (INT)bitmap->GetWidth(), (INT)bitmap->GetHeight(), bitmap->GetPixelFormat()));
+        }
+    }
+
+    mPresented.Clear();
+    for (auto& command : frame.mList.GetCommands())
+    {
+        if (command.mType == CRenderList::Image)
+        {
+            Bitmap* copy = mCopies[command.mImage].get();
+            if (copy != nullptr)
+            {
+                mPresented.DrawImage(copy, command.mDest, command.mSource);
+            }
+        }
+        else
+        {
+            mPresented.FillRectangle(Color(command.mColor), command.mDest.X, command.mDest.Y,
+                command.mDest.Width, command.mDest.Height);
+        }
+    }
+
+    mHasFrame = true;
+    return &mPresented;
+}
+
+
+/**
+ * Record how long a paint took. Called by the window.
+ * \param milliseconds Time the paint took
+ */
+void CSimThread::PaintDone(double milliseconds)
+{
+    mPaints.Add(milliseconds);
+}
+
+
+/**
+ * Loop run by the thread.
+ *
+ * Each time around, the ticks that are due are run and then one
+ * frame is published, however many ticks there were.
+ */
+void CSimThread::Loop()
+{
+    auto tick = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(TickTime));
+    auto next = chrono::steady_clock::now();
+    auto last = next;
+
+    while (!mStop)
+    {
+        this_thread::sleep_until(next);
+
+        auto start = chrono::steady_clock::now();
+        {
+            auto lock = Lock();
+
+            mIntervals.Add(chrono::duration<double, milli>(start - last).count());
+            mLate += start - next > tick / 2 ? 1 : 0;
+            last = start;
+
+            int ticks = 0;
+            while (chrono::steady_clock::now() >= next && ticks < MaxCatchUp)
+            {
+                Tick();
+                next += tick;
+                ticks++;
+            }
+
+            if (ticks == MaxCatchUp)
+            {
+                next = chrono::steady_clock::now() + tick;
+            }
+
+            // Plan the hint once a frame, however many ticks there were
+            mGame->UpdatePathHint();
+
+            Frame& frame = mFrames.GetBack();
+            frame.mList.Clear();
+            mGame->BuildFrame(&frame.mList);
+            frame.mLoads = mGame->GetLoads();
+            frame.mPublished = chrono::steady_clock::now();
+            mPublished++;
+
+            mUpdates.Add(chrono::duration<double, milli>(frame.mPublished - start).count());
+        }
+
+        mFrames.Publish();
+    }
+}
+
+
+/**
+ * Run one tick: the inputs that came in, then the game
+ */
+void CSimThread::Tick()
+{
+    Input input;
+    while (mInputs.Pop(input))
+    {
+        if (input.mClick)
+        {
+            mGame->ClickCargo(mGame->HitTest(input.mX, input.mY));
+        }
+        else
+        {
+            mGame->moveHero(input.mKey);
+        }
+    }
+
+    mGame->Update(TickTime);
+    mGame->UpdateControlPanel(TickTime);
+    mTicks++;
+}
+
+
+/**
+ * Get a report of how steady the ticks are and how long frames take to paint
+ * \returns Report text
+ */
+wstring CSimThread::GetReport()
+{
+    wostringstream report;
+    report << fixed << setprecision(2);
+
+    {
+        auto lock = Lock();
+        report << L"Simulation thread, " << TickTime * 1000 << L" ms ticks" << endl << endl;
+        report << mTicks << L" ticks, " << mPublished << L" frames published" << endl;
+        report << L"Loop interval " << mIntervals.GetMean() << L" ms mean, " << mIntervals.GetDeviation()
+            << L" ms deviation, " << mIntervals.mMax << L" ms longest" << endl;
+        report << L"Loops started over half a tick late: " << mLate << endl;
+        report << L"Ticks and frame take " << mUpdates.GetMean() << L" ms mean, " << mUpdates.mMax
+            << L" ms longest" << endl << endl;
+    }
+
+    report << mPaints.mCount << L" paints, " << mLatencies.mCount << L" new frames painted" << endl;
+    report << L"Paint takes " << mPaints.GetMean() << L" ms mean, " << mPaints.mMax << L" ms longest" << endl;
+    report << L"Frame published to painted " << mLatencies.GetMean() << L" ms mean, " << mLatencies.mMax
+        << L" ms longest" << endl;
+    report << mCopies.size() << L" bitmaps copied for the window" << endl;
+    report << L"Inputs that waited for room in the queue: " << mHeldInputs << endl;
+    return report.str();
+}
+
+
+/**
+ * Start the timings from zero
+ */
+void CSimThread::ResetTimings()
+{
+    mIntervals = Timing();
+    mUpdates = Timing();
+    mTicks = 0;
+    mLate = 0;
+    mPublished = 0;
+    mLatencies = Timing();
+    mPaints = Timing();
+}
+
+
+/**
+ * Add a time
+ * \param time Time to add
+ */
+void CSimThread::Timing::Add(double time)
+{
+    mCount++;
+    mTotal += time;
+    mSquares += time * time;
+    mMax = max(mMax, time);
+}
+
+
+/**
+ * Get the mean of the times
+ * \returns Mean, 0 if there are none
+ */
+double CSimThread::Timing::GetMean() const
+{
+    return mCount > 0 ? mTotal / mCount : 0;
+}
+
+
+/**
+ * Get the standard deviation of the times
+ * \returns Standard deviation, 0 if there are none
+ */
+double CSimThread::Timing::GetDeviation() const
+{
+    double mean = GetMean();
+    return mCount > 0 ? sqrt(max(0.0, mSquares / mCount - mean * mean)) : 0;
+}
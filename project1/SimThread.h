@@ -0,0 +1,187 @@
+/**
+ * \file SimThread.h
+ *
+ * \author Michael Dittman
+ *
+ * Runs the game on a thread of its own and hands frames to the window.
+ */
+
+#pragma once
+
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "RenderList.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+
+class CGame;
+
+
+/**
+ * Runs the game on a thread of its own and hands frames to the window.
+ *
+ * The thread updates the game at a steady tick rate. After the ticks
+ * due it records a frame into a render list and publishes it through
+ * a triple buffer. The window takes the newest frame when it paints,
+ * and sends key presses and clicks through a queue. Neither waits on
+ * the other, so a slow paint doesn't hold up the game and a slow
+ * update doesn't hold up painting. Inputs that find the queue full
+ * wait on the window's side and go in as it empties, so none are lost.
+ *
+ * GDI+ fails calls on an image another thread is using, so the
+ * window never draws the game's own bitmaps. The first time a frame
+ * uses a bitmap a copy is made for the window, with the game paused.
+ * Loading a level can free bitmaps and let new ones reuse their
+ * addresses, so the copies start over with the first frame after one.
+ *
+ * Anything else that uses the game while the thread is running has
+ * to hold Lock, which pauses the game between ticks.
+ */
+class CSimThread
+{
+public:
+    /// Length in seconds of a tick. Defined here so the benchmarks that
+    /// tick a game the same way don't need the thread linked in
+    constexpr static double TickTime = 0.010;
+
+    /// Copy constructor (disabled)
+    CSimThread(const CSimThread&) = delete;
+
+    /// Default constructor (disabled)
+    CSimThread() = delete;
+
+    CSimThread(CGame* game);
+
+    virtual ~CSimThread();
+
+    void Start();
+
+    void Stop();
+
+    /** Is the thread running the game?
+     * \returns True if it is */
+    bool IsRunning() const { return mThread.joinable(); }
+
+    void PostKey(UINT key);
+
+    void PostClick(double x, double y);
+
+    const CRenderList* Acquire();
+
+    void PaintDone(double milliseconds);
+
+    /** Pause the game so it can be used from another thread
+     * \returns Lock that holds the game until it is let go of */
+    std::unique_lock<std::mutex> Lock() { return std::unique_lock<std::mutex>(mMutex); }
+
+    std::wstring GetReport();
+
+private:
+    /// A key press or click from the window
+    struct Input
+    {
+        bool mClick = false;    ///< True for a click, false for a key
+        UINT mKey = 0;          ///< Key pressed
+        double mX = 0;          ///< X clicked in virtual pixels
+        double mY = 0;          ///< Y clicked in virtual pixels
+    };
+
+    /// A frame recorded by the thread
+    struct Frame
+    {
+        /// What to draw
+        CRenderList mList;
+
+        /// When the frame was published
+        std::chrono::steady_clock::time_point mPublished;
+
+        /// CGame::GetLoads when the frame was recorded
+        int mLoads = 0;
+    };
+
+    /// Running count, total, squares and largest of some times
+    struct Timing
+    {
+        long long mCount = 0;   ///< Number of times
+        double mTotal = 0;      ///< Sum of the times
+        double mSquares = 0;    ///< Sum of the squares of the times
+        double mMax = 0;        ///< Largest time
+
+        void Add(double time);
+        double GetMean() const;
+        double GetDeviation() const;
+    };
+
+    void Post(const Input& input);
+
+    void SendBacklog();
+
+    void Loop();
+
+    void Tick();
+
+    void ResetTimings();
+
+    /// The game being run
+    CGame* mGame;
+
+    /// The thread running the game
+    std::thread mThread;
+
+    /// Set to ask the thread to finish
+    std::atomic<bool> mStop{ false };
+
+    /// Held by the thread while it uses the game
+    std::mutex mMutex;
+
+    /// Key presses and clicks from the window
+    CSpscQueue<Input, 64> mInputs;
+
+    /// Inputs waiting for room in mInputs, only used by the window
+    std::deque<Input> mBacklog;
+
+    /// Inputs that found mInputs full and had to wait, only used by the window
+    long long mHeldInputs = 0;
+
+    /// Frames from the thread to the window
+    CTripleBuffer<Frame> mFrames;
+
+    /// The newest frame, drawing the window's copies of the bitmaps
+    CRenderList mPresented;
+
+    /// True once a frame has been acquired
+    bool mHasFrame = false;
+
+    /// The window's copies of the game's bitmaps
+    std::map<Gdiplus::Bitmap*, std::unique_ptr<Gdiplus::Bitmap>> mCopies;
+
+    /// CGame::GetLoads for the bitmaps mCopies are copies of
+    int mCopiesLoads = 0;
+
+    /// Milliseconds between the starts of one loop and the next, under mMutex
+    Timing mIntervals;
+
+    /// Milliseconds the ticks and frame of a loop take, under mMutex
+    Timing mUpdates;
+
+    /// Ticks run, under mMutex
+    long long mTicks = 0;
+
+    /// Loops that started more than half a tick late, under mMutex
+    long long mLate = 0;
+
+    /// Frames published, under mMutex
+    long long mPublished = 0;
+
+    /// Milliseconds from a frame being published to it being acquired
+    Timing mLatencies;
+
+    /// Milliseconds paints take
+    Timing mPaints;
+};
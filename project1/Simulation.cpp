@@ -0,0 +1,245 @@
+/**
+ * \file Simulation.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "Simulation.h"
+#include "Game.h"
+#include "NextEventVisitor.h"
+#include <cmath>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+/// Length of a tick in fixed tick mode, the longest step the view used to take
+const double Tick = 0.050;
+
+/// Shortest step in event driven mode. Rules like the sketchy boat's
+/// compare with >, so the step that lands on an event is followed by
+/// one this long to get past it.
+const double MinStep = 0.000001;
+
+
+/**
+ * Constructor
+ * \param game Game to play, with its levels added
+ * \param mode How to step through time
+ */
+CSimulation::CSimulation(CGame* game, Mode mode) : mGame(game), mMode(mode)
+{
+}
+
+
+/**
+ * Play a replay from the start of its level.
+ *
+ * Stops as soon as the level is won or lost, otherwise once the
+ * inputs run out and the level time reaches the limit.
+ *
+ * \param replay Inputs to play
+ * \param limit Level time in seconds to stop at if the level does not end
+ * \returns How the level played out
+ */
+CSimulation::Outcome CSimulation::Run(const CReplay& replay, double limit)
+{
+    mGame->Load(replay.GetLevel());
+    mUpdates = 0;
+    mSettle = false;
+
+    bool ended = false;
+    for (auto& input : replay.GetInputs())
+    {
+        ended = Advance(input.mTime - mGame->GetLevelTime(), true);
+        if (ended)
+        {
+            break;
+        }
+
+        mGame->Perform(input);
+        mSettle = true;
+    }
+
+    if (!ended)
+    {
+        Advance(limit - mGame->GetLevelTime(), true);
+    }
+
+    Outcome outcome;
+    outcome.mWon = mGame->GetGameWon();
+    outcome.mLossCondition = mGame->GetGameLost() ? mGame->GameLossCondition() : -1;
+    outcome.mTime = mGame->GetLevelTime();
+    outcome.mUpdates = mUpdates;
+    return outcome;
+}
+
+
+/**
+ * Let time pass in the game.
+ * \param duration Time in seconds to let pass
+ * \param stopAtEnd True to stop early when the level is won or lost
+ * \returns True if stopAtEnd is set and the level has ended
+ */
+bool CSimulation::Advance(double duration, bool stopAtEnd)
+{
+    double left = duration;
+    while (true)
+    {
+        if (stopAtEnd && (mGame->GetGameLost() || mGame->GetGameWon()))
+        {
+            return true;
+        }
+
+        if (left <= 0)
+        {
+            return false;
+        }
+
+        double step = Tick;
+        if (mMode == EventDriven)
+        {
+            step = mSettle ? MinStep : max(GetTimeToNextEvent(), MinStep);
+            mSettle = false;
+        }
+
+        step = min(step, left);
+        Step(step);
+        left -= step;
+    }
+}
+
+
+/**
+ * Get how long until something can next change in the game
+ * other than vehicles moving along their lanes.
+ * \returns Time in seconds, HUGE_VAL if nothing will change until the next input
+ */
+double CSimulation::GetTimeToNextEvent()
+{
+    // A finished level only waits to be switched
+    if (mGame->GetGameLost() || mGame->GetGameWon())
+    {
+        return mGame->GetTimeToSwitchLevel();
+    }
+
+    double next = HUGE_VAL;
+
+    // The timer starts once the get ready countdown is over
+    double ready = CControlPanel::ReadyTime - mGame->GetControlPanel()->GetTime();
+    if (ready >= 0)
+    {
+        next = min(next, ready);
+    }
+
+    auto hero = mGame->GetHero();
+    double x = hero->GetX();
+    double speed = hero->GetSpeed();
+
+    if (hero->GetOnBoat())
+    {
+        // Drifting off either side of the game area
+        if (speed > 0)
+        {
+            next = min(next, (mGame->GetHeroMaxX() - x) / speed);
+        }
+        else if (speed < 0)
+        {
+            next = min(next, x / -speed);
+        }
+    }
+
+    // Cars reaching the hero and sketchy boats breaking
+    CNextEventVisitor visitor(hero);
+    mGame->Accept(&visitor);
+    next = min(next, visitor.GetTimeToEvent());
+
+    return next;
+}
+
+
+/**
+ * Update the game and its control panel
+ * \param elapsed Time in seconds
+ */
+void CSimulation::Step(double elapsed)
+{
+    mGame->Update(elapsed);
+    mGame->UpdateControlPanel(elapsed);
+    mUpdates++;
+}
+
+
+/**
+ * Play every replay in a directory in both modes and report
+ * whether they played out the same way.
+ *
+ * The modes have to agree on whether the level was won or how it
+ * was lost. The event driven mode notices things up to a tick
+ * sooner, so the times may differ by that much.
+ *
+ * \param levels Directory the levels are in, ending with a separator
+ * \param replays Directory the replays are in, ending with a separator
+ * \returns Report of the results
+ */
+std::wstring CSimulation::CheckReplays(const std::wstring& levels, const std::wstring& replays)
+{
+    // Each mode plays its own game so neither disturbs the other
+    CGame fixedGame;
+    fixedGame.LoadLevels(levels, 4);
+    CGame eventGame;
+    eventGame.LoadLevels(levels, 4);
+
+    CSimulation fixedTick(&fixedGame, FixedTick);
+    CSimulation eventDriven(&eventGame, EventDriven);
+
+    wostringstream report;
+    report << L"Replay check, fixed tick vs event driven" << endl;
+
+    int count = 0;
+    int matched = 0;
+    CFileFind finder;
+    BOOL working = finder.FindFile((replays + L"*.xml").c_str());
+    while (working)
+    {
+        working = finder.FindNextFile();
+
+        CReplay replay;
+        if (!replay.Load((LPCTSTR)finder.GetFilePath()))
+        {
+            continue;
+        }
+
+        double limit = replay.GetInputs().empty() ? 0 : replay.GetInputs().back().mTime;
+        limit += 10;
+
+        auto start = chrono::steady_clock::now();
+        Outcome fixedOutcome = fixedTick.Run(replay, limit);
+        auto middle = chrono::steady_clock::now();
+        Outcome eventOutcome = eventDriven.Run(replay, limit);
+        auto end = chrono::steady_clock::now();
+
+        bool match = fixedOutcome.mWon == eventOutcome.mWon &&
+            fixedOutcome.mLossCondition == eventOutcome.mLossCondition &&
+            fabs(fixedOutcome.mTime - eventOutcome.mTime) <= Tick;
+
+        count++;
+        matched += match ? 1 : 0;
+
+        const wchar_t* result = fixedOutcome.mWon ? L"won" :
+            fixedOutcome.mLossCondition > 0 ? CRuleTable::GetLossName((CRuleTable::Loss)fixedOutcome.mLossCondition) : L"unfinished";
+
+        report << endl << (LPCTSTR)finder.GetFileName() << L", level " << replay.GetLevel() << L", "
+            << replay.GetInputs().size() << L" inputs: " << result << L" at " << fixed << setprecision(2)
+            << fixedOutcome.mTime << L" s, " << (match ? L"match" : L"MISMATCH") << endl;
+        report << L"  fixed tick   " << setw(6) << fixedOutcome.mUpdates << L" updates "
+            << setw(8) << chrono::duration<double, milli>(middle - start).count() << L" ms" << endl;
+        report << L"  event driven " << setw(6) << eventOutcome.mUpdates << L" updates "
+            << setw(8) << chrono::duration<double, milli>(end - middle).count() << L" ms" << endl;
+    }
+
+    report << endl << matched << L" of " << count << L" replays match" << endl;
+    return report.str();
+}
@@ -0,0 +1,81 @@
+/**
+ * \file Simulation.h
+ *
+ * \author Michael Dittman
+ *
+ * Plays a game without drawing it, either a tick at a time or
+ * jumping from one event to the next.
+ */
+
+#pragma once
+
+#include <string>
+#include "Replay.h"
+
+class CGame;
+
+
+/**
+ * Plays a game without drawing it, either a tick at a time or
+ * jumping from one event to the next.
+ *
+ * Between inputs almost nothing happens but vehicles moving along
+ * their lanes, and vehicle locations are worked out directly from
+ * the time. So in event driven mode the game is only updated when
+ * something can change: a car reaching the hero, the hero drifting
+ * off the screen on a boat, a sketchy boat breaking, the get ready
+ * countdown ending, a finished level being switched, or an input.
+ * Both modes use the same CGame::Update, so a replay plays out the
+ * same way in either.
+ */
+class CSimulation
+{
+public:
+    /// How the simulation steps through time
+    enum Mode { FixedTick, EventDriven };
+
+    /// How a replay played out
+    struct Outcome
+    {
+        bool mWon = false;          ///< True if the level was won
+        int mLossCondition = -1;    ///< Loss condition if the level was lost, -1 otherwise
+        double mTime = 0;           ///< Level time in seconds the replay ended at
+        int mUpdates = 0;           ///< Number of game updates it took
+    };
+
+    /// Default constructor (disabled)
+    CSimulation() = delete;
+
+    /// Copy constructor (disabled)
+    CSimulation(const CSimulation&) = delete;
+
+    CSimulation(CGame* game, Mode mode);
+
+    Outcome Run(const CReplay& replay, double limit);
+
+    bool Advance(double duration, bool stopAtEnd);
+
+    double GetTimeToNextEvent();
+
+    /** Get the number of game updates made so far
+     * \returns Number of updates */
+    int GetUpdates() const { return mUpdates; }
+
+    static std::wstring CheckReplays(const std::wstring& levels, const std::wstring& replays);
+
+private:
+    void Step(double elapsed);
+
+    /// Game being played
+    CGame* mGame;
+
+    /// How the simulation steps through time
+    Mode mMode;
+
+    /// Number of game updates made so far
+    int mUpdates = 0;
+
+    /// Take a tiny step next so an input takes effect before anything else happens
+    bool mSettle = false;
+};
+
@@ -32,29 +32,25 @@ CSketchyBoat::CSketchyBoat(CGame* game, std::shared_ptr<Gdiplus::Bitmap> bitmap,
 
 /**
  * Draws the Sketchy Boat
- * \param graphics Graphics context to draw on
+ * \param list Render list to record the drawing into
  */
-void CSketchyBoat::Draw(Gdiplus::Graphics* graphics)
+void CSketchyBoat::Draw(CRenderList* list)
 {
     CGame* game = GetGame();
 
-    if (game->GetHero()->GetOnSketchy() && mTimeRidden > 2.0)
+    if (game->GetHero()->GetOnSketchy() && mTimeRidden > RideTime)
     {
-        game->SetGameLost();
-        // temorary loss condition
-        game->SetLossCondtion(2);
-        
         double wid = mBrokenItemImage->GetWidth();
         double hit = mBrokenItemImage->GetHeight();
 
-        graphics->DrawImage(mBrokenItemImage.get(),
+        list->DrawImage(mBrokenItemImage.get(),
             float(GetX() - wid / 2), float(GetY() - hit / 2),
             (float)mBrokenItemImage->GetWidth(), (float)mBrokenItemImage->GetHeight());
 
     }
     else
     {
-        CVehicle::Draw(graphics);
+        CVehicle::Draw(list);
 
     }
 
@@ -73,7 +69,9 @@ void CSketchyBoat::Update(double elapsed)
 {
     CGame* game = GetGame();
 
-    if (game->GetHero()->GetOnSketchy() && game->GetHero()->GetX() == GetX())
+    // The hero steps along at the boat's speed while the boat's
+    // location is worked out from the time, so allow for rounding
+    if (game->GetHero()->GetOnSketchy() && fabs(game->GetHero()->GetX() - GetX()) < 0.5)
     {
         mTimeRidden += elapsed;
     }
@@ -81,6 +79,9 @@ void CSketchyBoat::Update(double elapsed)
     {
         mTimeRidden = 0;
     }
+
+    // The boat breaks once it has been ridden too long, which
+    // CGame's rules check for after everything has moved
     
     CVehicle::Update(elapsed);
 
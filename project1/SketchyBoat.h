@@ -19,6 +19,9 @@ class CSketchyBoat :
     public CBoat
 {
 public:
+    /// Seconds the hero can ride the boat before it breaks
+    const static int RideTime = 2;
+
     /// Default constructor (disabled)
     CSketchyBoat() = delete;
 
@@ -36,7 +39,7 @@ public:
 
     virtual void Accept(CItemVisitor* visitor) override;
 
-    virtual void Draw(Gdiplus::Graphics* graphics) override;
+    virtual void Draw(CRenderList* list) override;
     /** Gets time hero has been on the boat
     * \return time hero has been on the boat
     */
@@ -0,0 +1,512 @@
+/**
+ * \file SoftwareRenderer.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "SoftwareRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Gdiplus;
+using namespace std;
+
+/// Opaque black in premultiplied ARGB
+const UINT32 ClearColor = 0xff000000;
+
+
+/**
+ * Source pixels of a 32-bit sprite row
+ */
+struct DirectPixels
+{
+    const UINT32* mRow;   ///< Pixels of the row
+
+    /** Get a source pixel
+     * \param x Pixel to get
+     * \returns Premultiplied pixel */
+    UINT32 operator[](int x) const { return mRow[x]; }
+};
+
+
+/**
+ * Source pixels of a palettized sprite row
+ */
+struct PalettePixels
+{
+    const unsigned char* mRow;    ///< Palette indices of the row
+    const UINT32* mPalette;       ///< Palette of the sprite
+
+    /** Get a source pixel, expanded through the palette
+     * \param x Pixel to get
+     * \returns Premultiplied pixel */
+    UINT32 operator[](int x) const { return mPalette[mRow[x]]; }
+};
+
+
+/**
+ * Copy a run of opaque 32-bit pixels
+ * \param dst Frame pixels to copy to
+ * \param in Source row
+ * \param from First source pixel to copy
+ * \param count Number of pixels
+ */
+static void CopyRun(UINT32* dst, const DirectPixels& in, int from, int count)
+{
+    memcpy(dst, in.mRow + from, (size_t)count * 4);
+}
+
+
+/**
+ * Copy a run of opaque palettized pixels
+ * \param dst Frame pixels to copy to
+ * \param in Source row
+ * \param from First source pixel to copy
+ * \param count Number of pixels
+ */
+static void CopyRun(UINT32* dst, const PalettePixels& in, int from, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        dst[i] = in[from + i];
+    }
+}
+
+
+/**
+ * Round a frame coordinate to the nearest pixel
+ * \param value Coordinate to round
+ * \returns Nearest pixel
+ */
+static int RoundPixel(float value)
+{
+    return (int)floor(value + 0.5f);
+}
+
+
+/**
+ * Constructor
+ */
+CSoftwareRenderer::CSoftwareRenderer()
+{
+}
+
+
+/**
+ * Rasterize a render list into a frame.
+ *
+ * The frame is cleared to black first.
+ *
+ * \param list Commands to rasterize
+ * \param pixels First byte of a premultiplied ARGB frame
+ * \param width Frame width in pixels
+ * \param height Frame height in pixels
+ * \param stride Bytes between frame rows
+ * \param scale Frame pixels per virtual pixel
+ * \param pool Threads to rasterize the bands on, or null for the calling thread only
+ */
+void CSoftwareRenderer::Render(const CRenderList& list, unsigned char* pixels, int width, int height, int stride,
+    float scale, CThreadPool* pool)
+{
+    mWidth = width;
+    mHeight = height;
+    mBandRows = max(1, RoundPixel(BandHeight * scale));
+    int bands = (height + mBandRows - 1) / mBandRows;
+
+    mBins.resize(bands);
+    for (auto& bin : mBins)
+    {
+        bin.clear();
+    }
+    mResolved.clear();
+
+    //
+    // Convert the commands to frame pixels and bin them by band.
+    // Sprites are made here since GDI+ objects can't be read from
+    // several threads at once.
+    //
+    for (auto& command : list.GetCommands())
+    {
+        Resolved resolved;
+        resolved.mSprite = nullptr;
+        resolved.mColor = 0;
+        resolved.mX0 = RoundPixel(command.mDest.X * scale);
+        resolved.mY0 = RoundPixel(command.mDest.Y * scale);
+        resolved.mX1 = RoundPixel((command.mDest.X + command.mDest.Width) * scale);
+        resolved.mY1 = RoundPixel((command.mDest.Y + command.mDest.Height) * scale);
+
+        if (command.mType == CRenderList::Image)
+        {
+            const CSprite* sprite = GetSprite(command.mImage);
+            Rect source = command.mSource;
+            source.X = max(0, source.X);
+            source.Y = max(0, source.Y);
+            source.Width = min(source.Width, sprite->GetWidth() - source.X);
+            source.Height = min(source.Height, sprite->GetHeight() - source.Y);
+            if (source.Width <= 0 || source.Height <= 0)
+            {
+                continue;
+            }
+
+            // Images stretched a pixel to hide seams between tiles are
+            // drawn at their real size since pixel aligned blits have no seams
+            if (scale == 1.0f && fabs(command.mDest.Width - source.Width) <= 1 &&
+                fabs(command.mDest.Height - source.Height) <= 1)
+            {
+                resolved.mX1 = resolved.mX0 + source.Width;
+                resolved.mY1 = resolved.mY0 + source.Height;
+            }
+
+            resolved.mSprite = sprite;
+            resolved.mSource = source;
+        }
+        else
+        {
+            resolved.mColor = CSprite::Premultiply(command.mColor);
+        }
+
+        if (resolved.mX0 >= resolved.mX1 || resolved.mY0 >= resolved.mY1 ||
+            resolved.mX1 <= 0 || resolved.mX0 >= width || resolved.mY1 <= 0 || resolved.mY0 >= height)
+        {
+            continue;
+        }
+
+        int index = (int)mResolved.size();
+        mResolved.push_back(resolved);
+
+        int first = max(0, resolved.mY0) / mBandRows;
+        int last = (min(height, resolved.mY1) - 1) / mBandRows;
+        for (int band = first; band <= last; band++)
+        {
+            mBins[band].push_back(index);
+        }
+    }
+
+    if (pool == nullptr)
+    {
+        for (int band = 0; band < bands; band++)
+        {
+            RenderBand(band, pixels, width, height, stride);
+        }
+    }
+    else
+    {
+        pool->ParallelFor(0, bands, 1, [&](int first, int last)
+            {
+                for (int band = first; band < last; band++)
+                {
+                    RenderBand(band, pixels, width, height, stride);
+                }
+            });
+    }
+}
+
+
+/**
+ * Get the sprite for a bitmap, making it the first time
+ * \param bitmap Bitmap to get the sprite of
+ * \returns Sprite with the bitmap's pixels
+ */
+const CSprite* CSoftwareRenderer::GetSprite(Gdiplus::Bitmap* bitmap)
+{
+    auto& sprite = mSprites[bitmap];
+    if (sprite == nullptr)
+    {
+        sprite = CSprite::FromBitmap(bitmap);
+        if (mPalettesEnabled)
+        {
+            sprite->Palettize();
+        }
+    }
+
+    return sprite.get();
+}
+
+
+/**
+ * Set if sprites are palettized when they have few enough colors.
+ *
+ * The sprites we already have are thrown away so they are
+ * made again the new way.
+ *
+ * \param enabled True to store sprites as 8-bit palette indices
+ */
+void CSoftwareRenderer::SetPalettesEnabled(bool enabled)
+{
+    if (enabled != mPalettesEnabled)
+    {
+        mPalettesEnabled = enabled;
+        ClearSprites();
+    }
+}
+
+
+/**
+ * Get the memory all of the sprites take
+ * \returns Size in bytes
+ */
+size_t CSoftwareRenderer::GetSpriteBytes() const
+{
+    size_t bytes = 0;
+    for (auto& sprite : mSprites)
+    {
+        bytes += sprite.second->GetBytes();
+    }
+
+    return bytes;
+}
+
+
+/**
+ * Clear one band and play back its commands
+ * \param band Band to rasterize
+ * \param pixels First byte of the frame
+ * \param width Frame width in pixels
+ * \param height Frame height in pixels
+ * \param stride Bytes between frame rows
+ */
+void CSoftwareRenderer::RenderBand(int band, unsigned char* pixels, int width, int height, int stride)
+{
+    int top = band * mBandRows;
+    int bottom = min(height, top + mBandRows);
+
+    for (int y = top; y < bottom; y++)
+    {
+        UINT32* row = (UINT32*)(pixels + (size_t)y * stride);
+        fill(row, row + width, ClearColor);
+    }
+
+    for (int index : mBins[band])
+    {
+        Draw(mResolved[index], top, bottom, pixels, width, stride);
+    }
+}
+
+
+/**
+ * Draw one command clipped to a range of rows
+ * \param command Command to draw
+ * \param top First row we may draw
+ * \param bottom One past the last row we may draw
+ * \param pixels First byte of the frame
+ * \param width Frame width in pixels
+ * \param stride Bytes between frame rows
+ */
+void CSoftwareRenderer::Draw(const Resolved& command, int top, int bottom, unsigned char* pixels, int width, int stride)
+{
+    int x0 = max(command.mX0, 0);
+    int x1 = min(command.mX1, width);
+    int y0 = max(command.mY0, top);
+    int y1 = min(command.mY1, bottom);
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    if (command.mSprite == nullptr)
+    {
+        for (int y = y0; y < y1; y++)
+        {
+            UINT32* row = (UINT32*)(pixels + (size_t)y * stride);
+            if ((command.mColor >> 24) == 255)
+            {
+                fill(row + x0, row + x1, command.mColor);
+            }
+            else
+            {
+                for (int x = x0; x < x1; x++)
+                {
+                    CSprite::BlendPixel(row[x], command.mColor);
+                }
+            }
+        }
+        return;
+    }
+
+    const Rect& source = command.mSource;
+    int destWidth = command.mX1 - command.mX0;
+    int destHeight = command.mY1 - command.mY0;
+    bool unscaled = destWidth == source.Width && destHeight == source.Height;
+
+    for (int y = y0; y < y1; y++)
+    {
+        int sy = unscaled ? y - command.mY0 : (int)((long long)(y - command.mY0) * source.Height / destHeight);
+        UINT32* row = (UINT32*)(pixels + (size_t)y * stride);
+
+        if (command.mSprite->IsPalettized())
+        {
+            PalettePixels in{ command.mSprite->GetIndexRow(source.Y + sy) + source.X, command.mSprite->GetPalette() };
+            DrawRow(command, in, source.Y + sy, row, x0, x1, unscaled);
+        }
+        else
+        {
+            DirectPixels in{ command.mSprite->GetRow(source.Y + sy) + source.X };
+            DrawRow(command, in, source.Y + sy, row, x0, x1, unscaled);
+        }
+    }
+}
+
+
+/**
+ * Draw one row of an image command
+ * \param command Image command being drawn
+ * \param in Source pixels of the row, starting at the left of the source rectangle
+ * \param spanRow Sprite row the spans come from
+ * \param row Frame row to draw into
+ * \param x0 First frame pixel we may draw
+ * \param x1 One past the last frame pixel we may draw
+ * \param unscaled True if the image is drawn at its real size
+ */
+template <class Source>
+void CSoftwareRenderer::DrawRow(const Resolved& command, const Source& in, int spanRow, UINT32* row,
+    int x0, int x1, bool unscaled)
+{
+    const Rect& source = command.mSource;
+    int destWidth = command.mX1 - command.mX0;
+
+    if (!mSpansEnabled)
+    {
+        // Plain alpha blit of every pixel
+        for (int x = x0; x < x1; x++)
+        {
+            int sx = unscaled ? x - command.mX0 : (int)((long long)(x - command.mX0) * source.Width / destWidth);
+            CSprite::BlendPixel(row[x], in[sx]);
+        }
+        return;
+    }
+
+    auto end = command.mSprite->GetSpansEnd(spanRow);
+    for (auto span = command.mSprite->GetSpansBegin(spanRow); span != end; ++span)
+    {
+        int dx0, dx1;
+        if (!SpanToFrame(command, *span, x0, x1, dx0, dx1))
+        {
+            continue;
+        }
+
+        if (unscaled)
+        {
+            int from = dx0 - command.mX0;
+            if (span->mOpaque)
+            {
+                CopyRun(row + dx0, in, from, dx1 - dx0);
+            }
+            else
+            {
+                for (int x = dx0; x < dx1; x++)
+                {
+                    CSprite::BlendPixel(row[x], in[from++]);
+                }
+            }
+        }
+        else
+        {
+            for (int x = dx0; x < dx1; x++)
+            {
+                int sx = (int)((long long)(x - command.mX0) * source.Width / destWidth);
+                if (span->mOpaque)
+                {
+                    row[x] = in[sx];
+                }
+                else
+                {
+                    CSprite::BlendPixel(row[x], in[sx]);
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Find the frame pixels a span of a sprite row lands on.
+ *
+ * A frame pixel belongs to the span when the source pixel it
+ * samples is in the span, so scaled blits of spans cover exactly
+ * the pixels a plain blit would.
+ *
+ * \param command Image command being drawn
+ * \param span Span of the sprite row
+ * \param x0 First frame pixel we may draw
+ * \param x1 One past the last frame pixel we may draw
+ * \param dx0 Set to the first frame pixel of the span
+ * \param dx1 Set to one past the last frame pixel of the span
+ * \returns True if the span covers any pixels we may draw
+ */
+bool CSoftwareRenderer::SpanToFrame(const Resolved& command, const CSprite::Span& span, int x0, int x1,
+    int& dx0, int& dx1)
+{
+    const Rect& source = command.mSource;
+    int start = max(span.mStart, source.X) - source.X;
+    int end = min(span.mEnd, source.X + source.Width) - source.X;
+    if (start >= end)
+    {
+        return false;
+    }
+
+    long long destWidth = command.mX1 - command.mX0;
+    dx0 = command.mX0 + (int)((start * destWidth + source.Width - 1) / source.Width);
+    dx1 = command.mX0 + (int)((end * destWidth + source.Width - 1) / source.Width);
+    dx0 = max(dx0, x0);
+    dx1 = min(dx1, x1);
+    return dx0 < dx1;
+}
+
+
+/**
+ * Count the bytes the last frame's image blits read and write.
+ *
+ * A plain alpha blit reads the source and the frame and writes the
+ * frame for every pixel. A span blit skips transparent pixels, only
+ * reads the source and writes the frame for opaque pixels, and reads
+ * the span list as it goes. Palettized sprites read one byte per
+ * source pixel instead of four.
+ *
+ * \returns Bytes touched by both kinds of blit
+ */
+CSoftwareRenderer::Traffic CSoftwareRenderer::MeasureTraffic() const
+{
+    Traffic traffic;
+
+    for (auto& command : mResolved)
+    {
+        if (command.mSprite == nullptr)
+        {
+            continue;
+        }
+
+        int x0 = max(command.mX0, 0);
+        int x1 = min(command.mX1, mWidth);
+        int y0 = max(command.mY0, 0);
+        int y1 = min(command.mY1, mHeight);
+        if (x0 >= x1 || y0 >= y1)
+        {
+            continue;
+        }
+
+        const Rect& source = command.mSource;
+        int destHeight = command.mY1 - command.mY0;
+        int sourceBytes = command.mSprite->IsPalettized() ? 1 : 4;
+        for (int y = y0; y < y1; y++)
+        {
+            traffic.mPlainBytes += (long long)(x1 - x0) * 12;
+
+            int sy = (int)((long long)(y - command.mY0) * source.Height / destHeight);
+            auto end = command.mSprite->GetSpansEnd(source.Y + sy);
+            for (auto span = command.mSprite->GetSpansBegin(source.Y + sy); span != end; ++span)
+            {
+                traffic.mSpanBytes += sizeof(CSprite::Span);
+
+                int dx0, dx1;
+                if (SpanToFrame(command, *span, x0, x1, dx0, dx1))
+                {
+                    traffic.mSpanBytes += (long long)(dx1 - dx0) * (sourceBytes + (span->mOpaque ? 4 : 8));
+                }
+            }
+        }
+    }
+
+    return traffic;
+}
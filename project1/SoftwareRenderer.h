@@ -0,0 +1,119 @@
+/**
+ * \file SoftwareRenderer.h
+ *
+ * \author Michael Dittman
+ *
+ * Rasterizes a render list into a frame in horizontal bands.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+#include <memory>
+#include "RenderList.h"
+#include "Sprite.h"
+#include "ThreadPool.h"
+
+
+/**
+ * Rasterizes a render list into a frame in horizontal bands.
+ *
+ * The frame is split into bands one lane row tall. Every command is
+ * binned into the bands it touches and each band plays back its own
+ * commands in list order, clipped to the band. Because every pixel
+ * sees exactly the same commands in the same order, the result does
+ * not depend on how many threads rasterize the bands.
+ */
+class CSoftwareRenderer
+{
+public:
+    /// Height of a band in virtual pixels, one lane row
+    const static int BandHeight = 64;
+
+    CSoftwareRenderer();
+
+    /// Copy constructor (disabled)
+    CSoftwareRenderer(const CSoftwareRenderer&) = delete;
+
+    void Render(const CRenderList& list, unsigned char* pixels, int width, int height, int stride,
+        float scale, CThreadPool* pool);
+
+    /// Forget all of the sprites made from bitmaps
+    void ClearSprites() { mSprites.clear(); }
+
+    /** Set if images are blitted a span at a time
+     * \param enabled True to skip transparent runs, false to alpha blend every pixel */
+    void SetSpansEnabled(bool enabled) { mSpansEnabled = enabled; }
+
+    /** Get if images are blitted a span at a time
+     * \returns True if span blits are used */
+    bool GetSpansEnabled() const { return mSpansEnabled; }
+
+    void SetPalettesEnabled(bool enabled);
+
+    /** Get if sprites are palettized when they have few enough colors
+     * \returns True if sprites are palettized */
+    bool GetPalettesEnabled() const { return mPalettesEnabled; }
+
+    size_t GetSpriteBytes() const;
+
+    /// Bytes of memory the image blits of a frame touch
+    struct Traffic
+    {
+        long long mPlainBytes = 0;  ///< Bytes touched blending every pixel
+        long long mSpanBytes = 0;   ///< Bytes touched blitting spans
+    };
+
+    Traffic MeasureTraffic() const;
+
+private:
+    /// A command converted to frame pixels
+    struct Resolved
+    {
+        int mX0;    ///< Left edge in frame pixels
+        int mY0;    ///< Top edge in frame pixels
+        int mX1;    ///< One past the right edge in frame pixels
+        int mY1;    ///< One past the bottom edge in frame pixels
+        const CSprite* mSprite;   ///< Sprite for image commands, null for fills
+        Gdiplus::Rect mSource;    ///< Part of the sprite to draw
+        UINT32 mColor;            ///< Premultiplied color for fills
+    };
+
+    const CSprite* GetSprite(Gdiplus::Bitmap* bitmap);
+
+    void RenderBand(int band, unsigned char* pixels, int width, int height, int stride);
+
+    void Draw(const Resolved& command, int top, int bottom, unsigned char* pixels, int width, int stride);
+
+    template <class Source>
+    void DrawRow(const Resolved& command, const Source& in, int spanRow, UINT32* row, int x0, int x1, bool unscaled);
+
+    static bool SpanToFrame(const Resolved& command, const CSprite::Span& span, int x0, int x1,
+        int& dx0, int& dx1);
+
+    /// Sprites made from the bitmaps we have drawn
+    std::map<Gdiplus::Bitmap*, std::unique_ptr<CSprite>> mSprites;
+
+    /// The commands of the frame being rendered
+    std::vector<Resolved> mResolved;
+
+    /// Indices into mResolved for each band
+    std::vector<std::vector<int>> mBins;
+
+    /// Height of a band in frame pixels
+    int mBandRows = BandHeight;
+
+    /// Width of the last frame rendered
+    int mWidth = 0;
+
+    /// Height of the last frame rendered
+    int mHeight = 0;
+
+    /// Blit images a span at a time
+    bool mSpansEnabled = true;
+
+    /// Store sprites as 8-bit palette indices when they have few enough colors
+    bool mPalettesEnabled = false;
+};
+
@@ -0,0 +1,402 @@
+/**
+ * \file Solver.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "Solver.h"
+#include "Game.h"
+#include "Simulation.h"
+#include <cmath>
+#include <algorithm>
+#include <unordered_set>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Length in seconds of a step
+const double StepTime = CLaneModel::StepTime;
+
+/// Number of states expanded together on one thread
+const int Grain = 64;
+
+/// Most states the search keeps before it gives up
+const size_t MaxStates = 4000000;
+
+/// Level time in seconds SolveLevels searches up to
+const double SolveLimit = 120;
+
+
+/**
+ * Constructor
+ * \param game Game to solve levels of, with its levels added
+ */
+CSolver::CSolver(CGame* game) : mGame(game), mPool(CThreadPool::GetShared())
+{
+}
+
+
+/**
+ * Find the quickest way to win a level.
+ *
+ * The game is left with the level freshly loaded.
+ *
+ * \param level Level to solve
+ * \param limit Level time in seconds to search up to
+ * \returns The quickest win found, if there is one
+ */
+CSolver::Solution CSolver::Solve(int level, double limit)
+{
+    Solution solution;
+    Build(level, limit);
+
+    // Nothing to carry across means nothing can win the level
+    if (mCargo->GetCount() == 0)
+    {
+        mGame->Load(level);
+        return solution;
+    }
+
+    // States somewhere safe, kept the first time they are reached
+    unordered_set<unsigned long long> settled;
+    settled.insert(GetKey(mStates[0]));
+    vector<int> waiting = { 0 };
+    vector<int> frontier = { 0 };
+
+    int goal = -1;
+    for (int step = mFirstStep; step < mSteps && goal < 0 && mStates.size() < MaxStates; step++)
+    {
+        // The states that just got here, then the ones waiting somewhere safe
+        vector<int> sources = frontier;
+        for (int index : waiting)
+        {
+            if (mStates[index].mStep < step)
+            {
+                sources.push_back(index);
+            }
+        }
+
+        if (sources.empty())
+        {
+            break;
+        }
+
+        vector<vector<Successor>> found((sources.size() + Grain - 1) / Grain);
+        mPool->ParallelFor(0, (int)sources.size(), Grain, [&](int begin, int end)
+            {
+                vector<Successor>& successors = found[begin / Grain];
+                for (int i = begin; i < end; i++)
+                {
+                    Expand(sources[i], step, successors);
+                }
+            });
+
+        // Keep each state once, in the order found so the result is the
+        // same however the work was split up
+        unordered_set<unsigned long long> reached;
+        frontier.clear();
+        for (auto& successors : found)
+        {
+            for (auto& successor : successors)
+            {
+                if (successor.mWon)
+                {
+                    if (goal < 0)
+                    {
+                        mStates.push_back(successor.mState);
+                        goal = (int)mStates.size() - 1;
+                    }
+                    continue;
+                }
+
+                unsigned long long key = GetKey(successor.mState);
+                bool safe = IsSafe(successor.mState);
+                if (!(safe ? settled : reached).insert(key).second)
+                {
+                    continue;
+                }
+
+                mStates.push_back(successor.mState);
+                frontier.push_back((int)mStates.size() - 1);
+                if (safe)
+                {
+                    waiting.push_back((int)mStates.size() - 1);
+                }
+            }
+        }
+    }
+
+    if (goal >= 0)
+    {
+        solution.mSolved = true;
+        solution.mTime = (mStates[goal].mStep - 1) * StepTime;
+        solution.mScript = GetScript(level, goal);
+    }
+    solution.mStates = (int)mStates.size();
+
+    mGame->Load(level);
+    return solution;
+}
+
+
+/**
+ * Work out everything the search needs to know about a level.
+ *
+ * The level is loaded into the game and its vehicles are followed
+ * through every step.
+ *
+ * \param level Level to solve
+ * \param limit Level time in seconds to search up to
+ */
+void CSolver::Build(int level, double limit)
+{
+    mGame->Load(level);
+    mSteps = (int)ceil(limit / StepTime);
+
+    // Inputs do nothing until the get ready countdown is over
+    mFirstStep = CLaneModel::GetReadyStep();
+
+    mModel = make_unique<CLaneModel>(mGame);
+    mModel->Extend(mSteps);
+
+    // The hero starts wherever the level puts it with all of the cargo
+    // where it was loaded
+    auto hero = mGame->GetHero();
+    mCargo = make_unique<CCargoModel>(mGame);
+
+    State start;
+    start.mHero.mX = hero->GetX();
+    start.mHero.mRow = (int)(hero->GetY() / TileToPixels);
+    start.mStep = mFirstStep;
+    start.mCargo = mCargo->GetStart();
+
+    mStates.clear();
+    mStates.push_back(start);
+}
+
+
+/**
+ * Find the states an input in a state leads to a step later.
+ *
+ * Only reads the search's tables, so states can be expanded on
+ * any number of threads at once.
+ *
+ * \param index State to make the input in
+ * \param step Step the input is made in
+ * \param successors Where to add the states found
+ */
+void CSolver::Expand(int index, int step, std::vector<Successor>& successors) const
+{
+    const State& state = mStates[index];
+    bool safe = IsSafe(state);
+
+    // Everything that doesn't lead into a lane was already tried
+    // from a safe state the step it got there
+    bool waited = safe && state.mStep < step;
+
+    for (int action = -1; action <= CReplay::Cargo; action++)
+    {
+        // A safe state waits by staying in the waiting states
+        if ((safe && action < 0) ||
+            (waited && action != CReplay::Forward && action != CReplay::Backward))
+        {
+            continue;
+        }
+
+        int clicks = action == CReplay::Cargo ? mCargo->GetCount() : 1;
+        for (int cargo = 0; cargo < clicks; cargo++)
+        {
+            Successor successor;
+            State& next = successor.mState;
+            next = state;
+            next.mParent = index;
+            next.mStep = step + 1;
+            next.mAction = action;
+            next.mCargoIndex = cargo;
+
+            if ((action >= 0 && !Apply(next, action, cargo, step)) || (waited && IsSafe(next)))
+            {
+                continue;
+            }
+
+            bool moved = action >= 0 && action != CReplay::Cargo;
+            if (!Survives(next, step, moved))
+            {
+                continue;
+            }
+
+            mModel->Ride(next.mHero, step);
+
+            successor.mWon = action == CReplay::Cargo && IsWon(next);
+            successors.push_back(successor);
+        }
+    }
+}
+
+
+/**
+ * Make an input, the way CGame::moveHero and CGame::ClickCargo do
+ * \param state State to make the input in, changed to the state after it
+ * \param action Input to make
+ * \param cargo Cargo clicked on for Cargo inputs
+ * \param step Step the input is made in
+ * \returns False if the input does nothing or drifts the hero off the screen
+ */
+bool CSolver::Apply(State& state, int action, int cargo, int step) const
+{
+    if (action == CReplay::Cargo)
+    {
+        return mCargo->Click(state.mCargo, state.mHero.mRow, cargo);
+    }
+
+    return mModel->Move(state.mHero, action, step);
+}
+
+
+/**
+ * Test if the hero gets through a step without losing.
+ *
+ * The lanes are tested by the model, then whether any cargo is eaten.
+ *
+ * \param state State at the start of the step, after the input
+ * \param step Step to get through
+ * \param moved True if the hero just moved
+ * \returns True if nothing loses the level during the step
+ */
+bool CSolver::Survives(const State& state, int step, bool moved) const
+{
+    return mModel->Survives(state.mHero, step, moved) && !mCargo->IsEaten(state.mCargo, state.mHero.mRow);
+}
+
+
+/**
+ * Test if the hero can wait in a state for as long as it likes
+ * \param state State to test
+ * \returns True if the hero is on a row with no cars or river
+ */
+bool CSolver::IsSafe(const State& state) const
+{
+    return mModel->IsSafe(state.mHero);
+}
+
+
+/**
+ * Test if all of the cargo has been put down at the top
+ * \param state State to test
+ * \returns True if the level is won
+ */
+bool CSolver::IsWon(const State& state) const
+{
+    return mCargo->IsWon(state.mCargo);
+}
+
+
+/**
+ * Get a key that is the same for states the search treats as the same.
+ *
+ * States waiting somewhere safe are the same whatever step they got
+ * there in. The step is left to whoever keeps track of the others.
+ *
+ * \param state State to get the key of
+ * \returns Key
+ */
+unsigned long long CSolver::GetKey(const State& state) const
+{
+    return state.mCargo * mModel->GetKeyCount() + mModel->GetKey(state.mHero, state.mStep);
+}
+
+
+/**
+ * Get the inputs that lead from the start to a state
+ * \param level Level being solved
+ * \param goal State to lead to
+ * \returns Inputs, stamped with the level time they are made at
+ */
+CReplay CSolver::GetScript(int level, int goal) const
+{
+    vector<const State*> path;
+    for (int index = goal; index >= 0; index = mStates[index].mParent)
+    {
+        path.push_back(&mStates[index]);
+    }
+
+    CReplay script;
+    script.Clear(level);
+    for (auto i = path.rbegin(); i != path.rend(); i++)
+    {
+        if ((*i)->mAction >= 0)
+        {
+            script.Add(((*i)->mStep - 1) * StepTime, (CReplay::Action)(*i)->mAction, (*i)->mCargoIndex);
+        }
+    }
+
+    return script;
+}
+
+
+/**
+ * Solve every level, check each solution by playing it and save it.
+ *
+ * Solutions are saved as levelN-solution.xml. They can be copied to
+ * the replays directory for checking the replays to play them too.
+ *
+ * \param levels Directory the levels are in, ending with a separator
+ * \param replays Directory to save the solutions to, ending with a
+ * separator, not the game's own replays directory
+ * \returns Report of how each level went
+ */
+std::wstring CSolver::SolveLevels(const std::wstring& levels, const std::wstring& replays)
+{
+    CGame game;
+    game.LoadLevels(levels, 4);
+    CSolver solver(&game);
+    CSimulation simulation(&game, CSimulation::FixedTick);
+
+    wostringstream report;
+    report << L"Level solver, " << StepTime << L" s steps, " << solver.mPool->GetThreadCount() << L" threads" << endl;
+    report << L"Solutions saved to " << replays << endl;
+
+    for (int level = 0; level < game.GetLevelCount(); level++)
+    {
+        auto start = chrono::steady_clock::now();
+        Solution solution = solver.Solve(level, SolveLimit);
+        auto end = chrono::steady_clock::now();
+
+        report << endl << L"Level " << level << L": ";
+        if (solution.mSolved)
+        {
+            CSimulation::Outcome outcome = simulation.Run(solution.mScript, solution.mTime + 1);
+            solution.mScript.Save(replays + L"level" + to_wstring(level) + L"-solution.xml");
+
+            report << L"won at " << fixed << setprecision(2) << solution.mTime << L" s with "
+                << solution.mScript.GetInputs().size() << L" inputs, "
+                << (outcome.mWon ? L"verified" : L"NOT VERIFIED") << endl;
+        }
+        else if (solver.mCargo->GetCount() == 0)
+        {
+            report << L"no cargo to carry, can't be won" << endl;
+        }
+        else
+        {
+            report << L"no win found within " << fixed << setprecision(0) << SolveLimit << L" s" << endl;
+        }
+
+        report << L"  " << solution.mStates << L" states "
+            << fixed << setprecision(2) << chrono::duration<double, milli>(end - start).count() << L" ms" << endl;
+
+        // The fewest trips the cargo takes, whatever the lanes are like
+        auto puzzle = game.GetCargoPuzzle();
+        if (puzzle != nullptr && puzzle->IsSolvable())
+        {
+            report << L"  cargo needs " << puzzle->GetTrips().size() << L" trips across at the least" << endl;
+        }
+    }
+
+    return report.str();
+}
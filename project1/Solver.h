@@ -0,0 +1,123 @@
+/**
+ * \file Solver.h
+ *
+ * \author Michael Dittman
+ *
+ * Finds the quickest way to win a level without playing it.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include "Replay.h"
+#include "ThreadPool.h"
+#include "LaneModel.h"
+#include "CargoModel.h"
+
+class CGame;
+
+
+/**
+ * Finds the quickest way to win a level without playing it.
+ *
+ * The hero can make one input each step. A state is where the hero
+ * is, the boat it is riding and where each cargo is. Vehicles follow
+ * the same path every time the level is played, so the search goes
+ * forward a step at a time from the start of the level, keeping each
+ * distinct state once per step. The first step an input wins the level
+ * at is the quickest time it can be won in.
+ *
+ * Most states are the hero standing somewhere nothing can hit it,
+ * where it can wait as long as it likes. Those are kept only the
+ * first time they are reached and tried again each step only for
+ * moves out into a lane, which keeps the search small.
+ *
+ * Vehicle locations, lane crossings and the cargo rules are worked out
+ * from the game before the search starts, so the states of each step
+ * can be expanded in parallel without touching the game. The hero's
+ * moves through the lanes are tried on a CLaneModel and clicks on the
+ * cargo on a CCargoModel.
+ */
+class CSolver
+{
+public:
+    /// How a level can be won
+    struct Solution
+    {
+        bool mSolved = false;   ///< True if the level can be won within the limit
+        double mTime = 0;       ///< Level time in seconds of the input that wins it
+        CReplay mScript;        ///< Inputs that win the level in that time
+        int mStates = 0;        ///< Number of states searched
+    };
+
+    /// Default constructor (disabled)
+    CSolver() = delete;
+
+    /// Copy constructor (disabled)
+    CSolver(const CSolver&) = delete;
+
+    CSolver(CGame* game);
+
+    Solution Solve(int level, double limit);
+
+    static std::wstring SolveLevels(const std::wstring& levels, const std::wstring& replays);
+
+private:
+    /// One state of the search
+    struct State
+    {
+        CLaneModel::Position mHero; ///< Where the hero is
+        int mParent = -1;           ///< State the input was made in, -1 for the start
+        int mStep = 0;              ///< Step the state is reached at
+        int mCargo = 0;             ///< Where each cargo is, a CCargoModel state
+        int mAction = -1;           ///< Input made to get here, -1 for none
+        int mCargoIndex = 0;        ///< Cargo clicked on for Cargo inputs
+    };
+
+    /// A state found from another and whether it won the level
+    struct Successor
+    {
+        State mState;               ///< State found
+        bool mWon = false;          ///< True if the input won the level
+    };
+
+    void Build(int level, double limit);
+
+    void Expand(int index, int step, std::vector<Successor>& successors) const;
+
+    bool Apply(State& state, int action, int cargo, int step) const;
+
+    bool Survives(const State& state, int step, bool moved) const;
+
+    bool IsSafe(const State& state) const;
+
+    bool IsWon(const State& state) const;
+
+    unsigned long long GetKey(const State& state) const;
+
+    CReplay GetScript(int level, int goal) const;
+
+    /// Game the levels are loaded into
+    CGame* mGame;
+
+    /// Threads the states of a step are expanded on
+    CThreadPool* mPool;
+
+    /// Number of steps the search can run to
+    int mSteps = 0;
+
+    /// First step the hero can make an input in
+    int mFirstStep = 0;
+
+    /// Where the hero can go in the level being solved
+    std::unique_ptr<CLaneModel> mModel;
+
+    /// Where the cargo of the level being solved can be
+    std::unique_ptr<CCargoModel> mCargo;
+
+    /// Every state found, the start first
+    std::vector<State> mStates;
+};
+
@@ -0,0 +1,195 @@
+/**
+ * \file Sprite.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "Sprite.h"
+#include <cstring>
+#include <unordered_map>
+
+using namespace Gdiplus;
+using namespace std;
+
+
+/**
+ * Constructor
+ * \param width Width in pixels
+ * \param height Height in pixels
+ */
+CSprite::CSprite(int width, int height) : mWidth(width), mHeight(height)
+{
+    mPixels.resize((size_t)width * height);
+    mRowSpans.assign((size_t)height + 1, 0);
+}
+
+
+/**
+ * Make a sprite from a GDI+ bitmap
+ * \param bitmap Bitmap to copy the pixels of
+ * \returns New sprite, or an empty sprite if the bitmap could not be read
+ */
+std::unique_ptr<CSprite> CSprite::FromBitmap(Gdiplus::Bitmap* bitmap)
+{
+    int width = bitmap == nullptr ? 0 : (int)bitmap->GetWidth();
+    int height = bitmap == nullptr ? 0 : (int)bitmap->GetHeight();
+
+    Rect rect(0, 0, width, height);
+    BitmapData data;
+    if (width == 0 || height == 0 ||
+        bitmap->LockBits(&rect, ImageLockModeRead, PixelFormat32bppPARGB, &data) != Ok)
+    {
+        return make_unique<CSprite>(0, 0);
+    }
+
+    auto sprite = make_unique<CSprite>(width, height);
+    for (int y = 0; y < height; y++)
+    {
+        memcpy(sprite->GetRow(y), (unsigned char*)data.Scan0 + (size_t)y * data.Stride, (size_t)width * 4);
+    }
+
+    bitmap->UnlockBits(&data);
+
+    sprite->BuildSpans();
+    return sprite;
+}
+
+
+/**
+ * Find the spans of visible pixels in every row.
+ *
+ * Call this after the pixels have been filled in. Runs of
+ * opaque pixels and runs of partly transparent pixels become
+ * separate spans, fully transparent pixels are left out.
+ */
+void CSprite::BuildSpans()
+{
+    mSpans.clear();
+    mRowSpans.assign((size_t)mHeight + 1, 0);
+
+    for (int y = 0; y < mHeight; y++)
+    {
+        mRowSpans[y] = (int)mSpans.size();
+
+        const UINT32* row = GetRow(y);
+        int x = 0;
+        while (x < mWidth)
+        {
+            UINT32 alpha = row[x] >> 24;
+            if (alpha == 0)
+            {
+                x++;
+                continue;
+            }
+
+            bool opaque = alpha == 255;
+            int start = x;
+            while (x < mWidth && (row[x] >> 24) != 0 && ((row[x] >> 24) == 255) == opaque)
+            {
+                x++;
+            }
+
+            mSpans.push_back({ start, x, opaque });
+        }
+    }
+
+    mRowSpans[mHeight] = (int)mSpans.size();
+}
+
+
+/**
+ * Store the sprite as 8-bit palette indices if it has few enough colors.
+ *
+ * The palette holds the exact premultiplied colors, so nothing
+ * is lost. Sprites with more than 256 colors are left alone.
+ * Build the spans first, they are made from the 32-bit pixels.
+ *
+ * \returns True if the sprite is now palettized
+ */
+bool CSprite::Palettize()
+{
+    if (IsPalettized())
+    {
+        return true;
+    }
+
+    unordered_map<UINT32, unsigned char> colors;
+    vector<UINT32> palette;
+    vector<unsigned char> indices(mPixels.size());
+
+    for (size_t i = 0; i < mPixels.size(); i++)
+    {
+        auto found = colors.find(mPixels[i]);
+        if (found == colors.end())
+        {
+            if (palette.size() == 256)
+            {
+                return false;
+            }
+
+            found = colors.emplace(mPixels[i], (unsigned char)palette.size()).first;
+            palette.push_back(mPixels[i]);
+        }
+
+        indices[i] = found->second;
+    }
+
+    if (palette.empty())
+    {
+        return false;
+    }
+
+    mIndices = move(indices);
+    mPalette = move(palette);
+
+    // The 32-bit pixels are no longer needed
+    vector<UINT32>().swap(mPixels);
+    return true;
+}
+
+
+/**
+ * Get the memory the sprite's pixels and spans take
+ * \returns Size in bytes
+ */
+size_t CSprite::GetBytes() const
+{
+    return mPixels.size() * sizeof(UINT32) + mIndices.size() + mPalette.size() * sizeof(UINT32) +
+        mSpans.size() * sizeof(Span) + mRowSpans.size() * sizeof(int);
+}
+
+
+/**
+ * Blend a row of premultiplied pixels over another
+ * \param dst Pixels to blend onto
+ * \param src Premultiplied pixels to blend
+ * \param count Number of pixels
+ */
+void CSprite::BlendRow(UINT32* dst, const UINT32* src, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        BlendPixel(dst[i], src[i]);
+    }
+}
+
+
+/**
+ * Premultiply a straight ARGB color
+ * \param color Color to premultiply
+ * \returns Premultiplied color
+ */
+UINT32 CSprite::Premultiply(Gdiplus::ARGB color)
+{
+    UINT32 alpha = color >> 24;
+    if (alpha == 255)
+    {
+        return color;
+    }
+
+    UINT32 r = ((color >> 16) & 0xff) * alpha / 255;
+    UINT32 g = ((color >> 8) & 0xff) * alpha / 255;
+    UINT32 b = (color & 0xff) * alpha / 255;
+    return (alpha << 24) | (r << 16) | (g << 8) | b;
+}
@@ -0,0 +1,149 @@
+/**
+ * \file Sprite.h
+ *
+ * \author Michael Dittman
+ *
+ * Copy of an image's pixels the software renderer can blit from.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+
+/**
+ * Copy of an image's pixels the software renderer can blit from.
+ *
+ * Pixels are premultiplied ARGB so blending is a single multiply.
+ * Each row is also stored as spans of visible pixels, so a blit
+ * can skip the transparent runs, copy the opaque runs and only
+ * blend the partly transparent edges.
+ *
+ * A sprite with no more than 256 colors can be palettized, after
+ * which it keeps an 8-bit index per pixel and a palette of
+ * premultiplied colors instead of the 32-bit pixels.
+ */
+class CSprite
+{
+public:
+    /// A run of pixels in a row that are not fully transparent
+    struct Span
+    {
+        int mStart;     ///< First pixel of the run
+        int mEnd;       ///< One past the last pixel of the run
+        bool mOpaque;   ///< True if every pixel of the run is fully opaque
+    };
+
+    /// Default constructor (disabled)
+    CSprite() = delete;
+
+    /// Copy constructor (disabled)
+    CSprite(const CSprite&) = delete;
+
+    CSprite(int width, int height);
+
+    static std::unique_ptr<CSprite> FromBitmap(Gdiplus::Bitmap* bitmap);
+
+    /** Get the width
+     * \returns Width in pixels */
+    int GetWidth() const { return mWidth; }
+
+    /** Get the height
+     * \returns Height in pixels */
+    int GetHeight() const { return mHeight; }
+
+    /** Get a row of pixels. Not available once palettized.
+     * \param y Row to get
+     * \returns First pixel of the row */
+    const UINT32* GetRow(int y) const { return mPixels.data() + (size_t)y * mWidth; }
+
+    /** Get a row of pixels to fill in
+     * \param y Row to get
+     * \returns First pixel of the row */
+    UINT32* GetRow(int y) { return mPixels.data() + (size_t)y * mWidth; }
+
+    void BuildSpans();
+
+    bool Palettize();
+
+    /** Is the sprite stored as palette indices?
+     * \returns True if palettized */
+    bool IsPalettized() const { return !mPalette.empty(); }
+
+    /** Get a row of palette indices of a palettized sprite
+     * \param y Row to get
+     * \returns First index of the row */
+    const unsigned char* GetIndexRow(int y) const { return mIndices.data() + (size_t)y * mWidth; }
+
+    /** Get the palette of a palettized sprite
+     * \returns Premultiplied colors the indices refer to */
+    const UINT32* GetPalette() const { return mPalette.data(); }
+
+    size_t GetBytes() const;
+
+    /** Get the first span of a row
+     * \param y Row to get the spans of
+     * \returns First span of the row */
+    const Span* GetSpansBegin(int y) const { return mSpans.data() + mRowSpans[y]; }
+
+    /** Get one past the last span of a row
+     * \param y Row to get the spans of
+     * \returns One past the last span of the row */
+    const Span* GetSpansEnd(int y) const { return mSpans.data() + mRowSpans[y + 1]; }
+
+    static void BlendRow(UINT32* dst, const UINT32* src, int count);
+
+    /**
+     * Blend one premultiplied pixel over another
+     * \param dst Pixel to blend onto
+     * \param src Premultiplied pixel to blend
+     */
+    static void BlendPixel(UINT32& dst, UINT32 src)
+    {
+        UINT32 alpha = src >> 24;
+        if (alpha == 255)
+        {
+            dst = src;
+            return;
+        }
+
+        if (alpha == 0)
+        {
+            return;
+        }
+
+        // dst * (255 - alpha) / 255 on two channels at a time
+        UINT32 inverse = 255 - alpha;
+        UINT32 rb = (dst & 0x00ff00ff) * inverse + 0x00800080;
+        rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+        UINT32 ag = ((dst >> 8) & 0x00ff00ff) * inverse + 0x00800080;
+        ag = (ag + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+        dst = src + rb + ag;
+    }
+
+    static UINT32 Premultiply(Gdiplus::ARGB color);
+
+private:
+    /// Width in pixels
+    int mWidth;
+
+    /// Height in pixels
+    int mHeight;
+
+    /// Premultiplied ARGB pixels, row after row
+    std::vector<UINT32> mPixels;
+
+    /// Palette index of every pixel when palettized, row after row
+    std::vector<unsigned char> mIndices;
+
+    /// Premultiplied colors of the palette, empty when not palettized
+    std::vector<UINT32> mPalette;
+
+    /// Spans of every row, row after row
+    std::vector<Span> mSpans;
+
+    /// Index of the first span of each row, plus one past the last span
+    std::vector<int> mRowSpans;
+};
+
@@ -0,0 +1,66 @@
+/**
+ * \file SpscQueue.h
+ *
+ * \author Michael Dittman
+ *
+ * Fixed size queue from one thread to another without locks.
+ */
+
+#pragma once
+
+#include <atomic>
+
+
+/**
+ * Fixed size queue from one thread to another without locks.
+ *
+ * One thread pushes and one thread pops. The queue holds one item
+ * less than its capacity, so full and empty can be told apart.
+ */
+template <class T, int Capacity>
+class CSpscQueue
+{
+public:
+    /** Add an item to the back of the queue
+     * \param item Item to add
+     * \returns False if the queue is full */
+    bool Push(const T& item)
+    {
+        int tail = mTail.load(std::memory_order_relaxed);
+        int next = (tail + 1) % Capacity;
+        if (next == mHead.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        mItems[tail] = item;
+        mTail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /** Take the item at the front of the queue
+     * \param item Set to the item taken
+     * \returns False if the queue is empty */
+    bool Pop(T& item)
+    {
+        int head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = mItems[head];
+        mHead.store((head + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    /// Items, from mHead up to mTail
+    T mItems[Capacity];
+
+    /// Next item to pop, only changed by the popping thread
+    std::atomic<int> mHead{ 0 };
+
+    /// Next place to push, only changed by the pushing thread
+    std::atomic<int> mTail{ 0 };
+};
@@ -0,0 +1,228 @@
+/**
+ * \file StateDecoder.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "StateDecoder.h"
+#include "StateEncoder.h"
+#include <cstring>
+
+using namespace std;
+
+/// Width of a tile in virtual pixels, how far a sideways move goes
+const double TileToPixels = 64;
+
+/// Decoded bytes kept before they are let go of
+const size_t KeepBytes = 4096;
+
+
+/**
+ * Constructor
+ * \param levels Templates of the levels the session can play, by level
+ */
+CStateDecoder::CStateDecoder(const std::vector<const CLevelTemplate*>& levels) : mLevels(levels)
+{
+}
+
+
+/**
+ * Add bytes from the encoder
+ * \param data Bytes, in whole records
+ * \param size Number of bytes
+ */
+void CStateDecoder::Read(const unsigned char* data, size_t size)
+{
+    if (mNext > KeepBytes)
+    {
+        mBytes.erase(mBytes.begin(), mBytes.begin() + mNext);
+        mNext = 0;
+    }
+
+    mBytes.insert(mBytes.end(), data, data + size);
+}
+
+
+/**
+ * Follow the session through one tick
+ * \returns False if there hasn't been a keyframe yet
+ */
+bool CStateDecoder::Tick()
+{
+    unsigned header = 0;
+    while (PeekVarint(header) && header == CStateEncoder::Keyframe)
+    {
+        GetVarint();
+        ReadKeyframe();
+    }
+
+    if (mLevel < 0)
+    {
+        return false;
+    }
+
+    mIdle++;
+    mResult = CLevelTemplate::Playing;
+    if (PeekVarint(header) && header == mIdle * 2)
+    {
+        GetVarint();
+        ReadTick();
+        mIdle = 0;
+    }
+    else
+    {
+        mLevels[mLevel]->GetLanes().Ride(mState.mHero, mState.mStep);
+        mState.mStep++;
+    }
+
+    return true;
+}
+
+
+/**
+ * Decode a keyframe, after its header
+ */
+void CStateDecoder::ReadKeyframe()
+{
+    mLevel = (int)GetVarint();
+    mState.mStep = (int)GetVarint();
+    mState.mHero.mRow = (int)GetVarint();
+    mState.mHero.mBoat = (int)GetVarint() - 1;
+    if (mState.mHero.mBoat >= 0)
+    {
+        mState.mHero.mBoarded = (int)GetVarint();
+        mState.mHero.mX = mLevels[mLevel]->GetLanes().GetBoatX(mState.mHero.mBoat, mState.mStep);
+    }
+    else
+    {
+        mState.mHero.mX = GetDouble();
+    }
+    mState.mCargo = (int)GetVarint();
+
+    mResult = CLevelTemplate::Playing;
+    mIdle = 0;
+}
+
+
+/**
+ * Decode a tick record, after its header, and take the state to the next step
+ */
+void CStateDecoder::ReadTick()
+{
+    const CLevelTemplate* level = mLevels[mLevel];
+    CLaneModel::Position& hero = mState.mHero;
+
+    unsigned flags = mBytes[mNext++];
+    mResult = (CLevelTemplate::Result)(flags >> CStateEncoder::ResultShift);
+    if (mResult != CLevelTemplate::Playing)
+    {
+        mState = level->GetStart();
+        return;
+    }
+
+    switch (flags & CStateEncoder::RowMask)
+    {
+    case CStateEncoder::RowUp:
+        hero.mRow--;
+        break;
+
+    case CStateEncoder::RowDown:
+        hero.mRow++;
+        break;
+
+    case CStateEncoder::RowOther:
+        hero.mRow = (int)GetVarint();
+        break;
+    }
+
+    switch (flags & CStateEncoder::XMask)
+    {
+    case CStateEncoder::XLeft:
+        hero.mX -= TileToPixels;
+        break;
+
+    case CStateEncoder::XRight:
+        hero.mX += TileToPixels;
+        break;
+
+    case CStateEncoder::XOther:
+        hero.mX = GetDouble();
+        break;
+    }
+
+    if (flags & CStateEncoder::BoatChanged)
+    {
+        hero.mBoat = (int)GetVarint() - 1;
+        if (hero.mBoat >= 0)
+        {
+            hero.mBoarded = mState.mStep;
+        }
+    }
+
+    if (flags & CStateEncoder::CargoChanged)
+    {
+        mState.mCargo = (int)GetVarint();
+    }
+
+    level->GetLanes().Ride(hero, mState.mStep);
+    mState.mStep++;
+}
+
+
+/**
+ * Look at the varint at the next byte without decoding past it
+ * \param value Set to the number
+ * \returns False if there is no whole varint there
+ */
+bool CStateDecoder::PeekVarint(unsigned& value) const
+{
+    value = 0;
+    for (size_t i = mNext, shift = 0; i < mBytes.size() && shift < 32; i++, shift += 7)
+    {
+        value |= (unsigned)(mBytes[i] & 0x7f) << shift;
+        if ((mBytes[i] & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/**
+ * Decode a varint
+ * \returns The number
+ */
+unsigned CStateDecoder::GetVarint()
+{
+    unsigned value = 0;
+    for (int shift = 0; mNext < mBytes.size(); shift += 7)
+    {
+        unsigned char byte = mBytes[mNext++];
+        value |= (unsigned)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            break;
+        }
+    }
+
+    return value;
+}
+
+
+/**
+ * Decode a number written as its eight bytes
+ * \returns The number
+ */
+double CStateDecoder::GetDouble()
+{
+    double value = 0;
+    if (mNext + sizeof(double) <= mBytes.size())
+    {
+        memcpy(&value, &mBytes[mNext], sizeof(double));
+    }
+    mNext += sizeof(double);
+    return value;
+}
@@ -0,0 +1,87 @@
+/**
+ * \file StateDecoder.h
+ *
+ * \author Michael Dittman
+ *
+ * Follows a session from the keyframes and diffs a CStateEncoder writes.
+ */
+
+#pragma once
+
+#include <vector>
+#include "LevelTemplate.h"
+
+
+/**
+ * Follows a session from the keyframes and diffs a CStateEncoder writes.
+ *
+ * The decoder has the same level templates as the session, so between
+ * records it carries the hero along with the boat it is riding, and
+ * where every vehicle is can be read from the template's lanes at the
+ * state's step.
+ *
+ * Bytes are given to Read as they arrive, in whole records, and Tick
+ * is called once for every tick of the session. A keyframe is the
+ * state at the start of the tick after it, so a spectator that joins
+ * late has nothing to show until its first Tick.
+ */
+class CStateDecoder
+{
+public:
+    /// Default constructor (disabled)
+    CStateDecoder() = delete;
+
+    /// Copy constructor (disabled)
+    CStateDecoder(const CStateDecoder&) = delete;
+
+    CStateDecoder(const std::vector<const CLevelTemplate*>& levels);
+
+    void Read(const unsigned char* data, size_t size);
+
+    bool Tick();
+
+    /** Get the session's state after the last tick
+     * \returns State */
+    const CLevelTemplate::State& GetState() const { return mState; }
+
+    /** Get the level the session is playing
+     * \returns Level number, -1 before the first keyframe */
+    int GetLevel() const { return mLevel; }
+
+    /** Get how the last tick went. If it ended the level the
+     * state is the start of the level again
+     * \returns Result of the last tick */
+    CLevelTemplate::Result GetResult() const { return mResult; }
+
+private:
+    void ReadKeyframe();
+
+    void ReadTick();
+
+    bool PeekVarint(unsigned& value) const;
+
+    unsigned GetVarint();
+
+    double GetDouble();
+
+    /// Templates, by level
+    std::vector<const CLevelTemplate*> mLevels;
+
+    /// Bytes read and not yet decoded, from mNext on
+    std::vector<unsigned char> mBytes;
+
+    /// Next byte to decode
+    size_t mNext = 0;
+
+    /// Level the session is playing
+    int mLevel = -1;
+
+    /// State after the last tick
+    CLevelTemplate::State mState;
+
+    /// How the last tick went
+    CLevelTemplate::Result mResult = CLevelTemplate::Playing;
+
+    /// Ticks since the last record
+    unsigned mIdle = 0;
+};
@@ -0,0 +1,301 @@
+/**
+ * \file StateEncoder.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "StateEncoder.h"
+#include "StateDecoder.h"
+#include "Replay.h"
+#include "Game.h"
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+/// Width of a tile in virtual pixels, how far a sideways move goes
+const double TileToPixels = 64;
+
+/// Level time in seconds benchmark replays run out of time at
+const double BenchmarkLimit = 60;
+
+
+/**
+ * Test if a decoded state is the state that was encoded
+ * \param decoded State from the decoder
+ * \param state State from the session
+ * \returns True if they are the same
+ */
+static bool IsSame(const CLevelTemplate::State& decoded, const CLevelTemplate::State& state)
+{
+    return decoded.mHero.mX == state.mHero.mX && decoded.mHero.mRow == state.mHero.mRow &&
+        decoded.mHero.mBoat == state.mHero.mBoat && decoded.mCargo == state.mCargo && decoded.mStep == state.mStep &&
+        (state.mHero.mBoat < 0 || decoded.mHero.mBoarded == state.mHero.mBoarded);
+}
+
+
+/**
+ * Write a keyframe with the whole state. Decoders start from here.
+ * \param level Level the session is playing
+ * \param state State at the start of the next tick
+ */
+void CStateEncoder::WriteKeyframe(int level, const CLevelTemplate::State& state)
+{
+    PutVarint(Keyframe);
+    PutVarint(level);
+    PutVarint(state.mStep);
+    PutVarint(state.mHero.mRow);
+    PutVarint(state.mHero.mBoat + 1);
+    if (state.mHero.mBoat >= 0)
+    {
+        PutVarint(state.mHero.mBoarded);
+    }
+    else
+    {
+        PutDouble(state.mHero.mX);
+    }
+    PutVarint(state.mCargo);
+
+    mLast = state;
+    mIdle = 0;
+}
+
+
+/**
+ * Write the diff of a tick, if it has one
+ * \param state State after the tick, the start of the level if it ended
+ * \param result How the tick went
+ */
+void CStateEncoder::WriteTick(const CLevelTemplate::State& state, CLevelTemplate::Result result)
+{
+    mIdle++;
+
+    const CLaneModel::Position& before = mLast.mHero;
+    const CLaneModel::Position& after = state.mHero;
+
+    unsigned char flags = 0;
+    if (result != CLevelTemplate::Playing)
+    {
+        // The decoder knows where the level starts
+        flags = (unsigned char)(result << ResultShift);
+    }
+    else
+    {
+        if (after.mRow == before.mRow - 1)
+        {
+            flags |= RowUp;
+        }
+        else if (after.mRow == before.mRow + 1)
+        {
+            flags |= RowDown;
+        }
+        else if (after.mRow != before.mRow)
+        {
+            flags |= RowOther;
+        }
+
+        // On a boat, or just off one, the X is the boat's
+        if (before.mBoat < 0 && after.mBoat < 0 && after.mX != before.mX)
+        {
+            flags |= after.mX == before.mX - TileToPixels ? XLeft :
+                after.mX == before.mX + TileToPixels ? XRight : XOther;
+        }
+
+        if (after.mBoat != before.mBoat)
+        {
+            flags |= BoatChanged;
+        }
+
+        if (state.mCargo != mLast.mCargo)
+        {
+            flags |= CargoChanged;
+        }
+
+        if (flags == 0)
+        {
+            mLast = state;
+            return;
+        }
+    }
+
+    PutVarint(mIdle * 2);
+    mBytes.push_back(flags);
+    if ((flags & RowMask) == RowOther)
+    {
+        PutVarint(after.mRow);
+    }
+    if ((flags & XMask) == XOther)
+    {
+        PutDouble(after.mX);
+    }
+    if (flags & BoatChanged)
+    {
+        PutVarint(after.mBoat + 1);
+    }
+    if (flags & CargoChanged)
+    {
+        PutVarint(state.mCargo);
+    }
+
+    mLast = state;
+    mIdle = 0;
+}
+
+
+/**
+ * Write a number seven bits a byte, low bits first
+ * \param value Number to write
+ */
+void CStateEncoder::PutVarint(unsigned value)
+{
+    while (value >= 0x80)
+    {
+        mBytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    mBytes.push_back((unsigned char)value);
+}
+
+
+/**
+ * Write a number exactly, as its eight bytes
+ * \param value Number to write
+ */
+void CStateEncoder::PutDouble(double value)
+{
+    unsigned char bytes[sizeof(double)];
+    memcpy(bytes, &value, sizeof(double));
+    mBytes.insert(mBytes.end(), bytes, bytes + sizeof(double));
+}
+
+
+/**
+ * Play recorded replays on level templates, stream each one through
+ * an encoder and a decoder and compare the bytes with sending a
+ * keyframe every tick.
+ *
+ * Inputs are made at the step nearest their time, one a step, so a
+ * replay can play out differently than it does in the game.
+ *
+ * \param levels Directory the levels are in, ending with a separator
+ * \param replays Directory the replays are in, ending with a separator
+ * \returns Report of the bytes sent
+ */
+std::wstring CStateEncoder::Benchmark(const std::wstring& levels, const std::wstring& replays)
+{
+    CGame game;
+    game.LoadLevels(levels, 4);
+
+    vector<unique_ptr<CLevelTemplate>> templates;
+    vector<const CLevelTemplate*> pointers;
+    for (int level = 0; level < game.GetLevelCount(); level++)
+    {
+        game.Load(level);
+        templates.push_back(make_unique<CLevelTemplate>(&game, BenchmarkLimit));
+        pointers.push_back(templates.back().get());
+    }
+
+    const wchar_t* results[] = { L"playing", L"won", L"lost", L"out of time" };
+
+    wostringstream report;
+    report << L"State stream benchmark, keyframe and diffs vs a keyframe every tick" << endl;
+
+    long long totalTicks = 0;
+    long long totalSent = 0;
+    long long totalFull = 0;
+    int count = 0;
+    int matched = 0;
+
+    CFileFind finder;
+    BOOL working = finder.FindFile((replays + L"*.xml").c_str());
+    while (working)
+    {
+        working = finder.FindNextFile();
+
+        CReplay replay;
+        if (!replay.Load((LPCTSTR)finder.GetFilePath()) || replay.GetLevel() >= (int)pointers.size())
+        {
+            continue;
+        }
+
+        const CLevelTemplate* level = pointers[replay.GetLevel()];
+        const auto& inputs = replay.GetInputs();
+
+        CStateEncoder encoder;
+        CStateEncoder full;
+        CStateDecoder decoder(pointers);
+
+        CLevelTemplate::State state = level->GetStart();
+        encoder.WriteKeyframe(replay.GetLevel(), state);
+
+        size_t next = 0;
+        int ticks = 0;
+        int records = 0;
+        int mismatches = 0;
+        size_t sent = 0;
+        size_t fullSent = 0;
+        CLevelTemplate::Result result = CLevelTemplate::Playing;
+        while (result == CLevelTemplate::Playing)
+        {
+            int action = CLevelTemplate::Wait;
+            if (next < inputs.size() && lround(inputs[next].mTime / CLaneModel::StepTime) <= state.mStep)
+            {
+                const CReplay::Input& input = inputs[next++];
+                action = input.mAction == CReplay::Cargo ? CLevelTemplate::ClickCargo + input.mCargo :
+                    CLevelTemplate::Forward + input.mAction - CReplay::Forward;
+            }
+
+            result = level->Advance(state, action);
+            if (result != CLevelTemplate::Playing)
+            {
+                state = level->GetStart();
+            }
+
+            size_t before = encoder.GetBytes().size();
+            encoder.WriteTick(state, result);
+            records += encoder.GetBytes().size() > before ? 1 : 0;
+
+            full.WriteKeyframe(replay.GetLevel(), state);
+            fullSent += full.GetBytes().size();
+            full.Clear();
+
+            decoder.Read(encoder.GetBytes().data(), encoder.GetBytes().size());
+            sent += encoder.GetBytes().size();
+            encoder.Clear();
+
+            decoder.Tick();
+            if (!IsSame(decoder.GetState(), state) || decoder.GetResult() != result)
+            {
+                mismatches++;
+            }
+            ticks++;
+        }
+
+        count++;
+        matched += mismatches == 0 ? 1 : 0;
+        totalTicks += ticks;
+        totalSent += sent;
+        totalFull += fullSent;
+
+        report << endl << (LPCTSTR)finder.GetFileName() << L", level " << replay.GetLevel() << L", "
+            << ticks << L" ticks, " << results[result] << endl;
+        report << L"  " << sent << L" bytes in " << records << L" records, " << fullSent << L" bytes as keyframes, "
+            << fixed << setprecision(1) << 100.0 * sent / max<size_t>(fullSent, 1) << L"%, "
+            << (mismatches == 0 ? L"decoded exactly" : L"MISMATCH") << endl;
+    }
+
+    report << endl << matched << L" of " << count << L" replays decode exactly" << endl;
+    if (totalTicks > 0)
+    {
+        double seconds = totalTicks * CLaneModel::StepTime;
+        report << fixed << setprecision(2) << (double)totalSent / totalTicks << L" bytes a tick, "
+            << totalSent * 8 / seconds << L" bits a second, vs " << (double)totalFull / totalTicks << L" bytes a tick, "
+            << totalFull * 8 / seconds << L" bits a second sending keyframes" << endl;
+    }
+    return report.str();
+}
@@ -0,0 +1,90 @@
+/**
+ * \file StateEncoder.h
+ *
+ * \author Michael Dittman
+ *
+ * Writes a session's states as a keyframe followed by small per-tick diffs.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include "LevelTemplate.h"
+
+
+/**
+ * Writes a session's states as a keyframe followed by small per-tick diffs.
+ *
+ * The lanes move the same way every time a level is played, so someone
+ * watching a session only needs what the player did. A keyframe has the
+ * whole state. After that each tick that changes the state in a way
+ * the lanes don't say adds a record of only what changed: the hero's
+ * row or its X off a boat, getting on or off a boat, the cargo, or the
+ * level being won, lost or running out of time. Ticks that change
+ * nothing add nothing, and a CStateDecoder with the same level
+ * templates works out the hero riding boats and where every vehicle is.
+ *
+ * Every record starts with a varint header. A keyframe's is 1, and it
+ * is followed by the level, step, row, boat + 1, then the step the boat
+ * was boarded at or the X if there is no boat, and the cargo. A tick
+ * record's header is the number of ticks since the last record times
+ * two, then a Flags byte and the fields the flags say, in the order
+ * row, X, boat + 1 and cargo.
+ */
+class CStateEncoder
+{
+public:
+    /// Flags in a tick record, a Result shifted by ResultShift ends the level
+    enum Flags
+    {
+        RowUp = 1,          ///< The hero moved up a row
+        RowDown = 2,        ///< The hero moved down a row
+        RowOther = 3,       ///< The row follows
+        RowMask = 3,        ///< Bits of the row change
+        XLeft = 4,          ///< The hero moved a tile to the left
+        XRight = 8,         ///< The hero moved a tile to the right
+        XOther = 12,        ///< The X follows
+        XMask = 12,         ///< Bits of the X change
+        BoatChanged = 16,   ///< The boat follows
+        CargoChanged = 32,  ///< The cargo follows
+        ResultShift = 6     ///< Shift of the result, the level starts over if it isn't Playing
+    };
+
+    /// Header of a keyframe, tick records have even headers
+    const static unsigned Keyframe = 1;
+
+    /// Default constructor
+    CStateEncoder() = default;
+
+    /// Copy constructor (disabled)
+    CStateEncoder(const CStateEncoder&) = delete;
+
+    void WriteKeyframe(int level, const CLevelTemplate::State& state);
+
+    void WriteTick(const CLevelTemplate::State& state, CLevelTemplate::Result result);
+
+    /** Get what has been written
+     * \returns Bytes since the last Clear */
+    const std::vector<unsigned char>& GetBytes() const { return mBytes; }
+
+    /** Let go of what has been written once it is sent. The
+     * next tick is still written as a diff from the last state */
+    void Clear() { mBytes.clear(); }
+
+    static std::wstring Benchmark(const std::wstring& levels, const std::wstring& replays);
+
+private:
+    void PutVarint(unsigned value);
+
+    void PutDouble(double value);
+
+    /// What has been written
+    std::vector<unsigned char> mBytes;
+
+    /// State the last record leaves a decoder in
+    CLevelTemplate::State mLast;
+
+    /// Ticks since the last record
+    unsigned mIdle = 0;
+};
@@ -0,0 +1,399 @@
+/**
+ * \file StressLevel.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "StressLevel.h"
+#include "Game.h"
+#include "Level.h"
+#include "SimThread.h"
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cwctype>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+using namespace xmlnode;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Tiles across the lanes
+const int Columns = 16;
+
+/// Rows of each bank, at the top and the bottom of a level
+const int BankRows = 2;
+
+/// Most lanes in a run of roads or rivers
+const int MaxRun = 4;
+
+/// Slowest a lane goes in tiles a second
+const double MinSpeed = 2;
+
+/// Fastest a lane goes in tiles a second
+const double MaxSpeed = 5;
+
+/// A kind of car the levels have
+struct CarType
+{
+    const wchar_t* mId;         ///< Type id
+    const wchar_t* mName;       ///< Name the control panel shows
+    int mWidth;                 ///< Width in tiles
+    const wchar_t* mImage1;     ///< First image
+    const wchar_t* mImage2;     ///< Second image
+};
+
+/// Cars a stress level has, the ones level 3 has
+const CarType Cars[] = {
+    { L"michigan", L"Michigan", 2, L"invaderUMa.png", L"invaderUMb.png" },
+    { L"ohio", L"Ohio", 2, L"invaderOSa.png", L"invaderOSb.png" },
+    { L"iowa", L"Iowa", 2, L"invaderIa.png", L"invaderIb.png" },
+    { L"nebraska", L"Nebraska", 3, L"invaderNa.png", L"invaderNb.png" },
+    { L"wisc", L"Wisconsin", 2, L"invaderWa.png", L"invaderWb.png" } };
+
+/// A kind of boat the levels have
+struct BoatType
+{
+    const wchar_t* mId;         ///< Type id
+    int mWidth;                 ///< Width in tiles
+    const wchar_t* mImage;      ///< Image
+};
+
+/// Boats a stress level has
+const BoatType Boats[] = {
+    { L"b2", 2, L"green-raft.png" },
+    { L"b3b", 3, L"red-boat.png" },
+    { L"b4c", 4, L"green-canoe.png" } };
+
+/// Cargo a stress level has, named for their images, used again if there are more
+const wchar_t* const CargoNames[] = { L"buckeye", L"gopher", L"badger", L"fox", L"goose", L"grain" };
+
+/// Items in each level the benchmark makes, about
+const int BenchmarkItems[] = { 100, 10000, 1000000 };
+
+/// Vehicles in each lane of the benchmark's levels
+const int BenchmarkVehicles = 4;
+
+/// Decor items in each row of the benchmark's levels
+const int BenchmarkDecor = 8;
+
+/// Frames timed on each of the benchmark's levels
+const int BenchmarkFrames = 500;
+
+/// Seconds before a lost level is loaded again that the benchmark loads it itself, outside the timing
+const double ReloadSlack = 0.5;
+
+/// Growth past which a subsystem is reported as growing faster than the items
+const double SuperlinearGrowth = 1.3;
+
+
+/**
+ * Make a level document at a scale
+ * \param config How big a level to make
+ * \returns Root node of the level document
+ */
+std::shared_ptr<xmlnode::CXmlNode> CStressLevel::Make(const Config& config)
+{
+    mt19937 random(config.mSeed);
+    int decor = min(max(config.mDecorPerRow, 1), Columns);
+    int vehicles = max(config.mVehiclesPerLane, 0);
+    int cargo = min(max(config.mCargo, 0), (int)CCargoPuzzle::MaxCargo);
+
+    // Runs of roads and rivers with grass between them, between the banks
+    vector<CRuleTable::Terrain> lanes;
+    CRuleTable::Terrain kind = CRuleTable::Road;
+    for (int made = 0; made < config.mLanes; kind = kind == CRuleTable::Road ? CRuleTable::River : CRuleTable::Road)
+    {
+        int run = min(uniform_int_distribution<int>(1, MaxRun)(random), config.mLanes - made);
+        if (made > 0)
+        {
+            lanes.push_back(CRuleTable::Land);
+        }
+        lanes.insert(lanes.end(), run, kind);
+        made += run;
+    }
+
+    // A level is never shorter than the screen
+    while ((int)lanes.size() + 2 * BankRows < CRuleTable::Rows)
+    {
+        lanes.push_back(CRuleTable::Land);
+    }
+    int rows = (int)lanes.size() + 2 * BankRows;
+
+    auto root = CXmlNode::CreateDocument(L"level");
+    root->SetAttribute(L"rows", rows);
+
+    auto types = root->AddChild(L"types");
+    const wchar_t* tiles[] = { L"grass", L"r002", L"r001" };
+    const wchar_t* tileImages[] = { L"grass1.png", L"road1.png", L"river.png" };
+    const wchar_t* terrain[] = { L"", L"road", L"river" };
+    for (int i = 0; i < 3; i++)
+    {
+        auto node = types->AddChild(L"decor");
+        node->SetAttribute(L"id", tiles[i]);
+        node->SetAttribute(L"image", tileImages[i]);
+        if (*terrain[i] != 0)
+        {
+            node->SetAttribute(L"terrain", terrain[i]);
+        }
+    }
+
+    auto bank = types->AddChild(L"decor");
+    bank->SetAttribute(L"id", L"s001");
+    bank->SetAttribute(L"image", L"sidewalk1.png");
+
+    for (auto& car : Cars)
+    {
+        auto node = types->AddChild(L"car");
+        node->SetAttribute(L"id", car.mId);
+        node->SetAttribute(L"name", car.mName);
+        node->SetAttribute(L"width", car.mWidth);
+        node->SetAttribute(L"image1", car.mImage1);
+        node->SetAttribute(L"image2", car.mImage2);
+    }
+
+    for (auto& boat : Boats)
+    {
+        auto node = types->AddChild(L"boat");
+        node->SetAttribute(L"id", boat.mId);
+        node->SetAttribute(L"width", boat.mWidth);
+        node->SetAttribute(L"image", boat.mImage);
+    }
+
+    // The ground of each row is split into as many decor items as asked
+    auto background = root->AddChild(L"background");
+    for (int row = 0; row < rows; row++)
+    {
+        int lane = row - BankRows;
+        bool onBank = lane < 0 || lane >= (int)lanes.size();
+        const wchar_t* id = onBank ? L"s001" : tiles[lanes[lane]];
+        for (int part = 0; part < decor; part++)
+        {
+            int left = part * Columns / decor;
+            int right = (part + 1) * Columns / decor;
+            auto node = background->AddChild(L"decor");
+            node->SetAttribute(L"id", id);
+            node->SetAttribute(L"x", left);
+            node->SetAttribute(L"y", row);
+            node->SetAttribute(L"repeat-x", right - left);
+        }
+    }
+
+    auto hero = root->AddChild(L"hero");
+    hero->SetAttribute(L"image", L"sparty.png");
+    hero->SetAttribute(L"name", L"Sparty");
+    hero->SetAttribute(L"hit-image", L"sparty-hit.png");
+    hero->SetAttribute(L"mask", L"sparty-mask.png");
+
+    // Cargo is spread along the bottom bank, which is where it starts
+    const int cargoNames = sizeof(CargoNames) / sizeof(CargoNames[0]);
+    for (int i = 0; i < cargo; i++)
+    {
+        wstring name = CargoNames[i % cargoNames];
+        wstring title = name;
+        title[0] = towupper(title[0]);
+        wostringstream id;
+        id << name << i;
+        wostringstream x;
+        x << (i + 0.5) * Columns / cargo;
+
+        auto node = root->AddChild(L"cargo");
+        node->SetAttribute(L"id", id.str());
+        node->SetAttribute(L"x", x.str());
+        node->SetAttribute(L"name", title);
+        node->SetAttribute(L"image", name + L".png");
+        node->SetAttribute(L"carried-image", name + L"-carried.png");
+        if (config.mEats && i > 0)
+        {
+            wostringstream eats;
+            eats << CargoNames[(i - 1) % cargoNames] << i - 1;
+            node->SetAttribute(L"eats", eats.str());
+        }
+    }
+
+    // The vehicles of a lane are spread evenly, with room between them
+    uniform_real_distribution<double> speeds(MinSpeed, MaxSpeed);
+    uniform_int_distribution<int> widths(config.mMinWidth, max(config.mMaxWidth, config.mMinWidth));
+    for (int lane = 0; lane < (int)lanes.size(); lane++)
+    {
+        if (lanes[lane] == CRuleTable::Land)
+        {
+            continue;
+        }
+
+        bool road = lanes[lane] == CRuleTable::Road;
+        int spacing = (road ? 3 : 4) + 1;
+        int width = max(widths(random), vehicles * spacing);
+        double speed = speeds(random) * (random() % 2 == 0 ? 1 : -1);
+
+        wostringstream speedText;
+        speedText << setprecision(3) << speed;
+        auto node = root->AddChild(road ? L"road" : L"river");
+        node->SetAttribute(L"y", lane + BankRows);
+        node->SetAttribute(L"speed", speedText.str());
+        node->SetAttribute(L"width", width);
+
+        for (int i = 0; i < vehicles; i++)
+        {
+            auto vehicle = node->AddChild(road ? L"car" : L"boat");
+            int type = road ? random() % (sizeof(Cars) / sizeof(Cars[0])) : random() % (sizeof(Boats) / sizeof(Boats[0]));
+            vehicle->SetAttribute(L"id", road ? Cars[type].mId : Boats[type].mId);
+            vehicle->SetAttribute(L"x", i * width / vehicles);
+        }
+    }
+
+    return root;
+}
+
+
+/**
+ * Time a function
+ * \param function Function to time
+ * \returns Time it took in microseconds
+ */
+template <class Function>
+static double Time(Function function)
+{
+    auto start = chrono::steady_clock::now();
+    function();
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+}
+
+
+/**
+ * Measure how loading, updating, collision testing and drawing grow
+ * with the number of items in a level.
+ *
+ * Levels of about 10^2, 10^4 and 10^6 items are made with the same
+ * lanes and decor, only more of them. Each is compiled straight from
+ * its document, then saved and loaded from the file the way the game
+ * loads levels, and played into a game. The hero is walked up the
+ * level a row a frame with the cheats on and cargo that eats nothing,
+ * so nothing loses. Each frame is timed as an update, a boat test and
+ * a click hit test, and a recorded frame.
+ *
+ * How much each grows from one level to the next is reported as the
+ * power of the number of items it goes as, so 1 is linear and 0 is
+ * flat. Anything growing faster than the items is pointed out.
+ *
+ * The files are saved in the temporary directory and deleted once
+ * they are loaded, so the game's own levels are left alone.
+ *
+ * \returns Report text
+ */
+std::wstring CStressLevel::Benchmark()
+{
+    const wchar_t* names[] = { L"Make", L"Compile", L"Parse", L"Instance", L"Update", L"Collision", L"Draw" };
+    const int Subsystems = sizeof(names) / sizeof(names[0]);
+    const int Sizes = sizeof(BenchmarkItems) / sizeof(BenchmarkItems[0]);
+
+    wostringstream report;
+    report << L"Stress level benchmark, " << BenchmarkVehicles << L" vehicles a lane, " << BenchmarkDecor
+        << L" decor a row, " << BenchmarkFrames << L" frames of " << CSimThread::TickTime * 1000 << L" ms ticks"
+        << endl << endl;
+    report << L"Items\tRows\tMake\tCompile\tParse\tInstance\tUpdate\tCollision\tDraw" << endl;
+    report << fixed;
+
+    wchar_t temp[MAX_PATH];
+    GetTempPath(MAX_PATH, temp);
+    wstring filename = wstring(temp) + L"stress.xml";
+    double items[Sizes];
+    double times[Sizes][Subsystems];
+    for (int size = 0; size < Sizes; size++)
+    {
+        Config config;
+        config.mVehiclesPerLane = BenchmarkVehicles;
+        config.mDecorPerRow = BenchmarkDecor;
+        config.mEats = false;
+        config.mLanes = max(1, BenchmarkItems[size] / (BenchmarkVehicles + BenchmarkDecor * 3 / 2));
+
+        double* time = times[size];
+        CGame game;
+        shared_ptr<CXmlNode> root;
+        time[0] = Time([&] { root = Make(config); });
+
+        {
+            CLevel compiled(&game);
+            time[1] = Time([&] { compiled.Load(root); });
+        }
+
+        root->Save(filename);
+        root = nullptr;
+
+        auto level = make_shared<CLevel>(&game);
+        time[2] = Time([&] { level->Load(filename); });
+        DeleteFile(filename.c_str());
+
+        game.Add(level);
+        time[3] = Time([&] { game.Load(0); });
+        items[size] = (double)(level->GetItems().size() + level->GetCargo().size() + 1);
+
+        game.SetRoadCheatState(true);
+        game.SetRiverCheatState(true);
+        int rows = game.GetRows();
+        double cargoX = game.GetCargo(0) != nullptr ? game.GetCargo(0)->GetX() : 0;
+        CRenderList list;
+        time[4] = time[5] = time[6] = 0;
+        for (int frame = 0; frame < BenchmarkFrames; frame++)
+        {
+            if (game.GetTimeToSwitchLevel() < ReloadSlack)
+            {
+                game.Load(0);
+            }
+
+            // From the bottom bank to the top one, then again
+            int row = rows - BankRows - frame % (rows - BankRows);
+            auto hero = game.GetHero();
+            hero->SetLocation(hero->GetX(), row * TileToPixels + TileToPixels / 2);
+
+            time[4] += Time([&] { game.Update(CSimThread::TickTime); });
+            time[5] += Time([&] { game.BoatTest(); game.HitTest(cargoX, game.GetHeight() - TileToPixels / 2); });
+            time[6] += Time([&] { list.Clear(); game.BuildFrame(&list); });
+        }
+
+        report << setprecision(0) << items[size] << L"\t" << rows;
+        for (int i = 0; i < Subsystems; i++)
+        {
+            // Loading is timed once, the rest is a mean over the frames
+            if (i >= 4)
+            {
+                time[i] /= BenchmarkFrames;
+            }
+            report << L"\t" << setprecision(i < 4 ? 1 : 2) << (i < 4 ? time[i] / 1000 : time[i]) << (i < 4 ? L" ms" : L" us");
+        }
+        report << endl;
+    }
+
+    report << endl << L"Growth as a power of the items" << endl << L"Subsystem";
+    for (int size = 1; size < Sizes; size++)
+    {
+        report << L"\t" << setprecision(0) << items[size - 1] << L" to " << items[size];
+    }
+    report << endl;
+
+    wstring superlinear;
+    for (int i = 0; i < Subsystems; i++)
+    {
+        report << names[i];
+        for (int size = 1; size < Sizes; size++)
+        {
+            double growth = log(max(times[size][i], 1e-3) / max(times[size - 1][i], 1e-3)) / log(items[size] / items[size - 1]);
+            report << L"\t" << setprecision(2) << growth;
+            if (growth > SuperlinearGrowth && superlinear.find(names[i]) == wstring::npos)
+            {
+                superlinear += superlinear.empty() ? names[i] : wstring(L", ") + names[i];
+            }
+        }
+        report << endl;
+    }
+
+    report << endl << (superlinear.empty() ? L"Nothing grows faster than the items" :
+        L"Growing faster than the items: " + superlinear) << endl;
+    return report.str();
+}
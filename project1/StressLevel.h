@@ -0,0 +1,59 @@
+/**
+ * \file StressLevel.h
+ *
+ * \author Michael Dittman
+ *
+ * Makes levels of any size for stress testing, and measures how the game scales with them.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "XmlNode.h"
+
+
+/**
+ * Makes levels of any size for stress testing, and measures how the game scales with them.
+ *
+ * A Config says how many lanes a level has, how many vehicles each
+ * lane has, how many decor items each row's ground is split into, how
+ * much cargo there is and how wide the lanes are. Make builds the
+ * level document in memory. It can be saved as a level file or given
+ * straight to CLevel::Load, which compiles it into items the same way
+ * without going through a file.
+ *
+ * Lanes come in runs of roads or rivers with a row of grass between
+ * runs, between a bank at the top and a bank at the bottom. The level
+ * is as tall as it needs to be, and never shorter than a screen. The
+ * kinds, speeds and widths of the lanes follow from a seed, and the
+ * vehicles in a lane are spread out so none overlap.
+ *
+ * The benchmark makes levels of about 10^2, 10^4 and 10^6 items and
+ * times loading them, updating them, testing for collisions and
+ * drawing them, then reports how each grows with the number of items.
+ */
+class CStressLevel
+{
+public:
+    /// How big a level to make
+    struct Config
+    {
+        int mLanes = 12;            ///< Roads and rivers
+        int mVehiclesPerLane = 3;   ///< Cars or boats in each lane
+        int mDecorPerRow = 1;       ///< Decor items each row's ground is split into, 1 to 16
+        int mCargo = 3;             ///< Cargo items, up to CCargoPuzzle::MaxCargo
+        bool mEats = true;          ///< Each cargo item eats the one before it
+        int mMinWidth = 20;         ///< Fewest tiles a lane wraps around after
+        int mMaxWidth = 24;         ///< Most tiles a lane wraps around after, before room is made for the vehicles
+        unsigned mSeed = 1;         ///< Seed the lanes are made from
+    };
+
+    /// Default constructor (disabled)
+    CStressLevel() = delete;
+
+    static std::shared_ptr<xmlnode::CXmlNode> Make(const Config& config);
+
+    static std::wstring Benchmark();
+};
+
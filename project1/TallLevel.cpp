@@ -0,0 +1,275 @@
+/**
+ * \file TallLevel.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "TallLevel.h"
+#include "Game.h"
+#include "Level.h"
+#include "XmlNode.h"
+#include "SimThread.h"
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+using namespace xmlnode;
+
+/// Number of pixels wide and tall a tile is.
+const double TileToPixels = 64;
+
+/// Rows of each bank, at the top and the bottom of a level
+const int BankRows = 2;
+
+/// Rows of lanes between the banks of a level that fits on the screen
+const int LaneRows = CRuleTable::Rows - 2 * BankRows;
+
+/// Attributes of the nodes of a level that are kept when they are copied
+const wchar_t* const CopiedAttributes[] = { L"id", L"x", L"y", L"repeat-x", L"repeat-y",
+    L"color", L"height", L"width", L"speed" };
+
+/// Frames measured on each level
+const int BenchmarkFrames = 3000;
+
+/// Frames the hero stays on each row as it is walked up the level
+const int FramesPerRow = 2;
+
+/// Seconds before a lost level is loaded again that the benchmark loads it itself, outside the timing
+const double ReloadSlack = 0.5;
+
+
+/**
+ * Write a number of tiles to an attribute, without any trailing zeros
+ * \param node Node to set the attribute of
+ * \param name Attribute name
+ * \param value Tiles
+ */
+static void SetTiles(const shared_ptr<CXmlNode>& node, const wstring& name, double value)
+{
+    wostringstream text;
+    text << value;
+    node->SetAttribute(name, text.str());
+}
+
+
+/**
+ * Add a copy of a node, and of the elements in it, to a parent
+ * \param node Node to copy
+ * \param parent Node to add the copy to
+ * \returns The copy
+ */
+static shared_ptr<CXmlNode> Copy(const shared_ptr<CXmlNode>& node, const shared_ptr<CXmlNode>& parent)
+{
+    auto copy = parent->AddChild(node->GetName());
+    for (auto name : CopiedAttributes)
+    {
+        wstring value = node->GetAttributeValue(name, L"");
+        if (!value.empty())
+        {
+            copy->SetAttribute(name, value);
+        }
+    }
+
+    for (auto child : node->GetChildren())
+    {
+        if (child->GetType() == NODE_ELEMENT)
+        {
+            Copy(child, copy);
+        }
+    }
+
+    return copy;
+}
+
+
+/**
+ * Make a level taller than the screen from a level that fits on it.
+ *
+ * The rows of lanes are repeated, each time one lane band further down,
+ * and the bottom bank is moved to the bottom. Decor in the last band is
+ * cut off where the bottom bank starts. Cargo with no y of its own
+ * starts on the bottom bank wherever that is.
+ *
+ * The level is only made in memory, to be loaded with CLevel::Load,
+ * so nothing is written next to the game's levels.
+ *
+ * \param source Level file to make the tall level from
+ * \param rows Rows of tiles the tall level has, a screen's worth or more
+ * \returns Root node of the level document, null if it couldn't be made
+ */
+std::shared_ptr<xmlnode::CXmlNode> CTallLevel::Make(const std::wstring& source, int rows)
+{
+    if (rows < CRuleTable::Rows)
+    {
+        return nullptr;
+    }
+
+    shared_ptr<CXmlNode> root;
+    try
+    {
+        root = CXmlNode::OpenDocument(source);
+        root->SetAttribute(L"rows", rows);
+
+        // The bottom bank starts here in the tall level
+        int bottom = rows - BankRows;
+
+        // The nodes are found before any are added, so no copy is copied again
+        shared_ptr<CXmlNode> background;
+        vector<shared_ptr<CXmlNode>> decor;
+        vector<shared_ptr<CXmlNode>> lanes;
+        for (auto section : root->GetChildren())
+        {
+            if (section->GetType() != NODE_ELEMENT)
+            {
+                continue;
+            }
+
+            if (section->GetName() == L"background")
+            {
+                background = section;
+                for (auto node : section->GetChildren())
+                {
+                    if (node->GetType() == NODE_ELEMENT)
+                    {
+                        decor.push_back(node);
+                    }
+                }
+            }
+            else if (section->GetName() == L"road" || section->GetName() == L"river")
+            {
+                lanes.push_back(section);
+            }
+        }
+
+        for (auto node : decor)
+        {
+            double y = node->GetAttributeDoubleValue(L"y", 0);
+            if (y >= CRuleTable::Rows - BankRows)
+            {
+                SetTiles(node, L"y", y + rows - CRuleTable::Rows);
+                continue;
+            }
+
+            if (y < BankRows)
+            {
+                continue;
+            }
+
+            for (int band = LaneRows; y + band < bottom; band += LaneRows)
+            {
+                auto copy = Copy(node, background);
+                SetTiles(copy, L"y", y + band);
+
+                int repeat = node->GetAttributeIntValue(L"repeat-y", 1);
+                if (y + band + repeat > bottom)
+                {
+                    copy->SetAttribute(L"repeat-y", (int)ceil(bottom - y - band));
+                }
+            }
+        }
+
+        for (auto lane : lanes)
+        {
+            int y = lane->GetAttributeIntValue(L"y", 0);
+            for (int band = LaneRows; y + band < bottom; band += LaneRows)
+            {
+                auto copy = Copy(lane, root);
+                copy->SetAttribute(L"y", y + band);
+            }
+        }
+    }
+    catch (CXmlNode::Exception ex)
+    {
+        return nullptr;
+    }
+
+    return root;
+}
+
+
+/**
+ * Measure how long a frame takes on level 3 and on a tall level made from it.
+ *
+ * The hero is walked up each level a row every few frames, with the
+ * road and river cheats on so it can go anywhere, and the camera
+ * follows it. Each frame is an update and a recorded frame, the way
+ * the simulation thread does them. A level that is lost is loaded
+ * again outside the timing before the game would load it itself.
+ *
+ * \param levels Directory the levels are in, ending with a separator
+ * \returns Report text
+ */
+std::wstring CTallLevel::Benchmark(const std::wstring& levels)
+{
+    auto root = Make(levels + L"level3.xml", BenchmarkRows);
+    if (root == nullptr)
+    {
+        return L"Could not make a tall level from " + levels + L"level3.xml";
+    }
+
+    CGame game;
+    game.LoadLevels(levels, 4);
+    auto tall = make_shared<CLevel>(&game);
+    tall->Load(root);
+    game.Add(tall);
+    game.SetRoadCheatState(true);
+    game.SetRiverCheatState(true);
+
+    wostringstream report;
+    report << L"Tall level benchmark, " << BenchmarkFrames << L" frames of " << CSimThread::TickTime * 1000
+        << L" ms ticks with the hero walking up each level" << endl << endl;
+    report << L"Level\tRows\tRows moved\tCommands\tFrame mean\tFrame max" << endl;
+    report << fixed;
+
+    const int Levels[] = { 3, 4 };
+    double means[2] = { 0, 0 };
+    CRenderList list;
+    for (int i = 0; i < 2; i++)
+    {
+        game.Load(Levels[i]);
+        int rows = game.GetRows();
+        double total = 0;
+        double most = 0;
+        long long moved = 0;
+        long long commands = 0;
+        for (int frame = 0; frame < BenchmarkFrames; frame++)
+        {
+            if (game.GetTimeToSwitchLevel() < ReloadSlack)
+            {
+                game.Load(Levels[i]);
+            }
+
+            // From the bottom bank to the top one, then again
+            int row = rows - BankRows - (frame / FramesPerRow) % (rows - BankRows);
+            auto hero = game.GetHero();
+            hero->SetLocation(hero->GetX(), row * TileToPixels + TileToPixels / 2);
+
+            auto start = chrono::steady_clock::now();
+            game.Update(CSimThread::TickTime);
+            game.UpdateControlPanel(CSimThread::TickTime);
+            list.Clear();
+            game.BuildFrame(&list);
+            double time = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+            total += time;
+            most = max(most, time);
+            moved += game.GetLiveRows().second - game.GetLiveRows().first;
+            commands += list.GetSize();
+        }
+
+        means[i] = total / BenchmarkFrames;
+        report << (Levels[i] == 3 ? L"level3" : L"level3-tall") << L"\t" << rows << L"\t"
+            << setprecision(1) << (double)moved / BenchmarkFrames << L"\t" << (double)commands / BenchmarkFrames
+            << L"\t" << setprecision(2) << means[i] << L" us\t" << most << L" us" << endl;
+    }
+
+    report << endl << L"A frame of the " << BenchmarkRows << L"-row level took " << setprecision(2)
+        << means[1] / max(means[0], 1e-9) << L" times as long as one of level 3" << endl;
+    return report.str();
+}
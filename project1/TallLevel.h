@@ -0,0 +1,42 @@
+/**
+ * \file TallLevel.h
+ *
+ * \author Michael Dittman
+ *
+ * Makes levels taller than the screen out of a level that fits on it, and measures them.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "XmlNode.h"
+
+
+/**
+ * Makes levels taller than the screen out of a level that fits on it, and measures them.
+ *
+ * A tall level keeps the banks of the level it is made from, its top
+ * two rows and its bottom two, and repeats the rows of lanes between
+ * them until it has as many rows as asked. The level's rows attribute
+ * says how tall it is, so it loads and plays like any other level
+ * with the camera following the hero.
+ *
+ * The benchmark plays a tall level made from level 3 against level 3
+ * itself. Only the rows near the screen are drawn and moved, so the
+ * two should take about as long a frame.
+ */
+class CTallLevel
+{
+public:
+    /// Rows the benchmark's tall level has
+    const static int BenchmarkRows = 500;
+
+    /// Default constructor (disabled)
+    CTallLevel() = delete;
+
+    static std::shared_ptr<xmlnode::CXmlNode> Make(const std::wstring& source, int rows);
+
+    static std::wstring Benchmark(const std::wstring& levels);
+};
+
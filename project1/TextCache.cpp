@@ -0,0 +1,218 @@
+/**
+ * \file TextCache.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "TextCache.h"
+#include <cmath>
+
+using namespace Gdiplus;
+using namespace std;
+
+/// Characters put in every glyph atlas
+const wstring AtlasGlyphs = L"0123456789:";
+
+/// Size of the font for each style
+const REAL FontSizes[CTextCache::StyleCount] = { 15, 28, 23, 44 };
+
+/// Style of the font for each style
+const int FontStyles[CTextCache::StyleCount] = { FontStyleBold, FontStyleRegular, FontStyleBold, FontStyleBold };
+
+
+/**
+ * Constructor
+ *
+ * GDI+ objects are made when first needed, so a cache can
+ * exist before GDI+ has been started.
+ */
+CTextCache::CTextCache()
+{
+}
+
+
+/**
+ * Get the font for a style, making it the first time
+ * \param style Style to get the font of
+ * \returns Font to draw with
+ */
+Gdiplus::Font* CTextCache::GetFont(Style style)
+{
+    if (mFontFamily == nullptr)
+    {
+        mFontFamily = make_unique<FontFamily>(L"Verdana");
+        mMeasureBitmap = make_unique<Bitmap>(1, 1, PixelFormat32bppPARGB);
+        mMeasureGraphics = make_unique<Graphics>(mMeasureBitmap.get());
+        mMeasureGraphics->SetTextRenderingHint(TextRenderingHintAntiAlias);
+    }
+
+    auto& font = mFonts[style];
+    if (font == nullptr)
+    {
+        font = make_unique<Gdiplus::Font>(mFontFamily.get(), FontSizes[style], FontStyles[style]);
+    }
+
+    return font.get();
+}
+
+
+/**
+ * Measure a string the way DrawString would lay it out
+ * \param style Style of the text
+ * \param text Text to measure
+ * \returns Size of the laid out text in pixels
+ */
+Gdiplus::SizeF CTextCache::Measure(Style style, const std::wstring& text)
+{
+    Gdiplus::Font* font = GetFont(style);
+
+    RectF bounds;
+    mMeasureGraphics->MeasureString(text.c_str(), -1, font, PointF(0, 0), &bounds);
+    return SizeF(bounds.Width, bounds.Height);
+}
+
+
+/**
+ * Lay a string out into a bitmap of its own
+ * \param style Style of the text
+ * \param color Color of the text
+ * \param text Text to lay out
+ * \returns Bitmap with the text drawn at its origin, or null for empty text
+ */
+std::unique_ptr<Gdiplus::Bitmap> CTextCache::Layout(Style style, const Gdiplus::Color& color, const std::wstring& text)
+{
+    SizeF size = Measure(style, text);
+    int width = (int)ceil(size.Width);
+    int height = (int)ceil(size.Height);
+    if (width <= 0 || height <= 0)
+    {
+        return nullptr;
+    }
+
+    auto& brush = mBrushes[color.GetValue()];
+    if (brush == nullptr)
+    {
+        brush = make_unique<SolidBrush>(color);
+    }
+
+    auto bitmap = make_unique<Bitmap>(width, height, PixelFormat32bppPARGB);
+    Graphics graphics(bitmap.get());
+
+    // ClearType needs an opaque background, so use plain antialiasing
+    graphics.SetTextRenderingHint(TextRenderingHintAntiAlias);
+    graphics.DrawString(text.c_str(), -1, GetFont(style), PointF(0, 0), brush.get());
+
+    return bitmap;
+}
+
+
+/**
+ * Get the glyph atlas for a style and color, making it the first time
+ * \param style Style of the glyphs
+ * \param color Color of the glyphs
+ * \returns Atlas of the glyphs
+ */
+CTextCache::Atlas* CTextCache::GetAtlas(Style style, const Gdiplus::Color& color)
+{
+    Atlas& atlas = mAtlases[make_pair((int)style, color.GetValue())];
+    if (atlas.mBitmap != nullptr)
+    {
+        return &atlas;
+    }
+
+    //
+    // Each glyph is laid out on its own, then packed side by side.
+    // The advance leaves out the padding DrawString puts around
+    // a string, so glyphs drawn in a row line up like a string.
+    //
+    vector<unique_ptr<Bitmap>> glyphs;
+    int width = 0;
+    int height = 0;
+    for (wchar_t glyph : AtlasGlyphs)
+    {
+        wstring single(1, glyph);
+        wstring pair(2, glyph);
+        atlas.mAdvances[glyph] = Measure(style, pair).Width - Measure(style, single).Width;
+
+        glyphs.push_back(Layout(style, color, single));
+        width += (int)glyphs.back()->GetWidth();
+        height = max(height, (int)glyphs.back()->GetHeight());
+    }
+
+    atlas.mBitmap = make_unique<Bitmap>(width, height, PixelFormat32bppPARGB);
+    Graphics graphics(atlas.mBitmap.get());
+    graphics.SetCompositingMode(CompositingModeSourceCopy);
+
+    int x = 0;
+    for (size_t i = 0; i < AtlasGlyphs.size(); i++)
+    {
+        int glyphWidth = (int)glyphs[i]->GetWidth();
+        int glyphHeight = (int)glyphs[i]->GetHeight();
+        graphics.DrawImage(glyphs[i].get(), x, 0, glyphWidth, glyphHeight);
+        atlas.mCells[AtlasGlyphs[i]] = Rect(x, 0, glyphWidth, glyphHeight);
+        x += glyphWidth;
+    }
+
+    return &atlas;
+}
+
+
+/**
+ * Draw a string, laying it out only the first time it is drawn
+ * \param list Render list to record the drawing into
+ * \param style Style of the text
+ * \param color Color of the text
+ * \param text Text to draw
+ * \param x X location of the text
+ * \param y Y location of the text
+ */
+void CTextCache::DrawString(CRenderList* list, Style style, const Gdiplus::Color& color,
+    const std::wstring& text, float x, float y)
+{
+    auto& bitmap = mStrings[make_tuple((int)style, color.GetValue(), text)];
+    if (bitmap == nullptr)
+    {
+        bitmap = Layout(style, color, text);
+        if (bitmap == nullptr)
+        {
+            return;
+        }
+    }
+
+    list->DrawImage(bitmap.get(), x, y, (float)bitmap->GetWidth(), (float)bitmap->GetHeight());
+}
+
+
+/**
+ * Draw text one glyph at a time from the glyph atlas.
+ *
+ * Only the digits and the colon are in the atlas, anything
+ * else is skipped.
+ *
+ * \param list Render list to record the drawing into
+ * \param style Style of the text
+ * \param color Color of the text
+ * \param text Text to draw
+ * \param x X location of the text
+ * \param y Y location of the text
+ */
+void CTextCache::DrawGlyphs(CRenderList* list, Style style, const Gdiplus::Color& color,
+    const std::wstring& text, float x, float y)
+{
+    Atlas* atlas = GetAtlas(style, color);
+
+    for (wchar_t glyph : text)
+    {
+        auto cell = atlas->mCells.find(glyph);
+        if (cell == atlas->mCells.end())
+        {
+            continue;
+        }
+
+        const Rect& source = cell->second;
+        list->DrawImage(atlas->mBitmap.get(),
+            RectF(x, y, (float)source.Width, (float)source.Height), source);
+        x += atlas->mAdvances[glyph];
+    }
+}
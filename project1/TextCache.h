@@ -0,0 +1,93 @@
+/**
+ * \file TextCache.h
+ *
+ * \author Michael Dittman
+ *
+ * Fonts, laid out strings and glyph atlases for drawing text.
+ */
+
+#pragma once
+
+#include <map>
+#include <tuple>
+#include <string>
+#include <memory>
+#include "RenderList.h"
+
+
+/**
+ * Fonts, laid out strings and glyph atlases for drawing text.
+ *
+ * Fonts are made once. A string is laid out by GDI+ into a bitmap
+ * the first time it is drawn in a style and color, and after that
+ * drawing it is a single image blit. Text that changes all the time,
+ * like the timer, is drawn one glyph at a time from an atlas.
+ */
+class CTextCache
+{
+public:
+    /// Text styles used by the game
+    enum Style
+    {
+        Heading,    ///< Small bold status text
+        Timer,      ///< Timer digits
+        Label,      ///< Level and cargo names
+        Banner,     ///< Large messages in the middle of the screen
+        StyleCount  ///< Number of styles
+    };
+
+    CTextCache();
+
+    /// Copy constructor (disabled)
+    CTextCache(const CTextCache&) = delete;
+
+    void DrawString(CRenderList* list, Style style, const Gdiplus::Color& color,
+        const std::wstring& text, float x, float y);
+
+    void DrawGlyphs(CRenderList* list, Style style, const Gdiplus::Color& color,
+        const std::wstring& text, float x, float y);
+
+private:
+    /// Glyphs of one style and color packed into a bitmap
+    struct Atlas
+    {
+        /// Bitmap holding every glyph side by side
+        std::unique_ptr<Gdiplus::Bitmap> mBitmap;
+
+        /// Where each glyph is in the bitmap
+        std::map<wchar_t, Gdiplus::Rect> mCells;
+
+        /// How far to move right after each glyph
+        std::map<wchar_t, float> mAdvances;
+    };
+
+    Gdiplus::Font* GetFont(Style style);
+
+    Gdiplus::SizeF Measure(Style style, const std::wstring& text);
+
+    std::unique_ptr<Gdiplus::Bitmap> Layout(Style style, const Gdiplus::Color& color, const std::wstring& text);
+
+    Atlas* GetAtlas(Style style, const Gdiplus::Color& color);
+
+    /// Font family all of the styles use
+    std::unique_ptr<Gdiplus::FontFamily> mFontFamily;
+
+    /// Font for each style, made the first time it is used
+    std::unique_ptr<Gdiplus::Font> mFonts[StyleCount];
+
+    /// Brush for each color we have laid text out in
+    std::map<Gdiplus::ARGB, std::unique_ptr<Gdiplus::SolidBrush>> mBrushes;
+
+    /// Bitmap the measuring graphics draws into
+    std::unique_ptr<Gdiplus::Bitmap> mMeasureBitmap;
+
+    /// Graphics used to measure strings
+    std::unique_ptr<Gdiplus::Graphics> mMeasureGraphics;
+
+    /// Laid out strings by style, color and text
+    std::map<std::tuple<int, Gdiplus::ARGB, std::wstring>, std::unique_ptr<Gdiplus::Bitmap>> mStrings;
+
+    /// Glyph atlases by style and color
+    std::map<std::pair<int, Gdiplus::ARGB>, Atlas> mAtlases;
+};
+
@@ -0,0 +1,394 @@
+/**
+ * \file ThreadPool.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+/// Pool the thread running this is a worker of, null outside of any pool
+static thread_local CThreadPool* WorkerPool = nullptr;
+
+/// Queue of the worker running this
+static thread_local int WorkerQueue = 0;
+
+
+/**
+ * Constructor
+ * \param threads Total number of threads to use including the caller,
+ * or 0 to use one per hardware core
+ */
+CThreadPool::CThreadPool(int threads)
+{
+    if (threads <= 0)
+    {
+        threads = max(1, (int)thread::hardware_concurrency());
+    }
+
+    // The calling thread is one of the threads
+    for (int i = 0; i < threads; i++)
+    {
+        mQueues.push_back(make_unique<Queue>());
+    }
+
+    for (int i = 1; i < threads; i++)
+    {
+        mWorkers.push_back(thread(&CThreadPool::WorkerLoop, this, i));
+    }
+}
+
+/**
+ * Destructor
+ *
+ * Tasks still queued are never run.
+ */
+CThreadPool::~CThreadPool()
+{
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+
+/**
+ * Spawn a task.
+ *
+ * The task is queued once every task it runs after has finished.
+ * It is run by some thread at some point after that, and for sure
+ * by the time a Wait for it returns.
+ *
+ * \param work Work the task does
+ * \param after Tasks that have to finish before this one starts
+ * \returns The task
+ */
+CThreadPool::Task CThreadPool::Spawn(std::function<void()> work, const std::vector<Task>& after)
+{
+    auto job = make_shared<Job>();
+    job->mWork = move(work);
+    job->mPending = (int)after.size() + 1;
+
+    for (auto& before : after)
+    {
+        lock_guard<mutex> lock(before->mMutex);
+        if (before->mFinished)
+        {
+            job->mPending--;
+        }
+        else
+        {
+            before->mDependents.push_back(job);
+        }
+    }
+
+    if (--job->mPending == 0)
+    {
+        Push(job);
+    }
+
+    return job;
+}
+
+
+/**
+ * Wait for a task to finish, running queued tasks in the meantime
+ * \param task Task to wait for
+ */
+void CThreadPool::Wait(const Task& task)
+{
+    while (!task->mDone)
+    {
+        if (RunOne())
+        {
+            continue;
+        }
+
+        // Nothing to do but wait for another thread to finish something
+        unique_lock<mutex> lock(mMutex);
+        mWaiting++;
+        mFinished.wait(lock, [&] { return task->mDone || mQueued > 0; });
+        mWaiting--;
+    }
+}
+
+
+/**
+ * Wait for tasks to finish, running queued tasks in the meantime
+ * \param tasks Tasks to wait for
+ */
+void CThreadPool::Wait(const std::vector<Task>& tasks)
+{
+    for (auto& task : tasks)
+    {
+        Wait(task);
+    }
+}
+
+
+/**
+ * Run body over [begin, end) split into chunks of grain indices.
+ *
+ * Returns once every chunk has been run. Chunks may be run in
+ * any order and on any thread, and the caller always runs some.
+ * With no workers the body is called once for the whole range.
+ *
+ * \param begin First index
+ * \param end One past the last index
+ * \param grain Number of indices to hand out at a time
+ * \param body Function called with the [start, stop) range of each chunk
+ */
+void CThreadPool::ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    grain = max(grain, 1);
+
+    // Not worth waking anybody up
+    if (GetThreadCount() == 1 || end - begin <= grain)
+    {
+        body(begin, end);
+        return;
+    }
+
+    // Each helper takes chunks until there are none left, so a
+    // helper that is stolen late finds nothing and costs little
+    atomic<int> next{ begin };
+    auto chunks = [&]
+    {
+        for (int start = next.fetch_add(grain); start < end; start = next.fetch_add(grain))
+        {
+            body(start, min(start + grain, end));
+        }
+    };
+
+    int helpers = min((end - begin + grain - 1) / grain, GetThreadCount()) - 1;
+    vector<Task> tasks;
+    for (int i = 0; i < helpers; i++)
+    {
+        tasks.push_back(Spawn(chunks));
+    }
+
+    // The caller works too
+    chunks();
+    Wait(tasks);
+}
+
+
+/**
+ * Get counts of the tasks run since the pool was made or ResetStats
+ * \returns Counts
+ */
+CThreadPool::Stats CThreadPool::GetStats() const
+{
+    Stats stats;
+    stats.mRun = mRun;
+    stats.mStolen = mStolen;
+    return stats;
+}
+
+
+/**
+ * Start counting the tasks run from zero
+ */
+void CThreadPool::ResetStats()
+{
+    mRun = 0;
+    mStolen = 0;
+}
+
+
+/**
+ * Set if the workers are left idle.
+ *
+ * While they are, tasks only run on threads that wait for them and
+ * a ParallelFor runs on the caller alone.
+ *
+ * \param single True to leave the workers idle
+ */
+void CThreadPool::SetSingleThreaded(bool single)
+{
+    {
+        lock_guard<mutex> lock(mMutex);
+        mSingleThreaded = single;
+    }
+    mWake.notify_all();
+}
+
+
+/**
+ * Get the pool shared by loading, simulation, rendering and tools.
+ *
+ * The pool is made the first time it is asked for and is never
+ * destroyed, its threads end with the process.
+ *
+ * \returns Pool with one thread per hardware core
+ */
+CThreadPool* CThreadPool::GetShared()
+{
+    static CThreadPool* shared = new CThreadPool();
+    return shared;
+}
+
+
+/**
+ * Get the queue the calling thread puts tasks in
+ * \returns Queue index, 0 for threads outside the pool
+ */
+int CThreadPool::GetQueueIndex() const
+{
+    return WorkerPool == this ? WorkerQueue : 0;
+}
+
+
+/**
+ * Queue a task that is ready to run
+ * \param job Task to queue
+ */
+void CThreadPool::Push(const Task& job)
+{
+    {
+        Queue& queue = *mQueues[GetQueueIndex()];
+        lock_guard<mutex> lock(queue.mMutex);
+        queue.mJobs.push_back(job);
+        mQueued++;
+    }
+
+    if (mSleeping > 0 || mWaiting > 0)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mWake.notify_one();
+        mFinished.notify_all();
+    }
+}
+
+
+/**
+ * Run one queued task, if there are any.
+ *
+ * The newest task in the thread's own queue is taken first. It is the
+ * most likely to still be in the cache, and a thread waiting on tasks
+ * it spawned goes depth first rather than piling up waits. Failing
+ * that, the oldest task of the other queues is stolen. Workers left
+ * idle run nothing.
+ *
+ * \returns True if a task was run
+ */
+bool CThreadPool::RunOne()
+{
+    int own = GetQueueIndex();
+    if (own != 0 && mSingleThreaded)
+    {
+        return false;
+    }
+
+    int count = (int)mQueues.size();
+    for (int i = 0; i < count; i++)
+    {
+        Queue& queue = *mQueues[(own + i) % count];
+        Task job;
+        {
+            lock_guard<mutex> lock(queue.mMutex);
+            if (queue.mJobs.empty())
+            {
+                continue;
+            }
+
+            if (i == 0)
+            {
+                job = move(queue.mJobs.back());
+                queue.mJobs.pop_back();
+            }
+            else
+            {
+                job = move(queue.mJobs.front());
+                queue.mJobs.pop_front();
+            }
+            mQueued--;
+        }
+
+        if (i != 0)
+        {
+            mStolen++;
+        }
+
+        Run(job);
+        return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * Run a task and queue the tasks that were waiting on it
+ * \param job Task to run
+ */
+void CThreadPool::Run(const Task& job)
+{
+    job->mWork();
+    job->mWork = nullptr;
+    mRun++;
+
+    vector<Task> dependents;
+    {
+        lock_guard<mutex> lock(job->mMutex);
+        job->mFinished = true;
+        dependents.swap(job->mDependents);
+    }
+
+    for (auto& dependent : dependents)
+    {
+        if (--dependent->mPending == 0)
+        {
+            Push(dependent);
+        }
+    }
+
+    job->mDone = true;
+    if (mWaiting > 0)
+    {
+        lock_guard<mutex> lock(mMutex);
+        mFinished.notify_all();
+    }
+}
+
+
+/**
+ * Loop run by every worker thread
+ * \param index Queue of the worker
+ */
+void CThreadPool::WorkerLoop(int index)
+{
+    WorkerPool = this;
+    WorkerQueue = index;
+
+    while (true)
+    {
+        if (RunOne())
+        {
+            continue;
+        }
+
+        unique_lock<mutex> lock(mMutex);
+        mSleeping++;
+        mWake.wait(lock, [this] { return mStop || (mQueued > 0 && !mSingleThreaded); });
+        mSleeping--;
+        if (mStop)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * \file ThreadPool.h
+ *
+ * \author Michael Dittman
+ *
+ * Pool of worker threads that run tasks and split work over ranges.
+ */
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+
+/**
+ * Pool of worker threads that run tasks and split work over ranges.
+ *
+ * Every worker has its own queue of tasks. A worker runs the newest
+ * task in its own queue first, and when that is empty steals the
+ * oldest task from another queue. Threads that are not in the pool
+ * share one more queue the same way. A task can wait for other tasks
+ * to finish before it is queued at all.
+ *
+ * A thread waiting for a task runs queued tasks until it finishes,
+ * so tasks can spawn and wait for more tasks. The calling thread
+ * always takes part in a ParallelFor.
+ *
+ * A pool with one thread has no workers, and a pool can be set to
+ * leave its workers idle. Tasks then run on the thread that waits
+ * for them, in an order that is the same every time. That makes
+ * problems easier to debug.
+ */
+class CThreadPool
+{
+private:
+    struct Job;
+
+public:
+    /// A task that was spawned, to wait for or run after
+    typedef std::shared_ptr<Job> Task;
+
+    /// Counts of the tasks the pool has run
+    struct Stats
+    {
+        long long mRun = 0;         ///< Tasks run
+        long long mStolen = 0;      ///< Tasks run by a thread other than the one that queued them
+    };
+
+    /// Copy constructor (disabled)
+    CThreadPool(const CThreadPool&) = delete;
+
+    /// Assignment operator (disabled)
+    void operator=(const CThreadPool&) = delete;
+
+    CThreadPool(int threads = 0);
+
+    virtual ~CThreadPool();
+
+    Task Spawn(std::function<void()> work, const std::vector<Task>& after = {});
+
+    void Wait(const Task& task);
+
+    void Wait(const std::vector<Task>& tasks);
+
+    void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    /** Number of threads that take part in a ParallelFor, including the caller
+     * \returns Thread count */
+    int GetThreadCount() const { return mSingleThreaded ? 1 : (int)mWorkers.size() + 1; }
+
+    void SetSingleThreaded(bool single);
+
+    /** Are the workers left idle?
+     * \returns True if tasks only run on threads that wait for them */
+    bool GetSingleThreaded() const { return mSingleThreaded; }
+
+    Stats GetStats() const;
+
+    void ResetStats();
+
+    static CThreadPool* GetShared();
+
+private:
+    /// A task and the tasks waiting on it
+    struct Job
+    {
+        /// Work the task does
+        std::function<void()> mWork;
+
+        /// Tasks still to finish before this one is queued, plus one
+        /// until Spawn is done with it
+        std::atomic<int> mPending{ 1 };
+
+        /// Set once the work is done
+        std::atomic<bool> mDone{ false };
+
+        /// Protects mDependents and mFinished
+        std::mutex mMutex;
+
+        /// Tasks to queue once this one is done
+        std::vector<Task> mDependents;
+
+        /// Set under mMutex once mDependents have been let go
+        bool mFinished = false;
+    };
+
+    /// Tasks ready to run that one thread queued
+    struct Queue
+    {
+        /// Protects mJobs
+        std::mutex mMutex;
+
+        /// Tasks in the order they were queued
+        std::deque<Task> mJobs;
+    };
+
+    void WorkerLoop(int index);
+
+    void Push(const Task& job);
+
+    bool RunOne();
+
+    void Run(const Task& job);
+
+    int GetQueueIndex() const;
+
+    /// The worker threads
+    std::vector<std::thread> mWorkers;
+
+    /// Queue 0 is shared by threads outside the pool, then one per worker
+    std::vector<std::unique_ptr<Queue>> mQueues;
+
+    /// Protects sleeping and waiting
+    std::mutex mMutex;
+
+    /// Signalled when a task is queued or the pool is stopping
+    std::condition_variable mWake;
+
+    /// Signalled when a task finishes while threads are waiting
+    std::condition_variable mFinished;
+
+    /// Number of tasks in the queues
+    std::atomic<int> mQueued{ 0 };
+
+    /// Number of workers asleep for want of tasks
+    std::atomic<int> mSleeping{ 0 };
+
+    /// Number of threads blocked in Wait
+    std::atomic<int> mWaiting{ 0 };
+
+    /// Tasks run
+    std::atomic<long long> mRun{ 0 };
+
+    /// Tasks stolen from another thread's queue
+    std::atomic<long long> mStolen{ 0 };
+
+    /// Set when the workers are left idle
+    std::atomic<bool> mSingleThreaded{ false };
+
+    /// Set when the pool is being destroyed
+    bool mStop = false;
+};
@@ -0,0 +1,73 @@
+/**
+ * \file TripleBuffer.h
+ *
+ * \author Michael Dittman
+ *
+ * Three copies of a value handed from one thread to another without locks.
+ */
+
+#pragma once
+
+#include <atomic>
+
+
+/**
+ * Three copies of a value handed from one thread to another without locks.
+ *
+ * The writer fills in the back copy and publishes it. The reader
+ * takes the newest copy published when it wants one. Neither ever
+ * waits for the other: the writer always has a copy the reader isn't
+ * using, and copies the reader never got to are written over.
+ *
+ * Only one thread may write and only one may read.
+ */
+template <class T>
+class CTripleBuffer
+{
+public:
+    /** Get the copy the writer fills in
+     * \returns Back copy */
+    T& GetBack() { return mCopies[mBack]; }
+
+    /** Hand the back copy to the reader, and take another to fill in */
+    void Publish()
+    {
+        mBack = mMiddle.exchange(mBack | Fresh) & Index;
+    }
+
+    /** Take the newest copy published, if there is one the reader hasn't had
+     * \returns True if the front copy changed */
+    bool Acquire()
+    {
+        if ((mMiddle.load() & Fresh) == 0)
+        {
+            return false;
+        }
+
+        mFront = mMiddle.exchange(mFront) & Index;
+        return true;
+    }
+
+    /** Get the copy the reader has
+     * \returns Front copy */
+    const T& GetFront() const { return mCopies[mFront]; }
+
+private:
+    /// Bit set on the middle copy when it is newer than the front
+    const static int Fresh = 4;
+
+    /// Bits of the index of a copy
+    const static int Index = 3;
+
+    /// The copies
+    T mCopies[3];
+
+    /// Copy the writer fills in
+    int mBack = 0;
+
+    /// Copy waiting between the two, with the fresh bit
+    std::atomic<int> mMiddle{ 1 };
+
+    /// Copy the reader has
+    int mFront = 2;
+};
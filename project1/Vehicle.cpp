@@ -6,12 +6,19 @@
 
 #include "pch.h"
 #include "Vehicle.h"
+#include <cmath>
+#include <algorithm>
 
 using namespace Gdiplus;
+using namespace std;
 
 /// Number of pixels wide and tall a tile is.
 const int TileToPixels = 64;
 
+/// Widest a vehicle can be, in pixels. Vehicles going right go this
+/// far past the end of the lane before they wrap around.
+const double MaxVehicleWidth = 256;
+
 /**
  * Constructor
  * \param game Pointer to the game this decor is a part of
@@ -57,36 +64,276 @@ CVehicle::CVehicle(const CVehicle& vehicle) : CItem(vehicle)
     mSpeed = vehicle.mSpeed;
     mLaneWidth = vehicle.mLaneWidth;
     mId = vehicle.mId;
+    mStartX = vehicle.mStartX;
+    mTime = vehicle.mTime;
+    mStarted = vehicle.mStarted;
+    mSweepStart = vehicle.mSweepStart;
 }
 
 /**
- * Update function for vehicle. Checks if a vehicle needs to be reset 
- * to the other side of the screen.
+ * Update function for vehicle. Moves the vehicle to where it is
+ * after this much more time has passed.
  * \param elapsed Time elapsed
  */
 void CVehicle::Update(double elapsed)
 {
+    SetTime(mTime + elapsed);
+}
+
+
+/**
+ * Move the vehicle to where it is at a time since it started moving.
+ *
+ * This does not depend on how the vehicle got to its current
+ * location, so a vehicle can be moved to any time at once.
+ *
+ * \param time Time in seconds
+ */
+void CVehicle::SetTime(double time)
+{
+    if (!mStarted)
+    {
+        mStartX = GetX();
+        mStarted = true;
+    }
+
+    double elapsed = time - mTime;
+    mTime = time;
+
+    double x = GetPositionAt(time);
+    SetLocation(x, GetY());
+
+    // The vehicle moved in a straight line to here, starting
+    // where it came back into the lane if it wrapped around
+    mSweepStart = x - mSpeed * max(elapsed, 0.0);
+    double laneWidth = mLaneWidth * TileToPixels;
+    if (laneWidth > 0 && mSpeed > 0)
+    {
+        mSweepStart = max(mSweepStart, GetWidth() - 2 * MaxVehicleWidth);
+    }
+    else if (laneWidth > 0 && mSpeed < 0)
+    {
+        mSweepStart = min(mSweepStart, laneWidth - GetWidth() / 2);
+    }
+}
 
-    const int maxVehicleWidth = 256;
+
+/**
+ * Get where the vehicle is at a time since it started moving.
+ *
+ * A vehicle going right comes back in on the left once it is well
+ * past the end of the lane, and a vehicle going left comes back in
+ * on the right once it is off the left edge. Between those it moves
+ * at a constant speed, so the location follows straight from where
+ * it started.
+ *
+ * \param time Time in seconds
+ * \returns X location of the center of the vehicle
+ */
+double CVehicle::GetPositionAt(double time) const
+{
+    double x = (mStarted ? mStartX : GetX()) + mSpeed * time;
 
     // Width of the lane (in pixels)
-    int laneWidth = mLaneWidth * TileToPixels;
+    double laneWidth = mLaneWidth * TileToPixels;
+    if (laneWidth <= 0 || mSpeed == 0)
+    {
+        return x;
+    }
+
+    if (mSpeed > 0)
+    {
+        // Locations run from here up to where the vehicle wraps
+        double left = GetWidth() - 2 * MaxVehicleWidth;
+        double period = laneWidth + MaxVehicleWidth;
+        double offset = fmod(x - left, period);
+        return left + (offset < 0 ? offset + period : offset);
+    }
+
+    // Locations run down from here to where the vehicle wraps
+    double right = laneWidth - GetWidth() / 2;
+    double offset = fmod(right - x, laneWidth);
+    return right - (offset < 0 ? offset + laneWidth : offset);
+}
+
+
+/**
+ * Get the part of the lane the vehicle covers at a time since it
+ * started moving.
+ * \param time Time in seconds
+ * \returns Left and right edges of the vehicle
+ */
+std::pair<double, double> CVehicle::GetExtentAt(double time) const
+{
+    double x = GetPositionAt(time);
+    return std::make_pair(x - GetWidth() / 2, x + GetWidth() / 2);
+}
+
 
-    // If going off the left of the screen
-    if (GetX() + (GetWidth() / 2) <= 0 && mSpeed < 0)
+/**
+ * Get the parts of the lane the vehicle covers some of the time
+ * between two times.
+ *
+ * The vehicle moves in a straight line unless it wraps around, in
+ * which case it covers the end of the lane it went out at and the
+ * start of the lane it came back in at.
+ *
+ * \param from Time in seconds to start at
+ * \param to Time in seconds to end at, less than a period after from
+ * \param sweep Filled in with the left and right edges of each part in virtual pixels
+ * \returns Number of parts, 2 if the vehicle wrapped around and 1 if it didn't
+ */
+int CVehicle::GetSweep(double from, double to, std::pair<double, double> sweep[2]) const
+{
+    double half = GetWidth() / 2;
+    double start = GetPositionAt(from);
+    double end = GetPositionAt(to);
+    double distance = mSpeed * (to - from);
+
+    if (fabs(end - start - distance) < 0.001)
     {
-        // Set the vehicle to the right boundary
-        SetLocation(GetX() + laneWidth, GetY());
+        sweep[0] = make_pair(min(start, end) - half, max(start, end) + half);
+        return 1;
     }
 
-    // If going off the right of the screen
-    if (GetX() + maxVehicleWidth >= laneWidth + GetWidth() && mSpeed > 0)
+    // Wrapped around, the part before and the part after
+    sweep[0] = make_pair(min(start, start + distance) - half, max(start, start + distance) + half);
+    sweep[1] = make_pair(min(end - distance, end) - half, max(end - distance, end) + half);
+    return 2;
+}
+
+
+/**
+ * Get where the vehicle wraps around.
+ * \returns Position of the center where the vehicle goes out of the
+ * lane and where it comes back in, in virtual pixels
+ */
+std::pair<double, double> CVehicle::GetWrap() const
+{
+    double laneWidth = mLaneWidth * TileToPixels;
+    if (mSpeed > 0)
     {
-        // Set to the left boundary
-        SetLocation(GetX() - laneWidth - maxVehicleWidth, GetY());
+        double left = GetWidth() - 2 * MaxVehicleWidth;
+        return make_pair(left + laneWidth + MaxVehicleWidth, left);
     }
 
-	SetLocation(GetX() + mSpeed* elapsed, GetY());
+    double right = laneWidth - GetWidth() / 2;
+    return make_pair(right - laneWidth, right);
+}
+
+
+/**
+ * Get when the vehicle next starts or stops covering part of its lane.
+ *
+ * \param time Time in seconds to look forward from
+ * \param left Left edge of the part of the lane
+ * \param right Right edge of the part of the lane
+ * \returns Time in seconds, or HUGE_VAL if the vehicle never gets there
+ */
+double CVehicle::GetNextCrossing(double time, double left, double right) const
+{
+    if (mSpeed == 0)
+    {
+        return HUGE_VAL;
+    }
+
+    // Work along the direction of travel so both directions look the same.
+    // The vehicle covers the part while its center is between these.
+    double half = GetWidth() / 2;
+    double direction = mSpeed > 0 ? 1 : -1;
+    double position = direction * GetPositionAt(time);
+    double enter = mSpeed > 0 ? left - half : -right - half;
+    double leave = mSpeed > 0 ? right + half : -left + half;
+
+    double distance = HUGE_VAL;
+    double laneWidth = mLaneWidth * TileToPixels;
+    if (laneWidth <= 0)
+    {
+        if (position < enter)
+        {
+            distance = enter - position;
+        }
+        else if (position < leave)
+        {
+            distance = leave - position;
+        }
+    }
+    else
+    {
+        // Where the vehicle comes into the lane and how far it goes before it wraps
+        double start = mSpeed > 0 ? GetWidth() - 2 * MaxVehicleWidth : half - laneWidth;
+        double period = mSpeed > 0 ? laneWidth + MaxVehicleWidth : laneWidth;
+        enter = max(enter, start);
+        leave = min(leave, start + period);
+
+        if (enter >= leave)
+        {
+            return HUGE_VAL;
+        }
+
+        if (position < enter)
+        {
+            distance = enter - position;
+        }
+        else if (position < leave)
+        {
+            distance = leave - position;
+        }
+        else
+        {
+            // Around the end of the lane and back in
+            distance = period - position + enter;
+        }
+    }
+
+    return time + distance / fabs(mSpeed);
+}
+
+
+/**
+ * Get how long it takes the vehicle to go once around its lane.
+ *
+ * Every vehicle in a lane has the same speed and lane width, so
+ * this is also how often the traffic in the lane repeats.
+ *
+ * \returns Time in seconds, 0 if the vehicle never comes back around
+ */
+double CVehicle::GetPeriod() const
+{
+    double laneWidth = mLaneWidth * TileToPixels;
+    if (laneWidth <= 0 || mSpeed == 0)
+    {
+        return 0;
+    }
+
+    // Vehicles going right go past the end of the lane before they wrap
+    return (mSpeed > 0 ? laneWidth + MaxVehicleWidth : laneWidth) / fabs(mSpeed);
+}
+
+
+/**
+ * Get the row of tiles the vehicle's lane is on
+ * \returns Row, counting from the top of the screen
+ */
+int CVehicle::GetRow() const
+{
+    return (int)floor(GetY() / TileToPixels);
+}
+
+
+/**
+ * Test if this vehicle hit an item at any time during the last update.
+ *
+ * The vehicle moved in a straight line from where it started the
+ * update to where it is now, so checking every position in between
+ * catches hits no matter how long the update was.
+ *
+ * \param item Item to test against, which is assumed not to have moved
+ * \returns True if the vehicle touched the item
+ */
+bool CVehicle::SweptCollidesWith(const CItem& item) const
+{
+    return CollidesWithSwept(item, mStarted ? mSweepStart : GetX());
 }
 
 /**
@@ -109,9 +356,9 @@ void CVehicle::XmlLoad(const std::shared_ptr<xmlnode::CXmlNode>& node)
 
 /**
  * Draw the vehicle
- * \param graphics 
+ * \param list Render list to record the drawing into
  */
-void CVehicle::Draw(Gdiplus::Graphics* graphics)
+void CVehicle::Draw(CRenderList* list)
 {
     // Get the image item
     Gdiplus::Bitmap* itemImage = this->GetImage();
@@ -127,13 +374,10 @@ void CVehicle::Draw(Gdiplus::Graphics* graphics)
     if (GetX() - GetWidth() / 2 < 0)
     {
         // Draw the vehiclke
-        CItem::Draw(graphics);
-
-        // Create a solid black brush
-        SolidBrush black(Color(0, 0, 0));
+        CItem::Draw(list);
 
         // Fill a rectangle starting off the screen and going to the edge of the boundary
-        graphics->FillRectangle(&black, float(-600), float(GetY() - hit / 2),
+        list->FillRectangle(Color(0, 0, 0), float(-600), float(GetY() - hit / 2),
             (float)600, (float)800);
 
     }
@@ -142,48 +386,17 @@ void CVehicle::Draw(Gdiplus::Graphics* graphics)
     {
 
         // Draw the vehicle
-        CItem::Draw(graphics);
-        
-        // Create a solid black brush
-        SolidBrush black(Color(0, 0, 0));
+        CItem::Draw(list);
 
         // Fill a recntangle starting at the width of the boundary to off screen
-        graphics->FillRectangle(&black, float(Width), float(GetY() - hit / 2),
+        list->FillRectangle(Color(0, 0, 0), float(Width), float(GetY() - hit / 2),
             (float)800, (float)800);
     }
     else
     {
         // Draw the vehcile normally
-        CItem::Draw(graphics);
+        CItem::Draw(list);
     }
 
 }
 
-/**
- * Checks to see if this Car hit the Hero.
- * \param x X location of the Hero
- * \param y Y location of the Hero
- * \returns True if Hero was hit, False otherwise
- */
-bool CVehicle::HitTest(double x, double y)
-{
-
-    double wid = GetImage()->GetWidth();
-    double hit = GetImage()->GetHeight();
-
-    // Make x and y relative to the top-left corner of the bitmap image.
-    // Subtracting the center makes x, y relative to the center of
-    // the image. Adding half the size makes x, y relative to the top
-    // corner of the image.
-    double testX = x - GetX() + wid / 2;
-    double testY = y - GetY() + hit / 2;
-
-    // Test to see if x, y are in the image
-    if (testX < 0 || testY < 0 || testX >= wid || testY >= hit)
-    {
-        // We are outside the image
-        return false;
-    }
-    else return true;
-
-}
@@ -9,6 +9,8 @@
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 #include "Item.h"
 #include "XmlNode.h"
 #include "Game.h"
@@ -43,15 +45,36 @@ public:
 
     virtual void Update(double elapsed);
 
+    void SetTime(double time);
+
+    /** Get the time the vehicle has been moving for
+    * \return Time in seconds
+    */
+    double GetTime() const { return mTime; }
+
+    double GetPositionAt(double time) const;
+
+    std::pair<double, double> GetExtentAt(double time) const;
+
+    int GetSweep(double from, double to, std::pair<double, double> sweep[2]) const;
+
+    std::pair<double, double> GetWrap() const;
+
+    int GetRow() const;
+
+    double GetNextCrossing(double time, double left, double right) const;
+
+    double GetPeriod() const;
+
+    bool SweptCollidesWith(const CItem& item) const;
+
     virtual void XmlLoad(const std::shared_ptr<xmlnode::CXmlNode>& node);
 
     /** Accept a visitor
      * \param visitor The visitor we accept */
     virtual void Accept(CItemVisitor* visitor) override { visitor->VisitVehicle(this); }
 
-    virtual void Draw(Gdiplus::Graphics* graphics) override;
-
-    bool HitTest(double x, double y);
+    virtual void Draw(CRenderList* list) override;
 
     /** Clones a vehicle by invoking the copy constructor, returns an item pointer
     * \return pointer to a copied object
@@ -72,5 +95,17 @@ private:
 
     /// Name
     std::wstring mId;
+
+    /// X location when the vehicle started moving
+    double mStartX = 0;
+
+    /// Time the vehicle has been moving for
+    double mTime = 0;
+
+    /// Has the vehicle started moving yet?
+    bool mStarted = false;
+
+    /// X location the vehicle moved in a straight line from in the last update
+    double mSweepStart = 0;
 };
 
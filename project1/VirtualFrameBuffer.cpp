@@ -0,0 +1,143 @@
+/**
+ * \file VirtualFrameBuffer.cpp
+ *
+ * \author Michael Dittman
+ */
+
+#include "pch.h"
+#include "VirtualFrameBuffer.h"
+#include <algorithm>
+
+using namespace Gdiplus;
+using namespace std;
+
+/// Opaque black in premultiplied ARGB
+const UINT32 LetterboxColor = 0xff000000;
+
+
+/**
+ * Constructor
+ * \param width Native width in virtual pixels
+ * \param height Native height in virtual pixels
+ */
+CVirtualFrameBuffer::CVirtualFrameBuffer(int width, int height) :
+    mWidth(width), mHeight(height), mPool(CThreadPool::GetShared()), mScaler(mPool)
+{
+    mFrame = make_unique<Bitmap>(width, height, PixelFormat32bppPARGB);
+    mFrameGraphics = make_unique<Graphics>(mFrame.get());
+}
+
+
+/**
+ * Start drawing a new frame.
+ *
+ * The frame is cleared to black and has no transform, so
+ * everything drawn is in virtual pixels.
+ *
+ * \returns Graphics to draw the frame with
+ */
+Gdiplus::Graphics* CVirtualFrameBuffer::Begin()
+{
+    mFrameGraphics->Clear(Color(Color::Black));
+    return mFrameGraphics.get();
+}
+
+
+/**
+ * Start a new frame by rasterizing a render list into it in software.
+ *
+ * The bands of the frame are rasterized in parallel on the pool.
+ *
+ * \param list Commands to rasterize, in virtual pixels
+ */
+void CVirtualFrameBuffer::Rasterize(const CRenderList& list)
+{
+    // Make sure GDI+ is done with the frame before we write to it
+    mFrameGraphics->Flush(FlushIntentionSync);
+
+    Rect frameRect(0, 0, mWidth, mHeight);
+    BitmapData frameData;
+    if (mFrame->LockBits(&frameRect, ImageLockModeWrite, PixelFormat32bppPARGB, &frameData) != Ok)
+    {
+        return;
+    }
+
+    mRenderer.Render(list, (unsigned char*)frameData.Scan0, mWidth, mHeight, frameData.Stride, 1.0f, mPool);
+
+    mFrame->UnlockBits(&frameData);
+}
+
+
+/**
+ * Scale and letterbox the frame into the window
+ * \param graphics The window graphics to present to
+ * \param width Width of the client window
+ * \param height Height of the client window
+ */
+void CVirtualFrameBuffer::Present(Gdiplus::Graphics* graphics, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // Same letterboxing as the direct drawing path
+    float scale = min(float(width) / float(mWidth), float(height) / float(mHeight));
+    int scaledWidth = max(1, min(width, (int)(mWidth * scale + 0.5f)));
+    int scaledHeight = max(1, min(height, (int)(mHeight * scale + 0.5f)));
+    int xOffset = (width - scaledWidth) / 2;
+    int yOffset = (height - scaledHeight) / 2;
+
+    if (mOutput == nullptr || (int)mOutput->GetWidth() != width || (int)mOutput->GetHeight() != height)
+    {
+        mOutput = make_unique<Bitmap>(width, height, PixelFormat32bppPARGB);
+    }
+
+    // Make sure GDI+ has finished drawing into the frame
+    mFrameGraphics->Flush(FlushIntentionSync);
+
+    Rect frameRect(0, 0, mWidth, mHeight);
+    BitmapData frameData;
+    if (mFrame->LockBits(&frameRect, ImageLockModeRead, PixelFormat32bppPARGB, &frameData) != Ok)
+    {
+        return;
+    }
+
+    Rect outputRect(0, 0, width, height);
+    BitmapData outputData;
+    if (mOutput->LockBits(&outputRect, ImageLockModeWrite, PixelFormat32bppPARGB, &outputData) != Ok)
+    {
+        mFrame->UnlockBits(&frameData);
+        return;
+    }
+
+    unsigned char* output = (unsigned char*)outputData.Scan0;
+
+    // Black bars
+    for (int y = 0; y < height; y++)
+    {
+        UINT32* row = (UINT32*)(output + (size_t)y * outputData.Stride);
+        if (y < yOffset || y >= yOffset + scaledHeight)
+        {
+            fill(row, row + width, LetterboxColor);
+        }
+        else
+        {
+            fill(row, row + xOffset, LetterboxColor);
+            fill(row + xOffset + scaledWidth, row + width, LetterboxColor);
+        }
+    }
+
+    mScaler.Scale((const unsigned char*)frameData.Scan0, mWidth, mHeight, frameData.Stride,
+        output + (size_t)yOffset * outputData.Stride + (size_t)xOffset * 4,
+        scaledWidth, scaledHeight, outputData.Stride);
+
+    mOutput->UnlockBits(&outputData);
+    mFrame->UnlockBits(&frameData);
+
+    // The output is already window sized, so this is a straight copy
+    graphics->SetCompositingMode(CompositingModeSourceCopy);
+    graphics->SetInterpolationMode(InterpolationModeNearestNeighbor);
+    graphics->DrawImage(mOutput.get(), 0, 0, width, height);
+    graphics->SetCompositingMode(CompositingModeSourceOver);
+}
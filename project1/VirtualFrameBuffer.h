@@ -0,0 +1,90 @@
+/**
+ * \file VirtualFrameBuffer.h
+ *
+ * \author Michael Dittman
+ *
+ * Offscreen frame the game is drawn into at its native size.
+ */
+
+#pragma once
+
+#include <memory>
+#include "ThreadPool.h"
+#include "FrameScaler.h"
+#include "SoftwareRenderer.h"
+
+
+/**
+ * Offscreen frame the game is drawn into at its native size.
+ *
+ * The game draws into the frame in virtual pixels with no transform,
+ * then Present scales and letterboxes the whole frame into the
+ * window in a single pass.
+ */
+class CVirtualFrameBuffer
+{
+public:
+    /// Default constructor (disabled)
+    CVirtualFrameBuffer() = delete;
+
+    /// Copy constructor (disabled)
+    CVirtualFrameBuffer(const CVirtualFrameBuffer&) = delete;
+
+    CVirtualFrameBuffer(int width, int height);
+
+    Gdiplus::Graphics* Begin();
+
+    void Rasterize(const CRenderList& list);
+
+    void Present(Gdiplus::Graphics* graphics, int width, int height);
+
+    /** Set the filter used when presenting
+     * \param filter New filter */
+    void SetFilter(CFrameScaler::Filter filter) { mScaler.SetFilter(filter); }
+
+    /** Get the filter used when presenting
+     * \returns Current filter */
+    CFrameScaler::Filter GetFilter() const { return mScaler.GetFilter(); }
+
+    /** Set if the software rasterizer palettizes its sprites
+     * \param enabled True to store sprites as 8-bit palette indices */
+    void SetPalettizedSprites(bool enabled) { mRenderer.SetPalettesEnabled(enabled); }
+
+    /** Forget the sprites made from the bitmaps drawn so far, for
+     * when those bitmaps have been freed */
+    void ClearSprites() { mRenderer.ClearSprites(); }
+
+    /** Get the memory the software rasterizer's sprites take
+     * \returns Size in bytes */
+    size_t GetSpriteBytes() const { return mRenderer.GetSpriteBytes(); }
+
+    /** Get the native frame
+     * \returns Frame bitmap */
+    Gdiplus::Bitmap* GetFrame() { return mFrame.get(); }
+
+private:
+    /// Native width in virtual pixels
+    int mWidth;
+
+    /// Native height in virtual pixels
+    int mHeight;
+
+    /// The frame at native size
+    std::unique_ptr<Gdiplus::Bitmap> mFrame;
+
+    /// Graphics that draws into mFrame
+    std::unique_ptr<Gdiplus::Graphics> mFrameGraphics;
+
+    /// The scaled and letterboxed frame at window size
+    std::unique_ptr<Gdiplus::Bitmap> mOutput;
+
+    /// Threads the scaler and renderer split rows across
+    CThreadPool* mPool;
+
+    /// Does the final scale
+    CFrameScaler mScaler;
+
+    /// Rasterizes render lists into the frame
+    CSoftwareRenderer mRenderer;
+};
+
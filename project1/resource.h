@@ -15,13 +15,39 @@
 #define ID_CHEATMENU                    32777
 #define ID_CHEATMENU_ROADCHEAT          32778
 #define ID_CHEATMENU_RIVERCHEAT         32779
+#define ID_VIEW_FRAMEBUFFER             32783
+#define ID_VIEW_BILINEARFILTER          32784
+#define ID_VIEW_SOFTWARERASTERIZER      32785
+#define ID_TOOLS_RENDERBENCHMARK        32786
+#define ID_VIEW_PALETTIZEDSPRITES       32787
+#define ID_TOOLS_SAVEREPLAY             32788
+#define ID_TOOLS_CHECKREPLAYS           32789
+#define ID_TOOLS_CHECKOCCUPANCY         32790
+#define ID_TOOLS_OCCUPANCYREPORT        32791
+#define ID_TOOLS_SOLVELEVELS            32792
+#define ID_VIEW_PATHHINT                32793
+#define ID_TOOLS_PATHHINTREPORT         32794
+#define ID_TOOLS_JOBBENCHMARK           32795
+#define ID_VIEW_SINGLETHREADEDJOBS      32796
+#define ID_VIEW_SIMULATIONTHREAD        32797
+#define ID_TOOLS_THREADTIMINGREPORT     32798
+#define ID_TOOLS_BATCHENVBENCHMARK      32799
+#define ID_TOOLS_SESSIONHOSTBENCHMARK   32800
+#define ID_TOOLS_STATESTREAMBENCHMARK   32801
+#define ID_TOOLS_DIFFICULTYESTIMATE     32802
+#define ID_TOOLS_TUNELEVELS             32803
+#define ID_LEVELMENU_ENDLESSMODE        32804
+#define ID_TOOLS_ENDLESSSOAKBENCHMARK   32805
+#define ID_LEVELMENU_TALLLEVEL          32806
+#define ID_TOOLS_TALLLEVELBENCHMARK     32807
+#define ID_TOOLS_STRESSLEVELBENCHMARK   32808
 
 // Next default values for new objects
 //
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        310
-#define _APS_NEXT_COMMAND_VALUE         32783
+#define _APS_NEXT_COMMAND_VALUE         32809
 #define _APS_NEXT_CONTROL_VALUE         1000
 #define _APS_NEXT_SYMED_VALUE           310
 #endif